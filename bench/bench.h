@@ -0,0 +1,65 @@
+#ifndef BENCH_H
+#define BENCH_H
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <utility>
+#include <vector>
+
+namespace evnt
+{
+/**
+ * Helpers of the benchmark programs (bench/). A case is run once to warm the caches up, then 'runs' times,
+ * the median time is reported: the machine noise only makes some of the runs slower. The programs print
+ * one line per case, the inputs are generated from fixed seeds so the runs are comparable.
+ */
+namespace bench
+{
+    using Clock = std::chrono::steady_clock;
+
+    // setup() runs before every run of func() and isn't timed, e.g. to release the results of the last run
+    template<typename SetupType, typename FunctionType>
+    double MedianMs(int runs, SetupType && setup, FunctionType && func)
+    {
+        setup();
+        func();
+
+        std::vector<double> times;
+        times.reserve(static_cast<size_t>(runs));
+        for(int i = 0; i < runs; ++i)
+        {
+            setup();
+
+            auto const start = Clock::now();
+            func();
+            times.push_back(std::chrono::duration<double, std::milli>(Clock::now() - start).count());
+        }
+
+        auto middle = times.begin() + static_cast<std::ptrdiff_t>(times.size() / 2);
+        std::nth_element(times.begin(), middle, times.end());
+        return *middle;
+    }
+
+    template<typename FunctionType>
+    double MedianMs(int runs, FunctionType && func)
+    {
+        return MedianMs(runs, [] {}, std::forward<FunctionType>(func));
+    }
+
+    // the time of the case and the throughput, items per second in millions
+    inline void Report(char const * name, double ms, double items)
+    {
+        std::printf("%-48s %10.3f ms %10.2f M/s\n", name, ms, ms > 0.0 ? items / ms / 1000.0 : 0.0);
+    }
+
+    // the time of the case relative to the reference case
+    inline void Report(char const * name, double ms, double items, double reference_ms)
+    {
+        std::printf("%-48s %10.3f ms %10.2f M/s %8.2fx\n", name, ms, ms > 0.0 ? items / ms / 1000.0 : 0.0,
+                    ms > 0.0 ? reference_ms / ms : 0.0);
+    }
+}   // namespace bench
+}   // namespace evnt
+
+#endif   // BENCH_H
@@ -0,0 +1,49 @@
+# Common settings of the benchmark programs, included by every bench/<name>/<name>.pro after its TARGET.
+# The programs which link the logger (src/log) add CONFIG += bench_log before the include.
+CONFIG += console
+CONFIG -= app_bundle
+CONFIG -= qt
+
+TEMPLATE = app
+
+CONFIG(release, debug|release) {
+    #This is a release build
+    DEFINES += NDEBUG
+} else {
+    #This is a debug build
+    DEFINES += DEBUG
+    TARGET = $$join(TARGET,,,_d)
+}
+
+DESTDIR = $$PWD/../bin/bench
+
+QMAKE_CXXFLAGS += -std=c++17 -Wno-unused-parameter -Wconversion -Wold-style-cast
+
+SRC_DIR = $$PWD/../src
+
+INCLUDEPATH += $$PWD $$SRC_DIR $$PWD/../include
+
+LIBS += -L$$PWD/../lib
+
+HEADERS += $$PWD/bench.h
+
+bench_log {
+    SOURCES += $$SRC_DIR/log/log.cpp
+    HEADERS += $$SRC_DIR/log/log.h
+
+    win32:{
+        INCLUDEPATH += d:/build/prj/external/libs/boost_1_77_0
+        LIBS += -Ld:/build/prj/external/libs/boost_1_77_0/stage/lib
+        LIBS += -lboost_log-mgw8-mt-x32-1_77 -lboost_system-mgw8-mt-x32-1_77
+        LIBS += -lboost_locale-mgw8-mt-x32-1_77 -lboost_thread-mgw8-mt-x32-1_77
+        LIBS += -lboost_filesystem-mgw8-mt-x32-1_77
+        LIBS += -liconv
+    }
+    unix:{
+        DEFINES += BOOST_LOG_DYN_LINK
+        LIBS += -lboost_thread -lboost_system -lboost_log -lboost_locale
+    }
+}
+
+win32:LIBS += -lz -lstdc++fs -static-libgcc -static-libstdc++ -static -lpthread
+unix:LIBS += -lz -lpthread
@@ -0,0 +1,19 @@
+# Benchmark programs of the engine subsystems, build with CONFIG+=release for meaningful numbers.
+# The programs are written to bin/bench.
+TEMPLATE = subdirs
+
+SUBDIRS += \
+    culling \
+    event \
+    filesystem \
+    imagecache \
+    imagekernels \
+    pathindex \
+    renderqueue \
+    resource \
+    snapshot \
+    spatialindex \
+    taskgraph \
+    texture \
+    threadpool \
+    transformhierarchy
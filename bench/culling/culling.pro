@@ -0,0 +1,15 @@
+TARGET = bench_culling
+
+include(../bench.pri)
+
+SOURCES += \
+    main.cpp \
+    $$SRC_DIR/core/exception.cpp \
+    $$SRC_DIR/core/taskgraph.cpp \
+    $$SRC_DIR/core/threadpool.cpp \
+    $$SRC_DIR/scene/batchculling.cpp \
+    $$SRC_DIR/scene/frustum.cpp
+
+HEADERS += \
+    $$SRC_DIR/scene/batchculling.h \
+    $$SRC_DIR/scene/frustum.h
@@ -0,0 +1,76 @@
+// CullBoxes and CullSpheres without and with the pool against the Frustum::cullBox and cullSphere loops over
+// a million random objects, about a tenth of them visible.
+#include "bench.h"
+#include "core/threadpool.h"
+#include "scene/batchculling.h"
+
+#include <algorithm>
+#include <random>
+#include <thread>
+#include <vector>
+
+using namespace evnt;
+
+int main()
+{
+    size_t const num_objects = 1000000;
+
+    std::mt19937                          rng(7);
+    std::uniform_real_distribution<float> position(-500.0f, 500.0f);
+    std::uniform_real_distribution<float> extent(0.1f, 5.0f);
+    std::vector<AABB>                     boxes;
+    BoxArray                              box_array;
+    SphereArray                           sphere_array;
+    for(size_t i = 0; i < num_objects; ++i)
+    {
+        glm::vec3 const center(position(rng), position(rng), position(rng));
+        glm::vec3 const half(extent(rng), extent(rng), extent(rng));
+
+        boxes.emplace_back(center - half, center + half);
+        box_array.add(boxes.back());
+        sphere_array.add(center, glm::length(half));
+    }
+
+    glm::mat4 const camera = glm::rotate(glm::mat4{1.0f}, 0.6f, glm::vec3(0.3f, 1.0f, 0.2f));
+    Frustum         frustum;
+    frustum.buildViewFrustum(camera, 60.0f, 1.6f, 0.5f, 400.0f);
+
+    ThreadPool            pool(std::max(1u, std::thread::hardware_concurrency()));
+    std::vector<uint64_t> visible(GetMaskSize(num_objects));
+    std::printf("kernels: %s\n", GetCullKernelsName());
+
+    double const box_loop = bench::MedianMs(5, [&] {
+        std::fill(visible.begin(), visible.end(), 0);
+        for(size_t i = 0; i < num_objects; ++i)
+            visible[i / 64] |= uint64_t{!frustum.cullBox(boxes[i])} << (i % 64);
+    });
+    bench::Report("Frustum::cullBox loop", box_loop, num_objects);
+
+    double const box_batch = bench::MedianMs(5, [&] { CullBoxes(frustum, box_array, visible.data()); });
+    bench::Report("CullBoxes", box_batch, num_objects, box_loop);
+
+    double const box_pool = bench::MedianMs(5, [&] { CullBoxes(frustum, box_array, visible.data(), pool); });
+    bench::Report("CullBoxes, pool", box_pool, num_objects, box_loop);
+
+    double const sphere_loop = bench::MedianMs(5, [&] {
+        std::fill(visible.begin(), visible.end(), 0);
+        for(size_t i = 0; i < num_objects; ++i)
+        {
+            glm::vec3 const center(sphere_array.center_x[i], sphere_array.center_y[i],
+                                   sphere_array.center_z[i]);
+            bool const      culled = frustum.cullSphere(center, sphere_array.radius[i]);
+            visible[i / 64] |= uint64_t{!culled} << (i % 64);
+        }
+    });
+    bench::Report("Frustum::cullSphere loop", sphere_loop, num_objects);
+
+    double const sphere_batch =
+        bench::MedianMs(5, [&] { CullSpheres(frustum, sphere_array, visible.data()); });
+    bench::Report("CullSpheres", sphere_batch, num_objects, sphere_loop);
+
+    double const sphere_pool =
+        bench::MedianMs(5, [&] { CullSpheres(frustum, sphere_array, visible.data(), pool); });
+    bench::Report("CullSpheres, pool", sphere_pool, num_objects, sphere_loop);
+
+    return 0;
+}
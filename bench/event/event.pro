@@ -0,0 +1,11 @@
+TARGET = bench_event
+
+include(../bench.pri)
+
+SOURCES += \
+    main.cpp \
+    $$SRC_DIR/core/threadpool.cpp
+
+HEADERS += \
+    $$SRC_DIR/core/event.h \
+    $$SRC_DIR/core/rcuptr.h
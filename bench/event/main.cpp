@@ -0,0 +1,53 @@
+// Events per second of Event<> with 1, 8 and 64 listeners: the async dispatch into the pool, the sync one on
+// the firing thread and invoke(). An async run ends when every delegate task has run.
+#include "bench.h"
+#include "core/event.h"
+
+#include <atomic>
+#include <string>
+#include <thread>
+
+using namespace evnt;
+
+int main()
+{
+    size_t const num_events = 10000;
+
+    ThreadPool pool(std::max(1u, std::thread::hardware_concurrency()));
+
+    for(size_t num_listeners : {1, 8, 64})
+    {
+        Event<void(int32_t, int32_t)> event(pool);
+        std::atomic<size_t>           calls{0};
+        for(size_t i = 0; i < num_listeners; ++i)
+            event.bind([&calls](int32_t, int32_t) { calls.fetch_add(1, std::memory_order_relaxed); });
+
+        std::string const suffix = ", " + std::to_string(num_listeners) + " listeners";
+        double const      events = static_cast<double>(num_events);
+
+        event.setDispatchMode(DispatchMode::async);
+        double const async = bench::MedianMs(5, [&] {
+            size_t const expected = calls.load() + num_events * num_listeners;
+            for(size_t i = 0; i < num_events; ++i)
+                event(static_cast<int32_t>(i), 1);
+            while(calls.load() < expected)
+                std::this_thread::yield();
+        });
+        bench::Report(("async" + suffix).c_str(), async, events);
+
+        event.setDispatchMode(DispatchMode::sync);
+        double const sync = bench::MedianMs(5, [&] {
+            for(size_t i = 0; i < num_events; ++i)
+                event(static_cast<int32_t>(i), 1);
+        });
+        bench::Report(("sync" + suffix).c_str(), sync, events, async);
+
+        double const invoked = bench::MedianMs(5, [&] {
+            for(size_t i = 0; i < num_events; ++i)
+                event.invoke(static_cast<int32_t>(i), 1);
+        });
+        bench::Report(("invoke" + suffix).c_str(), invoked, events, async);
+    }
+
+    return 0;
+}
@@ -0,0 +1,29 @@
+TARGET = bench_imagecache
+
+CONFIG += bench_log
+
+include(../bench.pri)
+
+SOURCES += \
+    main.cpp \
+    $$SRC_DIR/assets/blockcompression.cpp \
+    $$SRC_DIR/assets/imagecache.cpp \
+    $$SRC_DIR/assets/imagedata.cpp \
+    $$SRC_DIR/assets/imagekernels.cpp \
+    $$SRC_DIR/assets/texturedata.cpp \
+    $$SRC_DIR/core/exception.cpp \
+    $$SRC_DIR/core/taskgraph.cpp \
+    $$SRC_DIR/core/threadpool.cpp \
+    $$SRC_DIR/fs/file.cpp \
+    $$SRC_DIR/fs/file_mapping.cpp \
+    $$SRC_DIR/fs/file_system.cpp \
+    $$SRC_DIR/fs/file_watcher.cpp \
+    $$SRC_DIR/fs/memory_stream.cpp \
+    $$SRC_DIR/fs/path_index.cpp \
+    $$SRC_DIR/fs/zip_directory.cpp \
+    $$SRC_DIR/fs/zip_writer.cpp
+
+HEADERS += \
+    $$SRC_DIR/assets/imagecache.h \
+    $$SRC_DIR/assets/imagedata.h \
+    $$SRC_DIR/assets/texturedata.h
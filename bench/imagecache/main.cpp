@@ -0,0 +1,112 @@
+// Loading a texture through ImageCache against decoding and processing its TGA file: the first load pays
+// the decoding, the processing and the store, the next loads read the stored levels.
+#include "bench.h"
+#include "assets/imagecache.h"
+#include "assets/imagedata.h"
+#include "core/threadpool.h"
+
+#include <filesystem>
+#include <random>
+
+using namespace evnt;
+
+namespace
+{
+// smooth gradients with noise, compresses like a photo texture
+ImageData MakeImage(uint32_t size)
+{
+    ImageData id;
+    id.width  = size;
+    id.height = size;
+    id.type   = ImageData::PixelType::pt_rgba;
+    id.data   = std::make_unique<uint8_t[]>(size_t{size} * size * 4);
+
+    std::mt19937                       rng(3);
+    std::uniform_int_distribution<int> noise(-8, 8);
+    auto channel = [&](uint32_t value) {
+        return static_cast<uint8_t>(std::clamp(static_cast<int>(value * 255 / size) + noise(rng), 0, 255));
+    };
+
+    for(uint32_t y = 0; y < size; ++y)
+    {
+        for(uint32_t x = 0; x < size; ++x)
+        {
+            uint8_t * pixel = &id.data[(size_t{y} * size + x) * 4];
+            pixel[0]        = channel(x);
+            pixel[1]        = channel(y);
+            pixel[2]        = channel(size / 2);
+            pixel[3]        = 255;
+        }
+    }
+
+    return id;
+}
+
+bool Decode(BaseFile const & file, TextureProcessing const & proc, TextureData & td, ThreadPool & pool)
+{
+    ImageData id;
+    if(!ReadTGA(file, id))
+        return false;
+
+    ProcessTexture(std::move(id), proc, td, &pool);
+    return true;
+}
+}   // namespace
+
+int main()
+{
+    namespace fs = std::filesystem;
+
+    std::string const dir = (fs::temp_directory_path() / "evnt_bench_imagecache").generic_string();
+    fs::remove_all(dir);
+
+    ThreadPool    pool(std::max(1u, std::thread::hardware_concurrency()));
+    OutFile const tga  = WriteTGA("bench.tga", MakeImage(2048));
+    double const  pixels = 2048.0 * 2048.0;
+
+    ImageCache cache(dir, uint64_t{256} << 20);
+
+    TextureProcessing plain;
+    plain.compress = false;
+    plain.mipmaps  = false;
+
+    TextureProcessing bc1_mips;
+    bc1_mips.compress = true;
+    bc1_mips.format   = TextureData::Format::bc1;
+    bc1_mips.mipmaps  = true;
+
+    TextureProcessing bc7_mips = bc1_mips;
+    bc7_mips.format            = TextureData::Format::bc7;
+
+    double const key_ms = bench::MedianMs(9, [&] {
+        volatile uint64_t key = ImageCache::GetKey(tga, plain.getKey());
+        (void)key;
+    });
+    bench::Report("key of 2048x2048 tga", key_ms, pixels);
+
+    std::pair<char const *, TextureProcessing const *> const cases[] = {
+        {"rgba8", &plain}, {"bc1 + mips", &bc1_mips}, {"bc7 + mips", &bc7_mips}};
+
+    for(auto const & [name, proc] : cases)
+    {
+        std::string const suffix = std::string(", ") + name;
+
+        TextureData  td;
+        double const decode = bench::MedianMs(3, [&] { Decode(tga, *proc, td, pool); });
+        bench::Report(("decode and process" + suffix).c_str(), decode, pixels);
+
+        uint64_t const key   = ImageCache::GetKey(tga, proc->getKey());
+        double const   store = bench::MedianMs(3, [&] { cache.store(key, td); });
+        bench::Report(("cache store" + suffix).c_str(), store, pixels);
+
+        double const hit = bench::MedianMs(9, [&] {
+            TextureData cached;
+            if(!cache.find(ImageCache::GetKey(tga, proc->getKey()), cached))
+                std::printf("cache miss\n");
+        });
+        bench::Report(("cache hit" + suffix).c_str(), hit, pixels, decode);
+    }
+
+    fs::remove_all(dir);
+    return 0;
+}
@@ -0,0 +1,125 @@
+// The pixel kernels of the TGA and BMP readers against the per pixel loops they replaced, and the whole
+// ReadTGA/WriteTGA of a 2048x2048 image.
+#include "bench.h"
+#include "assets/imagedata.h"
+#include "assets/imagekernels.h"
+
+#include <random>
+#include <string>
+
+using namespace evnt;
+
+namespace
+{
+void SwapRedBlueLoop(uint8_t * dst, uint8_t const * src, size_t num_pixels, uint32_t bytes_per_pixel)
+{
+    for(size_t i = 0; i < num_pixels; ++i, dst += bytes_per_pixel, src += bytes_per_pixel)
+    {
+        dst[0] = src[2];
+        dst[1] = src[1];
+        dst[2] = src[0];
+        if(bytes_per_pixel == 4)
+            dst[3] = src[3];
+    }
+}
+
+void ExpandToRGBALoop(uint8_t * dst, uint8_t const * src, size_t num_pixels, uint8_t alpha)
+{
+    for(size_t i = 0; i < num_pixels; ++i, dst += 4, src += 3)
+    {
+        dst[0] = src[0];
+        dst[1] = src[1];
+        dst[2] = src[2];
+        dst[3] = alpha;
+    }
+}
+
+void FillPixelsLoop(uint8_t * dst, uint8_t const * pixel, size_t num_pixels, uint32_t bytes_per_pixel)
+{
+    for(size_t i = 0; i < num_pixels; ++i, dst += bytes_per_pixel)
+    {
+        for(uint32_t c = 0; c < bytes_per_pixel; ++c)
+            dst[c] = pixel[c];
+    }
+}
+}   // namespace
+
+int main()
+{
+    uint32_t const size       = 2048;
+    size_t const   num_pixels = size_t{size} * size;
+
+    std::vector<uint8_t> src(num_pixels * 4);
+    std::vector<uint8_t> dst(num_pixels * 4);
+    std::mt19937         rng(5);
+    for(auto & v : src)
+        v = static_cast<uint8_t>(rng());
+
+    std::printf("kernels: %s\n", GetImageKernelsName());
+    double const pixels = static_cast<double>(num_pixels);
+
+    for(uint32_t bpp : {3u, 4u})
+    {
+        std::string const suffix = ", " + std::to_string(bpp) + " bytes";
+
+        double const loop =
+            bench::MedianMs(9, [&] { SwapRedBlueLoop(dst.data(), src.data(), num_pixels, bpp); });
+        bench::Report(("swap red blue, loop" + suffix).c_str(), loop, pixels);
+        double const kernel =
+            bench::MedianMs(9, [&] { SwapRedBlue(dst.data(), src.data(), num_pixels, bpp); });
+        bench::Report(("swap red blue" + suffix).c_str(), kernel, pixels, loop);
+    }
+
+    double const expand_loop =
+        bench::MedianMs(9, [&] { ExpandToRGBALoop(dst.data(), src.data(), num_pixels, 255); });
+    bench::Report("expand to rgba, loop", expand_loop, pixels);
+    double const expand = bench::MedianMs(9, [&] { ExpandToRGBA(dst.data(), src.data(), num_pixels, 255); });
+    bench::Report("expand to rgba", expand, pixels, expand_loop);
+
+    double const reverse = bench::MedianMs(9, [&] { ReverseChannels(dst.data(), src.data(), num_pixels); });
+    bench::Report("reverse channels", reverse, pixels);
+
+    // the RLE packets of the TGA files, short runs dominate
+    for(size_t run : {4u, 32u})
+    {
+        std::string const suffix = ", runs of " + std::to_string(run);
+
+        double const loop = bench::MedianMs(9, [&] {
+            for(size_t i = 0; i + run <= num_pixels; i += run)
+                FillPixelsLoop(dst.data() + i * 3, src.data() + i % 1024, run, 3);
+        });
+        bench::Report(("fill pixels, loop" + suffix).c_str(), loop, pixels);
+        double const kernel = bench::MedianMs(9, [&] {
+            for(size_t i = 0; i + run <= num_pixels; i += run)
+                FillPixels(dst.data() + i * 3, src.data() + i % 1024, run, 3);
+        });
+        bench::Report(("fill pixels" + suffix).c_str(), kernel, pixels, loop);
+    }
+
+    for(auto type : {ImageData::PixelType::pt_rgb, ImageData::PixelType::pt_rgba})
+    {
+        uint32_t const    bpp    = type == ImageData::PixelType::pt_rgb ? 3 : 4;
+        std::string const suffix = ", " + std::to_string(size) + "x" + std::to_string(size) + "x" +
+                                   std::to_string(bpp);
+
+        ImageData id;
+        id.width  = size;
+        id.height = size;
+        id.type   = type;
+        id.data   = std::make_unique<uint8_t[]>(num_pixels * bpp);
+        std::copy(src.begin(), src.begin() + static_cast<std::ptrdiff_t>(num_pixels * bpp), id.data.get());
+
+        OutFile      tga;
+        double const write = bench::MedianMs(5, [&] { tga = WriteTGA("bench.tga", id); });
+        bench::Report(("WriteTGA" + suffix).c_str(), write, pixels);
+
+        double const read = bench::MedianMs(5, [&] {
+            ImageData loaded;
+            if(!ReadTGA(tga, loaded))
+                std::printf("ReadTGA failed\n");
+        });
+        bench::Report(("ReadTGA" + suffix).c_str(), read, pixels);
+    }
+
+    return 0;
+}
@@ -0,0 +1,66 @@
+// PathIndex lookups of the existing paths against the scan of a std::list of the full path strings, the
+// FileSystem table it replaced, for 200k files in 350 directories. The list runs 200 lookups, its time is
+// scaled to the 1M lookups of the index.
+#include "bench.h"
+#include "fs/path_index.h"
+
+#include <algorithm>
+#include <list>
+#include <random>
+#include <string>
+#include <vector>
+
+using namespace evnt;
+
+int main()
+{
+    size_t const num_files = 200000;
+
+    std::vector<std::string> paths;
+    paths.reserve(num_files);
+    for(size_t i = 0; i < num_files; ++i)
+    {
+        paths.push_back("textures/set" + std::to_string(i % 50) + "/sub" + std::to_string(i % 7) + "/tex_" +
+                        std::to_string(i) + ".tga");
+    }
+
+    std::mt19937        rng(2);
+    std::vector<size_t> queries(1000000);
+    for(auto & query : queries)
+        query = rng() % num_files;
+
+    std::list<std::string> list(paths.begin(), paths.end());
+    size_t const           num_list_queries = 200;
+    double const           list_lookups     = bench::MedianMs(3, [&] {
+        size_t found = 0;
+        for(size_t i = 0; i < num_list_queries; ++i)
+            found += std::find(list.begin(), list.end(), paths[queries[i]]) != list.end();
+
+        volatile size_t result = found;
+        static_cast<void>(result);
+    });
+    double const num_queries = static_cast<double>(queries.size());
+    double const reference   = list_lookups * num_queries / static_cast<double>(num_list_queries);
+    bench::Report("std::list scan, scaled to 1M lookups", reference, num_queries);
+
+    PathIndex    index;
+    double const build = bench::MedianMs(
+        3, [&] { index = PathIndex(); },
+        [&] {
+            for(size_t i = 0; i < num_files; ++i)
+                index.insert(paths[i], static_cast<uint32_t>(i));
+        });
+    bench::Report("PathIndex insert", build, static_cast<double>(num_files));
+
+    double const lookups = bench::MedianMs(5, [&] {
+        size_t found = 0;
+        for(size_t query : queries)
+            found += index.contains(paths[query]);
+
+        volatile size_t result = found;
+        static_cast<void>(result);
+    });
+    bench::Report("PathIndex find, 1M lookups", lookups, num_queries, reference);
+
+    return 0;
+}
@@ -0,0 +1,10 @@
+TARGET = bench_pathindex
+
+include(../bench.pri)
+
+SOURCES += \
+    main.cpp \
+    $$SRC_DIR/fs/path_index.cpp
+
+HEADERS += \
+    $$SRC_DIR/fs/path_index.h
@@ -0,0 +1,61 @@
+// RenderQueue::sort() without and with the pool against std::stable_sort() of the same 64-bit keys, for the
+// queue sizes of a small and of a large scene. Every run sorts a copy of the unsorted items.
+#include "bench.h"
+#include "core/threadpool.h"
+#include "scene/renderqueue.h"
+
+#include <algorithm>
+#include <random>
+#include <string>
+#include <thread>
+#include <vector>
+
+using namespace evnt;
+
+int main()
+{
+    ThreadPool   pool(std::max(1u, std::thread::hardware_concurrency()));
+    std::mt19937 rng(7);
+
+    for(size_t num_items : {5000, 50000, 500000})
+    {
+        // two layers, a tenth translucent, 64 pipelines and 1024 materials
+        std::uniform_real_distribution<float> depth(0.0f, 1e6f);
+        RenderQueue                           unsorted;
+        for(size_t i = 0; i < num_items; ++i)
+        {
+            SceneMgr::SortState state;
+            state.layer       = rng() % 2;
+            state.translucent = rng() % 10 == 0;
+            state.pipeline    = rng() % 64;
+            state.material    = rng() % 1024;
+            unsorted.add(RenderQueue::MakeKey(state, depth(rng), SceneMgr::SortOrder::Front_To_Back),
+                         static_cast<uint32_t>(i));
+        }
+
+        std::string const suffix = ", " + std::to_string(num_items) + " items";
+        int const         runs   = num_items < 100000 ? 50 : 10;
+        double const      items  = static_cast<double>(num_items);
+
+        std::vector<RenderItem> sorted;
+        double const            reference = bench::MedianMs(runs, [&] {
+            sorted = unsorted.getItems();
+            std::stable_sort(sorted.begin(), sorted.end(),
+                             [](RenderItem const & l, RenderItem const & r) { return l.key < r.key; });
+        });
+        bench::Report(("std::stable_sort" + suffix).c_str(), reference, items);
+
+        RenderQueue queue;
+        auto        sort = [&](ThreadPool * sort_pool) {
+            queue = unsorted;
+            queue.sort(sort_pool);
+        };
+        double const serial = bench::MedianMs(runs, [&] { sort(nullptr); });
+        bench::Report(("radix sort, no pool" + suffix).c_str(), serial, items, reference);
+
+        double const parallel = bench::MedianMs(runs, [&] { sort(&pool); });
+        bench::Report(("radix sort, pool" + suffix).c_str(), parallel, items, reference);
+    }
+
+    return 0;
+}
@@ -0,0 +1,13 @@
+TARGET = bench_renderqueue
+
+include(../bench.pri)
+
+SOURCES += \
+    main.cpp \
+    $$SRC_DIR/core/exception.cpp \
+    $$SRC_DIR/core/taskgraph.cpp \
+    $$SRC_DIR/core/threadpool.cpp \
+    $$SRC_DIR/scene/renderqueue.cpp
+
+HEADERS += \
+    $$SRC_DIR/scene/renderqueue.h
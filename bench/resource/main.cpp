@@ -0,0 +1,157 @@
+// ResourceManager::getResource() of the live resources from 8 threads against the table it replaced, one
+// std::list of weak handles per type scanned under one mutex, for 100 and 4000 resources. Each thread looks
+// up 100k random names, the list runs fewer lookups and its time is scaled to the same number.
+#include "bench.h"
+#include "assets/resource.h"
+#include "fs/file_system.h"
+
+#include <algorithm>
+#include <filesystem>
+#include <list>
+#include <mutex>
+#include <random>
+#include <string>
+#include <thread>
+#include <vector>
+
+using namespace evnt;
+
+namespace
+{
+size_t const num_threads = 8;
+
+class BenchResource : public Resource
+{
+public:
+    explicit BenchResource(std::string name) : Resource(ResourceType::Material, std::move(name))
+    {
+        m_state = State::state_mem;
+    }
+
+    static ResourceType GetTypeID() { return ResourceType::Material; }
+};
+
+struct ListTable
+{
+    Resource::ResourceSharedPtr getExisted(std::string const & name)
+    {
+        std::lock_guard lock(guard);
+        for(auto & res : list)
+        {
+            auto res_shared = res.lock();
+            if(res_shared && res_shared->getName() == name)
+                return res_shared;
+        }
+
+        return {};
+    }
+
+    std::mutex                           guard;
+    std::list<Resource::ResourceWeakPtr> list;
+};
+
+// runs lookup(thread, i) for i < num_lookups in each of the threads
+template<typename LookupType>
+void RunThreads(size_t num_lookups, LookupType const & lookup)
+{
+    std::vector<std::thread> threads;
+    for(size_t t = 0; t < num_threads; ++t)
+    {
+        threads.emplace_back([t, num_lookups, &lookup] {
+            size_t found = 0;
+            for(size_t i = 0; i < num_lookups; ++i)
+                found += lookup(t, i) != nullptr;
+
+            volatile size_t result = found;
+            static_cast<void>(result);
+        });
+    }
+
+    for(auto & thread : threads)
+        thread.join();
+}
+}   // namespace
+
+int main()
+{
+    namespace fs = std::filesystem;
+
+    size_t const      max_resources = 4000;
+    std::string const dir           = (fs::temp_directory_path() / "evnt_bench_resource").generic_string();
+    fs::remove_all(dir);
+    fs::create_directories(dir);
+
+    std::vector<std::string> names;
+    {
+        std::vector<char>             data(16, 'r');
+        std::vector<OutFile>          files;
+        std::vector<BaseFile const *> file_list;
+        files.reserve(max_resources);
+        for(size_t i = 0; i < max_resources; ++i)
+        {
+            names.push_back("materials/set" + std::to_string(i % 20) + "/mat_" + std::to_string(i) + ".mat");
+            files.emplace_back(names.back(), data.data(), data.size());
+            file_list.push_back(&files.back());
+        }
+
+        FileSystem(dir).createZIP(file_list, "pack.zip");
+    }
+
+    FileSystem file_system(dir);
+
+    size_t const num_lookups = 100000;   // per thread
+    for(size_t num_resources : {size_t{100}, max_resources})
+    {
+        std::mt19937                     rng(5);
+        std::vector<std::vector<size_t>> queries(num_threads, std::vector<size_t>(num_lookups));
+        for(auto & thread_queries : queries)
+        {
+            for(auto & query : thread_queries)
+                query = rng() % num_resources;
+        }
+
+        ResourceManager::ResourceRegEntry reg;
+        reg.res_type_name            = "Material";
+        reg.res_read_function        = [](std::string const & name) -> Resource::ResourceSharedPtr {
+            return std::make_shared<BenchResource>(name);
+        };
+        reg.res_get_default_function = [] { return Resource::ResourceSharedPtr{}; };
+
+        ResourceManager mgr;
+        mgr.setFileSystem(&file_system);
+        mgr.registerType(BenchResource::GetTypeID(), reg);
+
+        // the handles keep the resources alive, both tables hold the same ones
+        ListTable                                table;
+        std::vector<Resource::ResourceSharedPtr> handles;
+        for(size_t i = 0; i < num_resources; ++i)
+        {
+            handles.push_back(mgr.getResource(BenchResource::GetTypeID(), names[i]));
+            table.list.push_back(handles.back());
+        }
+        mgr.releaseUnused();   // the inserts are published
+
+        size_t const num_list_lookups = std::max<size_t>(100, num_lookups * 25 / num_resources);
+        double const list_ms          = bench::MedianMs(3, [&] {
+            RunThreads(num_list_lookups,
+                       [&](size_t t, size_t i) { return table.getExisted(names[queries[t][i]]); });
+        });
+        double const scaled_ms =
+            list_ms * static_cast<double>(num_lookups) / static_cast<double>(num_list_lookups);
+
+        double const mgr_ms = bench::MedianMs(5, [&] {
+            RunThreads(num_lookups, [&](size_t t, size_t i) {
+                return mgr.getResource(BenchResource::GetTypeID(), names[queries[t][i]]);
+            });
+        });
+
+        double const items = static_cast<double>(num_lookups * num_threads);
+        std::string  name  = "list under a mutex, " + std::to_string(num_resources) + " resources (scaled)";
+        bench::Report(name.c_str(), scaled_ms, items);
+        name = "ResourceManager::getResource, " + std::to_string(num_resources) + " resources";
+        bench::Report(name.c_str(), mgr_ms, items, scaled_ms);
+    }
+
+    fs::remove_all(dir);
+    return 0;
+}
@@ -0,0 +1,71 @@
+// ObjectManager::serialize() and the snapshot loads without and with the pool against the object by object
+// stream of the old format, for worlds of entities with one component each. The loaded objects are released
+// outside of the timed runs.
+#include "bench.h"
+#include "core/threadpool.h"
+#include "object/entity.h"
+#include "object/objectmanager.h"
+
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+using namespace evnt;
+
+int main()
+{
+    ThreadPool pool(std::max(1u, std::thread::hardware_concurrency()));
+
+    for(size_t num_objects : {10000, 100000, 1000000})
+    {
+        ObjectManager           manager;
+        std::vector<PObjHandle> handles;
+        handles.reserve(num_objects);
+        for(size_t i = 0; i < num_objects / 2; ++i)
+        {
+            PObjHandle entity    = manager.createDefaultObj<Entity>();
+            PObjHandle component = manager.createDefaultObj<Component>();
+            dynamic_ohdl_cast<Entity>(entity)->addComponent(component);
+            handles.push_back(entity);
+            handles.push_back(component);
+        }
+
+        std::string const suffix = ", " + std::to_string(num_objects) + " objects";
+        int const         runs   = num_objects < 1000000 ? 5 : 3;
+        double const      items  = static_cast<double>(num_objects);
+
+        OutputMemoryStream legacy;
+        for(auto const & handle : handles)
+            handle->getPtr()->write(legacy, manager);
+
+        OutputMemoryStream snapshot;
+        double const       serialize = bench::MedianMs(
+            runs, [&] { snapshot = OutputMemoryStream(); }, [&] { manager.serialize(snapshot); });
+        bench::Report(("serialize" + suffix).c_str(), serialize, items);
+
+        std::unique_ptr<ObjectManager> loaded;
+        std::vector<PObjHandle>        objects;
+        auto                           reset = [&] {
+            objects.clear();
+            loaded = std::make_unique<ObjectManager>();
+        };
+        auto load = [&](OutputMemoryStream const & out, ThreadPool * load_pool) {
+            InputMemoryStream in(out.getBufferPtr(), out.getLength());
+            loaded->deserialize(in, objects, load_pool);
+        };
+
+        double const reference = bench::MedianMs(runs, reset, [&] { load(legacy, nullptr); });
+        bench::Report(("old format load" + suffix).c_str(), reference, items);
+
+        double const serial = bench::MedianMs(runs, reset, [&] { load(snapshot, nullptr); });
+        bench::Report(("snapshot load, no pool" + suffix).c_str(), serial, items, reference);
+
+        double const parallel = bench::MedianMs(runs, reset, [&] { load(snapshot, &pool); });
+        bench::Report(("snapshot load, pool" + suffix).c_str(), parallel, items, reference);
+
+        objects.clear();
+    }
+
+    return 0;
+}
@@ -0,0 +1,23 @@
+TARGET = bench_snapshot
+
+CONFIG += bench_log
+
+include(../bench.pri)
+
+SOURCES += \
+    main.cpp \
+    $$SRC_DIR/core/exception.cpp \
+    $$SRC_DIR/core/slabpool.cpp \
+    $$SRC_DIR/core/taskgraph.cpp \
+    $$SRC_DIR/core/threadpool.cpp \
+    $$SRC_DIR/fs/memory_stream.cpp \
+    $$SRC_DIR/object/chunkstorage.cpp \
+    $$SRC_DIR/object/cmpmsgs.cpp \
+    $$SRC_DIR/object/component.cpp \
+    $$SRC_DIR/object/entity.cpp \
+    $$SRC_DIR/object/handletable.cpp \
+    $$SRC_DIR/object/object.cpp \
+    $$SRC_DIR/object/objectmanager.cpp
+
+HEADERS += \
+    $$SRC_DIR/object/objectmanager.h
@@ -0,0 +1,183 @@
+// The queries of the BVH and the loose grid against the brute force loops over all the bounds: a large and a
+// small frustum, boxes and rays, and the cost of moving 1% of the proxies per frame. The throughput of the
+// queries is in the bounds covered, the ones a loop would test.
+#include "bench.h"
+#include "scene/boundingvolumehierarchy.h"
+#include "scene/loosegrid.h"
+
+#include <random>
+#include <string>
+#include <utility>
+#include <vector>
+
+using namespace evnt;
+
+namespace
+{
+struct Scene
+{
+    std::vector<AABB>                            boxes;
+    Frustum                                      large_frustum;
+    Frustum                                      small_frustum;
+    std::vector<AABB>                            queries;
+    std::vector<std::pair<glm::vec3, glm::vec3>> rays;
+};
+
+struct BruteForce
+{
+    double large_frustum;
+    double small_frustum;
+    double queries;
+    double rays;
+};
+
+AABB RandomBox(std::mt19937 & rng, float world, float max_extent)
+{
+    std::uniform_real_distribution<float> position(-world, world);
+    std::uniform_real_distribution<float> extent(0.1f, max_extent);
+
+    glm::vec3 const center(position(rng), position(rng), position(rng));
+    glm::vec3 const half(extent(rng), extent(rng), extent(rng));
+    return AABB(center - half, center + half);
+}
+
+void CullLoop(Scene const & scene, Frustum const & frustum)
+{
+    size_t visible = 0;
+    for(auto const & box : scene.boxes)
+        visible += !frustum.cullBox(box);
+
+    volatile size_t result = visible;
+    static_cast<void>(result);
+}
+
+// the rebuilt tree is the one the scene manager keeps refitting
+void Build(BoundingVolumeHierarchy & bvh)
+{
+    bvh.rebuild();
+}
+
+void Build(SpatialIndex & index)
+{
+    index.update();
+}
+
+// the scene is copied, the moves change the boxes
+template<typename IndexType>
+void Run(char const * name, IndexType & index, Scene scene, BruteForce const & brute)
+{
+    double const      num_boxes = static_cast<double>(scene.boxes.size());
+    std::string const prefix    = std::string(name) + ", ";
+
+    // once, the index isn't emptied
+    std::vector<SpatialIndex::ProxyID> proxies(scene.boxes.size());
+    auto const                         start = bench::Clock::now();
+    for(size_t i = 0; i < scene.boxes.size(); ++i)
+        proxies[i] = index.addProxy(scene.boxes[i], static_cast<uint32_t>(i));
+    Build(index);
+    double const build = std::chrono::duration<double, std::milli>(bench::Clock::now() - start).count();
+    bench::Report((prefix + "build").c_str(), build, num_boxes);
+
+    std::vector<SpatialIndex::ProxyID> result;
+    bench::Report((prefix + "large frustum").c_str(),
+                  bench::MedianMs(5, [&] { index.queryFrustum(scene.large_frustum, nullptr, result); }),
+                  num_boxes, brute.large_frustum);
+    bench::Report((prefix + "small frustum").c_str(),
+                  bench::MedianMs(5, [&] { index.queryFrustum(scene.small_frustum, nullptr, result); }),
+                  num_boxes, brute.small_frustum);
+
+    double const num_queries = static_cast<double>(scene.queries.size());
+    double const queries     = bench::MedianMs(5, [&] {
+        for(auto const & query : scene.queries)
+            index.queryAABB(query, result);
+    });
+    bench::Report((prefix + "box queries").c_str(), queries, num_queries * num_boxes, brute.queries);
+
+    double const num_rays = static_cast<double>(scene.rays.size());
+    double const rays     = bench::MedianMs(5, [&] {
+        for(auto const & [origin, dir] : scene.rays)
+            index.castRayFirst(origin, dir, 1e30f);
+    });
+    bench::Report((prefix + "first ray hits").c_str(), rays, num_rays * num_boxes, brute.rays);
+
+    std::mt19937                          rng(11);
+    std::uniform_real_distribution<float> step(-4.0f, 4.0f);
+    size_t const                          num_moved = scene.boxes.size() / 100;
+    double const                          moves     = bench::MedianMs(20, [&] {
+        for(size_t k = 0; k < num_moved; ++k)
+        {
+            size_t const    i = rng() % scene.boxes.size();
+            glm::vec3 const offset(step(rng), step(rng), step(rng));
+
+            scene.boxes[i] = AABB(scene.boxes[i].min() + offset, scene.boxes[i].max() + offset);
+            index.moveProxy(proxies[i], scene.boxes[i]);
+        }
+        index.update();
+    });
+    bench::Report((prefix + "1% moved and updated").c_str(), moves, static_cast<double>(num_moved));
+}
+}   // namespace
+
+int main()
+{
+    size_t const num_boxes = 500000;
+    float const  world     = 1000.0f;
+
+    Scene        scene;
+    std::mt19937 rng(5);
+    for(size_t i = 0; i < num_boxes; ++i)
+        scene.boxes.push_back(RandomBox(rng, world, 3.0f));
+    for(size_t i = 0; i < 200; ++i)
+        scene.queries.push_back(RandomBox(rng, world, 20.0f));
+
+    std::uniform_real_distribution<float> unit(-1.0f, 1.0f);
+    for(size_t i = 0; i < 200; ++i)
+    {
+        glm::vec3 const origin(unit(rng) * world, unit(rng) * world, unit(rng) * world);
+        scene.rays.emplace_back(origin, glm::vec3(unit(rng), unit(rng), unit(rng)));
+    }
+
+    glm::mat4 const camera = glm::rotate(glm::mat4{1.0f}, 0.7f, glm::vec3(0.2f, 1.0f, 0.1f));
+    scene.large_frustum.buildViewFrustum(camera, 70.0f, 1.6f, 0.5f, 900.0f);
+    scene.small_frustum.buildViewFrustum(glm::mat4{1.0f}, 40.0f, 1.0f, 0.5f, 150.0f);
+
+    BruteForce brute;
+    brute.large_frustum = bench::MedianMs(5, [&] { CullLoop(scene, scene.large_frustum); });
+    bench::Report("cullBox loop, large frustum", brute.large_frustum, num_boxes);
+    brute.small_frustum = bench::MedianMs(5, [&] { CullLoop(scene, scene.small_frustum); });
+    bench::Report("cullBox loop, small frustum", brute.small_frustum, num_boxes);
+
+    brute.queries = bench::MedianMs(3, [&] {
+        size_t hits = 0;
+        for(auto const & query : scene.queries)
+        {
+            for(auto const & box : scene.boxes)
+                hits += box.intersects(query);
+        }
+        volatile size_t result = hits;
+        static_cast<void>(result);
+    });
+    bench::Report("box query loops", brute.queries, static_cast<double>(scene.queries.size()) * num_boxes);
+
+    brute.rays = bench::MedianMs(3, [&] {
+        size_t hits = 0;
+        for(auto const & [origin, dir] : scene.rays)
+        {
+            glm::vec3 const inv_dir = GetInverse(dir);
+            float           dist    = 0.0f;
+            for(auto const & box : scene.boxes)
+                hits += IntersectRay(origin, inv_dir, 1e30f, box.min(), box.max(), dist);
+        }
+        volatile size_t result = hits;
+        static_cast<void>(result);
+    });
+    bench::Report("ray loops", brute.rays, static_cast<double>(scene.rays.size()) * num_boxes);
+
+    BoundingVolumeHierarchy bvh;
+    Run("bvh", bvh, scene, brute);
+
+    LooseGrid grid(8.0f);
+    Run("loose grid", grid, scene, brute);
+
+    return 0;
+}
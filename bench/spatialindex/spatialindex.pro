@@ -0,0 +1,15 @@
+TARGET = bench_spatialindex
+
+include(../bench.pri)
+
+SOURCES += \
+    main.cpp \
+    $$SRC_DIR/scene/boundingvolumehierarchy.cpp \
+    $$SRC_DIR/scene/frustum.cpp \
+    $$SRC_DIR/scene/loosegrid.cpp
+
+HEADERS += \
+    $$SRC_DIR/scene/boundingvolumehierarchy.h \
+    $$SRC_DIR/scene/frustum.h \
+    $$SRC_DIR/scene/loosegrid.h \
+    $$SRC_DIR/scene/spatialindex.h
@@ -0,0 +1,107 @@
+// parallel_for and parallel_reduce against the serial loops, and the scheduling cost of TaskGraph::execute()
+// for a frame-like graph of small jobs.
+#include "bench.h"
+#include "core/taskgraph.h"
+
+#include <cmath>
+#include <numeric>
+#include <random>
+#include <string>
+
+using namespace evnt;
+
+namespace
+{
+// a few dozen cycles per element, like a transform or a bound update
+void Transform(std::vector<float> const & src, std::vector<float> & dst, size_t first, size_t last)
+{
+    for(size_t i = first; i < last; ++i)
+        dst[i] = std::sqrt(src[i] * src[i] + 1.0f) * 0.5f + std::sin(src[i]);
+}
+
+// layers of 'width' jobs, every job depends on two jobs of the previous layer
+void BuildLayers(TaskGraph & graph, size_t num_layers, size_t width, std::atomic<size_t> & counter)
+{
+    std::vector<TaskGraph::JobID> previous;
+    for(size_t layer = 0; layer < num_layers; ++layer)
+    {
+        std::vector<TaskGraph::JobID> current;
+        for(size_t i = 0; i < width; ++i)
+        {
+            std::vector<TaskGraph::JobID> deps;
+            if(!previous.empty())
+                deps = {previous[i], previous[(i + 1) % width]};
+
+            auto const affinity = i == 0 ? TaskGraph::Affinity::caller : TaskGraph::Affinity::any;
+            current.push_back(graph.addJob(
+                "job " + std::to_string(layer) + "." + std::to_string(i),
+                [&counter] { counter.fetch_add(1, std::memory_order_relaxed); }, deps, affinity));
+        }
+        previous = std::move(current);
+    }
+}
+}   // namespace
+
+int main()
+{
+    size_t const num_items = 4 * 1024 * 1024;
+
+    std::vector<float>                    src(num_items);
+    std::vector<float>                    dst(num_items);
+    std::mt19937                          rng(1);
+    std::uniform_real_distribution<float> value(-100.0f, 100.0f);
+    for(auto & v : src)
+        v = value(rng);
+
+    double const serial = bench::MedianMs(5, [&] { Transform(src, dst, 0, num_items); });
+    bench::Report("serial loop", serial, num_items);
+
+    double const serial_sum = bench::MedianMs(5, [&] {
+        volatile double sum = std::accumulate(src.begin(), src.end(), 0.0);
+        (void)sum;
+    });
+    bench::Report("serial sum", serial_sum, num_items);
+
+    std::vector<size_t> thread_counts{1, 2, 4};
+    if(std::thread::hardware_concurrency() > 4)
+        thread_counts.push_back(std::thread::hardware_concurrency());
+
+    for(size_t num_threads : thread_counts)
+    {
+        ThreadPool        pool(num_threads);
+        std::string const suffix = ", " + std::to_string(num_threads) + " threads";
+
+        double const parallel = bench::MedianMs(5, [&] {
+            parallel_for(pool, size_t{0}, num_items,
+                         [&](size_t first, size_t last) { Transform(src, dst, first, last); });
+        });
+        bench::Report(("parallel_for" + suffix).c_str(), parallel, num_items, serial);
+
+        double const reduce = bench::MedianMs(5, [&] {
+            volatile double sum = parallel_reduce(
+                pool, size_t{0}, num_items, 0.0,
+                [&](size_t first, size_t last, double acc) {
+                    return std::accumulate(src.begin() + static_cast<std::ptrdiff_t>(first),
+                                           src.begin() + static_cast<std::ptrdiff_t>(last), acc);
+                },
+                [](double l, double r) { return l + r; });
+            (void)sum;
+        });
+        bench::Report(("parallel_reduce" + suffix).c_str(), reduce, num_items, serial_sum);
+
+        // the cost per job of the dependency tracking and the scheduling, the jobs do almost nothing
+        std::atomic<size_t> counter{0};
+        TaskGraph           graph;
+        BuildLayers(graph, 64, 16, counter);
+
+        int const    executions = 100;
+        double const graph_ms   = bench::MedianMs(5, [&] {
+            for(int i = 0; i < executions; ++i)
+                graph.execute(pool);
+        });
+        bench::Report(("task graph 64x16 jobs" + suffix).c_str(), graph_ms,
+                      static_cast<double>(graph.getNumJobs() * executions));
+    }
+
+    return 0;
+}
@@ -0,0 +1,18 @@
+TARGET = bench_taskgraph
+
+CONFIG += bench_log
+
+include(../bench.pri)
+
+SOURCES += \
+    main.cpp \
+    $$SRC_DIR/core/exception.cpp \
+    $$SRC_DIR/core/taskgraph.cpp \
+    $$SRC_DIR/core/threadpool.cpp
+
+HEADERS += \
+    $$SRC_DIR/core/exception.h \
+    $$SRC_DIR/core/task.h \
+    $$SRC_DIR/core/taskgraph.h \
+    $$SRC_DIR/core/threadpool.h \
+    $$SRC_DIR/core/workstealingqueue.h
@@ -0,0 +1,121 @@
+// The block encoders on one thread and ProcessTexture (the mip chain and the blocks of all levels) of a
+// 2048x2048 image without and with the thread pool.
+#include "bench.h"
+#include "assets/blockcompression.h"
+#include "assets/texturedata.h"
+#include "core/threadpool.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <random>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+
+using namespace evnt;
+
+namespace
+{
+// smooth color gradients with noise and an alpha ramp
+std::vector<uint8_t> MakePixels(uint32_t size)
+{
+    std::vector<uint8_t>               pixels(size_t{size} * size * 4);
+    std::mt19937                       rng(9);
+    std::uniform_int_distribution<int> noise(-10, 10);
+    for(uint32_t y = 0; y < size; ++y)
+    {
+        for(uint32_t x = 0; x < size; ++x)
+        {
+            double const fx    = x / static_cast<double>(size);
+            double const fy    = y / static_cast<double>(size);
+            uint8_t *    pixel = &pixels[(size_t{y} * size + x) * 4];
+
+            int const values[] = {static_cast<int>(128 + 60 * std::sin(fx * 9 + fy * 3)) + noise(rng),
+                                  static_cast<int>(100 + 50 * std::cos(fy * 11)) + noise(rng),
+                                  static_cast<int>(80 + 40 * std::sin((fx + fy) * 7)) + noise(rng),
+                                  static_cast<int>(255 * fx)};
+            for(int c = 0; c < 4; ++c)
+                pixel[c] = static_cast<uint8_t>(std::clamp(values[c], 0, 255));
+        }
+    }
+
+    return pixels;
+}
+
+template<typename EncoderType>
+double EncodeImage(std::vector<uint8_t> const & pixels, uint32_t size, size_t block_size, EncoderType encode)
+{
+    std::vector<uint8_t> out(size_t{size / 4} * (size / 4) * block_size);
+    return bench::MedianMs(3, [&] {
+        uint8_t block[64];
+        for(uint32_t by = 0; by < size / 4; ++by)
+        {
+            for(uint32_t bx = 0; bx < size / 4; ++bx)
+            {
+                for(uint32_t row = 0; row < 4; ++row)
+                    std::memcpy(block + row * 16, &pixels[((size_t{by} * 4 + row) * size + bx * 4) * 4], 16);
+
+                encode(block, &out[(size_t{by} * (size / 4) + bx) * block_size]);
+            }
+        }
+    });
+}
+}   // namespace
+
+int main()
+{
+    uint32_t const       size   = 1024;
+    double const         pixels = static_cast<double>(size) * size;
+    std::vector<uint8_t> image  = MakePixels(size);
+
+    bench::Report("bc1 blocks, 1 thread", EncodeImage(image, size, 8, EncodeBC1Block), pixels);
+    bench::Report("bc3 blocks, 1 thread", EncodeImage(image, size, 16, EncodeBC3Block), pixels);
+    bench::Report("bc7 blocks, 1 thread", EncodeImage(image, size, 16, EncodeBC7Block), pixels);
+
+    uint32_t const       large        = 2048;
+    double const         large_pixels = static_cast<double>(large) * large;
+    std::vector<uint8_t> large_image  = MakePixels(large);
+
+    ThreadPool pool(std::max(1u, std::thread::hardware_concurrency()));
+
+    std::pair<char const *, TextureProcessing> cases[4];
+    cases[0] = {"rgba8", {}};
+    cases[1] = {"bc1", {}};
+    cases[2] = {"bc3", {}};
+    cases[3] = {"bc7", {}};
+    TextureData::Format const formats[] = {TextureData::Format::rgba8, TextureData::Format::bc1,
+                                           TextureData::Format::bc3, TextureData::Format::bc7};
+    for(size_t i = 0; i < 4; ++i)
+    {
+        cases[i].second.compress = i > 0;
+        cases[i].second.format   = formats[i];
+        cases[i].second.mipmaps  = true;
+    }
+
+    for(auto const & [name, proc] : cases)
+    {
+        auto process = [&](ThreadPool * process_pool) {
+            ImageData id;
+            id.width  = large;
+            id.height = large;
+            id.type   = ImageData::PixelType::pt_rgba;
+            id.data   = std::make_unique<uint8_t[]>(large_image.size());
+            std::memcpy(id.data.get(), large_image.data(), large_image.size());
+
+            TextureData td;
+            ProcessTexture(std::move(id), proc, td, process_pool);
+        };
+
+        std::string const prefix = std::string("process 2048x2048 ") + name + " + mips";
+
+        double const serial = bench::MedianMs(3, [&] { process(nullptr); });
+        bench::Report((prefix + ", no pool").c_str(), serial, large_pixels);
+
+        double const parallel = bench::MedianMs(3, [&] { process(&pool); });
+        bench::Report((prefix + ", pool").c_str(), parallel, large_pixels, serial);
+    }
+
+    return 0;
+}
@@ -0,0 +1,144 @@
+// Task throughput of the work-stealing ThreadPool against a pool with one locked queue of std::function,
+// the scheme of the io_service pool it replaced.
+#include "bench.h"
+#include "core/threadpool.h"
+
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <string>
+#include <thread>
+
+using namespace evnt;
+
+namespace
+{
+class LockedQueuePool
+{
+public:
+    explicit LockedQueuePool(size_t num_threads)
+    {
+        for(size_t i = 0; i < num_threads; ++i)
+            m_threads.emplace_back([this] { run(); });
+    }
+
+    ~LockedQueuePool()
+    {
+        {
+            std::lock_guard lk(m_mutex);
+            m_stop = true;
+        }
+        m_cv.notify_all();
+        for(auto & thread : m_threads)
+            thread.join();
+    }
+
+    void submit(std::function<void()> task)
+    {
+        {
+            std::lock_guard lk(m_mutex);
+            m_tasks.push_back(std::move(task));
+        }
+        m_cv.notify_one();
+    }
+
+private:
+    void run()
+    {
+        for(;;)
+        {
+            std::function<void()> task;
+            {
+                std::unique_lock lk(m_mutex);
+                m_cv.wait(lk, [this] { return m_stop || !m_tasks.empty(); });
+                if(m_tasks.empty())
+                    return;
+
+                task = std::move(m_tasks.front());
+                m_tasks.pop_front();
+            }
+            task();
+        }
+    }
+
+    std::vector<std::thread>          m_threads;
+    std::deque<std::function<void()>> m_tasks;
+    std::mutex                        m_mutex;
+    std::condition_variable           m_cv;
+    bool                              m_stop{false};
+};
+
+void WaitFor(std::atomic<int> const & counter, int value)
+{
+    while(counter.load(std::memory_order_acquire) < value)
+        std::this_thread::yield();
+}
+
+template<typename PoolType>
+double SubmitFromOutside(PoolType & pool, int num_tasks)
+{
+    return bench::MedianMs(5, [&] {
+        std::atomic<int> done{0};
+        for(int i = 0; i < num_tasks; ++i)
+            pool.submit([&done] { done.fetch_add(1, std::memory_order_release); });
+        WaitFor(done, num_tasks);
+    });
+}
+
+template<typename PoolType>
+double SubmitFromWorker(PoolType & pool, int num_tasks)
+{
+    return bench::MedianMs(5, [&] {
+        std::atomic<int> done{0};
+        pool.submit([&] {
+            for(int i = 0; i < num_tasks; ++i)
+                pool.submit([&done] { done.fetch_add(1, std::memory_order_release); });
+        });
+        WaitFor(done, num_tasks);
+    });
+}
+}   // namespace
+
+int main()
+{
+    int const num_tasks = 1000000;
+
+    std::vector<size_t> thread_counts{1, 2, 4};
+    if(std::thread::hardware_concurrency() > 4)
+        thread_counts.push_back(std::thread::hardware_concurrency());
+
+    for(size_t num_threads : thread_counts)
+    {
+        std::string const suffix = ", " + std::to_string(num_threads) + " threads";
+
+        double outside = 0.0;
+        double nested  = 0.0;
+        {
+            LockedQueuePool pool(num_threads);
+            outside = SubmitFromOutside(pool, num_tasks);
+            nested  = SubmitFromWorker(pool, num_tasks);
+            bench::Report(("locked queue, outside" + suffix).c_str(), outside, num_tasks);
+            bench::Report(("locked queue, nested" + suffix).c_str(), nested, num_tasks);
+        }
+
+        ThreadPool pool(num_threads);
+        bench::Report(("work stealing, outside" + suffix).c_str(), SubmitFromOutside(pool, num_tasks),
+                      num_tasks, outside);
+        bench::Report(("work stealing, nested" + suffix).c_str(), SubmitFromWorker(pool, num_tasks),
+                      num_tasks, nested);
+
+        // a result through a future per task
+        double const futures = bench::MedianMs(5, [&] {
+            std::vector<std::future<int>> results;
+            results.reserve(num_tasks / 10);
+            for(int i = 0; i < num_tasks / 10; ++i)
+                results.push_back(pool.submit([i] { return i; }));
+            for(auto & result : results)
+                result.get();
+        });
+        bench::Report(("work stealing, futures" + suffix).c_str(), futures, num_tasks / 10);
+    }
+
+    return 0;
+}
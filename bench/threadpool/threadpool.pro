@@ -0,0 +1,12 @@
+TARGET = bench_threadpool
+
+include(../bench.pri)
+
+SOURCES += \
+    main.cpp \
+    $$SRC_DIR/core/threadpool.cpp
+
+HEADERS += \
+    $$SRC_DIR/core/task.h \
+    $$SRC_DIR/core/threadpool.h \
+    $$SRC_DIR/core/workstealingqueue.h
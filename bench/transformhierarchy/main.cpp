@@ -0,0 +1,127 @@
+// TransformHierarchy::update() without and with the pool against the recursive update of a pointer tree,
+// the way the spatial components were updated before the hierarchy was flattened.
+#include "bench.h"
+#include "core/threadpool.h"
+#include "scene/transformhierarchy.h"
+
+#include <algorithm>
+#include <random>
+#include <thread>
+#include <vector>
+
+using namespace evnt;
+
+namespace
+{
+struct PointerNode
+{
+    glm::mat4                  local{1.0f};
+    glm::mat4                  world{1.0f};
+    AABB                       bound;
+    PointerNode *              parent = nullptr;
+    std::vector<PointerNode *> children;
+
+    void updateTree(AABB const & local_bound, bool initiator = true)
+    {
+        world = parent ? parent->world * local : local;
+        for(auto * child : children)
+            child->updateTree(local_bound, false);
+
+        updateBound(local_bound);
+        if(initiator)
+        {
+            for(PointerNode * node = parent; node; node = node->parent)
+                node->updateBound(local_bound);
+        }
+    }
+
+    void updateBound(AABB const & local_bound)
+    {
+        bound = local_bound;
+        bound.transform(world);
+        for(auto const * child : children)
+            bound.expandBy(child->bound);
+    }
+};
+
+glm::mat4 RandomTransform(std::mt19937 & rng)
+{
+    std::uniform_real_distribution<float> value(-1.0f, 1.0f);
+
+    glm::mat4 const moved = glm::translate(glm::mat4{1.0f}, glm::vec3(value(rng), value(rng), value(rng)));
+    return glm::rotate(moved, value(rng), glm::vec3(value(rng), value(rng), 1.0f));
+}
+}   // namespace
+
+int main()
+{
+    size_t const num_nodes = 100000;
+    size_t const num_roots = num_nodes / 1000;
+    AABB const   local_bound(glm::vec3(-0.5f), glm::vec3(0.5f));
+
+    std::mt19937                            rng(1);
+    std::vector<PointerNode>                nodes(num_nodes);
+    std::vector<TransformHierarchy::NodeID> ids(num_nodes);
+    TransformHierarchy                      hierarchy;
+    for(size_t i = 0; i < num_nodes; ++i)
+    {
+        nodes[i].local = RandomTransform(rng);
+
+        TransformHierarchy::NodeID parent_id = TransformHierarchy::invalid_node;
+        if(i >= num_roots)
+        {
+            // a parent from the earlier nodes gives a tree of about a dozen levels
+            std::uniform_int_distribution<size_t> pick((i - num_roots) / 4, (i - num_roots) / 2);
+
+            size_t const parent = pick(rng);
+            nodes[i].parent     = &nodes[parent];
+            nodes[parent].children.push_back(&nodes[i]);
+            parent_id = ids[parent];
+        }
+        ids[i] = hierarchy.addNode(parent_id, nodes[i].local, local_bound);
+    }
+
+    std::vector<size_t> moved(num_nodes / 100);
+    for(auto & node : moved)
+        node = std::uniform_int_distribution<size_t>(0, num_nodes - 1)(rng);
+
+    ThreadPool pool(std::max(1u, std::thread::hardware_concurrency()));
+    hierarchy.update(&pool);
+
+    double const pointer_all = bench::MedianMs(10, [&] {
+        for(size_t i = 0; i < num_roots; ++i)
+            nodes[i].updateTree(local_bound);
+    });
+    bench::Report("pointer tree, all nodes moved", pointer_all, num_nodes);
+
+    auto move_roots = [&](ThreadPool * update_pool) {
+        for(size_t i = 0; i < num_roots; ++i)
+            hierarchy.setLocalTransform(ids[i], nodes[i].local);
+        hierarchy.update(update_pool);
+    };
+    bench::Report("flattened, all nodes moved, no pool", bench::MedianMs(10, [&] { move_roots(nullptr); }),
+                  num_nodes, pointer_all);
+    bench::Report("flattened, all nodes moved, pool", bench::MedianMs(10, [&] { move_roots(&pool); }),
+                  num_nodes, pointer_all);
+
+    double const pointer_some = bench::MedianMs(10, [&] {
+        for(size_t node : moved)
+            nodes[node].updateTree(local_bound);
+    });
+    bench::Report("pointer tree, 1% nodes moved", pointer_some, static_cast<double>(moved.size()));
+
+    auto move_some = [&](ThreadPool * update_pool) {
+        for(size_t node : moved)
+            hierarchy.setLocalTransform(ids[node], nodes[node].local);
+        hierarchy.update(update_pool);
+    };
+    bench::Report("flattened, 1% nodes moved, no pool", bench::MedianMs(10, [&] { move_some(nullptr); }),
+                  static_cast<double>(moved.size()), pointer_some);
+    bench::Report("flattened, 1% nodes moved, pool", bench::MedianMs(10, [&] { move_some(&pool); }),
+                  static_cast<double>(moved.size()), pointer_some);
+
+    double const unchanged = bench::MedianMs(10, [&] { hierarchy.update(&pool); });
+    bench::Report("flattened, nothing moved", unchanged, num_nodes);
+
+    return 0;
+}
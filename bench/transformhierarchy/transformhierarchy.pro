@@ -0,0 +1,14 @@
+TARGET = bench_transformhierarchy
+
+include(../bench.pri)
+
+SOURCES += \
+    main.cpp \
+    $$SRC_DIR/core/exception.cpp \
+    $$SRC_DIR/core/taskgraph.cpp \
+    $$SRC_DIR/core/threadpool.cpp \
+    $$SRC_DIR/scene/transformhierarchy.cpp
+
+HEADERS += \
+    $$SRC_DIR/scene/AABB.h \
+    $$SRC_DIR/scene/transformhierarchy.h
@@ -45,15 +45,27 @@ SOURCES +=  \
     src/app/glfwwindow.cpp \
     src/app/mousecursor.cpp \
     src/app/window.cpp \
+    src/assets/blockcompression.cpp \
+    src/assets/imagecache.cpp \
     src/assets/imagedata.cpp \
+    src/assets/imagekernels.cpp \
     src/assets/resource.cpp \
+    src/assets/texturedata.cpp \
     src/assets/textureresource.cpp \
     src/core/core.cpp \
     src/core/exception.cpp \
+    src/core/slabpool.cpp \
+    src/core/taskgraph.cpp \
+    src/core/threadpool.cpp \
     src/demo/demostate.cpp \
     src/fs/file.cpp \
+    src/fs/file_mapping.cpp \
     src/fs/file_system.cpp \
+    src/fs/file_watcher.cpp \
     src/fs/memory_stream.cpp \
+    src/fs/path_index.cpp \
+    src/fs/zip_directory.cpp \
+    src/fs/zip_writer.cpp \
     src/input/input.cpp \
     src/input/inputglfw.cpp \
     src/input/keybinding.cpp \
@@ -62,9 +74,11 @@ SOURCES +=  \
     src/network/connection.cpp \
     src/network/socketaddress.cpp \
     src/network/udpsocket.cpp \
+    src/object/chunkstorage.cpp \
     src/object/cmpmsgs.cpp \
     src/object/component.cpp \
     src/object/entity.cpp \
+    src/object/handletable.cpp \
     src/object/object.cpp \
     src/object/objectmanager.cpp \
     src/render/gl45/glbuffer.cpp \
@@ -87,11 +101,17 @@ SOURCES +=  \
     src/render/shaderconstants.cpp \
     src/render/shaderdescriptor.cpp \
     src/render/texture.cpp \
+    src/scene/batchculling.cpp \
+    src/scene/boundingvolumehierarchy.cpp \
     src/scene/cameracomponent.cpp \
     src/scene/frustum.cpp \
     src/scene/lightcomponent.cpp \
+    src/scene/loosegrid.cpp \
+    src/scene/renderqueue.cpp \
     src/scene/scenecomponent.cpp \
     src/scene/scenemgr.cpp \
+    src/scene/spatialscenemgr.cpp \
+    src/scene/transformhierarchy.cpp \
     src/utils/timer.cpp
 
 HEADERS += \
@@ -101,19 +121,33 @@ HEADERS += \
     src/app/glfwwindow.h \
     src/app/mousecursor.h \
     src/app/window.h \
+    src/assets/blockcompression.h \
+    src/assets/imagecache.h \
     src/assets/imagedata.h \
+    src/assets/imagekernels.h \
     src/assets/resource.h \
+    src/assets/texturedata.h \
     src/assets/textureresource.h \
     src/core/core.h \
     src/core/event.h \
     src/core/exception.h \
     src/core/module.h \
+    src/core/rcuptr.h \
+    src/core/slabpool.h \
+    src/core/task.h \
+    src/core/taskgraph.h \
     src/core/threadpool.h \
+    src/core/workstealingqueue.h \
     src/demo/demostate.h \
     src/fs/file.h \
+    src/fs/file_mapping.h \
     src/fs/file_system.h \
+    src/fs/file_watcher.h \
     src/fs/memory_stream.h \
+    src/fs/path_index.h \
     src/fs/zip.h \
+    src/fs/zip_directory.h \
+    src/fs/zip_writer.h \
     src/input/devices.h \
     src/input/input.h \
     src/input/inputglfw.h \
@@ -123,10 +157,12 @@ HEADERS += \
     src/network/connection.h \
     src/network/socketaddress.h \
     src/network/udpsocket.h \
+    src/object/chunkstorage.h \
     src/object/classids.h \
     src/object/cmpmsgs.h \
     src/object/component.h \
     src/object/entity.h \
+    src/object/handletable.h \
     src/object/object.h \
     src/object/objectmanager.h \
     src/object/objhandle.h \
@@ -157,10 +193,17 @@ HEADERS += \
     src/render/texture.h \
     src/render/vertexarray.h \
     src/scene/AABB.h \
+    src/scene/batchculling.h \
+    src/scene/boundingvolumehierarchy.h \
     src/scene/cameracomponent.h \
     src/scene/frustum.h \
     src/scene/lightcomponent.h \
+    src/scene/loosegrid.h \
     src/scene/plane.h \
+    src/scene/renderqueue.h \
     src/scene/scenecomponent.h \
     src/scene/scenemgr.h \
+    src/scene/spatialindex.h \
+    src/scene/spatialscenemgr.h \
+    src/scene/transformhierarchy.h \
     src/utils/timer.h
@@ -5,12 +5,30 @@
 #include "../utils/timer.h"
 
 #include "../assets/textureresource.h"
+#include "../render/render.h"
 
 namespace evnt
 {
+// the block compressed formats aren't core in GL 3.3
+static char const * GetCompressionExtension(TextureData::Format format)
+{
+    switch(format)
+    {
+        case TextureData::Format::bc1:
+        case TextureData::Format::bc3:
+            return "GL_EXT_texture_compression_s3tc";
+        case TextureData::Format::bc7:
+            return "GL_ARB_texture_compression_bptc";
+        default:
+            return nullptr;
+    }
+}
+
 App::App() : m_end_state{addAppState<end_state>(*this)}, mp_obj_mgr_clean_timer{std::make_unique<Timer>()}
 {
     m_cur_state = m_end_state;
+
+    buildFrameGraphs();
 }
 
 App::~App() {}
@@ -35,6 +53,68 @@ bool App::init(int32_t argc, char * argv[])
 
     // Resource manager init
     m_resource_mgr.registerType(TextureResource::GetTypeID(), TextureResource::GetRegEntry());
+    if(auto tex_config = config.get_child_optional("App.TextureProcessing"))
+    {
+        // mipmaps and block compression on the CPU, the results are kept in the image cache
+        TextureProcessing proc;
+        proc.compress = TextureData::GetFormatFromString(tex_config->get<std::string>("Compression", "none"),
+                                                         proc.format)
+                        && TextureData::IsCompressed(proc.format);
+
+        Render *     render    = mp_main_window->getRender();
+        char const * extension = proc.compress ? GetCompressionExtension(proc.format) : nullptr;
+        if(extension && render && !render->isExtensionsSupported(extension))
+        {
+            Log::Log(Log::warning, Log::cstr_log("App: %s is not supported, the textures are not compressed",
+                                                 extension));
+            proc.compress = false;
+        }
+
+        proc.mipmaps  = tex_config->get<bool>("Mipmaps", false);
+        proc.srgb     = tex_config->get<bool>("SRGB", true);
+        TextureResource::SetProcessing(proc);
+    }
+    m_resource_mgr.setFileSystem(&Core::instance().getFileSystem());
+    m_resource_mgr.setRender(mp_main_window->getRender());   // finalization of the asynchronous loading
+    m_resource_mgr.setThreadPool(&Core::instance().getThreadPool());
+    if(auto budgets = config.get_child_optional("App.ResourceBudgets"))
+    {
+        // MB per type name, the loaded resources over the budget are released by releaseUnused()
+        for(auto const & [type_name, budget] : *budgets)
+        {
+            m_resource_mgr.setBudget(Resource::GetResourceTypeFromString(type_name),
+                                     budget.get_value<uint64_t>() * 1024 * 1024);
+        }
+    }
+    if(auto preload = config.get_child_optional("App.PreloadTextures"))
+    {
+        // loaded in the pool while the states initialize, uploaded by the render when ready
+        for(auto const & [key, name] : *preload)
+        {
+            m_preloaded.push_back(
+                m_resource_mgr.requestResource(TextureResource::GetTypeID(), name.get_value<std::string>()));
+        }
+    }
+
+    // "bvh" or "grid", the grid cells should hold a few objects each
+    std::string scene_mgr_type = "bvh";
+    float       cell_size      = 32.0f;
+    if(auto scene_config = config.get_child_optional("App.SceneManager"))
+    {
+        scene_mgr_type = scene_config->get<std::string>("Type", scene_mgr_type);
+        cell_size      = std::max(scene_config->get<float>("CellSize", cell_size), 0.01f);
+    }
+    mp_scene_mgr = SceneMgr::CreateSceneMgr(scene_mgr_type, cell_size, &Core::instance().getThreadPool());
+    // the entities added by addEntity() follow their hierarchy nodes or their transforms
+    mp_scene_mgr->registerTransformHandler();
+    mp_scene_mgr->followHierarchy(m_transforms);
+
+    // the loaded resources follow the changed files
+    if(config.get<bool>("FileSystem.HotReload", false))
+    {
+        Core::instance().getFileSystem().startWatching(
+            [this](std::vector<std::string> const & files) { m_resource_mgr.reloadFiles(files); });
+    }
 
     // AppStates init
     {
@@ -45,12 +125,11 @@ bool App::init(int32_t argc, char * argv[])
         }
     }
 
-    // delete dead objects
+    // delete dead objects, objects are released in the frame loop (see buildFrameGraphs)
     auto clean_time_period = config.get<uint32_t>("App.CleanTime");
-    auto clean_lambda      = [this] {
-        m_obj_mgr.releaseStalledObjects();
-        m_resource_mgr.releaseUnused();
-    };
+    auto clean_lambda      = [this] { m_resource_mgr.releaseUnused(); };
+
+    m_object_sweep_budget = std::chrono::microseconds(config.get<uint32_t>("App.ObjectSweepBudget"));
 
     mp_obj_mgr_clean_timer->loopCall(clean_time_period, clean_lambda);
 
@@ -59,15 +138,44 @@ bool App::init(int32_t argc, char * argv[])
 
 void App::update()
 {
-    mp_main_window->update();
+    m_update_graph.execute(Core::instance().getThreadPool());
+}
+
+void App::draw()
+{
+    m_draw_graph.execute(Core::instance().getThreadPool());
+}
+
+void App::buildFrameGraphs()
+{
+    using Affinity = TaskGraph::Affinity;
+
+    auto window_job = m_update_graph.addJob(
+        "window_update", [this] { mp_main_window->update(); }, {}, Affinity::caller);
 
     // perform state transition
-    if((m_next_state != -1 && (m_next_state != m_cur_state)))
-    {
-        doStateTransition();
-    }
+    auto transition_job = m_update_graph.addJob(
+        "state_transition",
+        [this] {
+            if((m_next_state != -1 && (m_next_state != m_cur_state)))
+            {
+                doStateTransition();
+            }
+        },
+        {window_job}, Affinity::caller);
+
+    auto state_job = m_update_graph.addJob(
+        "state_update", [this] { m_states[m_cur_state]->update(); },   // scene update
+        {transition_job}, Affinity::caller);
 
-    m_states[m_cur_state]->update();   // scene update
+    // the scene objects are moved in one batch
+    m_update_graph.addJob(
+        "transform_update", [this] { m_transforms.update(&Core::instance().getThreadPool()); }, {state_job},
+        Affinity::caller);
+
+    // incremental release of deleted objects, limited by App.ObjectSweepBudget
+    m_update_graph.addJob(
+        "object_sweep", [this] { m_obj_mgr.releaseStalledObjects(m_object_sweep_budget); }, {state_job});
 }
 
 void App::terminate()
@@ -81,6 +189,11 @@ void App::terminate()
         }
     }
 
+    // the watcher calls the resource manager, the loading tasks use the file system and the Core
+    Core::instance().getFileSystem().stopWatching();
+    m_resource_mgr.finishRequests();
+    m_preloaded.clear();   // the textures are destroyed with the context
+
     // window terminate
     mp_main_window->terminate();
 }
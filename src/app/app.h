@@ -2,7 +2,9 @@
 #define APP_H
 
 #include "../assets/resource.h"
+#include "../core/taskgraph.h"
 #include "../object/objectmanager.h"
+#include "../scene/scenemgr.h"
 #include "appstate.h"
 #include "command.h"
 #include "window.h"
@@ -21,8 +23,8 @@ public:
 
     bool init(int32_t argc, char * argv[]);
     void processInput() {}
-    void update();
-    void draw() {}                               // call render() for  main window
+    void update();                               // execute update graph
+    void draw();                                 // execute draw graph
     void swap() { mp_main_window->present(); }   // swap back buffer
     void terminate();
 
@@ -44,20 +46,33 @@ public:
     AppState::StateID getStateID(std::string const & state_name);   // if not found return 0
     std::string       getStateName(AppState::StateID id) const;
 
-    Window &          getMainWindow() { return *mp_main_window; }
-    ResourceManager & getResourceManager() { return m_resource_mgr; }
-    ObjectManager &   getObjectManager() { return m_obj_mgr; }
-    Command const &   getAppCommandLineParam() const { return m_command_line; }
+    Window &             getMainWindow() { return *mp_main_window; }
+    ResourceManager &    getResourceManager() { return m_resource_mgr; }
+    ObjectManager &      getObjectManager() { return m_obj_mgr; }
+    SceneMgr &           getSceneMgr() { return *mp_scene_mgr; }
+    TransformHierarchy & getTransformHierarchy() { return m_transforms; }
+    Command const &      getAppCommandLineParam() const { return m_command_line; }
+
+    // Per-frame job graphs. Update graph predefined jobs (main thread): "window_update" ->
+    // "state_transition" -> "state_update" -> "transform_update", and "object_sweep" in the pool after
+    // "state_update".
+    // Systems add their jobs with dependencies on them.
+    TaskGraph & getUpdateGraph() { return m_update_graph; }
+    TaskGraph & getDrawGraph() { return m_draw_graph; }
 
     // input queue interface
 
 private:
     void doStateTransition();
+    void buildFrameGraphs();
 
     std::unique_ptr<Window> mp_main_window;
     bool                    m_is_running{true};
 
-    ResourceManager m_resource_mgr;
+    ResourceManager                          m_resource_mgr;
+    std::vector<Resource::ResourceSharedPtr> m_preloaded;   // App.PreloadTextures, kept until terminate()
+    TransformHierarchy                       m_transforms;
+    std::unique_ptr<SceneMgr>                mp_scene_mgr;
 
     mutable std::mutex       m_state_mutex;
     std::vector<AppStatePtr> m_states;
@@ -67,9 +82,13 @@ private:
 
     // input queue buffers
 
-    std::unique_ptr<Timer> mp_obj_mgr_clean_timer;
-    ObjectManager          m_obj_mgr;
-    Command                m_command_line;
+    TaskGraph m_update_graph;
+    TaskGraph m_draw_graph;
+
+    std::unique_ptr<Timer>    mp_obj_mgr_clean_timer;
+    ObjectManager             m_obj_mgr;
+    std::chrono::microseconds m_object_sweep_budget{500};
+    Command                   m_command_line;
 };
 }   // namespace evnt
 #endif   // APP_H
@@ -49,7 +49,8 @@ public:
 
     void setWindowTitle(std::string const & title) { m_title = title; }
 
-    Input & getInput() { return *mp_input_backend; }
+    Input &  getInput() { return *mp_input_backend; }
+    Render * getRender() { return mp_renderer.get(); }   // nullptr before init()
 
     glm::ivec2        getWindowSize() const { return m_win_size; }
     DisplayMode const getDisplayMode() const { return DisplayMode(m_win_size); }
@@ -0,0 +1,430 @@
+#include "blockcompression.h"
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <limits>
+
+namespace evnt
+{
+namespace
+{
+    using BlockPixels = float[16][4];
+
+    void LoadBlock(uint8_t const * block, BlockPixels & px)
+    {
+        for(int32_t i = 0; i < 16; ++i)
+            for(int32_t c = 0; c < 4; ++c)
+                px[i][c] = block[i * 4 + c];
+    }
+
+    float Clamp255(float v)
+    {
+        return std::clamp(v, 0.f, 255.f);
+    }
+
+    // The endpoints at the extreme projections of the pixels on the principal axis, the axis is found by the
+    // power iteration of the covariance matrix started from its row of the largest variance.
+    void FitEndpoints(BlockPixels const & px, int32_t num_channels, float (&e0)[4], float (&e1)[4])
+    {
+        float mean[4] = {};
+        for(int32_t i = 0; i < 16; ++i)
+            for(int32_t c = 0; c < 4; ++c)
+                mean[c] += px[i][c] / 16.f;
+
+        float cov[4][4] = {};
+        for(int32_t i = 0; i < 16; ++i)
+            for(int32_t a = 0; a < num_channels; ++a)
+                for(int32_t b = 0; b < num_channels; ++b)
+                    cov[a][b] += (px[i][a] - mean[a]) * (px[i][b] - mean[b]);
+
+        int32_t max_row = 0;
+        for(int32_t a = 1; a < num_channels; ++a)
+            if(cov[a][a] > cov[max_row][max_row])
+                max_row = a;
+
+        float axis[4] = {};
+        for(int32_t a = 0; a < num_channels; ++a)
+            axis[a] = cov[max_row][a];
+
+        for(int32_t iter = 0; iter < 8; ++iter)
+        {
+            float next[4] = {};
+            float len     = 0.f;
+            for(int32_t a = 0; a < num_channels; ++a)
+            {
+                for(int32_t b = 0; b < num_channels; ++b)
+                    next[a] += cov[a][b] * axis[b];
+                len = std::max(len, std::fabs(next[a]));
+            }
+
+            if(len < 1e-6f)
+                break;   // a solid block
+
+            for(int32_t a = 0; a < num_channels; ++a)
+                axis[a] = next[a] / len;
+        }
+
+        float len2 = 0.f;
+        for(int32_t a = 0; a < num_channels; ++a)
+            len2 += axis[a] * axis[a];
+
+        float t_min = 0.f;
+        float t_max = 0.f;
+        if(len2 > 1e-12f)
+        {
+            t_min = std::numeric_limits<float>::max();
+            t_max = std::numeric_limits<float>::lowest();
+            for(int32_t i = 0; i < 16; ++i)
+            {
+                float t = 0.f;
+                for(int32_t a = 0; a < num_channels; ++a)
+                    t += (px[i][a] - mean[a]) * axis[a];
+
+                t_min = std::min(t_min, t / len2);
+                t_max = std::max(t_max, t / len2);
+            }
+        }
+
+        for(int32_t c = 0; c < 4; ++c)
+        {
+            e0[c] = Clamp255(mean[c] + t_min * axis[c]);
+            e1[c] = Clamp255(mean[c] + t_max * axis[c]);
+        }
+    }
+
+    // The endpoints minimizing the squared error for the fixed weights of the pixels (0 - e0, 1 - e1).
+    // false if all the pixels have the same weight.
+    bool RefineEndpoints(BlockPixels const & px, float const (&t)[16], int32_t num_channels, float (&e0)[4],
+                         float (&e1)[4])
+    {
+        float aa = 0.f, ab = 0.f, bb = 0.f;
+        float ax[4] = {}, bx[4] = {};
+        for(int32_t i = 0; i < 16; ++i)
+        {
+            float const a = 1.f - t[i];
+            float const b = t[i];
+
+            aa += a * a;
+            ab += a * b;
+            bb += b * b;
+            for(int32_t c = 0; c < num_channels; ++c)
+            {
+                ax[c] += a * px[i][c];
+                bx[c] += b * px[i][c];
+            }
+        }
+
+        float const det = aa * bb - ab * ab;
+        if(std::fabs(det) < 1e-6f)
+            return false;
+
+        for(int32_t c = 0; c < num_channels; ++c)
+        {
+            e0[c] = Clamp255((ax[c] * bb - bx[c] * ab) / det);
+            e1[c] = Clamp255((bx[c] * aa - ax[c] * ab) / det);
+        }
+
+        return true;
+    }
+
+    //==============================================================================
+    //         BC1 color
+    //==============================================================================
+    struct ColorBlock
+    {
+        uint16_t c0;
+        uint16_t c1;
+        uint32_t indices;   // 2 bits a pixel
+        float    error;
+    };
+
+    uint16_t To565(float const (&c)[4])
+    {
+        auto quantize = [](float v, float max) {
+            return static_cast<uint32_t>(std::lround(v * max / 255.f));
+        };
+
+        return static_cast<uint16_t>(quantize(c[0], 31.f) << 11 | quantize(c[1], 63.f) << 5
+                                     | quantize(c[2], 31.f));
+    }
+
+    void From565(uint16_t v, int32_t (&c)[3])
+    {
+        int32_t const r = v >> 11 & 31;
+        int32_t const g = v >> 5 & 63;
+        int32_t const b = v & 31;
+
+        c[0] = r << 3 | r >> 2;
+        c[1] = g << 2 | g >> 4;
+        c[2] = b << 3 | b >> 2;
+    }
+
+    // c0 > c1 selects the 4 color palette of BC1, equal endpoints use the first color only
+    ColorBlock EncodeColorEndpoints(BlockPixels const & px, float const (&e0)[4], float const (&e1)[4])
+    {
+        ColorBlock res{To565(e0), To565(e1), 0, 0.f};
+        if(res.c0 < res.c1)
+            std::swap(res.c0, res.c1);
+
+        int32_t palette[4][3];
+        From565(res.c0, palette[0]);
+        From565(res.c1, palette[1]);
+        for(int32_t c = 0; c < 3; ++c)
+        {
+            palette[2][c] = (2 * palette[0][c] + palette[1][c]) / 3;
+            palette[3][c] = (palette[0][c] + 2 * palette[1][c]) / 3;
+        }
+
+        int32_t const num_colors = res.c0 == res.c1 ? 1 : 4;
+        for(int32_t i = 0; i < 16; ++i)
+        {
+            float    best_error = std::numeric_limits<float>::max();
+            uint32_t best       = 0;
+            for(int32_t k = 0; k < num_colors; ++k)
+            {
+                float error = 0.f;
+                for(int32_t c = 0; c < 3; ++c)
+                    error += (px[i][c] - static_cast<float>(palette[k][c]))
+                             * (px[i][c] - static_cast<float>(palette[k][c]));
+
+                if(error < best_error)
+                {
+                    best_error = error;
+                    best       = static_cast<uint32_t>(k);
+                }
+            }
+
+            res.indices |= best << (2 * i);
+            res.error += best_error;
+        }
+
+        return res;
+    }
+
+    void EncodeColor(BlockPixels const & px, uint8_t * out)
+    {
+        float e0[4], e1[4];
+        FitEndpoints(px, 3, e0, e1);
+        ColorBlock res = EncodeColorEndpoints(px, e0, e1);
+
+        // the palette positions of the indices: c0, c1, 1/3, 2/3
+        float const weights[4] = {0.f, 1.f, 1.f / 3.f, 2.f / 3.f};
+        float       t[16];
+        for(int32_t i = 0; i < 16; ++i)
+            t[i] = weights[res.indices >> (2 * i) & 3];
+
+        if(res.c0 != res.c1 && RefineEndpoints(px, t, 3, e0, e1))
+        {
+            ColorBlock const refined = EncodeColorEndpoints(px, e0, e1);
+            if(refined.error < res.error)
+                res = refined;
+        }
+
+        std::memcpy(out, &res.c0, 2);   // little-endian
+        std::memcpy(out + 2, &res.c1, 2);
+        std::memcpy(out + 4, &res.indices, 4);
+    }
+
+    //==============================================================================
+    //         BC3 alpha
+    //==============================================================================
+    void EncodeAlpha(uint8_t const * block, uint8_t * out)
+    {
+        int32_t a0 = 0;
+        int32_t a1 = 255;
+        for(int32_t i = 0; i < 16; ++i)
+        {
+            a0 = std::max<int32_t>(a0, block[i * 4 + 3]);
+            a1 = std::min<int32_t>(a1, block[i * 4 + 3]);
+        }
+
+        // a0 > a1 selects the 8 value palette, equal values use the first one only
+        uint64_t indices = 0;
+        if(a0 > a1)
+        {
+            int32_t palette[8] = {a0, a1};
+            for(int32_t k = 2; k < 8; ++k)
+                palette[k] = ((8 - k) * a0 + (k - 1) * a1) / 7;
+
+            for(int32_t i = 0; i < 16; ++i)
+            {
+                int32_t  best_error = std::numeric_limits<int32_t>::max();
+                uint64_t best       = 0;
+                for(int32_t k = 0; k < 8; ++k)
+                {
+                    int32_t const error = std::abs(block[i * 4 + 3] - palette[k]);
+                    if(error < best_error)
+                    {
+                        best_error = error;
+                        best       = static_cast<uint64_t>(k);
+                    }
+                }
+
+                indices |= best << (3 * i);
+            }
+        }
+
+        out[0] = static_cast<uint8_t>(a0);
+        out[1] = static_cast<uint8_t>(a1);
+        for(int32_t i = 0; i < 6; ++i)
+            out[2 + i] = static_cast<uint8_t>(indices >> (8 * i));
+    }
+
+    //==============================================================================
+    //         BC7 mode 6
+    //==============================================================================
+    int32_t const bc7_weights[16] = {0, 4, 9, 13, 17, 21, 26, 30, 34, 38, 43, 47, 51, 55, 60, 64};
+
+    struct BC7Endpoint
+    {
+        int32_t q[4];   // 7 bits
+        int32_t p;      // the shared low bit
+    };
+
+    struct BC7Block
+    {
+        BC7Endpoint e0;
+        BC7Endpoint e1;
+        uint8_t     indices[16];
+        float       error;
+    };
+
+    BC7Endpoint QuantizeBC7(float const (&e)[4])
+    {
+        BC7Endpoint res{};
+        float       best_error = std::numeric_limits<float>::max();
+        for(int32_t p = 0; p < 2; ++p)
+        {
+            BC7Endpoint q{{}, p};
+            float       error = 0.f;
+            for(int32_t c = 0; c < 4; ++c)
+            {
+                long const v  = std::lround((e[c] - static_cast<float>(p)) / 2.f);
+                q.q[c]        = static_cast<int32_t>(std::clamp(v, 0l, 127l));
+                float const d = static_cast<float>(q.q[c] * 2 + p) - e[c];
+                error += d * d;
+            }
+
+            if(error < best_error)
+            {
+                best_error = error;
+                res        = q;
+            }
+        }
+
+        return res;
+    }
+
+    BC7Block EncodeBC7Endpoints(BlockPixels const & px, float const (&e0)[4], float const (&e1)[4])
+    {
+        BC7Block res{QuantizeBC7(e0), QuantizeBC7(e1), {}, 0.f};
+
+        int32_t palette[16][4];
+        for(int32_t k = 0; k < 16; ++k)
+        {
+            for(int32_t c = 0; c < 4; ++c)
+            {
+                int32_t const v0 = res.e0.q[c] * 2 + res.e0.p;
+                int32_t const v1 = res.e1.q[c] * 2 + res.e1.p;
+                palette[k][c]    = ((64 - bc7_weights[k]) * v0 + bc7_weights[k] * v1 + 32) >> 6;
+            }
+        }
+
+        for(int32_t i = 0; i < 16; ++i)
+        {
+            float   best_error = std::numeric_limits<float>::max();
+            uint8_t best       = 0;
+            for(int32_t k = 0; k < 16; ++k)
+            {
+                float error = 0.f;
+                for(int32_t c = 0; c < 4; ++c)
+                    error += (px[i][c] - static_cast<float>(palette[k][c]))
+                             * (px[i][c] - static_cast<float>(palette[k][c]));
+
+                if(error < best_error)
+                {
+                    best_error = error;
+                    best       = static_cast<uint8_t>(k);
+                }
+            }
+
+            res.indices[i] = best;
+            res.error += best_error;
+        }
+
+        return res;
+    }
+
+    struct BitWriter
+    {
+        uint64_t bits[2] = {};
+        uint32_t pos     = 0;
+
+        void put(uint32_t value, uint32_t num_bits)
+        {
+            for(uint32_t i = 0; i < num_bits; ++i, ++pos)
+                bits[pos / 64] |= uint64_t{(value >> i) & 1u} << (pos % 64);
+        }
+    };
+}   // namespace
+
+void EncodeBC1Block(uint8_t const * block, uint8_t * out)
+{
+    BlockPixels px;
+    LoadBlock(block, px);
+    EncodeColor(px, out);
+}
+
+void EncodeBC3Block(uint8_t const * block, uint8_t * out)
+{
+    BlockPixels px;
+    LoadBlock(block, px);
+    EncodeAlpha(block, out);
+    EncodeColor(px, out + 8);
+}
+
+void EncodeBC7Block(uint8_t const * block, uint8_t * out)
+{
+    BlockPixels px;
+    LoadBlock(block, px);
+
+    float e0[4], e1[4];
+    FitEndpoints(px, 4, e0, e1);
+    BC7Block res = EncodeBC7Endpoints(px, e0, e1);
+
+    float t[16];
+    for(int32_t i = 0; i < 16; ++i)
+        t[i] = static_cast<float>(bc7_weights[res.indices[i]]) / 64.f;
+
+    if(RefineEndpoints(px, t, 4, e0, e1))
+    {
+        BC7Block const refined = EncodeBC7Endpoints(px, e0, e1);
+        if(refined.error < res.error)
+            res = refined;
+    }
+
+    // the high bit of the first index is implicit 0
+    if(res.indices[0] & 8)
+    {
+        std::swap(res.e0, res.e1);
+        for(auto & index : res.indices)
+            index = static_cast<uint8_t>(15 - index);
+    }
+
+    BitWriter bw;
+    bw.put(1u << 6, 7);   // mode 6
+    for(int32_t c = 0; c < 4; ++c)
+    {
+        bw.put(static_cast<uint32_t>(res.e0.q[c]), 7);
+        bw.put(static_cast<uint32_t>(res.e1.q[c]), 7);
+    }
+    bw.put(static_cast<uint32_t>(res.e0.p), 1);
+    bw.put(static_cast<uint32_t>(res.e1.p), 1);
+
+    bw.put(res.indices[0], 3);
+    for(int32_t i = 1; i < 16; ++i)
+        bw.put(res.indices[i], 4);
+
+    std::memcpy(out, bw.bits, 16);   // little-endian
+}
+}   // namespace evnt
@@ -0,0 +1,16 @@
+#ifndef BLOCKCOMPRESSION_H
+#define BLOCKCOMPRESSION_H
+
+#include <cstdint>
+
+namespace evnt
+{
+// Encoders of 4x4 pixel blocks, block - 16 RGBA pixels by rows. The endpoints are fitted along the principal
+// axis of the block colors and refined by least squares once.
+inline static uint32_t const block_encoder_version = 1;   // bump when the output changes, see ImageCache
+
+void EncodeBC1Block(uint8_t const * block, uint8_t * out);   // 8 bytes, opaque, the alpha is ignored
+void EncodeBC3Block(uint8_t const * block, uint8_t * out);   // 16 bytes, BC1 color + interpolated alpha
+void EncodeBC7Block(uint8_t const * block, uint8_t * out);   // 16 bytes, mode 6 only: 1 subset RGBA
+}   // namespace evnt
+#endif   // BLOCKCOMPRESSION_H
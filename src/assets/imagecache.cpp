@@ -0,0 +1,339 @@
+#include "imagecache.h"
+#include "../fs/file_mapping.h"
+#include "../log/log.h"
+#include <algorithm>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <vector>
+
+namespace evnt
+{
+namespace fs = std::filesystem;
+
+namespace
+{
+    struct CacheFileHeader
+    {
+        uint32_t magic;
+        uint32_t decoder_version;
+        uint64_t key;
+        uint32_t width;
+        uint32_t height;
+        uint32_t format;   // TextureData::Format, sRGB flag in bit 8
+        uint32_t num_levels;
+        uint64_t data_size;
+    };
+
+    uint32_t const    cache_file_magic  = 0x43495645;   // "EVIC"
+    size_t const      cache_data_offset = 64;           // the pixels are aligned for SIMD copies and uploads
+    std::string const cache_file_ext    = ".img";
+    uint32_t const    srgb_flag         = 0x100;
+
+    uint64_t Rotl(uint64_t x, int r)
+    {
+        return (x << r) | (x >> (64 - r));
+    }
+
+    uint64_t Fmix(uint64_t h)
+    {
+        h ^= h >> 33;
+        h *= 0xff51afd7ed558ccdull;
+        h ^= h >> 33;
+        h *= 0xc4ceb9fe1a85ec53ull;
+        h ^= h >> 33;
+
+        return h;
+    }
+
+    // MurmurHash3 style mixing of 8 byte words, several GB/s, the key is recomputed for every load
+    uint64_t HashBytes(uint8_t const * data, size_t size, uint64_t seed)
+    {
+        uint64_t const c1 = 0x87c37b91114253d5ull;
+        uint64_t const c2 = 0x4cf5ad432745937full;
+
+        uint64_t h = seed ^ size;
+        size_t   i = 0;
+        for(; i + 8 <= size; i += 8)
+        {
+            uint64_t k;
+            std::memcpy(&k, data + i, sizeof(k));
+
+            k *= c1;
+            k = Rotl(k, 31);
+            k *= c2;
+            h ^= k;
+            h = Rotl(h, 27) * 5 + 0x52dce729;
+        }
+
+        uint64_t tail = 0;
+        for(size_t shift = 0; i < size; ++i, shift += 8)
+            tail |= static_cast<uint64_t>(data[i]) << shift;
+
+        return Fmix(h ^ (tail * c1));
+    }
+}   // namespace
+
+ImageCache::ImageCache(std::string dir, uint64_t max_size) : m_dir{std::move(dir)}, m_max_size{max_size}
+{
+    if(m_dir.empty())
+        return;
+
+    std::error_code ec;
+    fs::create_directories(m_dir, ec);
+    if(ec || !fs::is_directory(m_dir, ec))
+    {
+        Log::Log(Log::error,
+                 Log::cstr_log("ImageCache: \"%s\" - can't create the directory, the cache is disabled",
+                               m_dir.c_str()));
+        m_dir.clear();
+        return;
+    }
+
+    struct FoundEntry
+    {
+        Entry              entry;
+        fs::file_time_type time;
+    };
+    std::vector<FoundEntry> found;
+
+    for(auto it = fs::directory_iterator(m_dir, ec); !ec && it != fs::directory_iterator(); it.increment(ec))
+    {
+        fs::path const & path = it->path();
+        if(!it->is_regular_file(ec))
+            continue;
+
+        // files of an interrupted store
+        if(path.extension() == ".tmp")
+        {
+            fs::remove(path, ec);
+            continue;
+        }
+
+        if(path.extension() != cache_file_ext)
+            continue;
+
+        std::string const stem = path.stem().string();
+        char *            end  = nullptr;
+        uint64_t const    key  = std::strtoull(stem.c_str(), &end, 16);
+        if(stem.size() != 16 || end != stem.c_str() + stem.size())
+            continue;
+
+        found.push_back({{key, it->file_size(ec)}, it->last_write_time(ec)});
+    }
+
+    // the most recently used first
+    std::sort(found.begin(), found.end(),
+              [](FoundEntry const & l, FoundEntry const & r) { return l.time > r.time; });
+
+    std::lock_guard lk(m_mutex);
+    for(auto const & f : found)
+    {
+        m_lru.push_back(f.entry);
+        m_entries[f.entry.key] = std::prev(m_lru.end());
+        m_stats.size += f.entry.size;
+    }
+    m_stats.entries = m_entries.size();
+
+    evict();
+}
+
+uint64_t ImageCache::GetKey(BaseFile const & file, uint64_t variant)
+{
+    std::string const ext  = file.getNameExt();
+    uint64_t const    seed = HashBytes(reinterpret_cast<uint8_t const *>(ext.data()), ext.size(),
+                                       decoder_version ^ Fmix(variant));
+
+    return HashBytes(reinterpret_cast<uint8_t const *>(file.getData()), file.getFileSize(), seed);
+}
+
+std::string ImageCache::getPath(uint64_t key) const
+{
+    char name[17];
+    std::snprintf(name, sizeof(name), "%016llx", static_cast<unsigned long long>(key));
+
+    return m_dir + '/' + name + cache_file_ext;
+}
+
+bool ImageCache::find(uint64_t key, TextureData & td)
+{
+    if(!isEnabled())
+        return false;
+
+    std::string const path    = getPath(key);
+    auto              mapping = FileMapping::Map(path);
+
+    CacheFileHeader header{};
+    TextureData     entry;
+    bool            valid = mapping && mapping->getSize() >= cache_data_offset;
+    if(valid)
+    {
+        std::memcpy(&header, mapping->getData(), sizeof(header));
+
+        entry.width  = header.width;
+        entry.height = header.height;
+        entry.format = static_cast<TextureData::Format>(header.format & ~srgb_flag);
+        entry.srgb   = (header.format & srgb_flag) != 0;
+        valid        = header.magic == cache_file_magic && header.decoder_version == decoder_version
+                && header.key == key && entry.format <= TextureData::Format::bc7 && header.num_levels != 0
+                && header.num_levels <= TextureData::GetNumMipLevels(header.width, header.height);
+    }
+
+    if(valid)
+    {
+        uint64_t const expected_size = entry.setLevels(header.num_levels);
+        valid = header.data_size == expected_size && expected_size != 0
+                && mapping->getSize() >= cache_data_offset + header.data_size;
+    }
+
+    if(!valid)
+    {
+        std::lock_guard lk(m_mutex);
+        ++m_stats.misses;
+        removeEntry(key);   // removed outside or corrupted
+
+        if(mapping)
+        {
+            // a corrupted entry is stored again
+            Log::Log(Log::warning, Log::cstr_log("ImageCache: \"%s\" - corrupted entry", path.c_str()));
+
+            std::error_code ec;
+            fs::remove(path, ec);
+        }
+
+        return false;
+    }
+
+    entry.data.reset(new uint8_t[static_cast<size_t>(header.data_size)]);   // not zeroed, all written
+    std::memcpy(entry.data.get(), mapping->getData() + cache_data_offset,
+                static_cast<size_t>(header.data_size));
+    td = std::move(entry);
+
+    // the modification time keeps the order of use for the next run
+    std::error_code ec;
+    fs::last_write_time(path, fs::file_time_type::clock::now(), ec);
+
+    std::lock_guard lk(m_mutex);
+    ++m_stats.hits;
+
+    auto it = m_entries.find(key);
+    if(it != m_entries.end())
+        m_lru.splice(m_lru.begin(), m_lru, it->second);
+    else
+        addEntry(key, mapping->getSize());   // stored by another process
+
+    return true;
+}
+
+void ImageCache::store(uint64_t key, TextureData const & td)
+{
+    uint64_t const data_size = td.getDataSize();
+    if(!isEnabled() || data_size == 0 || !td.data)
+        return;
+
+    // would be evicted right after the write together with every other entry
+    if(cache_data_offset + data_size > m_max_size)
+        return;
+
+    CacheFileHeader header{};
+    header.magic           = cache_file_magic;
+    header.decoder_version = decoder_version;
+    header.key             = key;
+    header.width           = td.width;
+    header.height          = td.height;
+    header.format          = static_cast<uint32_t>(td.format) | (td.srgb ? srgb_flag : 0);
+    header.num_levels      = static_cast<uint32_t>(td.levels.size());
+    header.data_size       = data_size;
+
+    char padding[cache_data_offset] = {};
+
+    // written to a temporary file and renamed, a reader never sees a partial entry
+    std::string const path     = getPath(key);
+    std::string const tmp_path = path + '.' + FileSystem::GetTempFileName();
+    {
+        std::ofstream ofs(tmp_path, std::ios::binary | std::ios::trunc);
+        ofs.write(reinterpret_cast<char const *>(&header), sizeof(header));
+        ofs.write(padding, static_cast<std::streamsize>(cache_data_offset - sizeof(header)));
+        ofs.write(reinterpret_cast<char const *>(td.data.get()), static_cast<std::streamsize>(data_size));
+
+        if(!ofs)
+        {
+            Log::Log(Log::error, Log::cstr_log("ImageCache: \"%s\" - not written", tmp_path.c_str()));
+            ofs.close();
+
+            std::error_code ec;
+            fs::remove(tmp_path, ec);
+            return;
+        }
+    }
+
+    std::error_code ec;
+    fs::rename(tmp_path, path, ec);
+    if(ec)
+    {
+        fs::remove(tmp_path, ec);
+        return;
+    }
+
+    std::lock_guard lk(m_mutex);
+    ++m_stats.stores;
+
+    removeEntry(key);   // replaced
+    addEntry(key, cache_data_offset + data_size);
+    evict();
+}
+
+void ImageCache::clear()
+{
+    std::lock_guard lk(m_mutex);
+
+    std::error_code ec;
+    for(auto const & entry : m_lru)
+        fs::remove(getPath(entry.key), ec);
+
+    m_lru.clear();
+    m_entries.clear();
+    m_stats.size    = 0;
+    m_stats.entries = 0;
+}
+
+ImageCache::Stats ImageCache::getStats() const
+{
+    std::lock_guard lk(m_mutex);
+    return m_stats;
+}
+
+void ImageCache::addEntry(uint64_t key, uint64_t size)
+{
+    m_lru.push_front({key, size});
+    m_entries[key] = m_lru.begin();
+
+    m_stats.size += size;
+    m_stats.entries = m_entries.size();
+}
+
+void ImageCache::removeEntry(uint64_t key)
+{
+    auto it = m_entries.find(key);
+    if(it == m_entries.end())
+        return;
+
+    m_stats.size -= it->second->size;
+    m_lru.erase(it->second);
+    m_entries.erase(it);
+    m_stats.entries = m_entries.size();
+}
+
+void ImageCache::evict()
+{
+    std::error_code ec;
+    while(m_stats.size > m_max_size && !m_lru.empty())
+    {
+        uint64_t const key = m_lru.back().key;
+
+        fs::remove(getPath(key), ec);
+        removeEntry(key);
+        ++m_stats.evictions;
+    }
+}
+}   // namespace evnt
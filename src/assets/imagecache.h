@@ -0,0 +1,71 @@
+#ifndef IMAGECACHE_H
+#define IMAGECACHE_H
+
+#include "texturedata.h"
+#include <list>
+#include <mutex>
+#include <unordered_map>
+
+namespace evnt
+{
+/**
+ * Persistent cache of decoded and processed images. Entries are keyed by a hash of the source file
+ * bytes, the decoder version and the processing settings, so a changed file, decoder or setting never hits
+ * a stale entry. Each entry is one file holding a small header and the levels in the TextureData layout at
+ * a 64 byte aligned offset, ready for the texture upload. The cache size is limited, the least recently
+ * used entries are removed first, the order of use is kept in the modification time of the files between
+ * runs.
+ */
+class ImageCache
+{
+public:
+    // bump when the output of ReadTGA/ReadBMP or the entry layout changes, the old entries are never hit
+    static constexpr uint32_t decoder_version = 2;
+
+    struct Stats
+    {
+        uint64_t hits      = 0;
+        uint64_t misses    = 0;
+        uint64_t stores    = 0;
+        uint64_t evictions = 0;
+        uint64_t size      = 0;   // bytes on disk
+        size_t   entries   = 0;
+    };
+
+    // an empty dir disables the cache, max_size in bytes
+    ImageCache(std::string dir, uint64_t max_size);
+
+    bool isEnabled() const { return !m_dir.empty(); }
+
+    // hash of the file data and the extension, the decoder is chosen by the extension, variant - of the
+    // processing settings (see TextureProcessing::getKey)
+    static uint64_t GetKey(BaseFile const & file, uint64_t variant = 0);
+
+    bool find(uint64_t key, TextureData & td);
+    void store(uint64_t key, TextureData const & td);
+    void clear();
+
+    Stats getStats() const;
+
+private:
+    struct Entry
+    {
+        uint64_t key;
+        uint64_t size;
+    };
+
+    std::string getPath(uint64_t key) const;
+    void        addEntry(uint64_t key, uint64_t size);   // requires m_mutex locked
+    void        removeEntry(uint64_t key);               // requires m_mutex locked
+    void        evict();                                 // requires m_mutex locked
+
+    std::string m_dir;
+    uint64_t    m_max_size;
+
+    mutable std::mutex                                        m_mutex;
+    std::list<Entry>                                          m_lru;   // the most recently used first
+    std::unordered_map<uint64_t, std::list<Entry>::iterator> m_entries;
+    Stats                                                     m_stats;
+};
+}   // namespace evnt
+#endif   // IMAGECACHE_H
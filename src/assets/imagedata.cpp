@@ -1,4 +1,6 @@
 #include "imagedata.h"
+#include "imagekernels.h"
+#include <algorithm>
 #include <cstring>
 #include <fstream>
 #include <iostream>
@@ -72,21 +74,22 @@ bool ReadBMP(BaseFile const & file, ImageData & id)
     if(id.data)
         id.data.reset(nullptr);
 
+    // the data may be a read-only file mapping, reading past its end faults
     file_length = file.getFileSize();
-    if(file_length == 0)
+    if(file_length < sizeof(BITMAPFILEHEADER) + sizeof(BITMAPINFO12))
         return res;
 
-    auto * buffer = reinterpret_cast<uint8_t *>(const_cast<int8_t *>(file.getData()));
+    auto const * buffer = reinterpret_cast<uint8_t const *>(file.getData());
 
-    auto *             pPtr    = buffer;
-    BITMAPFILEHEADER * pHeader = reinterpret_cast<BITMAPFILEHEADER *>(pPtr);
+    auto const *             pPtr    = buffer;
+    BITMAPFILEHEADER const * pHeader = reinterpret_cast<BITMAPFILEHEADER const *>(pPtr);
     pPtr += sizeof(BITMAPFILEHEADER);
     if(pHeader->bfSize != file_length || pHeader->bfType != 0x4D42)   // little-endian
         return res;
 
-    if(reinterpret_cast<uint32_t *>(pPtr)[0] == 12)
+    if(reinterpret_cast<uint32_t const *>(pPtr)[0] == 12)
     {
-        BITMAPINFO12 * pInfo = reinterpret_cast<BITMAPINFO12 *>(pPtr);
+        BITMAPINFO12 const * pInfo = reinterpret_cast<BITMAPINFO12 const *>(pPtr);
         // pPtr += pInfo->biSize;
 
         if(pInfo->biBitCount != 24 && pInfo->biBitCount != 32)
@@ -102,7 +105,10 @@ bool ReadBMP(BaseFile const & file, ImageData & id)
     }
     else
     {
-        BITMAPINFO * pInfo = reinterpret_cast<BITMAPINFO *>(pPtr);
+        if(file_length < sizeof(BITMAPFILEHEADER) + sizeof(BITMAPINFO))
+            return res;
+
+        BITMAPINFO const * pInfo = reinterpret_cast<BITMAPINFO const *>(pPtr);
         // pPtr += pInfo->biSize;
 
         if(pInfo->biBitCount != 24 && pInfo->biBitCount != 32)
@@ -132,74 +138,32 @@ bool ReadBMP(BaseFile const & file, ImageData & id)
 
     // read data:
     pPtr                     = buffer + pHeader->bfOffBits;
-    uint32_t lineLength      = 0;
     uint32_t bytes_per_pixel = (id.type == ImageData::PixelType::pt_rgb ? 3 : 4);
-    auto     image           = std::make_unique<uint8_t[]>(id.width * id.height * bytes_per_pixel);
-    uint8_t  red, green, blue, alpha;
-    uint32_t w_ind(0), h_ind(0);
+    size_t   row_size        = size_t{id.width} * bytes_per_pixel;
+    size_t   lineLength      = 0;
 
     if(id.type == ImageData::PixelType::pt_rgb)
-        lineLength = id.width * bytes_per_pixel + id.width % 4;
+        lineLength = row_size + id.width % 4;   // the rows are aligned by 4 bytes
     else
-        lineLength = id.width * bytes_per_pixel;
+        lineLength = row_size;
 
-    for(uint32_t i = 0; i < id.height; ++i)
-    {
-        w_ind = 0;
-        for(uint32_t j = 0; j < lineLength; j += bytes_per_pixel)
-        {
-            if(j > id.width * bytes_per_pixel)
-                continue;
-
-            if(compressed)
-            {
-                uint32_t count = 0;
-                if(id.type == ImageData::PixelType::pt_rgba)
-                {
-                    alpha = pPtr[i * lineLength + j + count];
-                    count++;
-                }
-                blue = pPtr[i * lineLength + j + count];
-                count++;
-                green = pPtr[i * lineLength + j + count];
-                count++;
-                red = pPtr[i * lineLength + j + count];
-            }
-            else
-            {
-                blue  = pPtr[i * lineLength + j + 0];
-                green = pPtr[i * lineLength + j + 1];
-                red   = pPtr[i * lineLength + j + 2];
-                if(id.type == ImageData::PixelType::pt_rgba)   // !!!Not supported - the high byte in each
-                                                               // DWORD is not used
-                    alpha = pPtr
-                        [i * lineLength + j
-                         + 3];   // https://msdn.microsoft.com/en-us/library/windows/desktop/dd183376(v=vs.85).aspx
-            }
-
-            image[h_ind * id.width * bytes_per_pixel + w_ind * bytes_per_pixel + 0] = red;
-            image[h_ind * id.width * bytes_per_pixel + w_ind * bytes_per_pixel + 1] = green;
-            image[h_ind * id.width * bytes_per_pixel + w_ind * bytes_per_pixel + 2] = blue;
-            if(id.type == ImageData::PixelType::pt_rgba)
-                image[h_ind * id.width * bytes_per_pixel + w_ind * bytes_per_pixel + 3] = alpha;
-            w_ind++;
-        }
-        h_ind++;
-    }
+    if(pHeader->bfOffBits > file_length || lineLength * id.height > file_length - pHeader->bfOffBits)
+        return res;
 
-    // flip image if necessary
-    if(flip)
-    {
-        auto temp_buf = std::make_unique<uint8_t[]>(id.width * id.height * bytes_per_pixel);
+    std::unique_ptr<uint8_t[]> image(new uint8_t[row_size * id.height]);   // not zeroed, all written
 
-        for(uint32_t i = 0; i < id.height; i++)
-        {
-            std::memcpy(temp_buf.get() + i * id.width * bytes_per_pixel,
-                        image.get() + (id.height - 1 - i) * id.width * bytes_per_pixel,
-                        id.width * bytes_per_pixel);
-        }
+    // the rows of a top-down image are written flipped
+    for(uint32_t i = 0; i < id.height; ++i)
+    {
+        uint8_t const * src = pPtr + i * lineLength;
+        uint8_t *       dst = image.get() + (flip ? id.height - 1 - i : i) * row_size;
 
-        image = std::move(temp_buf);
+        // the high byte of the uncompressed 32 bit pixels is not used by the format, it is read as alpha
+        // https://msdn.microsoft.com/en-us/library/windows/desktop/dd183376(v=vs.85).aspx
+        if(compressed && id.type == ImageData::PixelType::pt_rgba)
+            ReverseChannels(dst, src, id.width);   // ABGR
+        else
+            SwapRedBlue(dst, src, id.width, bytes_per_pixel);
     }
 
     id.data = std::move(image);
@@ -228,60 +192,59 @@ OutFile WriteTGA(std::string fname, ImageData const & id)
     else
         tga.imagedescriptor = 0x18;
 
+    // converted by blocks of rows in the cache
+    size_t const               row_size       = size_t{id.width} * bytes_per_pixel;
+    size_t const               rows_per_block = 64 * 1024 / std::max<size_t>(row_size, 1) + 1;
+    std::unique_ptr<uint8_t[]> block(new uint8_t[rows_per_block * row_size]);
+
+    file.getStream().reserve(sizeof(tga) + row_size * id.height);
     file.getStream().write(tga);
 
-    uint8_t * data_ptr = id.data.get();
-    uint8_t   red, green, blue, alpha;
-    for(uint32_t i = 0; i < id.width * id.height * bytes_per_pixel; i += bytes_per_pixel)
+    for(size_t row = 0; row < id.height; row += rows_per_block)
     {
-        red   = data_ptr[i + 0];
-        green = data_ptr[i + 1];
-        blue  = data_ptr[i + 2];
-        if(bytes_per_pixel == 4)
-            alpha = data_ptr[i + 3];
-
-        file.write(reinterpret_cast<char *>(&blue), 1);
-        file.write(reinterpret_cast<char *>(&green), 1);
-        file.write(reinterpret_cast<char *>(&red), 1);
-        if(id.type == ImageData::PixelType::pt_rgba)
-            file.write(reinterpret_cast<char *>(&alpha), 1);
+        size_t const num_rows = std::min<size_t>(rows_per_block, id.height - row);
+
+        SwapRedBlue(block.get(), id.data.get() + row * row_size, num_rows * id.width, bytes_per_pixel);
+        file.write(reinterpret_cast<char const *>(block.get()), num_rows * row_size);
     }
 
     return file;
 }
 
-bool ReadUncompressedTGA(ImageData & id, char * data);
-bool ReadCompressedTGA(ImageData & id, char * data);
+bool ReadUncompressedTGA(ImageData & id, char const * data, size_t length);
+bool ReadCompressedTGA(ImageData & id, char const * data, size_t length);
 
 bool ReadTGA(BaseFile const & file, ImageData & id)
 {
     size_t file_length = 0;
 
+    // the data may be a read-only file mapping, reading past its end faults
     file_length = file.getFileSize();
-    if(file_length == 0)
+    if(file_length < sizeof(TGAHEADER))
         return false;
 
-    auto buffer = reinterpret_cast<char *>(const_cast<int8_t *>(file.getData()));
+    auto buffer = reinterpret_cast<char const *>(file.getData());
 
-    auto        pPtr    = buffer;
-    TGAHEADER * pHeader = reinterpret_cast<TGAHEADER *>(pPtr);
+    auto              pPtr    = buffer;
+    TGAHEADER const * pHeader = reinterpret_cast<TGAHEADER const *>(pPtr);
 
     if(pHeader->datatypecode == 2)
     {
-        return ReadUncompressedTGA(id, buffer);
+        return ReadUncompressedTGA(id, buffer, file_length);
     }
     else if(pHeader->datatypecode == 10)
     {
-        return ReadCompressedTGA(id, buffer);
+        return ReadCompressedTGA(id, buffer, file_length);
     }
 
     return false;
 }
 
-bool ReadUncompressedTGA(ImageData & id, char * data)
+bool ReadUncompressedTGA(ImageData & id, char const * data, size_t length)
 {
-    char *      pPtr    = data;
-    TGAHEADER * pHeader = reinterpret_cast<TGAHEADER *>(pPtr);
+    char const *      pPtr    = data;
+    char const *      pEnd    = data + length;
+    TGAHEADER const * pHeader = reinterpret_cast<TGAHEADER const *>(pPtr);
     pPtr += sizeof(TGAHEADER);
 
     if((pHeader->width == 0) || (pHeader->height == 0)
@@ -298,72 +261,42 @@ bool ReadUncompressedTGA(ImageData & id, char * data)
     bool flip_vertical   = (pHeader->imagedescriptor & 0x20);
 
     uint32_t bytes_per_pixel = pHeader->bitsperpixel / 8;
-    uint32_t image_size      = id.width * id.height * bytes_per_pixel;
+    size_t   row_size        = size_t{id.width} * bytes_per_pixel;
+    size_t   image_size      = row_size * id.height;
 
-    auto img = std::make_unique<uint8_t[]>(image_size);
+    if(image_size > static_cast<size_t>(pEnd - pPtr))
+        return false;
 
-    for(uint32_t i = 0; i < id.width * id.height; ++i)
-    {
-        char red, green, blue, alpha;
-
-        red   = pPtr[i * bytes_per_pixel + 2];
-        green = pPtr[i * bytes_per_pixel + 1];
-        blue  = pPtr[i * bytes_per_pixel + 0];
-        if(id.type == ImageData::PixelType::pt_rgba)
-            alpha = pPtr[i * bytes_per_pixel + 3];
-
-        img[i * bytes_per_pixel + 0] = static_cast<uint8_t>(red);
-        img[i * bytes_per_pixel + 1] = static_cast<uint8_t>(green);
-        img[i * bytes_per_pixel + 2] = static_cast<uint8_t>(blue);
-        if(id.type == ImageData::PixelType::pt_rgba)
-            img[i * bytes_per_pixel + 3] = static_cast<uint8_t>(alpha);
-    }
+    std::unique_ptr<uint8_t[]> img(new uint8_t[image_size]);   // not zeroed, all written
+    auto const *               src = reinterpret_cast<uint8_t const *>(pPtr);
 
+    // the rows of a top-left origin image are written flipped
     if(flip_vertical)
     {
-        auto flipped_img = std::make_unique<uint8_t[]>(image_size);
-
         for(uint32_t i = 0; i < id.height; i++)
-        {
-            std::memcpy(flipped_img.get() + i * id.width * bytes_per_pixel,
-                        img.get() + (id.height - 1 - i) * id.width * bytes_per_pixel,
-                        id.width * bytes_per_pixel);
-        }
-
-        img = std::move(flipped_img);
+            SwapRedBlue(img.get() + (id.height - 1 - i) * row_size, src + i * row_size, id.width,
+                        bytes_per_pixel);
+    }
+    else
+    {
+        SwapRedBlue(img.get(), src, size_t{id.width} * id.height, bytes_per_pixel);
     }
 
     if(flip_horizontal)
     {
-        auto flipped_img = std::make_unique<uint8_t[]>(image_size);
-
         for(uint32_t i = 0; i < id.height; i++)
-        {
-            for(uint32_t j = 0; j < id.width; j++)
-            {
-                flipped_img[id.width * bytes_per_pixel * i + j * bytes_per_pixel + 0] =
-                    img[id.width * bytes_per_pixel * i + (id.width - j - 1) * bytes_per_pixel + 0];
-                flipped_img[id.width * bytes_per_pixel * i + j * bytes_per_pixel + 1] =
-                    img[id.width * bytes_per_pixel * i + (id.width - j - 1) * bytes_per_pixel + 1];
-                flipped_img[id.width * bytes_per_pixel * i + j * bytes_per_pixel + 2] =
-                    img[id.width * bytes_per_pixel * i + (id.width - j - 1) * bytes_per_pixel + 2];
-                if(id.type == ImageData::PixelType::pt_rgba)
-                    flipped_img[id.width * bytes_per_pixel * i + j * bytes_per_pixel + 3] =
-                        img[id.width * bytes_per_pixel * i + (id.width - j - 1) * bytes_per_pixel + 3];
-            }
-        }
-
-        img = std::move(flipped_img);
+            ReversePixels(img.get() + i * row_size, id.width, bytes_per_pixel);
     }
 
     id.data = std::move(img);
     return true;
 }
 
-bool ReadCompressedTGA(ImageData & id, char * data)
+bool ReadCompressedTGA(ImageData & id, char const * data, size_t length)
 {
-    char *      pPtr    = data;
-    TGAHEADER * pHeader = reinterpret_cast<TGAHEADER *>(pPtr);
+    char const *      pPtr    = data;
+    char const *      pEnd    = data + length;
+    TGAHEADER const * pHeader = reinterpret_cast<TGAHEADER const *>(pPtr);
     pPtr += sizeof(TGAHEADER);
 
     if((pHeader->width == 0) || (pHeader->height == 0)
@@ -380,100 +313,78 @@ bool ReadCompressedTGA(ImageData & id, char * data)
     bool flip_vertical   = (pHeader->imagedescriptor & 0x20);
 
     uint32_t bytes_per_pixel = pHeader->bitsperpixel / 8;
-    uint32_t image_size      = id.width * id.height * bytes_per_pixel;
+    size_t   row_size        = size_t{id.width} * bytes_per_pixel;
+    size_t   image_size      = row_size * id.height;
 
-    auto     img          = std::make_unique<uint8_t[]>(image_size);
-    uint32_t pixelcount   = id.height * id.width;
-    uint32_t currentpixel = 0;
-    uint32_t currentbyte  = 0;
+    std::unique_ptr<uint8_t[]> img(new uint8_t[image_size]);   // not zeroed, all written
+
+    size_t    pixelcount   = size_t{id.height} * id.width;
+    size_t    currentpixel = 0;
+    uint8_t * currentbyte  = img.get();
 
     do
     {
-        int32_t chunk = static_cast<int32_t>(pPtr[0]);
+        if(pPtr >= pEnd)
+            return false;
+
+        size_t chunk = static_cast<uint8_t>(pPtr[0]);
         pPtr++;
 
         if(chunk & 128)
         {
+            // run-length packet, one pixel repeated
             chunk -= 127;
-            for(int32_t counter = 0; counter < chunk; counter++)
-            {
-                img[currentbyte + 0] = static_cast<uint8_t>(pPtr[2]);
-                img[currentbyte + 1] = static_cast<uint8_t>(pPtr[1]);
-                img[currentbyte + 2] = static_cast<uint8_t>(pPtr[0]);
-                if(id.type == ImageData::PixelType::pt_rgba)
-                    img[currentbyte + 3] = static_cast<uint8_t>(pPtr[3]);
-
-                currentbyte += bytes_per_pixel;
-                currentpixel++;
-
-                if(currentpixel > pixelcount)   // Make sure we havent written too many pixels
-                {
-                    return false;
-                }
-            }
+            if(bytes_per_pixel > static_cast<size_t>(pEnd - pPtr) || chunk > pixelcount - currentpixel)
+                return false;
+
+            uint8_t pixel[4];
+            SwapRedBlue(pixel, reinterpret_cast<uint8_t const *>(pPtr), 1, bytes_per_pixel);
+            FillPixels(currentbyte, pixel, chunk, bytes_per_pixel);
             pPtr += bytes_per_pixel;
         }
         else
         {
+            // raw packet
             chunk++;
-            for(short counter = 0; counter < chunk; counter++)
-            {
-                img[currentbyte + 0] = static_cast<uint8_t>(pPtr[2]);
-                img[currentbyte + 1] = static_cast<uint8_t>(pPtr[1]);
-                img[currentbyte + 2] = static_cast<uint8_t>(pPtr[0]);
-                if(id.type == ImageData::PixelType::pt_rgba)
-                    img[currentbyte + 3] = static_cast<uint8_t>(pPtr[3]);
-
-                currentbyte += bytes_per_pixel;
-                currentpixel++;
-                pPtr += bytes_per_pixel;
-
-                if(currentpixel > pixelcount)   // Make sure we havent read too many pixels
-                {
-                    return false;
-                }
-            }
+            if(chunk * bytes_per_pixel > static_cast<size_t>(pEnd - pPtr)
+               || chunk > pixelcount - currentpixel)
+                return false;
+
+            SwapRedBlue(currentbyte, reinterpret_cast<uint8_t const *>(pPtr), chunk, bytes_per_pixel);
+            pPtr += chunk * bytes_per_pixel;
         }
+
+        currentbyte += chunk * bytes_per_pixel;
+        currentpixel += chunk;
     } while(currentpixel < pixelcount);
 
+    // the packets may cross the rows, flipped in place after decoding
     if(flip_vertical)
-    {
-        auto flipped_img = std::make_unique<uint8_t[]>(image_size);
-
-        for(uint32_t i = 0; i < id.height; i++)
-        {
-            std::memcpy(flipped_img.get() + i * id.width * bytes_per_pixel,
-                        img.get() + (id.height - 1 - i) * id.width * bytes_per_pixel,
-                        id.width * bytes_per_pixel);
-        }
-
-        img = std::move(flipped_img);
-    }
+        FlipRows(img.get(), row_size, id.height);
 
     if(flip_horizontal)
     {
-        auto flipped_img = std::make_unique<uint8_t[]>(image_size);
-
         for(uint32_t i = 0; i < id.height; i++)
-        {
-            for(uint32_t j = 0; j < id.width; j++)
-            {
-                flipped_img[id.width * bytes_per_pixel * i + j * bytes_per_pixel + 0] =
-                    img[id.width * bytes_per_pixel * i + (id.width - j - 1) * bytes_per_pixel + 0];
-                flipped_img[id.width * bytes_per_pixel * i + j * bytes_per_pixel + 1] =
-                    img[id.width * bytes_per_pixel * i + (id.width - j - 1) * bytes_per_pixel + 1];
-                flipped_img[id.width * bytes_per_pixel * i + j * bytes_per_pixel + 2] =
-                    img[id.width * bytes_per_pixel * i + (id.width - j - 1) * bytes_per_pixel + 2];
-                if(id.type == ImageData::PixelType::pt_rgba)
-                    flipped_img[id.width * bytes_per_pixel * i + j * bytes_per_pixel + 3] =
-                        img[id.width * bytes_per_pixel * i + (id.width - j - 1) * bytes_per_pixel + 3];
-            }
-        }
-
-        img = std::move(flipped_img);
+            ReversePixels(img.get() + i * row_size, id.width, bytes_per_pixel);
     }
 
     id.data = std::move(img);
     return true;
 }
+
+//==============================================================================
+//         Conversion section
+//==============================================================================
+void ConvertToRGBA(ImageData & id, uint8_t alpha)
+{
+    if(id.type != ImageData::PixelType::pt_rgb || !id.data)
+        return;
+
+    size_t const               num_pixels = size_t{id.width} * id.height;
+    std::unique_ptr<uint8_t[]> rgba(new uint8_t[num_pixels * 4]);   // not zeroed
+    ExpandToRGBA(rgba.get(), id.data.get(), num_pixels, alpha);
+
+    id.data = std::move(rgba);
+    id.type = ImageData::PixelType::pt_rgba;
+}
 }   // namespace evnt
@@ -28,5 +28,8 @@ bool ReadBMP(BaseFile const & file, ImageData & id);
 bool ReadTGA(BaseFile const & file, ImageData & id);
 
 OutFile WriteTGA(std::string fname, ImageData const & id);
+
+// pt_rgb -> pt_rgba, 4 byte pixels are uploaded without the row unpacking
+void ConvertToRGBA(ImageData & id, uint8_t alpha = 255);
 }   // namespace evnt
 #endif   // IMAGEDATA_H
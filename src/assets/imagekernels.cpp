@@ -0,0 +1,400 @@
+#include "imagekernels.h"
+#include <cassert>
+#include <cstring>
+#include <memory>
+
+#if(defined(__x86_64__) || defined(__i386__)) && defined(__GNUC__)
+#    define EV_IMAGE_KERNELS_X86
+#    define EV_TARGET_SSSE3 __attribute__((target("ssse3")))
+#    define EV_TARGET_AVX2  __attribute__((target("avx2")))
+#    include <immintrin.h>
+#endif
+
+namespace evnt
+{
+namespace
+{
+    using ConvertFunc = void (*)(uint8_t *, uint8_t const *, size_t);
+    using ExpandFunc  = void (*)(uint8_t *, uint8_t const *, size_t, uint8_t);
+
+    struct Kernels
+    {
+        char const * name;
+        ConvertFunc  swap_rb3;
+        ConvertFunc  swap_rb4;
+        ConvertFunc  reverse4;
+        ExpandFunc   expand;
+        ConvertFunc  fill3;   // src - one pixel
+        ConvertFunc  fill4;
+    };
+
+    uint32_t Load32(uint8_t const * p)
+    {
+        uint32_t v;
+        std::memcpy(&v, p, sizeof(v));
+        return v;
+    }
+
+    void Store32(uint8_t * p, uint32_t v)
+    {
+        std::memcpy(p, &v, sizeof(v));
+    }
+
+    //==============================================================================
+    //         Scalar, the tails of the SIMD versions
+    //==============================================================================
+    void SwapRB3Scalar(uint8_t * dst, uint8_t const * src, size_t n)
+    {
+        for(size_t i = 0; i < n; ++i)
+        {
+            dst[i * 3 + 0] = src[i * 3 + 2];
+            dst[i * 3 + 1] = src[i * 3 + 1];
+            dst[i * 3 + 2] = src[i * 3 + 0];
+        }
+    }
+
+    void SwapRB4Scalar(uint8_t * dst, uint8_t const * src, size_t n)
+    {
+        // little-endian, red and blue are the bytes 0 and 2
+        for(size_t i = 0; i < n; ++i)
+        {
+            uint32_t const p = Load32(src + i * 4);
+            Store32(dst + i * 4, (p & 0xff00ff00u) | ((p >> 16) & 0xffu) | ((p & 0xffu) << 16));
+        }
+    }
+
+    void Reverse4Scalar(uint8_t * dst, uint8_t const * src, size_t n)
+    {
+        for(size_t i = 0; i < n; ++i)
+        {
+            uint32_t const p = Load32(src + i * 4);
+            Store32(dst + i * 4, (p >> 24) | ((p >> 8) & 0xff00u) | ((p << 8) & 0xff0000u) | (p << 24));
+        }
+    }
+
+    void ExpandScalar(uint8_t * dst, uint8_t const * src, size_t n, uint8_t alpha)
+    {
+        for(size_t i = 0; i < n; ++i)
+        {
+            dst[i * 4 + 0] = src[i * 3 + 0];
+            dst[i * 4 + 1] = src[i * 3 + 1];
+            dst[i * 4 + 2] = src[i * 3 + 2];
+            dst[i * 4 + 3] = alpha;
+        }
+    }
+
+    void Fill3Scalar(uint8_t * dst, uint8_t const * pixel, size_t n)
+    {
+        for(size_t i = 0; i < n; ++i)
+            std::memcpy(dst + i * 3, pixel, 3);
+    }
+
+    void Fill4Scalar(uint8_t * dst, uint8_t const * pixel, size_t n)
+    {
+        uint32_t const p = Load32(pixel);
+        for(size_t i = 0; i < n; ++i)
+            Store32(dst + i * 4, p);
+    }
+
+#ifdef EV_IMAGE_KERNELS_X86
+    //==============================================================================
+    //         SSSE3, 24-bit pixels can't be shuffled with SSE2 alone
+    //==============================================================================
+    EV_TARGET_SSSE3 __m128i Load128(uint8_t const * p)
+    {
+        return _mm_loadu_si128(reinterpret_cast<__m128i const *>(p));
+    }
+
+    EV_TARGET_SSSE3 void Store128(uint8_t * p, __m128i v)
+    {
+        _mm_storeu_si128(reinterpret_cast<__m128i *>(p), v);
+    }
+
+    EV_TARGET_SSSE3 void SwapRB3Ssse3(uint8_t * dst, uint8_t const * src, size_t n)
+    {
+        // 5 pixels a step, the 16th byte is written again by the next step
+        __m128i const mask = _mm_setr_epi8(2, 1, 0, 5, 4, 3, 8, 7, 6, 11, 10, 9, 14, 13, 12, 15);
+
+        size_t i = 0;
+        for(; i + 6 <= n; i += 5)
+            Store128(dst + i * 3, _mm_shuffle_epi8(Load128(src + i * 3), mask));
+
+        SwapRB3Scalar(dst + i * 3, src + i * 3, n - i);
+    }
+
+    EV_TARGET_SSSE3 void SwapRB4Ssse3(uint8_t * dst, uint8_t const * src, size_t n)
+    {
+        __m128i const mask = _mm_setr_epi8(2, 1, 0, 3, 6, 5, 4, 7, 10, 9, 8, 11, 14, 13, 12, 15);
+
+        size_t i = 0;
+        for(; i + 4 <= n; i += 4)
+            Store128(dst + i * 4, _mm_shuffle_epi8(Load128(src + i * 4), mask));
+
+        SwapRB4Scalar(dst + i * 4, src + i * 4, n - i);
+    }
+
+    EV_TARGET_SSSE3 void Reverse4Ssse3(uint8_t * dst, uint8_t const * src, size_t n)
+    {
+        __m128i const mask = _mm_setr_epi8(3, 2, 1, 0, 7, 6, 5, 4, 11, 10, 9, 8, 15, 14, 13, 12);
+
+        size_t i = 0;
+        for(; i + 4 <= n; i += 4)
+            Store128(dst + i * 4, _mm_shuffle_epi8(Load128(src + i * 4), mask));
+
+        Reverse4Scalar(dst + i * 4, src + i * 4, n - i);
+    }
+
+    EV_TARGET_SSSE3 void ExpandSsse3(uint8_t * dst, uint8_t const * src, size_t n, uint8_t alpha)
+    {
+        __m128i const mask       = _mm_setr_epi8(0, 1, 2, -1, 3, 4, 5, -1, 6, 7, 8, -1, 9, 10, 11, -1);
+        __m128i const alpha_bits = _mm_set1_epi32(static_cast<int32_t>(uint32_t{alpha} << 24));
+
+        // 4 pixels a step, 16 bytes are read
+        size_t i = 0;
+        for(; i + 6 <= n; i += 4)
+            Store128(dst + i * 4, _mm_or_si128(_mm_shuffle_epi8(Load128(src + i * 3), mask), alpha_bits));
+
+        ExpandScalar(dst + i * 4, src + i * 3, n - i, alpha);
+    }
+
+    EV_TARGET_SSSE3 __m128i LoadPixel3(uint8_t const * pixel)
+    {
+        return _mm_cvtsi32_si128(pixel[0] | pixel[1] << 8 | pixel[2] << 16);
+    }
+
+    EV_TARGET_SSSE3 void Fill3Ssse3(uint8_t * dst, uint8_t const * pixel, size_t n)
+    {
+        // 16 pixels a step, the byte k of the 48 bytes is the byte k % 3 of the pixel
+        __m128i const m0 = _mm_setr_epi8(0, 1, 2, 0, 1, 2, 0, 1, 2, 0, 1, 2, 0, 1, 2, 0);
+        __m128i const m1 = _mm_setr_epi8(1, 2, 0, 1, 2, 0, 1, 2, 0, 1, 2, 0, 1, 2, 0, 1);
+        __m128i const m2 = _mm_setr_epi8(2, 0, 1, 2, 0, 1, 2, 0, 1, 2, 0, 1, 2, 0, 1, 2);
+        __m128i const p  = LoadPixel3(pixel);
+        __m128i const p0 = _mm_shuffle_epi8(p, m0);
+        __m128i const p1 = _mm_shuffle_epi8(p, m1);
+        __m128i const p2 = _mm_shuffle_epi8(p, m2);
+
+        size_t i = 0;
+        for(; i + 16 <= n; i += 16)
+        {
+            Store128(dst + i * 3, p0);
+            Store128(dst + i * 3 + 16, p1);
+            Store128(dst + i * 3 + 32, p2);
+        }
+
+        Fill3Scalar(dst + i * 3, pixel, n - i);
+    }
+
+    EV_TARGET_SSSE3 void Fill4Ssse3(uint8_t * dst, uint8_t const * pixel, size_t n)
+    {
+        __m128i const p = _mm_set1_epi32(static_cast<int32_t>(Load32(pixel)));
+
+        size_t i = 0;
+        for(; i + 4 <= n; i += 4)
+            Store128(dst + i * 4, p);
+
+        Fill4Scalar(dst + i * 4, pixel, n - i);
+    }
+
+    //==============================================================================
+    //         AVX2
+    //==============================================================================
+    // the SSE tails are called after vzeroupper, the AVX-SSE transitions cost hundreds of cycles
+    EV_TARGET_AVX2 __m256i Load256(uint8_t const * p)
+    {
+        return _mm256_loadu_si256(reinterpret_cast<__m256i const *>(p));
+    }
+
+    EV_TARGET_AVX2 void Store256(uint8_t * p, __m256i v)
+    {
+        _mm256_storeu_si256(reinterpret_cast<__m256i *>(p), v);
+    }
+
+    // The shuffles don't cross the 128-bit lanes: 8 pixels of 24 bytes are split to the lanes by 12 bytes,
+    // shuffled and joined back.
+    EV_TARGET_AVX2 __m256i Split24(__m256i v)
+    {
+        return _mm256_permutevar8x32_epi32(v, _mm256_setr_epi32(0, 1, 2, 3, 3, 4, 5, 6));
+    }
+
+    EV_TARGET_AVX2 void SwapRB3Avx2(uint8_t * dst, uint8_t const * src, size_t n)
+    {
+        __m256i const mask = _mm256_setr_epi8(2, 1, 0, 5, 4, 3, 8, 7, 6, 11, 10, 9, 12, 13, 14, 15,   //
+                                              2, 1, 0, 5, 4, 3, 8, 7, 6, 11, 10, 9, 12, 13, 14, 15);
+        __m256i const join = _mm256_setr_epi32(0, 1, 2, 4, 5, 6, 7, 7);
+
+        // 8 pixels a step, 32 bytes are read and written, the last 8 are written again by the next step
+        size_t i = 0;
+        for(; i + 11 <= n; i += 8)
+        {
+            __m256i const v = _mm256_shuffle_epi8(Split24(Load256(src + i * 3)), mask);
+            Store256(dst + i * 3, _mm256_permutevar8x32_epi32(v, join));
+        }
+
+        _mm256_zeroupper();
+        SwapRB3Ssse3(dst + i * 3, src + i * 3, n - i);
+    }
+
+    EV_TARGET_AVX2 void SwapRB4Avx2(uint8_t * dst, uint8_t const * src, size_t n)
+    {
+        __m256i const mask = _mm256_setr_epi8(2, 1, 0, 3, 6, 5, 4, 7, 10, 9, 8, 11, 14, 13, 12, 15,   //
+                                              2, 1, 0, 3, 6, 5, 4, 7, 10, 9, 8, 11, 14, 13, 12, 15);
+
+        size_t i = 0;
+        for(; i + 8 <= n; i += 8)
+            Store256(dst + i * 4, _mm256_shuffle_epi8(Load256(src + i * 4), mask));
+
+        _mm256_zeroupper();
+        SwapRB4Ssse3(dst + i * 4, src + i * 4, n - i);
+    }
+
+    EV_TARGET_AVX2 void Reverse4Avx2(uint8_t * dst, uint8_t const * src, size_t n)
+    {
+        __m256i const mask = _mm256_setr_epi8(3, 2, 1, 0, 7, 6, 5, 4, 11, 10, 9, 8, 15, 14, 13, 12,   //
+                                              3, 2, 1, 0, 7, 6, 5, 4, 11, 10, 9, 8, 15, 14, 13, 12);
+
+        size_t i = 0;
+        for(; i + 8 <= n; i += 8)
+            Store256(dst + i * 4, _mm256_shuffle_epi8(Load256(src + i * 4), mask));
+
+        _mm256_zeroupper();
+        Reverse4Ssse3(dst + i * 4, src + i * 4, n - i);
+    }
+
+    EV_TARGET_AVX2 void ExpandAvx2(uint8_t * dst, uint8_t const * src, size_t n, uint8_t alpha)
+    {
+        __m256i const mask       = _mm256_setr_epi8(0, 1, 2, -1, 3, 4, 5, -1, 6, 7, 8, -1, 9, 10, 11, -1,   //
+                                                    0, 1, 2, -1, 3, 4, 5, -1, 6, 7, 8, -1, 9, 10, 11, -1);
+        __m256i const alpha_bits = _mm256_set1_epi32(static_cast<int32_t>(uint32_t{alpha} << 24));
+
+        // 8 pixels a step, 32 bytes are read
+        size_t i = 0;
+        for(; i + 11 <= n; i += 8)
+        {
+            __m256i const v = _mm256_shuffle_epi8(Split24(Load256(src + i * 3)), mask);
+            Store256(dst + i * 4, _mm256_or_si256(v, alpha_bits));
+        }
+
+        _mm256_zeroupper();
+        ExpandSsse3(dst + i * 4, src + i * 3, n - i, alpha);
+    }
+
+    EV_TARGET_AVX2 void Fill3Avx2(uint8_t * dst, uint8_t const * pixel, size_t n)
+    {
+        // 32 pixels a step, see Fill3Ssse3
+        __m128i const m0 = _mm_setr_epi8(0, 1, 2, 0, 1, 2, 0, 1, 2, 0, 1, 2, 0, 1, 2, 0);
+        __m128i const m1 = _mm_setr_epi8(1, 2, 0, 1, 2, 0, 1, 2, 0, 1, 2, 0, 1, 2, 0, 1);
+        __m128i const m2 = _mm_setr_epi8(2, 0, 1, 2, 0, 1, 2, 0, 1, 2, 0, 1, 2, 0, 1, 2);
+        __m256i const p  = _mm256_set1_epi32(pixel[0] | pixel[1] << 8 | pixel[2] << 16);
+        __m256i const p0 = _mm256_shuffle_epi8(p, _mm256_setr_m128i(m0, m1));
+        __m256i const p1 = _mm256_shuffle_epi8(p, _mm256_setr_m128i(m2, m0));
+        __m256i const p2 = _mm256_shuffle_epi8(p, _mm256_setr_m128i(m1, m2));
+
+        size_t i = 0;
+        for(; i + 32 <= n; i += 32)
+        {
+            Store256(dst + i * 3, p0);
+            Store256(dst + i * 3 + 32, p1);
+            Store256(dst + i * 3 + 64, p2);
+        }
+
+        _mm256_zeroupper();
+        Fill3Ssse3(dst + i * 3, pixel, n - i);
+    }
+
+    EV_TARGET_AVX2 void Fill4Avx2(uint8_t * dst, uint8_t const * pixel, size_t n)
+    {
+        __m256i const p = _mm256_set1_epi32(static_cast<int32_t>(Load32(pixel)));
+
+        size_t i = 0;
+        for(; i + 8 <= n; i += 8)
+            Store256(dst + i * 4, p);
+
+        _mm256_zeroupper();
+        Fill4Ssse3(dst + i * 4, pixel, n - i);
+    }
+#endif   // EV_IMAGE_KERNELS_X86
+
+    Kernels SelectKernels()
+    {
+#ifdef EV_IMAGE_KERNELS_X86
+        __builtin_cpu_init();
+        // checks the OS support of the AVX state too
+        if(__builtin_cpu_supports("avx2"))
+            return {"avx2", SwapRB3Avx2, SwapRB4Avx2, Reverse4Avx2, ExpandAvx2, Fill3Avx2, Fill4Avx2};
+        if(__builtin_cpu_supports("ssse3"))
+            return {"ssse3", SwapRB3Ssse3, SwapRB4Ssse3, Reverse4Ssse3, ExpandSsse3, Fill3Ssse3, Fill4Ssse3};
+#endif
+        return {"scalar",     SwapRB3Scalar, SwapRB4Scalar, Reverse4Scalar,
+                ExpandScalar, Fill3Scalar,   Fill4Scalar};
+    }
+
+    Kernels const & GetKernels()
+    {
+        static Kernels const kernels = SelectKernels();
+        return kernels;
+    }
+}   // namespace
+
+void SwapRedBlue(uint8_t * dst, uint8_t const * src, size_t num_pixels, uint32_t bytes_per_pixel)
+{
+    assert(bytes_per_pixel == 3 || bytes_per_pixel == 4);
+
+    if(bytes_per_pixel == 3)
+        GetKernels().swap_rb3(dst, src, num_pixels);
+    else
+        GetKernels().swap_rb4(dst, src, num_pixels);
+}
+
+void ReverseChannels(uint8_t * dst, uint8_t const * src, size_t num_pixels)
+{
+    GetKernels().reverse4(dst, src, num_pixels);
+}
+
+void ExpandToRGBA(uint8_t * dst, uint8_t const * src, size_t num_pixels, uint8_t alpha)
+{
+    GetKernels().expand(dst, src, num_pixels, alpha);
+}
+
+void FillPixels(uint8_t * dst, uint8_t const * pixel, size_t num_pixels, uint32_t bytes_per_pixel)
+{
+    assert(bytes_per_pixel == 3 || bytes_per_pixel == 4);
+
+    if(bytes_per_pixel == 3)
+        GetKernels().fill3(dst, pixel, num_pixels);
+    else
+        GetKernels().fill4(dst, pixel, num_pixels);
+}
+
+void FlipRows(uint8_t * data, size_t row_size, size_t num_rows)
+{
+    if(num_rows < 2)
+        return;
+
+    auto tmp = std::make_unique<uint8_t[]>(row_size);
+    for(size_t i = 0, j = num_rows - 1; i < j; ++i, --j)
+    {
+        std::memcpy(tmp.get(), data + i * row_size, row_size);
+        std::memcpy(data + i * row_size, data + j * row_size, row_size);
+        std::memcpy(data + j * row_size, tmp.get(), row_size);
+    }
+}
+
+void ReversePixels(uint8_t * row, size_t num_pixels, uint32_t bytes_per_pixel)
+{
+    if(num_pixels < 2)
+        return;
+
+    uint8_t tmp[4];
+    for(size_t i = 0, j = num_pixels - 1; i < j; ++i, --j)
+    {
+        std::memcpy(tmp, row + i * bytes_per_pixel, bytes_per_pixel);
+        std::memcpy(row + i * bytes_per_pixel, row + j * bytes_per_pixel, bytes_per_pixel);
+        std::memcpy(row + j * bytes_per_pixel, tmp, bytes_per_pixel);
+    }
+}
+
+char const * GetImageKernelsName()
+{
+    return GetKernels().name;
+}
+}   // namespace evnt
@@ -0,0 +1,24 @@
+#ifndef IMAGEKERNELS_H
+#define IMAGEKERNELS_H
+
+#include <cstddef>
+#include <cstdint>
+
+namespace evnt
+{
+// Pixel conversion kernels of the image readers and writers. The AVX2 or SSSE3 version is chosen by the CPU
+// at the first call, the scalar one on other CPUs. A kernel reads and writes only num_pixels pixels, dst and
+// src don't overlap.
+void SwapRedBlue(uint8_t * dst, uint8_t const * src, size_t num_pixels,
+                 uint32_t bytes_per_pixel);                                     // BGR(A) <-> RGB(A)
+void ReverseChannels(uint8_t * dst, uint8_t const * src, size_t num_pixels);   // ABGR -> RGBA
+void ExpandToRGBA(uint8_t * dst, uint8_t const * src, size_t num_pixels, uint8_t alpha);   // RGB -> RGBA
+void FillPixels(uint8_t * dst, uint8_t const * pixel, size_t num_pixels, uint32_t bytes_per_pixel);
+
+// in place, memory bound, libc memcpy is used
+void FlipRows(uint8_t * data, size_t row_size, size_t num_rows);
+void ReversePixels(uint8_t * row, size_t num_pixels, uint32_t bytes_per_pixel);
+
+char const * GetImageKernelsName();   // "avx2", "ssse3" or "scalar"
+}   // namespace evnt
+#endif   // IMAGEKERNELS_H
@@ -1,7 +1,12 @@
 #include "resource.h"
 #include <algorithm>
+#include <chrono>
+#include <vector>
 
-#include "../core/core.h"
+#include "../core/threadpool.h"
+#include "../fs/file_system.h"
+#include "../fs/path_index.h"
+#include "../render/render.h"
 
 namespace evnt
 {
@@ -56,10 +61,25 @@ Resource::ResourceType Resource::GetResourceTypeFromString(std::string const & t
 
 Resource::Resource(Resource::ResourceType type, std::string name) :
     m_type{type}, m_name{std::move(name)}, m_state{State::state_path}
-{}
+{
+    touch();
+}
+
+void Resource::touch()
+{
+    auto const    now = std::chrono::steady_clock::now().time_since_epoch();
+    int64_t const ms  = std::chrono::duration_cast<std::chrono::milliseconds>(now).count();
+
+    // the lookups of a popular resource don't write the shared cache line every time
+    if(m_last_use.load(std::memory_order_relaxed) != ms)
+        m_last_use.store(ms, std::memory_order_relaxed);
+}
 
 ResourceManager::~ResourceManager()
 {
+    // the pool tasks hold this, the Core may be shut down already
+    finishRequests();
+
     for(auto & [type, reg] : m_registry)
     {
         if(reg.res_release_function)
@@ -127,17 +147,26 @@ Resource::ResourceSharedPtr ResourceManager::getResource(Resource::ResourceType
     // if existed
     auto res_shared = getExisted(type, name);
     if(res_shared)
+    {
+        // requested or created and not loaded yet
+        if(res_shared->getState() == Resource::State::state_path)
+            loadRequested(res_shared);
+
         return res_shared;
+    }
 
     // load resource
     auto reg = getTypeRegEntry(type);
     if(isFileExisted(name))
     {
         res_shared = reg.res_read_function(name);
+        countLoad(*res_shared);
 
-        std::lock_guard lock(m_resources_guard);
-        m_resources[type].push_back(res_shared);
-        return res_shared;
+        auto added = addResource(res_shared);
+        if(added == res_shared && res_shared->getState() == Resource::State::state_mem)
+            finalizeResource(res_shared);
+
+        return added;
     }
 
     // if file not existed log and return default
@@ -150,35 +179,539 @@ Resource::ResourceSharedPtr ResourceManager::getResource(Resource::ResourceType
 
 void ResourceManager::releaseUnused()
 {
-    std::lock_guard lock(m_resources_guard);
-    for(auto & [type, list] : m_resources)
+    for(auto & shard : m_shards)
+    {
+        std::lock_guard lock(shard.added_guard);
+
+        // the shard is copied only if there is something to add or remove
+        auto       snapshot = shard.table.read();
+        bool const expired  = std::any_of(snapshot->begin(), snapshot->end(),
+                                          [](auto const & entry) { return entry.second.res.expired(); });
+        if(expired || !shard.added.empty())
+            Publish(shard, true);
+    }
+
+    enforceBudgets();
+}
+
+Resource::ResourceSharedPtr ResourceManager::requestResource(Resource::ResourceType type,
+                                                             std::string const & name, int32_t priority)
+{
+    auto const & reg = m_registry.at(type);
+    if(!reg.res_create_function)
+        return getResource(type, name);   // the type is loaded synchronously only
+
+    bool created    = false;
+    auto res_shared = getExisted(type, name);
+    if(!res_shared)
     {
-        for(auto it = list.begin(); it != list.end();)
+        if(!isFileExisted(name))
         {
-            if((*it).expired())
+            // if file not existed log and return default
+            std::stringstream ss;
+            ss << "Warning. Resource: \"" << name << "\" "
+               << "not existed!" << std::endl;
+            Log::Log(Log::warning, ss.str());
+            return reg.res_get_default_function();
+        }
+
+        auto new_res = reg.res_create_function(name);
+        res_shared   = addResource(new_res);   // may be added by another thread meanwhile
+        created      = res_shared == new_res;
+    }
+
+    std::lock_guard lock(m_requests_guard);
+    if(created)
+    {
+        enqueueRequest(res_shared, priority);
+    }
+    else if(res_shared->getState() == Resource::State::state_path && m_loading.count(res_shared.get()) == 0)
+    {
+        // requested again, the priority is raised only
+        auto it = m_request_keys.find(res_shared.get());
+        if(it == m_request_keys.end() || priority > it->second.priority)
+            enqueueRequest(res_shared, priority);
+    }
+
+    return res_shared;
+}
+
+bool ResourceManager::setPriority(Resource::ResourceSharedPtr const & res, int32_t priority)
+{
+    std::lock_guard lock(m_requests_guard);
+    if(m_request_keys.count(res.get()) == 0)
+        return false;
+
+    enqueueRequest(res, priority);
+    return true;
+}
+
+bool ResourceManager::cancelRequest(Resource::ResourceSharedPtr const & res)
+{
+    std::lock_guard lock(m_requests_guard);
+    auto            it = m_request_keys.find(res.get());
+    if(it == m_request_keys.end())
+        return false;
+
+    // the submitted task finds the next request or nothing
+    m_requests.erase(it->second);
+    m_request_keys.erase(it);
+    return true;
+}
+
+size_t ResourceManager::getNumRequests() const
+{
+    std::lock_guard lock(m_requests_guard);
+    return m_requests.size() + m_loading.size();
+}
+
+void ResourceManager::setRender(Render * render)
+{
+    std::lock_guard lock(m_requests_guard);
+    mp_render = render;
+}
+
+void ResourceManager::setThreadPool(ThreadPool * pool)
+{
+    std::lock_guard lock(m_requests_guard);
+    mp_thread_pool = pool;
+}
+
+void ResourceManager::finishRequests()
+{
+    std::unique_lock lock(m_requests_guard);
+    m_requests.clear();
+    m_request_keys.clear();
+
+    // the pool runs the tasks, the other queued tasks aren't run here
+    m_tasks_done.wait(lock, [this] { return m_num_tasks == 0; });
+}
+
+void ResourceManager::enqueueRequest(Resource::ResourceSharedPtr res, int32_t priority)
+{
+    auto it = m_request_keys.find(res.get());
+    if(it != m_request_keys.end())
+    {
+        // the position is changed, the task is already submitted
+        auto node  = m_requests.extract(it->second);
+        it->second = {priority, m_next_seq++};
+
+        node.key() = it->second;
+        m_requests.insert(std::move(node));
+        return;
+    }
+
+    RequestKey const key{priority, m_next_seq++};
+    m_request_keys.emplace(res.get(), key);
+    m_requests.emplace(key, std::move(res));
+
+    // every task loads the request of the highest priority at the moment it starts
+    ++m_num_tasks;
+    assert(mp_thread_pool != nullptr);
+    mp_thread_pool->submit([this] { loadNextRequest(); });
+}
+
+void ResourceManager::loadNextRequest()
+{
+    Resource::ResourceSharedPtr res;
+    {
+        std::lock_guard lock(m_requests_guard);
+        while(!res && !m_requests.empty())
+        {
+            auto node = m_requests.extract(m_requests.begin());
+            m_request_keys.erase(node.mapped().get());
+
+            // the handle is dropped by the requester
+            if(node.mapped().use_count() > 1)
+                res = std::move(node.mapped());
+        }
+
+        if(res)
+            m_loading.insert(res.get());
+    }
+
+    if(res)
+        loadResource(res);
+
+    std::lock_guard lock(m_requests_guard);
+    if(--m_num_tasks == 0)
+        m_tasks_done.notify_all();
+}
+
+void ResourceManager::loadRequested(Resource::ResourceSharedPtr const & res)
+{
+    {
+        std::unique_lock lock(m_requests_guard);
+
+        auto it = m_request_keys.find(res.get());
+        if(it != m_request_keys.end())
+        {
+            m_requests.erase(it->second);
+            m_request_keys.erase(it);
+        }
+
+        // loading in the pool, a resource is in m_loading only while its task runs
+        if(m_loading.count(res.get()) != 0)
+        {
+            m_loaded.wait(lock, [this, &res] { return m_loading.count(res.get()) == 0; });
+            return;
+        }
+
+        if(res->getState() != Resource::State::state_path)
+            return;
+
+        m_loading.insert(res.get());
+    }
+
+    loadResource(res);
+}
+
+void ResourceManager::loadResource(Resource::ResourceSharedPtr const & res)
+{
+    bool loaded = false;
+    try
+    {
+        loaded = res->load();
+    }
+    catch(std::exception const & e)
+    {
+        Log::Log(Log::error,
+                 Log::cstr_log("Resource: \"%s\" - loading failed: %s", res->getName().c_str(), e.what()));
+        res->m_state = Resource::State::state_invalid;
+    }
+
+    if(loaded)
+    {
+        countLoad(*res);
+        finalizeResource(res);
+    }
+
+    std::lock_guard lock(m_requests_guard);
+    m_loading.erase(res.get());
+    m_loaded.notify_all();
+}
+
+void ResourceManager::finalizeResource(Resource::ResourceSharedPtr const & res)
+{
+    auto const & reg = m_registry.at(res->getType());
+    if(!reg.res_finalize_function)
+        return;
+
+    Render * render = nullptr;
+    {
+        std::lock_guard lock(m_requests_guard);
+        render = mp_render;
+    }
+
+    // released meanwhile, the next load finalizes it again
+    auto finalize = [func = reg.res_finalize_function, res, render] {
+        if(res->getState() == Resource::State::state_mem)
+            func(*res, render);
+    };
+
+    if(render)
+        render->addUpdateCommand(std::move(finalize));
+    else
+        finalize();
+}
+
+void ResourceManager::reloadFiles(std::vector<std::string> const & names)
+{
+    for(auto const & name : names)
+    {
+        for(auto const & [type, reg] : m_registry)
+        {
+            // not loaded resources are read from the new file when used
+            auto res = findExisted(type, name);
+            if(!res || !reg.res_create_function || res->getState() != Resource::State::state_mem)
+                continue;
+
+            if(!isFileExisted(name))
             {
-                it = list.erase(it);
+                Log::Log(Log::warning,
+                         Log::cstr_log("Resource: \"%s\" - the file is removed, the loaded data is kept",
+                                       name.c_str()));
+                continue;
+            }
+
+            ThreadPool * pool = nullptr;
+            {
+                std::lock_guard lock(m_requests_guard);
+                ++m_num_tasks;
+                pool = mp_thread_pool;
+            }
+            assert(pool != nullptr);
+            pool->submit([this, res] { reloadResource(res); });
+        }
+    }
+}
+
+void ResourceManager::reloadResource(Resource::ResourceSharedPtr const & res)
+{
+    auto const & reg   = m_registry.at(res->getType());
+    auto         fresh = reg.res_create_function(res->getName());
+
+    bool loaded = false;
+    try
+    {
+        loaded = fresh->load();
+    }
+    catch(std::exception const & e)
+    {
+        Log::Log(Log::error, Log::cstr_log("Resource: \"%s\" - reloading failed: %s",
+                                           res->getName().c_str(), e.what()));
+    }
+
+    if(loaded)
+    {
+        countLoad(*fresh);
+
+        // the users read the data in the render thread, the old data is freed with fresh
+        Render * render = nullptr;
+        {
+            std::lock_guard lock(m_requests_guard);
+            render = mp_render;
+        }
+
+        auto swap = [res, fresh, finalize = reg.res_finalize_function, render] {
+            if(res->getState() == Resource::State::state_mem && res->swapData(*fresh) && finalize)
+                finalize(*res, render);
+        };
+
+        if(render)
+            render->addUpdateCommand(std::move(swap));
+        else
+            swap();
+    }
+    else
+    {
+        Log::Log(Log::warning, Log::cstr_log("Resource: \"%s\" - not reloaded, the old data is kept",
+                                             res->getName().c_str()));
+    }
+
+    std::lock_guard lock(m_requests_guard);
+    if(--m_num_tasks == 0)
+        m_tasks_done.notify_all();
+}
+
+void ResourceManager::setBudget(Resource::ResourceType type, uint64_t bytes)
+{
+    std::lock_guard lock(m_requests_guard);
+    m_residency[type].budget = bytes;
+}
+
+ResourceManager::ResidencyStats ResourceManager::getResidencyStats(Resource::ResourceType type) const
+{
+    ResidencyStats stats;
+    for(auto & shard : m_shards)
+    {
+        std::lock_guard lock(shard.added_guard);
+
+        auto snapshot = shard.table.read();
+        for(auto const * table : {snapshot.get(), &shard.added})
+        {
+            for(auto const & [hash, entry] : *table)
+            {
+                auto res = entry.type == type ? entry.res.lock() : nullptr;
+                if(!res)
+                    continue;
+
+                ++stats.num_total;
+                if(res->getState() == Resource::State::state_mem)
+                {
+                    ++stats.num_loaded;
+                    stats.cpu_size += res->getCpuSize();
+                    stats.gpu_size += res->getGpuSize();
+                }
+            }
+        }
+    }
+
+    std::lock_guard lock(m_requests_guard);
+    auto            it = m_residency.find(type);
+    if(it != m_residency.end())
+    {
+        stats.budget       = it->second.budget;
+        stats.num_loads    = it->second.num_loads;
+        stats.num_releases = it->second.num_releases;
+    }
+
+    return stats;
+}
+
+void ResourceManager::countLoad(Resource const & res)
+{
+    if(res.getState() != Resource::State::state_mem)
+        return;
+
+    std::lock_guard lock(m_requests_guard);
+    ++m_residency[res.getType()].num_loads;
+}
+
+void ResourceManager::enforceBudgets()
+{
+    std::unordered_map<Resource::ResourceType, uint64_t> budgets;
+    Render *                                             render = nullptr;
+    {
+        std::lock_guard lock(m_requests_guard);
+        for(auto const & [type, residency] : m_residency)
+        {
+            if(residency.budget > 0)
+                budgets[type] = residency.budget;
+        }
+        render = mp_render;
+    }
+
+    if(budgets.empty())
+        return;
+
+    struct Candidate
+    {
+        Resource::ResourceSharedPtr res;
+        int64_t                     last_use;
+        uint64_t                    size;
+    };
+
+    // called after the shards were published by releaseUnused()
+    std::unordered_map<Resource::ResourceType, std::vector<Candidate>> candidates;
+    for(auto const & shard : m_shards)
+    {
+        auto snapshot = shard.table.read();
+        for(auto const & [hash, entry] : *snapshot)
+        {
+            auto res = budgets.count(entry.type) != 0 ? entry.res.lock() : nullptr;
+            if(!res || res->getState() != Resource::State::state_mem)
+                continue;
+
+            uint64_t const size = res->getCpuSize() + res->getGpuSize();
+            candidates[entry.type].push_back({res, res->getLastUse(), size});
+        }
+    }
+
+    for(auto & [type, list] : candidates)
+    {
+        uint64_t const budget = budgets[type];
+        uint64_t       size   = 0;
+        for(auto const & c : list)
+            size += c.size;
+
+        if(size <= budget)
+            continue;
+
+        // the least recently used first
+        std::sort(list.begin(), list.end(),
+                  [](Candidate const & l, Candidate const & r) { return l.last_use < r.last_use; });
+
+        for(auto & c : list)
+        {
+            if(size <= budget)
+                break;
+
+            size -= c.size;
+            if(render)
+            {
+                render->addUpdateCommand([this, res = std::move(c.res), last_use = c.last_use] {
+                    releaseOverBudget(res, last_use);
+                });
             }
             else
             {
-                ++it;
+                releaseOverBudget(c.res, c.last_use);
             }
         }
     }
 }
 
-Resource::ResourceSharedPtr ResourceManager::getExisted(Resource::ResourceType type, std::string const & name)
+void ResourceManager::releaseOverBudget(Resource::ResourceSharedPtr const & res, int64_t last_use)
 {
-    std::lock_guard lock(m_resources_guard);
-    auto &          res_list = m_resources[type];
+    // used after it was chosen
+    if(res->getLastUse() != last_use || res->getState() != Resource::State::state_mem)
+        return;
 
-    // if resource already exists
-    for(auto & res : res_list)
     {
-        if(!res.expired())
+        std::lock_guard lock(m_requests_guard);
+        ++m_residency[res->getType()].num_releases;
+    }
+
+    res->release();
+}
+
+uint64_t ResourceManager::GetNameHash(Resource::ResourceType type, std::string const & name)
+{
+    uint64_t const type_hash = (static_cast<uint64_t>(type) + 1) * 0x9e3779b97f4a7c15ull;
+    return PathIndex::Hash(name) ^ type_hash;
+}
+
+Resource::ResourceSharedPtr ResourceManager::getExisted(Resource::ResourceType type,
+                                                        std::string const &    name) const
+{
+    auto res_shared = findExisted(type, name);
+    if(res_shared)
+        res_shared->touch();
+
+    return res_shared;
+}
+
+Resource::ResourceSharedPtr ResourceManager::findExisted(Resource::ResourceType type,
+                                                         std::string const &    name) const
+{
+    uint64_t const hash  = GetNameHash(type, name);
+    auto const &   shard = m_shards[(hash >> 32) % num_shards];
+
+    auto res_shared = FindEntry(*shard.table.read(), hash, type, name);
+    if(res_shared)
+        return res_shared;
+
+    // not published yet, the table is read again as it may have been published meanwhile
+    std::lock_guard lock(shard.added_guard);
+    res_shared = FindEntry(shard.added, hash, type, name);
+    return res_shared ? res_shared : FindEntry(*shard.table.read(), hash, type, name);
+}
+
+Resource::ResourceSharedPtr ResourceManager::addResource(Resource::ResourceSharedPtr res)
+{
+    Resource::ResourceType const type  = res->getType();
+    std::string const &          name  = res->getName();
+    uint64_t const               hash  = GetNameHash(type, name);
+    auto &                       shard = m_shards[(hash >> 32) % num_shards];
+
+    std::lock_guard lock(shard.added_guard);
+
+    auto snapshot = shard.table.read();
+    auto existed  = FindEntry(*snapshot, hash, type, name);
+    if(!existed)
+        existed = FindEntry(shard.added, hash, type, name);
+    if(existed)
+        return existed;
+
+    // an expired entry of the table is replaced when published
+    auto & interned    = *shard.names.insert(name).first;
+    auto [first, last] = shard.added.equal_range(hash);
+    auto it            = std::find_if(first, last, [&](auto const & entry) {
+        return entry.second.type == type && entry.second.name == &interned;
+    });
+    if(it != last)
+        it->second.res = res;
+    else
+        shard.added.emplace(hash, TableEntry{type, &interned, res});
+
+    if(shard.added.size() >= std::max(publish_batch, snapshot->size() / 4))
+        Publish(shard, false);
+
+    return res;
+}
+
+Resource::ResourceSharedPtr ResourceManager::FindEntry(ShardTable const & table, uint64_t hash,
+                                                       Resource::ResourceType type, std::string const & name)
+{
+    auto [first, last] = table.equal_range(hash);
+    for(auto it = first; it != last; ++it)
+    {
+        if(it->second.type == type && *it->second.name == name)
         {
-            auto res_shrd = res.lock();
-            if(res_shrd->m_name == name)
+            // expired entries are removed by releaseUnused()
+            auto res_shrd = it->second.res.lock();
+            if(res_shrd)
                 return res_shrd;
         }
     }
@@ -186,10 +719,41 @@ Resource::ResourceSharedPtr ResourceManager::getExisted(Resource::ResourceType t
     return {};
 }
 
+void ResourceManager::Publish(Shard & shard, bool remove_expired)
+{
+    shard.table.update([&](ShardTable & table) {
+        if(remove_expired)
+        {
+            for(auto it = table.begin(); it != table.end();)
+            {
+                if(it->second.res.expired())
+                    it = table.erase(it);
+                else
+                    ++it;
+            }
+        }
+
+        for(auto & [hash, added] : shard.added)
+        {
+            // the interned name pointers are equal for equal names
+            auto [first, last] = table.equal_range(hash);
+            auto it            = std::find_if(first, last, [&](auto const & entry) {
+                return entry.second.type == added.type && entry.second.name == added.name;
+            });
+            if(it != last)
+                it->second.res = std::move(added.res);   // the slot of a released resource is reused
+            else
+                table.emplace(hash, std::move(added));
+        }
+    });
+
+    shard.added.clear();
+}
+
 bool ResourceManager::isFileExisted(std::string const & name) const
 {
-    auto fs = Core::instance().getFileSystem();
-    return fs.isExist(name);
+    assert(mp_file_system != nullptr);
+    return mp_file_system->isExist(name);
 }
 
 }   // namespace evnt
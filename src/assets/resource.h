@@ -1,18 +1,28 @@
 #ifndef RESOURCE_H
 #define RESOURCE_H
 
+#include <array>
+#include <atomic>
+#include <condition_variable>
 #include <functional>
-#include <list>
+#include <map>
 #include <memory>
 #include <mutex>
 #include <string>
 #include <sstream>
 #include <unordered_map>
+#include <unordered_set>
+#include <vector>
 
+#include "../core/rcuptr.h"
 #include "../log/log.h"
 
 namespace evnt
 {
+class FileSystem;
+class Render;
+class ThreadPool;
+
 class Resource
 {
 public:
@@ -47,8 +57,20 @@ public:
     std::string  getName() const { return m_name; }
     State        getState() const { return m_state; }
 
+    // memory held by the loaded resource in bytes, set by the resource when loaded and released
+    size_t getCpuSize() const { return m_cpu_size.load(std::memory_order_relaxed); }
+    size_t getGpuSize() const { return m_gpu_size.load(std::memory_order_relaxed); }
+
+    // The lookups in ResourceManager mark the resource as used, users holding the handle call touch() when
+    // the resource is used. The least recently used resources are released first if over the budget.
+    void    touch();
+    int64_t getLastUse() const { return m_last_use.load(std::memory_order_relaxed); }   // ms, steady clock
+
     virtual bool load() { return true; }
     virtual void release() {}
+    // Exchanges the loaded data with other, a freshly loaded resource of the same type and name, for the hot
+    // reload. false if not supported.
+    virtual bool swapData(Resource & other) { return false; }
 
     static std::string  GetStringFromResourceType(ResourceType type);
     static ResourceType GetResourceTypeFromString(std::string const & type_name);
@@ -56,9 +78,13 @@ public:
     static ResourceType GetTypeID() { return ResourceType::Undefined; }
 
 protected:
-    ResourceType m_type = {ResourceType::Undefined};
-    std::string  m_name;
-    State        m_state;
+    ResourceType       m_type = {ResourceType::Undefined};
+    std::string        m_name;
+    std::atomic<State> m_state;   // set last by load(), the data is valid for the thread that sees state_mem
+
+    std::atomic<size_t>  m_cpu_size{0};
+    std::atomic<size_t>  m_gpu_size{0};
+    std::atomic<int64_t> m_last_use{0};
 
     friend class ResourceManager;
 };
@@ -71,6 +97,8 @@ public:
     using ResWriteFunc      = std::function<bool(Resource const &)>;
     using ResInitFunc       = std::function<void()>;
     using ResReleaseFunc    = std::function<void()>;
+    using ResCreateFunc     = std::function<Resource::ResourceSharedPtr(std::string const &)>;
+    using ResFinalizeFunc   = std::function<void(Resource &, Render *)>;
 
     struct ResourceRegEntry
     {
@@ -80,6 +108,10 @@ public:
         ResWriteFunc      res_write_function;
         ResInitFunc       res_init_function;
         ResReleaseFunc    res_release_function;
+        ResCreateFunc     res_create_function;     // not loaded instance, required by requestResource
+        // Main thread part of the loading (GPU upload), optional. Called in the render thread after the
+        // resource is loaded or reloaded, in the loading thread with a null render if there is none.
+        ResFinalizeFunc res_finalize_function;
     };
 
     ResourceManager() = default;
@@ -99,14 +131,136 @@ public:
                                             std::string const &    name);   // loaded
     void                        releaseUnused();
 
+    // Asynchronous loading. Returns the handle in state_path at once, Resource::load() runs in the thread
+    // pool in the order of priority (the highest first, FIFO for equal ones), then the finalize function of
+    // the type is queued to the render. The state becomes state_mem or state_invalid when the data is
+    // loaded. The requests of dropped handles are skipped.
+    Resource::ResourceSharedPtr requestResource(Resource::ResourceType type, std::string const & name,
+                                                int32_t priority = 0);
+    bool   setPriority(Resource::ResourceSharedPtr const & res, int32_t priority);   // false if not queued
+    bool   cancelRequest(Resource::ResourceSharedPtr const & res);                   // false if not queued
+    size_t getNumRequests() const;                                                   // queued and loading
+
+    // the files of the resources, required by getResource(), createResource() and requestResource()
+    void setFileSystem(FileSystem * file_system) { mp_file_system = file_system; }
+    // finalize functions are called in the loading thread without the render
+    void setRender(Render * render);
+    // the pool of the loading tasks, required by requestResource() and reloadFiles()
+    void setThreadPool(ThreadPool * pool);
+    // Drops the queued requests and waits for the loading and reloading tasks. Called by the owner before the
+    // pool and the file system are shut down, the destructor only waits for the tasks left.
+    void finishRequests();
+
+    // Hot reload of the changed files (see FileSystem::startWatching). The loaded resources are loaded again
+    // into new instances in the thread pool, then the data is swapped in (see Resource::swapData) and
+    // finalized in the render thread, the handles stay valid. The old data is kept if the reload fails.
+    void reloadFiles(std::vector<std::string> const & names);
+
+    struct ResidencyStats
+    {
+        uint64_t budget       = 0;   // bytes, 0 - not limited
+        uint64_t cpu_size     = 0;   // of the loaded resources
+        uint64_t gpu_size     = 0;
+        size_t   num_loaded   = 0;
+        size_t   num_total    = 0;   // live handles
+        uint64_t num_loads    = 0;   // by the manager, the reloads of the released resources included
+        uint64_t num_releases = 0;   // over the budget
+    };
+
+    // Residency. If the CPU + GPU size of the loaded resources of the type exceeds the budget,
+    // releaseUnused() releases the least recently used ones back to state_path, they are loaded again by
+    // the next getResource/requestResource. Release is queued to the render like the finalization: the
+    // resources are released in the thread that uses them, a resource used after it was chosen is kept.
+    void           setBudget(Resource::ResourceType type, uint64_t bytes);   // 0 - not limited
+    ResidencyStats getResidencyStats(Resource::ResourceType type) const;
+
 private:
-    Resource::ResourceSharedPtr getExisted(Resource::ResourceType type, std::string const & name);
+    // Resources are kept in shards selected by the hash of the type and the name. A shard is a read-copy-
+    // update hash table: lookups take no lock. Inserts go to the mutable 'added' table under the lock and
+    // are published in batches, the table is copied when 'added' grows to a part of its size and in
+    // releaseUnused(), so an insert copies O(1) entries amortized. A lookup missing the published table
+    // searches 'added' under the lock. The names are interned per shard, an entry copy doesn't copy them.
+    struct TableEntry
+    {
+        Resource::ResourceType    type;
+        std::string const *       name;   // in Shard::names
+        Resource::ResourceWeakPtr res;
+    };
+
+    using ShardTable = std::unordered_multimap<uint64_t, TableEntry>;
+
+    struct alignas(64) Shard   // the reader counters of the shards are on separate cache lines
+    {
+        RcuPtr<ShardTable>              table;
+        mutable std::mutex              added_guard;   // protects added, names and the publishing
+        ShardTable                      added;         // not published yet
+        std::unordered_set<std::string> names;         // kept until the manager is destroyed
+    };
+
+    static constexpr size_t num_shards    = 64;
+    static constexpr size_t publish_batch = 16;   // the min 'added' size published by an insert
+
+    // the live resource of the entry with the type and the name
+    static Resource::ResourceSharedPtr FindEntry(ShardTable const & table, uint64_t hash,
+                                                 Resource::ResourceType type, std::string const & name);
+    static void                        Publish(Shard & shard, bool remove_expired);   // requires added_guard
+
+    struct Residency
+    {
+        uint64_t budget{0};
+        uint64_t num_loads{0};
+        uint64_t num_releases{0};
+    };
+
+    struct RequestKey
+    {
+        int32_t  priority;
+        uint64_t seq;
+
+        bool operator<(RequestKey const & other) const
+        {
+            return priority != other.priority ? priority > other.priority : seq < other.seq;
+        }
+    };
+
+    static uint64_t GetNameHash(Resource::ResourceType type, std::string const & name);
+
+    Resource::ResourceSharedPtr findExisted(Resource::ResourceType type, std::string const & name) const;
+    Resource::ResourceSharedPtr getExisted(Resource::ResourceType type,
+                                           std::string const &    name) const;   // marked used
+    // the live resource with the same type and name if added by another thread meanwhile, res otherwise
+    Resource::ResourceSharedPtr addResource(Resource::ResourceSharedPtr res);
     bool                        isFileExisted(std::string const & name) const;
 
-    std::unordered_map<Resource::ResourceType, std::list<Resource::ResourceWeakPtr>> m_resources;
-    std::unordered_map<Resource::ResourceType, ResourceRegEntry>                     m_registry;
+    void enqueueRequest(Resource::ResourceSharedPtr res, int32_t priority);   // requires m_resources_guard
+    void loadNextRequest();                                                   // pool task
+    void loadRequested(Resource::ResourceSharedPtr const & res);   // waits if loading in another thread
+    void loadResource(Resource::ResourceSharedPtr const & res);    // the resource is in m_loading
+    void finalizeResource(Resource::ResourceSharedPtr const & res);   // queued to the render
+    void countLoad(Resource const & res);
+    void reloadResource(Resource::ResourceSharedPtr const & res);   // pool task
+
+    void enforceBudgets();
+    void releaseOverBudget(Resource::ResourceSharedPtr const & res, int64_t last_use);
+
+    std::array<Shard, num_shards>                                m_shards;
+    std::unordered_map<Resource::ResourceType, ResourceRegEntry> m_registry;
+    FileSystem *                                                 mp_file_system{nullptr};   // set before use
 
-    std::mutex m_resources_guard;
+    // the queue holds the handles, a request is dropped if the queue is the only owner
+    // m_requests_guard protects the requests, m_loading, mp_render, mp_thread_pool and m_residency
+    std::map<RequestKey, Resource::ResourceSharedPtr>     m_requests;
+    std::unordered_map<Resource const *, RequestKey>      m_request_keys;
+    std::unordered_set<Resource const *>                  m_loading;
+    uint64_t                                              m_next_seq{0};
+    size_t                                                m_num_tasks{0};   // submitted and not finished
+    Render *                                              mp_render{nullptr};
+    ThreadPool *                                          mp_thread_pool{nullptr};
+    std::unordered_map<Resource::ResourceType, Residency> m_residency;
+
+    mutable std::mutex      m_requests_guard;
+    std::condition_variable m_tasks_done;   // m_num_tasks is 0
+    std::condition_variable m_loaded;       // a resource left m_loading
 };
 
 template<typename ResourceType>
@@ -121,13 +275,7 @@ Resource::ResourceSharedPtr ResourceManager::createResource(std::string const &
     auto reg = getTypeRegEntry(ResourceType::GetTypeID());
 
     if(isFileExisted(name))
-    {
-        res_shared = std::make_shared<ResourceType>(name);
-
-        std::lock_guard lock(m_resources_guard);
-        m_resources[ResourceType::GetTypeID()].push_back(res_shared);
-        return res_shared;
-    }
+        return addResource(std::make_shared<ResourceType>(name));
 
     // if file not existed log and return default
     std::stringstream ss;
@@ -0,0 +1,291 @@
+#include "texturedata.h"
+#include "../core/taskgraph.h"
+#include "blockcompression.h"
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
+namespace evnt
+{
+namespace
+{
+    // sRGB <-> 16 bit linear, the linear values keep the precision of the dark sRGB ones
+    struct SrgbTables
+    {
+        uint16_t to_linear[256];
+        uint8_t  to_srgb[65536];
+
+        SrgbTables()
+        {
+            for(int32_t i = 0; i < 256; ++i)
+            {
+                double const c = i / 255.0;
+                double const l = c <= 0.04045 ? c / 12.92 : std::pow((c + 0.055) / 1.055, 2.4);
+                to_linear[i]   = static_cast<uint16_t>(std::lround(l * 65535.0));
+            }
+
+            for(int32_t i = 0; i < 65536; ++i)
+            {
+                double const l = i / 65535.0;
+                double const c = l <= 0.0031308 ? l * 12.92 : 1.055 * std::pow(l, 1.0 / 2.4) - 0.055;
+                to_srgb[i]     = static_cast<uint8_t>(std::lround(c * 255.0));
+            }
+        }
+    };
+
+    SrgbTables const & GetSrgbTables()
+    {
+        static SrgbTables const tables;
+        return tables;
+    }
+
+    // 2x2 box filter of the RGBA pixels, the last row and column of an odd size are skipped, a size of 1
+    // repeats the row or column. The color is averaged in the linear space if the tables are given.
+    void DownsampleRows(uint8_t const * src, uint32_t src_w, uint32_t src_h, uint8_t * dst, uint32_t dst_w,
+                        uint32_t first_row, uint32_t last_row, SrgbTables const * tables)
+    {
+        for(uint32_t y = first_row; y < last_row; ++y)
+        {
+            uint8_t const * row0 = src + size_t{std::min(2 * y, src_h - 1)} * src_w * 4;
+            uint8_t const * row1 = src + size_t{std::min(2 * y + 1, src_h - 1)} * src_w * 4;
+            uint8_t *       out  = dst + size_t{y} * dst_w * 4;
+
+            for(uint32_t x = 0; x < dst_w; ++x, out += 4)
+            {
+                size_t const x0 = size_t{std::min(2 * x, src_w - 1)} * 4;
+                size_t const x1 = size_t{std::min(2 * x + 1, src_w - 1)} * 4;
+
+                for(size_t c = 0; c < 3; ++c)
+                {
+                    if(tables)
+                    {
+                        auto const &   lin = tables->to_linear;
+                        uint32_t const sum =
+                            lin[row0[x0 + c]] + lin[row0[x1 + c]] + lin[row1[x0 + c]] + lin[row1[x1 + c]];
+                        out[c] = tables->to_srgb[(sum + 2) >> 2];
+                    }
+                    else
+                    {
+                        uint32_t const sum = row0[x0 + c] + row0[x1 + c] + row1[x0 + c] + row1[x1 + c];
+                        out[c]             = static_cast<uint8_t>((sum + 2) >> 2);
+                    }
+                }
+
+                uint32_t const alpha = row0[x0 + 3] + row0[x1 + 3] + row1[x0 + 3] + row1[x1 + 3];
+                out[3]               = static_cast<uint8_t>((alpha + 2) >> 2);
+            }
+        }
+    }
+
+    using BlockEncoder = void (*)(uint8_t const * block, uint8_t * out);
+
+    // the blocks of the row by of the RGBA level, the pixels past the edges repeat the edge ones
+    void EncodeBlockRow(uint8_t const * src, uint32_t w, uint32_t h, uint32_t by, BlockEncoder encode,
+                        size_t block_size, uint8_t * out)
+    {
+        uint8_t        block[64];
+        uint32_t const num_blocks = (w + 3) / 4;
+        for(uint32_t bx = 0; bx < num_blocks; ++bx, out += block_size)
+        {
+            for(uint32_t y = 0; y < 4; ++y)
+            {
+                uint8_t const * row = src + size_t{std::min(by * 4 + y, h - 1)} * w * 4;
+                for(uint32_t x = 0; x < 4; ++x)
+                    std::memcpy(block + (y * 4 + x) * 4, row + size_t{std::min(bx * 4 + x, w - 1)} * 4, 4);
+            }
+
+            encode(block, out);
+        }
+    }
+}   // namespace
+
+size_t TextureData::setLevels(uint32_t num_levels)
+{
+    levels.clear();
+
+    size_t   offset = 0;
+    uint32_t w      = width;
+    uint32_t h      = height;
+    for(uint32_t i = 0; i < num_levels; ++i)
+    {
+        size_t const size = GetLevelSize(format, w, h);
+        levels.push_back({w, h, offset, size});
+
+        offset += size;
+        w = std::max(w / 2, 1u);
+        h = std::max(h / 2, 1u);
+    }
+
+    return offset;
+}
+
+size_t TextureData::GetLevelSize(Format format, uint32_t width, uint32_t height)
+{
+    size_t const num_blocks = size_t{(width + 3) / 4} * ((height + 3) / 4);
+    switch(format)
+    {
+        case Format::rgb8:
+            return size_t{width} * height * 3;
+        case Format::rgba8:
+            return size_t{width} * height * 4;
+        case Format::bc1:
+            return num_blocks * 8;
+        case Format::bc3:
+        case Format::bc7:
+            return num_blocks * 16;
+        default:
+            return 0;
+    }
+}
+
+uint32_t TextureData::GetNumMipLevels(uint32_t width, uint32_t height)
+{
+    uint32_t num_levels = 1;
+    for(uint32_t size = std::max(width, height); size > 1; size /= 2)
+        ++num_levels;
+
+    return num_levels;
+}
+
+bool TextureData::GetFormatFromString(std::string const & name, Format & format)
+{
+    static std::pair<char const *, Format> const names[] = {
+        {"rgb8", Format::rgb8}, {"rgba8", Format::rgba8}, {"bc1", Format::bc1},
+        {"bc3", Format::bc3},   {"bc7", Format::bc7},
+    };
+
+    for(auto const & [str, value] : names)
+    {
+        if(name == str)
+        {
+            format = value;
+            return true;
+        }
+    }
+
+    return false;
+}
+
+uint64_t TextureProcessing::getKey() const
+{
+    return 1 | uint64_t{compress} << 1 | uint64_t{mipmaps} << 2 | uint64_t{srgb} << 3
+           | static_cast<uint64_t>(format) << 8 | uint64_t{block_encoder_version} << 32;
+}
+
+void ProcessTexture(ImageData && id, TextureProcessing const & proc, TextureData & td, ThreadPool * pool)
+{
+    td        = TextureData{};
+    td.width  = id.width;
+    td.height = id.height;
+    td.srgb   = proc.srgb;
+
+    if(!id.data || id.width == 0 || id.height == 0)
+        return;
+
+    if(!proc.compress && !proc.mipmaps)
+    {
+        td.format = id.type == ImageData::PixelType::pt_rgb ? TextureData::Format::rgb8
+                                                             : TextureData::Format::rgba8;
+        td.setLevels(1);
+        td.data = std::move(id.data);
+        return;
+    }
+
+    ConvertToRGBA(id);
+
+    // the mip chain in RGBA, the result if not compressed
+    TextureData chain;
+    chain.width  = id.width;
+    chain.height = id.height;
+    chain.format = TextureData::Format::rgba8;
+    chain.srgb   = proc.srgb;
+    chain.setLevels(proc.mipmaps ? TextureData::GetNumMipLevels(id.width, id.height) : 1);
+
+    if(chain.levels.size() == 1)
+    {
+        chain.data = std::move(id.data);
+    }
+    else
+    {
+        chain.data.reset(new uint8_t[chain.getDataSize()]);   // not zeroed, all written
+        std::memcpy(chain.data.get(), id.data.get(), chain.levels[0].size);
+        id.data.reset();
+
+        SrgbTables const * tables = proc.srgb ? &GetSrgbTables() : nullptr;
+        for(size_t i = 1; i < chain.levels.size(); ++i)
+        {
+            auto const & src  = chain.levels[i - 1];
+            auto const & dst  = chain.levels[i];
+            auto         rows = [&](uint32_t first, uint32_t last) {
+                DownsampleRows(chain.data.get() + src.offset, src.width, src.height,
+                               chain.data.get() + dst.offset, dst.width, first, last, tables);
+            };
+
+            if(pool)
+                parallel_for(*pool, uint32_t{0}, dst.height, rows);
+            else
+                rows(0, dst.height);
+        }
+    }
+
+    if(!proc.compress || !TextureData::IsCompressed(proc.format))
+    {
+        td = std::move(chain);
+        return;
+    }
+
+    BlockEncoder encode     = EncodeBC7Block;
+    size_t       block_size = 16;
+    if(proc.format == TextureData::Format::bc1)
+    {
+        encode     = EncodeBC1Block;
+        block_size = 8;
+    }
+    else if(proc.format == TextureData::Format::bc3)
+    {
+        encode = EncodeBC3Block;
+    }
+
+    td.format = proc.format;
+    td.setLevels(static_cast<uint32_t>(chain.levels.size()));
+    td.data.reset(new uint8_t[td.getDataSize()]);   // not zeroed, all written
+
+    // the block rows of all levels are one range, the small levels don't leave the threads idle
+    std::vector<std::pair<uint32_t, uint32_t>> block_rows;   // level, row
+    for(uint32_t i = 0; i < chain.levels.size(); ++i)
+        for(uint32_t by = 0; by < (chain.levels[i].height + 3) / 4; ++by)
+            block_rows.emplace_back(i, by);
+
+    auto encode_rows = [&](size_t first, size_t last) {
+        for(size_t i = first; i < last; ++i)
+        {
+            auto const [level, by] = block_rows[i];
+            auto const & src       = chain.levels[level];
+            size_t const row_size  = size_t{(src.width + 3) / 4} * block_size;
+
+            EncodeBlockRow(chain.data.get() + src.offset, src.width, src.height, by, encode, block_size,
+                           td.data.get() + td.levels[level].offset + by * row_size);
+        }
+    };
+
+    if(pool)
+        parallel_for(*pool, size_t{0}, block_rows.size(), encode_rows);
+    else
+        encode_rows(0, block_rows.size());
+}
+
+bool GetBaseLevel(TextureData const & td, ImageData & id)
+{
+    if(TextureData::IsCompressed(td.format) || td.levels.empty() || !td.data)
+        return false;
+
+    id.width  = td.width;
+    id.height = td.height;
+    id.type   = td.format == TextureData::Format::rgb8 ? ImageData::PixelType::pt_rgb
+                                                       : ImageData::PixelType::pt_rgba;
+    id.data.reset(new uint8_t[td.levels[0].size]);   // not zeroed, all written
+    std::memcpy(id.data.get(), td.data.get(), td.levels[0].size);
+
+    return true;
+}
+}   // namespace evnt
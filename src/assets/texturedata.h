@@ -0,0 +1,69 @@
+#ifndef TEXTUREDATA_H
+#define TEXTUREDATA_H
+
+#include "imagedata.h"
+#include <vector>
+
+namespace evnt
+{
+class ThreadPool;
+
+// Texture ready for the upload: the mip levels one after another in one buffer, origin is the lower-left
+// corner like in ImageData. A compressed level is 4x4 pixel blocks by rows, the edge blocks are padded with
+// the edge pixels.
+struct TextureData
+{
+    enum class Format
+    {
+        rgb8,
+        rgba8,
+        bc1,
+        bc3,
+        bc7
+    };
+
+    struct Level
+    {
+        uint32_t width;
+        uint32_t height;
+        size_t   offset;   // in data
+        size_t   size;
+    };
+
+    uint32_t                   width  = 0;
+    uint32_t                   height = 0;
+    Format                     format = Format::rgba8;
+    bool                       srgb   = false;   // the color channels are sRGB encoded
+    std::vector<Level>         levels;
+    std::unique_ptr<uint8_t[]> data;
+
+    // fills the levels by width, height and format, returns the data size
+    size_t setLevels(uint32_t num_levels);
+    size_t getDataSize() const { return levels.empty() ? 0 : levels.back().offset + levels.back().size; }
+
+    static bool     IsCompressed(Format format) { return format >= Format::bc1; }
+    static size_t   GetLevelSize(Format format, uint32_t width, uint32_t height);
+    static uint32_t GetNumMipLevels(uint32_t width, uint32_t height);   // down to 1x1
+    static bool     GetFormatFromString(std::string const & name, Format & format);   // "rgba8", "bc7", ...
+};
+
+struct TextureProcessing
+{
+    bool                compress = false;
+    TextureData::Format format   = TextureData::Format::bc7;   // of the compressed textures
+    bool                mipmaps  = false;
+    bool                srgb     = true;   // the images are sRGB, mipmaps are filtered in the linear space
+
+    uint64_t getKey() const;   // of the settings, never 0, see ImageCache::GetKey
+};
+
+// Builds the mip chain with the 2x2 box filter and encodes the blocks, the block rows of all levels are
+// spread over the pool if given. Without compression and mipmaps the pixels of id are moved in as is,
+// otherwise id is converted to RGBA first.
+void ProcessTexture(ImageData && id, TextureProcessing const & proc, TextureData & td,
+                    ThreadPool * pool = nullptr);
+
+// level 0 of the rgb8 and rgba8 formats, false for the compressed ones
+bool GetBaseLevel(TextureData const & td, ImageData & id);
+}   // namespace evnt
+#endif   // TEXTUREDATA_H
@@ -1,6 +1,7 @@
 #include "textureresource.h"
 #include "../core/core.h"
 #include "../log/log.h"
+#include "../render/render.h"
 
 namespace evnt
 {
@@ -12,32 +13,48 @@ ResourceManager::ResourceRegEntry TextureResource::GetRegEntry()
     reg.res_get_default_function = std::bind(TextureResource::GetDefaultTexture);
     reg.res_write_function       = std::bind(TextureResource::WriteTga, std::placeholders::_1);
     reg.res_read_function        = std::bind(TextureResource::LoadTexture, std::placeholders::_1);
+    reg.res_create_function      = [](std::string const & name) -> Resource::ResourceSharedPtr {
+        return std::make_shared<TextureResource>(name);
+    };
+    reg.res_finalize_function    = TextureResource::FinalizeTexture;
 
     return reg;
 }
 
 Resource::ResourceSharedPtr TextureResource::LoadTexture(std::string const & name)
 {
-    auto tex = std::make_shared<TextureResource>(name);
-    auto fs  = Core::instance().getFileSystem();
+    auto   tex   = std::make_shared<TextureResource>(name);
+    auto & fs    = Core::instance().getFileSystem();
+    auto & cache = Core::instance().getImageCache();
 
     auto file = fs.getFile(name);   // exception if not found
 
-    if(file.getNameExt() == ".tga")
+    // processed images are cached by the content of the file and the settings, a change gets a new key
+    uint64_t const key = cache.isEnabled() ? ImageCache::GetKey(file, sm_processing.getKey()) : 0;
+    if(cache.isEnabled() && cache.find(key, tex->m_data))
     {
-        if(ReadTGA(file, tex->m_data))
-        {
-            tex->m_state = State::state_mem;
-            return tex;
-        }
+        tex->m_cpu_size = tex->getDataSize();
+        tex->m_state    = State::state_mem;
+        return tex;
     }
+
+    ImageData id;
+    bool      decoded = false;
+    if(file.getNameExt() == ".tga")
+        decoded = ReadTGA(file, id);
     else if(file.getNameExt() == ".bmp")
+        decoded = ReadBMP(file, id);
+
+    if(decoded)
     {
-        if(ReadBMP(file, tex->m_data))
-        {
-            tex->m_state = State::state_mem;
-            return tex;
-        }
+        // the block rows are encoded in the pool, the loading thread takes part
+        ProcessTexture(std::move(id), sm_processing, tex->m_data, &Core::instance().getThreadPool());
+        if(cache.isEnabled())
+            cache.store(key, tex->m_data);
+
+        tex->m_cpu_size = tex->getDataSize();
+        tex->m_state    = State::state_mem;
+        return tex;
     }
 
     std::stringstream ss;
@@ -59,7 +76,8 @@ Resource::ResourceSharedPtr TextureResource::GetDefaultTexture()
         auto ptr           = std::make_shared<TextureResource>("default_texture");
         ptr->m_data.height = 4;
         ptr->m_data.width  = 4;
-        ptr->m_data.type   = ImageData::PixelType::pt_rgba;
+        ptr->m_data.format = TextureData::Format::rgba8;
+        ptr->m_data.setLevels(1);
 
         ptr->m_data.data = std::make_unique<uint8_t[]>(4 * 4 * 4);
         std::memcpy(ptr->m_data.data.get(), texData, 4 * 4 * 4);
@@ -72,14 +90,45 @@ Resource::ResourceSharedPtr TextureResource::GetDefaultTexture()
 
 bool TextureResource::WriteTga(Resource const & texture)
 {
-    auto fs = Core::instance().getFileSystem();
+    auto & fs = Core::instance().getFileSystem();
+
+    auto &    tex = static_cast<TextureResource const &>(texture);
+    ImageData id;
+    if(!GetBaseLevel(tex.m_data, id))
+    {
+        Log::Log(Log::warning,
+                 Log::cstr_log("Texture: \"%s\" - compressed, not written", tex.getName().c_str()));
+        return false;
+    }
 
-    auto & tex      = static_cast<TextureResource const &>(texture);
-    auto   out_file = WriteTGA(tex.getName(), tex.m_data);
+    auto out_file = WriteTGA(tex.getName(), id);
 
     return fs.writeFile({}, &out_file);
 }
 
+void TextureResource::FinalizeTexture(Resource & texture, Render * render)
+{
+    // without the render the data stays on the CPU
+    if(render == nullptr)
+        return;
+
+    auto & tex = static_cast<TextureResource &>(texture);
+    if(!tex.m_data.data)
+        return;
+
+    // a reloaded texture gets a new one, the sizes of the levels may change
+    auto const width  = static_cast<int32_t>(tex.m_data.width);
+    auto const height = static_cast<int32_t>(tex.m_data.height);
+    auto const levels = static_cast<int32_t>(tex.m_data.levels.size());
+    tex.mp_texture    = render->createTexture(width, height, levels, tex.getInternalFormat());
+    tex.upload(*tex.mp_texture);
+
+    size_t gpu_size = 0;
+    for(auto const & level : tex.m_data.levels)
+        gpu_size += level.size;
+    tex.m_gpu_size = gpu_size;
+}
+
 TextureResource::TextureResource(std::string name) :
     Resource(ResourceType::Texture, std::move(name)), m_data{}
 {}
@@ -104,18 +153,76 @@ bool TextureResource::load()
         return false;
     }
 
-    std::swap(m_state, tex_ptr->m_state);
-    std::swap(m_type, tex_ptr->m_type);
-    std::swap(m_name, tex_ptr->m_name);
     std::swap(m_data, tex_ptr->m_data);
+    m_cpu_size = getDataSize();
+    m_state    = tex_ptr->getState();   // published after the data, may be read by other threads
 
     return true;
 }
 
 void TextureResource::release()
 {
-    m_state = Resource::State::state_path;
-    ImageData temp;
+    TextureData temp;
     std::swap(m_data, temp);
+    mp_texture.reset();
+    m_cpu_size = 0;
+    m_gpu_size = 0;
+    m_state    = Resource::State::state_path;   // a load may start when seen
+}
+
+bool TextureResource::swapData(Resource & other)
+{
+    auto & tex = static_cast<TextureResource &>(other);
+
+    std::swap(m_data, tex.m_data);
+    m_cpu_size     = getDataSize();
+    tex.m_cpu_size = tex.getDataSize();
+
+    return true;
+}
+
+size_t TextureResource::getDataSize() const
+{
+    return m_data.data ? m_data.getDataSize() : 0;
+}
+
+TextureInternalFormat TextureResource::getInternalFormat() const
+{
+    bool const srgb = m_data.srgb;
+    switch(m_data.format)
+    {
+        case TextureData::Format::rgb8:
+            return srgb ? TextureInternalFormat::SRGB8 : TextureInternalFormat::RGB8;
+        case TextureData::Format::bc1:
+            return srgb ? TextureInternalFormat::SRGB_BC1 : TextureInternalFormat::RGB_BC1;
+        case TextureData::Format::bc3:
+            return srgb ? TextureInternalFormat::SRGB_ALPHA_BC3 : TextureInternalFormat::RGBA_BC3;
+        case TextureData::Format::bc7:
+            return srgb ? TextureInternalFormat::SRGB_ALPHA_BC7 : TextureInternalFormat::RGBA_BC7;
+        default:
+            return srgb ? TextureInternalFormat::SRGB8_ALPHA8 : TextureInternalFormat::RGBA8;
+    }
+}
+
+void TextureResource::upload(ITexture & tex) const
+{
+    if(!m_data.data)
+        return;
+
+    for(size_t i = 0; i < m_data.levels.size(); ++i)
+    {
+        auto const &    level = m_data.levels[i];
+        auto const      w     = static_cast<int32_t>(level.width);
+        auto const      h     = static_cast<int32_t>(level.height);
+        auto const      index = static_cast<int32_t>(i);
+        uint8_t const * data  = m_data.data.get() + level.offset;
+
+        if(TextureData::IsCompressed(m_data.format))
+            tex.setCompressedData(0, 0, w, h, index, static_cast<int32_t>(level.size), data);
+        else if(m_data.format == TextureData::Format::rgb8)
+            tex.setData(0, 0, w, h, index, TexturePixelFormat::RGB, TextureDataType::UnsignedByte, data);
+        else
+            tex.setData(0, 0, w, h, index, TexturePixelFormat::RGBA, TextureDataType::UnsignedByte, data);
+    }
 }
 }   // namespace evnt
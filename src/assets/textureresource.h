@@ -1,8 +1,10 @@
 #ifndef TEXTURERESOURCE_H
 #define TEXTURERESOURCE_H
 
-#include "imagedata.h"
+#include "../render/graphics_types.h"
+#include "../render/texture.h"
 #include "resource.h"
+#include "texturedata.h"
 
 namespace evnt
 {
@@ -16,6 +18,7 @@ public:
 public:
     bool load() override;
     void release() override;
+    bool swapData(Resource & other) override;
 
     static ResourceType                      GetTypeID() { return ResourceType::Texture; }
     static ResourceManager::ResourceRegEntry GetRegEntry();
@@ -23,9 +26,26 @@ public:
     static Resource::ResourceSharedPtr LoadTexture(std::string const & name);
     static ResourceSharedPtr           GetDefaultTexture();
     static bool                        WriteTga(Resource const & texture);
+    static void                        FinalizeTexture(Resource & texture, Render * render);
+
+    // applied to the textures loaded after the call, set once at the start
+    static void                      SetProcessing(TextureProcessing const & proc) { sm_processing = proc; }
+    static TextureProcessing const & GetProcessing() { return sm_processing; }
+
+    TextureData const &   getData() const { return m_data; }
+    TextureInternalFormat getInternalFormat() const;
+    // all the levels of the loaded data, tex is created with getInternalFormat() and the number of levels
+    void upload(ITexture & tex) const;
+    // created by the finalize function in the render thread, null until then and after release()
+    ITexture * getTexture() const { return mp_texture.get(); }
 
 protected:
-    ImageData m_data;
+    size_t getDataSize() const;
+
+    TextureData               m_data;
+    std::unique_ptr<ITexture> mp_texture;
+
+    inline static TextureProcessing sm_processing;
 };
 }   // namespace evnt
 #endif   // TEXTURERESOURCE_H
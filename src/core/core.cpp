@@ -23,8 +23,13 @@ Core::Core() : mp_thread_pool{std::make_unique<ThreadPool>(1)}, evExit{*mp_threa
     // Load the config.json file in this ptree
     pt::read_json(std::string(root_config_filename), m_root_config);
 
-    mp_file_system =
-        std::make_unique<FileSystem>(m_root_config.get<std::string>("FileSystem.RootPathRelative"));
+    mp_file_system = std::make_unique<FileSystem>(
+        m_root_config.get<std::string>("FileSystem.RootPathRelative"), mp_thread_pool.get());
+
+    // the cache is optional, without the path images are decoded on every load
+    mp_image_cache = std::make_unique<ImageCache>(
+        m_root_config.get<std::string>("FileSystem.ImageCache.Path", ""),
+        m_root_config.get<uint64_t>("FileSystem.ImageCache.MaxSizeMB", 512) * 1024 * 1024);
 
     Log::SeverityLevel sl =
         Log::ConvertStrToSeverity(m_root_config.get<std::string>("Logging.SeverityLevelFilter"));
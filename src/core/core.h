@@ -4,6 +4,7 @@
 #include <boost/property_tree/ptree.hpp>
 
 #include "../app/app.h"
+#include "../assets/imagecache.h"
 #include "../fs/file_system.h"
 #include "event.h"
 #include "module.h"
@@ -22,6 +23,7 @@ class Core : public Module<Core>
     pt::ptree                   m_root_config;
     std::unique_ptr<ThreadPool> mp_thread_pool;
     std::unique_ptr<FileSystem> mp_file_system;
+    std::unique_ptr<ImageCache> mp_image_cache;
     std::unique_ptr<App>        mp_app;
 
     bool m_running{false};
@@ -43,13 +45,14 @@ public:
     // getters
     ThreadPool &      getThreadPool() { return *mp_thread_pool; }
     FileSystem &      getFileSystem() { return *mp_file_system; }
+    ImageCache &      getImageCache() { return *mp_image_cache; }
     pt::ptree const & getRootConfig() const { return m_root_config; }
     App &             getApp() { return *mp_app; }
     uint32_t          getFPS() const { return m_fps; }
 };
 
 template<typename RetType, typename... Args>
-Event<RetType(Args...)>::Event() : m_access_flag(false), m_thread_pool{Core::instance().getThreadPool()}
+Event<RetType(Args...)>::Event() : m_thread_pool{Core::instance().getThreadPool()}
 {}
 }   // namespace evnt
 #endif   // CORE_H
@@ -1,11 +1,14 @@
 #ifndef EVENT_H
 #define EVENT_H
 
+#include "rcuptr.h"
 #include "threadpool.h"
 
+#include <algorithm>
 #include <functional>
-#include <list>
+#include <optional>
 #include <tuple>
+#include <vector>
 
 namespace evnt
 {
@@ -35,9 +38,20 @@ struct ScopedHandle
     ~ScopedHandle() { m_evnt.unbind(m_hdl); }
 };
 
+enum class DispatchMode
+{
+    async,   // every delegate is a separate task in the thread pool
+    sync     // delegates are called on the thread which fires the event
+};
+
 template<typename EventTrait>
 class Event;
 
+/**
+ * Multicast event. The delegate list is copy-on-write (RcuPtr): bind()/unbind() publish a new list, firing
+ * the event reads the current list without locking. On async dispatch the arguments are copied once into a
+ * pooled payload shared by all delegate tasks, so firing doesn't allocate per listener.
+ */
 template<typename RetType, typename... Args>
 class Event<RetType(Args...)>
 {
@@ -49,52 +63,91 @@ public:
     static constexpr std::size_t num_args = std::tuple_size<ParamsTuple>::value;
 
     Event();
-    explicit Event(ThreadPool & pool) : m_access_flag(false), m_thread_pool{pool} {}
+    explicit Event(ThreadPool & pool, DispatchMode mode = DispatchMode::async) :
+        m_thread_pool{pool}, m_mode{mode}
+    {}
 
     DelegateHandle bind(DelegateType fn)
     {
-        FlagLock       lk(m_access_flag);
-        DelegateHandle evh = ++m_next_available_ID;
-        m_delegates.push_back(DelegateHolder{fn, evh});
+        DelegateHandle evh = m_next_available_ID.fetch_add(1, std::memory_order_relaxed) + 1;
+        m_delegates.update([&](DelegateList & list) { list.push_back(DelegateHolder{std::move(fn), evh}); });
 
         return evh;
     }
 
     void unbind(DelegateHandle dgh)
     {
-        FlagLock lk(m_access_flag);
-        m_delegates.erase(std::remove_if(m_delegates.begin(), m_delegates.end(),
-                                         [dgh](DelegateHolder const & d) { return d.object == dgh; }),
-                          m_delegates.end());
+        m_delegates.update([dgh](DelegateList & list) {
+            list.erase(std::remove_if(list.begin(), list.end(),
+                                      [dgh](DelegateHolder const & d) { return d.object == dgh; }),
+                       list.end());
+        });
     }
 
+    void         setDispatchMode(DispatchMode mode) { m_mode.store(mode, std::memory_order_relaxed); }
+    DispatchMode getDispatchMode() const { return m_mode.load(std::memory_order_relaxed); }
+    std::size_t  getNumDelegates() const { return m_delegates.read()->size(); }
+
     // https://stackoverflow.com/questions/29638627/perfect-forwarding-for-functions-inside-of-a-templated-c-class
     template<typename... Args2>
     auto call(Args2 &&... args2) const
     {
         std::vector<std::future<ResultType>> res;
+
+        auto list = m_delegates.read();
+        if(list->empty())
+            return res;
+
+        // the payload may be released by the last task before the loop ends, don't touch it after submit
+        std::size_t const num_delegates = list->size();
+        res.reserve(num_delegates);
+        Payload *         payload       = CreatePayload(std::move(list), std::forward<Args2>(args2)...);
+        for(std::size_t i = 0; i < num_delegates; ++i)
         {
-            FlagLock lk(m_access_flag);
-            for(auto & d : m_delegates)
-            {
-                std::function<ResultType()> fn = std::bind(d.delegate, std::forward<Args2>(args2)...);
-                res.push_back(m_thread_pool.submit(fn));
-            }
+            std::packaged_task<ResultType()> task([payload, i]() -> ResultType {
+                PayloadRef ref{payload};
+                return payload->invoke(i);
+            });
+            res.push_back(task.get_future());
+            m_thread_pool.submit([t = std::move(task)]() mutable { t(); });
         }
+
         return res;
     }
 
     template<typename... Args2>
     void submit(Args2 &&... args2) const
     {
-        FlagLock lk(m_access_flag);
-        for(auto & d : m_delegates)
+        if(getDispatchMode() == DispatchMode::sync)
+        {
+            invoke(std::forward<Args2>(args2)...);
+            return;
+        }
+
+        auto list = m_delegates.read();
+        if(list->empty())
+            return;
+
+        std::size_t const num_delegates = list->size();
+        Payload *         payload       = CreatePayload(std::move(list), std::forward<Args2>(args2)...);
+        for(std::size_t i = 0; i < num_delegates; ++i)
         {
-            std::function<void()> fn = std::bind(d.delegate, std::forward<Args2>(args2)...);
-            m_thread_pool.submit(fn);
+            m_thread_pool.submit([payload, i]() {
+                PayloadRef ref{payload};
+                payload->invoke(i);
+            });
         }
     }
 
+    // Calls all delegates on the calling thread regardless of the dispatch mode.
+    template<typename... Args2>
+    void invoke(Args2 &&... args2) const
+    {
+        auto list = m_delegates.read();
+        for(auto & d : *list)
+            d.delegate(args2...);
+    }
+
     template<typename... Args2>
     void operator()(Args2 &&... args2) const
     {
@@ -108,10 +161,88 @@ private:
         std::size_t  object;
     };
 
-    mutable std::atomic_bool  m_access_flag;
-    ThreadPool &              m_thread_pool;
-    std::list<DelegateHolder> m_delegates;
-    uint32_t                  m_next_available_ID = {0};
+    using DelegateList     = std::vector<DelegateHolder>;
+    using DelegateSnapshot = typename RcuPtr<DelegateList>::Snapshot;
+
+    // Arguments of one async dispatch, shared by the tasks of all delegates.
+    struct Payload
+    {
+        DelegateSnapshot                                 delegates;
+        std::optional<std::tuple<std::decay_t<Args>...>> args;
+        std::atomic<uint32_t>                            refs{0};
+        Payload *                                        next{nullptr};
+
+        ResultType invoke(std::size_t i) { return std::apply((*delegates)[i].delegate, *args); }
+    };
+
+    struct PayloadPool
+    {
+        std::atomic_bool flag{false};
+        Payload *        head{nullptr};
+
+        ~PayloadPool()
+        {
+            while(head != nullptr)
+            {
+                Payload * p = head;
+                head        = p->next;
+                delete p;
+            }
+        }
+
+        Payload * acquire()
+        {
+            {
+                FlagLock lk(flag);
+                if(head != nullptr)
+                {
+                    Payload * p = head;
+                    head        = p->next;
+                    return p;
+                }
+            }
+            return new Payload;
+        }
+
+        void release(Payload * p)
+        {
+            p->args.reset();
+            p->delegates = {};
+
+            FlagLock lk(flag);
+            p->next = head;
+            head    = p;
+        }
+    };
+
+    // releases the payload after the last delegate task
+    struct PayloadRef
+    {
+        Payload * p;
+        ~PayloadRef()
+        {
+            if(p->refs.fetch_sub(1, std::memory_order_acq_rel) == 1)
+                s_payload_pool.release(p);
+        }
+    };
+
+    template<typename... Args2>
+    static Payload * CreatePayload(DelegateSnapshot list, Args2 &&... args2)
+    {
+        Payload * p = s_payload_pool.acquire();
+        p->args.emplace(std::forward<Args2>(args2)...);
+        p->refs.store(static_cast<uint32_t>(list->size()), std::memory_order_relaxed);
+        p->delegates = std::move(list);
+
+        return p;
+    }
+
+    inline static PayloadPool s_payload_pool;
+
+    ThreadPool &                m_thread_pool;
+    std::atomic<DispatchMode>   m_mode{DispatchMode::async};
+    RcuPtr<DelegateList>        m_delegates;
+    std::atomic<DelegateHandle> m_next_available_ID = {0};
 };
 }   // namespace evnt
 
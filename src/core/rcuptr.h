@@ -0,0 +1,124 @@
+#ifndef RCUPTR_H
+#define RCUPTR_H
+
+#include <atomic>
+#include <mutex>
+#include <thread>
+#include <utility>
+
+namespace evnt
+{
+/**
+ * Read-copy-update pointer for read-mostly data.
+ * read() takes no lock: it pins the current version with a reference count and returns a Snapshot.
+ * update() copies the current version, modifies the copy and publishes it; the old version is freed when the
+ * last Snapshot referencing it is gone. Writers are serialized with a mutex and wait for a short grace period
+ * that only covers the pinning step of read(), never user code, so update() may be called while holding a
+ * Snapshot on the same thread.
+ */
+template<typename T>
+class RcuPtr
+{
+    struct Node
+    {
+        T                     value;
+        std::atomic<uint32_t> refs{1};
+
+        template<typename... Args>
+        explicit Node(Args &&... args) : value(std::forward<Args>(args)...)
+        {}
+    };
+
+    static void Release(Node * n)
+    {
+        if(n != nullptr && n->refs.fetch_sub(1, std::memory_order_acq_rel) == 1)
+            delete n;
+    }
+
+public:
+    class Snapshot
+    {
+    public:
+        Snapshot() = default;
+        Snapshot(Snapshot const & other) : mp_node{other.mp_node}
+        {
+            if(mp_node != nullptr)
+                mp_node->refs.fetch_add(1, std::memory_order_relaxed);
+        }
+        Snapshot(Snapshot && other) noexcept : mp_node{other.mp_node} { other.mp_node = nullptr; }
+        Snapshot & operator=(Snapshot other) noexcept
+        {
+            std::swap(mp_node, other.mp_node);
+            return *this;
+        }
+        ~Snapshot() { Release(mp_node); }
+
+        T const & operator*() const { return mp_node->value; }
+        T const * operator->() const { return &mp_node->value; }
+        T const * get() const { return mp_node != nullptr ? &mp_node->value : nullptr; }
+        explicit operator bool() const { return mp_node != nullptr; }
+
+    private:
+        explicit Snapshot(Node * n) : mp_node{n} {}
+
+        Node * mp_node{nullptr};
+
+        friend class RcuPtr;
+    };
+
+    template<typename... Args>
+    explicit RcuPtr(Args &&... args) : mp_node{new Node(std::forward<Args>(args)...)}
+    {}
+    ~RcuPtr() { Release(mp_node.load(std::memory_order_relaxed)); }
+
+    RcuPtr(RcuPtr const &)             = delete;
+    RcuPtr & operator=(RcuPtr const &) = delete;
+
+    Snapshot read() const
+    {
+        uint32_t const idx = m_epoch.load() & 1;
+
+        m_readers[idx].fetch_add(1);
+        Node * n = mp_node.load();
+        n->refs.fetch_add(1, std::memory_order_relaxed);
+        m_readers[idx].fetch_sub(1, std::memory_order_release);
+
+        return Snapshot(n);
+    }
+
+    // modify(T &) is called on a private copy of the current value
+    template<typename FunctionType>
+    void update(FunctionType && modify)
+    {
+        std::lock_guard lk(m_write_mutex);
+
+        Node * old_node = mp_node.load(std::memory_order_relaxed);
+        Node * new_node = new Node(old_node->value);
+        modify(new_node->value);
+
+        mp_node.store(new_node);
+        synchronize();
+        Release(old_node);
+    }
+
+private:
+    // Wait until every read() which could have loaded the old pointer has pinned it.
+    // The epoch flip moves new readers to the other counter, so the writer can't be starved.
+    void synchronize()
+    {
+        for(uint32_t i = 0; i < 2; ++i)
+        {
+            uint32_t const idx = m_epoch.fetch_add(1) & 1;
+            while(m_readers[idx].load(std::memory_order_acquire) != 0)
+                std::this_thread::yield();
+        }
+    }
+
+    std::atomic<Node *>           mp_node;
+    mutable std::atomic<uint32_t> m_epoch{0};
+    mutable std::atomic<uint32_t> m_readers[2] = {0, 0};
+    std::mutex                    m_write_mutex;
+};
+}   // namespace evnt
+
+#endif   // RCUPTR_H
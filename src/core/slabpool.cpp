@@ -0,0 +1,103 @@
+#include "slabpool.h"
+
+#include <algorithm>
+#include <iterator>
+#include <new>
+
+namespace evnt
+{
+SlabPool::SlabPool(std::size_t size, std::size_t align) :
+    m_align{std::max(align, alignof(FreeSlot))}
+{
+    // every slot must be able to hold the free list link
+    m_slot_size       = std::max(size, sizeof(FreeSlot));
+    m_slot_size       = (m_slot_size + m_align - 1) / m_align * m_align;
+    m_slots_per_slab  = std::max(min_slab_slots, slab_size / m_slot_size);
+    m_stats.slot_size = m_slot_size;
+}
+
+SlabPool::~SlabPool()
+{
+    for(void * slab : m_slabs)
+        ::operator delete(slab, std::align_val_t(m_align));
+}
+
+void * SlabPool::allocate()
+{
+    std::lock_guard lk(m_mutex);
+
+    if(mp_free == nullptr)
+        addSlab();
+
+    FreeSlot * slot = mp_free;
+    mp_free         = slot->next;
+
+    ++m_stats.num_allocs;
+    m_stats.peak = std::max(m_stats.peak, ++m_stats.live);
+
+    return slot;
+}
+
+void SlabPool::deallocate(void * p)
+{
+    if(p == nullptr)
+        return;
+
+    std::lock_guard lk(m_mutex);
+
+    auto * slot = static_cast<FreeSlot *>(p);
+    slot->next  = mp_free;
+    mp_free     = slot;
+
+    --m_stats.live;
+}
+
+SlabPool::Stats SlabPool::getStats() const
+{
+    std::lock_guard lk(m_mutex);
+
+    Stats res = m_stats;
+    if(res.capacity > 0)
+        res.free_ratio = static_cast<float>(res.capacity - res.live) / static_cast<float>(res.capacity);
+
+    // the free slots are counted per slab by walking the free list, the stats are for diagnostics only
+    std::vector<std::pair<unsigned char const *, std::size_t>> slabs;   // start, free slots
+    slabs.reserve(m_slabs.size());
+    for(void * slab : m_slabs)
+        slabs.emplace_back(static_cast<unsigned char const *>(slab), 0);
+    std::sort(slabs.begin(), slabs.end());
+
+    for(FreeSlot const * slot = mp_free; slot != nullptr; slot = slot->next)
+    {
+        auto const * p     = reinterpret_cast<unsigned char const *>(slot);
+        auto const   after = [](auto const * ptr, auto const & slab) { return ptr < slab.first; };
+        ++std::prev(std::upper_bound(slabs.begin(), slabs.end(), p, after))->second;
+    }
+
+    for(auto const & [slab, num_free] : slabs)
+    {
+        if(num_free > 0 && num_free < m_slots_per_slab)
+            ++res.num_partial_slabs;
+    }
+
+    return res;
+}
+
+void SlabPool::addSlab()
+{
+    auto * slab = static_cast<unsigned char *>(::operator new(m_slots_per_slab * m_slot_size,
+                                                               std::align_val_t(m_align)));
+    m_slabs.push_back(slab);
+
+    // link the slots in the address order
+    for(std::size_t i = m_slots_per_slab; i > 0; --i)
+    {
+        auto * slot = reinterpret_cast<FreeSlot *>(slab + (i - 1) * m_slot_size);
+        slot->next  = mp_free;
+        mp_free     = slot;
+    }
+
+    m_stats.capacity += m_slots_per_slab;
+    ++m_stats.num_slabs;
+}
+}   // namespace evnt
@@ -0,0 +1,110 @@
+#ifndef SLABPOOL_H
+#define SLABPOOL_H
+
+#include <cstddef>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+namespace evnt
+{
+/**
+ * Fixed size block allocator. Memory is reserved in slabs of many slots and is never returned to the system
+ * until the pool is destroyed, freed slots are reused in LIFO order. Thread safe.
+ */
+class SlabPool
+{
+public:
+    struct Stats
+    {
+        std::size_t slot_size{0};
+        std::size_t live{0};               // allocated slots
+        std::size_t peak{0};               // max number of live slots
+        std::size_t capacity{0};           // slots in all slabs
+        std::size_t num_slabs{0};
+        std::size_t num_partial_slabs{0};   // slabs with both live and free slots, they can't be freed
+        std::size_t num_allocs{0};          // allocations since creation
+        float       free_ratio{0.0f};       // share of the reserved slots which are free
+    };
+
+    static constexpr std::size_t slab_size      = 64 * 1024;
+    static constexpr std::size_t min_slab_slots = 16;
+
+    SlabPool(std::size_t size, std::size_t align = alignof(std::max_align_t));
+    ~SlabPool();
+
+    SlabPool(SlabPool const &)             = delete;
+    SlabPool & operator=(SlabPool const &) = delete;
+
+    void * allocate();
+    void   deallocate(void * p);
+
+    std::size_t getSlotSize() const { return m_slot_size; }
+    Stats       getStats() const;
+
+private:
+    struct FreeSlot
+    {
+        FreeSlot * next;
+    };
+
+    void addSlab();
+
+    std::size_t         m_slot_size;
+    std::size_t         m_align;
+    std::size_t         m_slots_per_slab;
+    FreeSlot *          mp_free{nullptr};
+    std::vector<void *> m_slabs;
+    Stats               m_stats;
+    mutable std::mutex  m_mutex;
+};
+
+// STL allocator taking single objects from a SlabPool shared by all allocators of the same type,
+// arrays are allocated with operator new. Used with std::allocate_shared.
+template<typename T>
+class PoolAllocator
+{
+public:
+    using value_type = T;
+
+    PoolAllocator() = default;
+    template<typename U>
+    PoolAllocator(PoolAllocator<U> const &)
+    {}
+
+    static SlabPool & GetPool()
+    {
+        static SlabPool pool(sizeof(T), alignof(T));
+        return pool;
+    }
+
+    T * allocate(std::size_t n)
+    {
+        if(n == 1)
+            return static_cast<T *>(GetPool().allocate());
+
+        return static_cast<T *>(::operator new(n * sizeof(T)));
+    }
+
+    void deallocate(T * p, std::size_t n)
+    {
+        if(n == 1)
+            GetPool().deallocate(p);
+        else
+            ::operator delete(p);
+    }
+
+    template<typename U>
+    bool operator==(PoolAllocator<U> const &) const
+    {
+        return true;
+    }
+    template<typename U>
+    bool operator!=(PoolAllocator<U> const &) const
+    {
+        return false;
+    }
+};
+}   // namespace evnt
+
+#endif   // SLABPOOL_H
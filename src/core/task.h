@@ -0,0 +1,127 @@
+#ifndef TASK_H
+#define TASK_H
+
+#include <cstddef>
+#include <new>
+#include <type_traits>
+#include <utility>
+
+namespace evnt
+{
+/**
+ * Move-only type-erased void() callable with inline storage. Callables which fit into
+ * Task::inline_size bytes (lambdas with a few captures, std::packaged_task) are stored in place,
+ * so posting them to the ThreadPool doesn't touch the heap. Bigger callables fall back to a heap copy.
+ */
+class Task
+{
+public:
+    static constexpr std::size_t inline_size = 48;
+
+    Task() = default;
+
+    template<typename FunctionType,
+             typename = std::enable_if_t<!std::is_same_v<std::decay_t<FunctionType>, Task>>>
+    Task(FunctionType && f)
+    {
+        using func_type = std::decay_t<FunctionType>;
+
+        if constexpr(IsInline<func_type>())
+        {
+            ::new(storage()) func_type(std::forward<FunctionType>(f));
+            mp_ops = &InlineOps<func_type>::ops;
+        }
+        else
+        {
+            ::new(storage()) func_type *(new func_type(std::forward<FunctionType>(f)));
+            mp_ops = &HeapOps<func_type>::ops;
+        }
+    }
+
+    Task(Task && other) noexcept { moveFrom(other); }
+    Task & operator=(Task && other) noexcept
+    {
+        // check for self-assignment
+        if(&other == this)
+            return *this;
+
+        reset();
+        moveFrom(other);
+
+        return *this;
+    }
+
+    Task(Task const &)             = delete;
+    Task & operator=(Task const &) = delete;
+
+    ~Task() { reset(); }
+
+    void operator()() { mp_ops->invoke(storage()); }
+    explicit operator bool() const { return mp_ops != nullptr; }
+
+    void reset()
+    {
+        if(mp_ops != nullptr)
+        {
+            mp_ops->destroy(storage());
+            mp_ops = nullptr;
+        }
+    }
+
+private:
+    struct Ops
+    {
+        void (*invoke)(void * self);
+        void (*move)(void * dst, void * src);   // move-construct dst from src and destroy src
+        void (*destroy)(void * self);
+    };
+
+    template<typename T>
+    static constexpr bool IsInline()
+    {
+        return sizeof(T) <= inline_size && alignof(T) <= alignof(std::max_align_t)
+               && std::is_nothrow_move_constructible_v<T>;
+    }
+
+    template<typename T>
+    struct InlineOps
+    {
+        static void invoke(void * self) { (*static_cast<T *>(self))(); }
+        static void move(void * dst, void * src)
+        {
+            ::new(dst) T(std::move(*static_cast<T *>(src)));
+            static_cast<T *>(src)->~T();
+        }
+        static void destroy(void * self) { static_cast<T *>(self)->~T(); }
+
+        inline static Ops const ops{invoke, move, destroy};
+    };
+
+    template<typename T>
+    struct HeapOps
+    {
+        static void invoke(void * self) { (**static_cast<T **>(self))(); }
+        static void move(void * dst, void * src) { ::new(dst) T *(*static_cast<T **>(src)); }
+        static void destroy(void * self) { delete *static_cast<T **>(self); }
+
+        inline static Ops const ops{invoke, move, destroy};
+    };
+
+    void moveFrom(Task & other) noexcept
+    {
+        mp_ops = other.mp_ops;
+        if(mp_ops != nullptr)
+        {
+            mp_ops->move(storage(), other.storage());
+            other.mp_ops = nullptr;
+        }
+    }
+
+    void * storage() { return static_cast<void *>(m_storage); }
+
+    Ops const *                             mp_ops{nullptr};
+    alignas(std::max_align_t) unsigned char m_storage[inline_size];
+};
+}   // namespace evnt
+
+#endif   // TASK_H
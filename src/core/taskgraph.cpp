@@ -0,0 +1,152 @@
+#include "taskgraph.h"
+#include "../log/log.h"
+#include "exception.h"
+#include <cassert>
+
+namespace evnt
+{
+TaskGraph::JobID TaskGraph::addJob(std::string name, std::function<void()> fn,
+                                   std::vector<JobID> const & dependencies, Affinity affinity)
+{
+    auto job      = std::make_unique<Job>();
+    job->name     = std::move(name);
+    job->fn       = std::move(fn);
+    job->affinity = affinity;
+
+    JobID const id = static_cast<JobID>(m_jobs.size());
+    m_jobs.push_back(std::move(job));
+
+    for(auto dep : dependencies)
+        addDependency(id, dep);
+
+    return id;
+}
+
+void TaskGraph::addDependency(JobID job, JobID depends_on)
+{
+    if(job >= m_jobs.size() || depends_on >= job)
+        EV_EXCEPT("TaskGraph: a job can depend only on the jobs added before it");
+
+    m_jobs[depends_on]->successors.push_back(job);
+    m_jobs[job]->num_dependencies++;
+}
+
+TaskGraph::JobID TaskGraph::findJob(std::string const & name) const
+{
+    for(JobID i = 0; i < m_jobs.size(); ++i)
+    {
+        if(m_jobs[i]->name == name)
+            return i;
+    }
+
+    return invalid_job;
+}
+
+void TaskGraph::clear()
+{
+    assert(mp_pool == nullptr);
+
+    m_jobs.clear();
+}
+
+void TaskGraph::execute(ThreadPool & pool)
+{
+    if(m_jobs.empty())
+        return;
+
+    mp_pool = &pool;
+
+    ReadyJobs & ready = *mp_ready;
+    {
+        std::lock_guard lk(ready.mutex);
+        ready.remaining = m_jobs.size();
+    }
+
+    for(auto & job : m_jobs)
+        job->pending.store(job->num_dependencies, std::memory_order_relaxed);
+
+    for(JobID i = 0; i < m_jobs.size(); ++i)
+    {
+        if(m_jobs[i]->num_dependencies == 0)
+            schedule(i);
+    }
+
+    // the caller jobs first, then the jobs the pool hasn't taken yet
+    std::unique_lock lk(ready.mutex);
+    while(ready.remaining > 0)
+    {
+        auto & queue = !ready.caller.empty() ? ready.caller : ready.any;
+        if(queue.empty())
+        {
+            ready.changed.wait(lk);
+            continue;
+        }
+
+        JobID const id = queue.back();
+        queue.pop_back();
+
+        lk.unlock();
+        runJob(id);
+        lk.lock();
+    }
+
+    mp_pool = nullptr;
+}
+
+void TaskGraph::schedule(JobID id)
+{
+    bool const caller = m_jobs[id]->affinity == Affinity::caller;
+    {
+        std::lock_guard lk(mp_ready->mutex);
+        (caller ? mp_ready->caller : mp_ready->any).push_back(id);
+        mp_ready->changed.notify_one();
+    }
+
+    if(caller)
+        return;
+
+    // any ready job, the job may be run by the caller before the task starts
+    mp_pool->submit([this, ready = mp_ready]() {
+        JobID id = invalid_job;
+        {
+            std::lock_guard lk(ready->mutex);
+            if(ready->any.empty())
+                return;
+
+            id = ready->any.back();
+            ready->any.pop_back();
+        }
+
+        runJob(id);
+    });
+}
+
+void TaskGraph::runJob(JobID id)
+{
+    Job & job = *m_jobs[id];
+
+    try
+    {
+        if(job.fn)
+            job.fn();
+    }
+    catch(std::exception const & ex)
+    {
+        Log::Log(Log::error, Log::cstr_log("TaskGraph job \"%s\" failed: %s", job.name.c_str(), ex.what()));
+    }
+    catch(...)
+    {
+        Log::Log(Log::error, Log::cstr_log("TaskGraph job \"%s\" failed", job.name.c_str()));
+    }
+
+    for(auto succ : job.successors)
+    {
+        if(m_jobs[succ]->pending.fetch_sub(1, std::memory_order_acq_rel) == 1)
+            schedule(succ);
+    }
+
+    std::lock_guard lk(mp_ready->mutex);
+    if(--mp_ready->remaining == 0)
+        mp_ready->changed.notify_one();
+}
+}   // namespace evnt
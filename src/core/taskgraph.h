@@ -0,0 +1,220 @@
+#ifndef TASKGRAPH_H
+#define TASKGRAPH_H
+
+#include "threadpool.h"
+
+#include <algorithm>
+#include <condition_variable>
+#include <functional>
+#include <limits>
+#include <memory>
+#include <mutex>
+#include <string>
+
+namespace evnt
+{
+/**
+ * Completion counter used instead of futures: every job increments it on launch and decrements it when
+ * finished. wait() blocks the calling thread until the counter drops to zero, it doesn't run the other
+ * queued pool tasks meanwhile. So a pool worker must not wait for the tasks queued behind it.
+ */
+class TaskCounter
+{
+public:
+    explicit TaskCounter(int64_t initial = 0) : m_count{initial} {}
+
+    TaskCounter(TaskCounter const &)             = delete;
+    TaskCounter & operator=(TaskCounter const &) = delete;
+
+    void add(int64_t n = 1) { m_count.fetch_add(n, std::memory_order_relaxed); }
+    void decrement()
+    {
+        // under the lock, the waiter may destroy the counter as soon as it sees zero
+        std::lock_guard lk(m_mutex);
+        if(m_count.fetch_sub(1, std::memory_order_acq_rel) == 1)
+            m_zero.notify_all();
+    }
+    void reset(int64_t value) { m_count.store(value, std::memory_order_relaxed); }
+    bool done() const { return m_count.load(std::memory_order_acquire) <= 0; }
+
+    void wait() const
+    {
+        std::unique_lock lk(m_mutex);
+        m_zero.wait(lk, [this] { return done(); });
+    }
+
+private:
+    std::atomic<int64_t>            m_count;
+    mutable std::mutex              m_mutex;
+    mutable std::condition_variable m_zero;
+};
+
+namespace detail
+{
+    // The chunks of one parallel_for. Shared with its pool tasks, a task started after the loop is over
+    // finds no chunk left and doesn't touch the loop.
+    struct ChunkState
+    {
+        std::size_t              num_chunks{0};
+        std::atomic<std::size_t> next{0};   // the first chunk not taken
+        std::atomic<std::size_t> done{0};
+        std::mutex               mutex;
+        std::condition_variable  finished;   // all chunks are done
+    };
+}   // namespace detail
+
+// Splits [first, last) into chunks of 'grain' elements (0 - chosen from the pool size) and calls
+// func(chunk_begin, chunk_end) for each chunk in the pool. The calling thread takes the chunks too, then
+// waits only for the chunks being run by the workers, it never runs unrelated pool tasks.
+// func must not throw.
+template<typename IndexType, typename FunctionType>
+void parallel_for(ThreadPool & pool, IndexType first, IndexType last, FunctionType && func,
+                  IndexType grain = 0)
+{
+    if(first >= last)
+        return;
+
+    IndexType const count = last - first;
+    if(grain <= 0)
+        grain = std::max<IndexType>(1, count / static_cast<IndexType>(4 * (pool.getNumThreads() + 1)));
+
+    if(count <= grain)
+    {
+        func(first, last);
+        return;
+    }
+
+    auto state        = std::make_shared<detail::ChunkState>();
+    state->num_chunks = static_cast<std::size_t>((count - 1) / grain) + 1;
+
+    auto run_chunks = [state, &func, first, last, grain]() {
+        std::size_t chunk;
+        while((chunk = state->next.fetch_add(1, std::memory_order_relaxed)) < state->num_chunks)
+        {
+            IndexType const begin = first + static_cast<IndexType>(chunk) * grain;
+            func(begin, last - begin > grain ? begin + grain : last);
+
+            if(state->done.fetch_add(1, std::memory_order_acq_rel) + 1 == state->num_chunks)
+            {
+                std::lock_guard lk(state->mutex);
+                state->finished.notify_all();
+            }
+        }
+    };
+
+    // the workers and the calling thread take the chunks one by one
+    std::size_t const num_tasks = std::min(state->num_chunks - 1, pool.getNumThreads());
+    for(std::size_t i = 0; i < num_tasks; ++i)
+        pool.submit(run_chunks);
+
+    run_chunks();
+
+    std::unique_lock lk(state->mutex);
+    state->finished.wait(
+        lk, [&state] { return state->done.load(std::memory_order_acquire) == state->num_chunks; });
+}
+
+// Reduces [first, last) in parallel: reduce(chunk_begin, chunk_end, identity) produces one partial result
+// per chunk, partial results are folded with combine() in the range order, so a non-commutative combine
+// gives the same result as the serial loop.
+template<typename ValueType, typename IndexType, typename ReduceFunc, typename CombineFunc>
+ValueType parallel_reduce(ThreadPool & pool, IndexType first, IndexType last, ValueType identity,
+                          ReduceFunc && reduce, CombineFunc && combine, IndexType grain = 0)
+{
+    if(first >= last)
+        return identity;
+
+    IndexType const count = last - first;
+    if(grain <= 0)
+        grain = std::max<IndexType>(1, count / static_cast<IndexType>(4 * (pool.getNumThreads() + 1)));
+
+    std::size_t const      num_chunks = static_cast<std::size_t>((count + grain - 1) / grain);
+    std::vector<ValueType> partial(num_chunks, identity);
+
+    parallel_for(
+        pool, std::size_t{0}, num_chunks,
+        [&](std::size_t chunk_first, std::size_t chunk_last) {
+            for(std::size_t i = chunk_first; i < chunk_last; ++i)
+            {
+                IndexType begin = first + static_cast<IndexType>(i) * grain;
+                IndexType end   = std::min<IndexType>(begin + grain, last);
+                partial[i]      = reduce(begin, end, identity);
+            }
+        },
+        std::size_t{1});
+
+    ValueType res = identity;
+    for(auto & p : partial)
+        res = combine(res, p);
+
+    return res;
+}
+
+/**
+ * Reusable dependency graph of jobs. Jobs are added once and the graph is executed as many times as needed
+ * (for example once per frame). A job may depend only on jobs added before it, so the graph is always
+ * acyclic. Jobs with Affinity::caller are executed by the thread which called execute() (main thread only
+ * work like window events or GL calls), all other jobs are spread over the pool. The calling thread runs the
+ * ready jobs of the graph not taken by the pool yet, it never runs the other pool tasks.
+ */
+class TaskGraph
+{
+public:
+    using JobID = uint32_t;
+
+    enum class Affinity
+    {
+        any,
+        caller
+    };
+
+    inline static JobID const invalid_job = std::numeric_limits<JobID>::max();
+
+    TaskGraph() = default;
+
+    TaskGraph(TaskGraph const &)             = delete;
+    TaskGraph & operator=(TaskGraph const &) = delete;
+
+    JobID addJob(std::string name, std::function<void()> fn, std::vector<JobID> const & dependencies = {},
+                 Affinity affinity = Affinity::any);
+    void  addDependency(JobID job, JobID depends_on);
+
+    JobID       findJob(std::string const & name) const;   // invalid_job if not found
+    std::size_t getNumJobs() const { return m_jobs.size(); }
+    void        clear();
+
+    // Blocks until all jobs are finished, the calling thread executes the jobs of the graph too.
+    void execute(ThreadPool & pool);
+
+private:
+    struct Job
+    {
+        std::string           name;
+        std::function<void()> fn;
+        std::vector<JobID>    successors;
+        uint32_t              num_dependencies{0};
+        Affinity              affinity{Affinity::any};
+        std::atomic<uint32_t> pending{0};
+    };
+
+    // Shared with the pool tasks, a task started after execute() returned finds no job and doesn't touch
+    // the graph.
+    struct ReadyJobs
+    {
+        std::mutex              mutex;
+        std::condition_variable changed;   // a job is ready or all jobs are done
+        std::vector<JobID>      any;       // taken by the pool tasks or the caller
+        std::vector<JobID>      caller;    // Affinity::caller
+        std::size_t             remaining{0};
+    };
+
+    void schedule(JobID id);
+    void runJob(JobID id);
+
+    std::vector<std::unique_ptr<Job>> m_jobs;
+    ThreadPool *                      mp_pool{nullptr};   // valid during execute()
+    std::shared_ptr<ReadyJobs>        mp_ready{std::make_shared<ReadyJobs>()};
+};
+}   // namespace evnt
+
+#endif   // TASKGRAPH_H
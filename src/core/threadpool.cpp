@@ -0,0 +1,279 @@
+#include "threadpool.h"
+
+namespace evnt
+{
+namespace
+{
+    constexpr std::size_t node_block_size  = 64;
+    constexpr std::size_t node_cache_limit = 256;   // worker returns half of its cache when exceeded
+    constexpr uint32_t    spin_count       = 64;    // steal attempts before going to sleep
+}   // namespace
+
+thread_local ThreadPool::WorkerContext ThreadPool::ts_context;
+
+ThreadPool::~ThreadPool()
+{
+    // Force all workers to return, tasks which are still queued are dropped.
+    {
+        std::lock_guard lk(m_sleep_mutex);
+        m_stop = true;
+    }
+    m_sleep_cv.notify_all();
+
+    for(auto & w : m_workers)
+    {
+        if(w->thread.joinable())
+            w->thread.join();
+    }
+
+    // destroy not executed tasks, the nodes memory is owned by m_node_blocks
+    for(auto & w : m_workers)
+    {
+        TaskNode * node = nullptr;
+        while(w->deque.pop(node))
+            node->task.reset();
+
+        for(auto * n : w->inbox)
+            n->task.reset();
+    }
+}
+
+void ThreadPool::createPoolThreads(std::size_t pool_size)
+{
+    m_workers.reserve(pool_size);
+    for(std::size_t i = 0; i < pool_size; ++i)
+        m_workers.push_back(std::make_unique<Worker>());
+
+    // start threads after all workers are created, so stealing never sees a partially built vector
+    for(std::size_t i = 0; i < pool_size; ++i)
+        m_workers[i]->thread = std::thread([this, i]() { workerLoop(i); });
+}
+
+void ThreadPool::workerLoop(std::size_t index)
+{
+    ts_context.pool  = this;
+    ts_context.index = index;
+
+    uint32_t idle_spins = 0;
+    while(!m_stop.load(std::memory_order_relaxed))
+    {
+        TaskNode * node = nullptr;
+        if(findTask(index, node))
+        {
+            idle_spins = 0;
+            runTask(node);
+            continue;
+        }
+
+        if(++idle_spins < spin_count)
+        {
+            std::this_thread::yield();
+            continue;
+        }
+
+        idle_spins = 0;
+        ++m_num_sleeping;
+        {
+            std::unique_lock lk(m_sleep_mutex);
+            m_sleep_cv.wait(lk, [this] { return m_stop || m_num_queued.load() > 0; });
+        }
+        --m_num_sleeping;
+    }
+
+    ts_context = WorkerContext{};
+}
+
+void ThreadPool::enqueue(Task task)
+{
+    TaskNode * node = acquireNode();
+    node->task      = std::move(task);
+
+    ++m_num_tasks;
+
+    if(ts_context.pool == this)
+    {
+        m_workers[ts_context.index]->deque.push(node);
+    }
+    else
+    {
+        auto & w = *m_workers[m_next_inbox.fetch_add(1, std::memory_order_relaxed) % m_workers.size()];
+
+        std::lock_guard lk(w.inbox_mutex);
+        w.inbox.push_back(node);
+    }
+
+    ++m_num_queued;
+    wakeWorker();
+}
+
+void ThreadPool::wakeWorker()
+{
+    // m_num_queued is incremented before the check, a worker going to sleep rechecks it under the mutex
+    if(m_num_sleeping.load() > 0)
+    {
+        {
+            std::lock_guard lk(m_sleep_mutex);
+        }
+        m_sleep_cv.notify_one();
+    }
+}
+
+bool ThreadPool::runPendingTask()
+{
+    TaskNode * node  = nullptr;
+    bool       found = false;
+
+    if(ts_context.pool == this)
+    {
+        found = findTask(ts_context.index, node);
+    }
+    else
+    {
+        found = stealTask(0, m_workers.size(), node);
+        if(found)
+            --m_num_queued;
+    }
+
+    if(found)
+        runTask(node);
+
+    return found;
+}
+
+bool ThreadPool::findTask(std::size_t index, TaskNode *& node)
+{
+    auto & self = *m_workers[index];
+
+    // own tasks in LIFO order
+    bool found = self.deque.pop(node);
+
+    // tasks from outside the pool in FIFO order
+    if(!found)
+    {
+        std::lock_guard lk(self.inbox_mutex);
+        if(!self.inbox.empty())
+        {
+            node = self.inbox.front();
+            self.inbox.pop_front();
+            found = true;
+        }
+    }
+
+    // steal from the other workers
+    if(!found)
+        found = stealTask(index + 1, m_workers.size() - 1, node);
+
+    if(found)
+        --m_num_queued;
+
+    return found;
+}
+
+bool ThreadPool::stealTask(std::size_t first_victim, std::size_t num_victims, TaskNode *& node)
+{
+    std::size_t const num_workers = m_workers.size();
+
+    for(std::size_t i = 0; i < num_victims; ++i)
+    {
+        auto & victim = *m_workers[(first_victim + i) % num_workers];
+
+        if(victim.deque.steal(node))
+            return true;
+
+        std::unique_lock lk(victim.inbox_mutex, std::try_to_lock);
+        if(lk.owns_lock() && !victim.inbox.empty())
+        {
+            node = victim.inbox.front();
+            victim.inbox.pop_front();
+            return true;
+        }
+    }
+
+    return false;
+}
+
+void ThreadPool::runTask(TaskNode * node)
+{
+    // Run the user supplied task.
+    try
+    {
+        node->task();
+    }
+    // Suppress all exceptions.
+    catch(...)
+    {}
+
+    releaseNode(node);
+    --m_num_tasks;
+}
+
+ThreadPool::TaskNode * ThreadPool::acquireNode()
+{
+    if(ts_context.pool == this)
+    {
+        auto & cache = m_workers[ts_context.index]->free_nodes;
+        if(cache.empty())
+        {
+            std::lock_guard lk(m_nodes_mutex);
+            while(mp_free_nodes != nullptr && cache.size() < node_block_size)
+            {
+                cache.push_back(mp_free_nodes);
+                mp_free_nodes = mp_free_nodes->next;
+            }
+
+            if(cache.empty())
+            {
+                m_node_blocks.push_back(std::make_unique<TaskNode[]>(node_block_size));
+                for(std::size_t i = 0; i < node_block_size; ++i)
+                    cache.push_back(&m_node_blocks.back()[i]);
+            }
+        }
+
+        TaskNode * node = cache.back();
+        cache.pop_back();
+        return node;
+    }
+
+    std::lock_guard lk(m_nodes_mutex);
+    if(mp_free_nodes == nullptr)
+    {
+        m_node_blocks.push_back(std::make_unique<TaskNode[]>(node_block_size));
+        for(std::size_t i = 0; i < node_block_size; ++i)
+        {
+            m_node_blocks.back()[i].next = mp_free_nodes;
+            mp_free_nodes                = &m_node_blocks.back()[i];
+        }
+    }
+
+    TaskNode * node = mp_free_nodes;
+    mp_free_nodes   = node->next;
+    return node;
+}
+
+void ThreadPool::releaseNode(TaskNode * node)
+{
+    node->task.reset();
+
+    if(ts_context.pool == this)
+    {
+        auto & cache = m_workers[ts_context.index]->free_nodes;
+        cache.push_back(node);
+
+        if(cache.size() > node_cache_limit)
+        {
+            std::lock_guard lk(m_nodes_mutex);
+            while(cache.size() > node_cache_limit / 2)
+            {
+                cache.back()->next = mp_free_nodes;
+                mp_free_nodes      = cache.back();
+                cache.pop_back();
+            }
+        }
+        return;
+    }
+
+    std::lock_guard lk(m_nodes_mutex);
+    node->next    = mp_free_nodes;
+    mp_free_nodes = node;
+}
+}   // namespace evnt
@@ -1,116 +1,128 @@
 #ifndef THREADPOOL_H
 #define THREADPOOL_H
 
+#include "task.h"
+#include "workstealingqueue.h"
+
 #include <atomic>
-#include <boost/asio.hpp>
+#include <condition_variable>
+#include <deque>
 #include <future>
+#include <mutex>
 #include <thread>
 #include <vector>
 
 namespace evnt
 {
+/**
+ * Work-stealing thread pool.
+ * Every worker owns a Chase-Lev deque: tasks submitted from a worker go to its own deque, tasks submitted
+ * from outside the pool are spread round-robin over per-worker inboxes. Idle workers steal from the others.
+ * Tasks are stored in recycled nodes with inline storage (see Task), so submit() of a small callable
+ * doesn't allocate.
+ */
 class ThreadPool
 {
-private:
-    boost::asio::io_service       m_io_serv;
-    boost::asio::io_service::work m_work;
-    std::vector<std::thread>      m_threads;
-    std::atomic_size_t            m_num_tasks;
+    struct TaskNode
+    {
+        Task       task;
+        TaskNode * next{nullptr};
+    };
+
+    struct Worker
+    {
+        WorkStealingQueue<TaskNode *> deque;
+        std::mutex                    inbox_mutex;
+        std::deque<TaskNode *>        inbox;
+        std::vector<TaskNode *>       free_nodes;   // accessed by the owner thread only
+        std::thread                   thread;
+    };
+
+    struct WorkerContext
+    {
+        ThreadPool const * pool{nullptr};
+        std::size_t        index{0};
+    };
+
+    static thread_local WorkerContext ts_context;
+
+    std::vector<std::unique_ptr<Worker>> m_workers;
+    std::atomic_size_t                   m_num_tasks{0};
+    std::atomic<int64_t>                 m_num_queued{0};   // tasks not yet taken by workers
+    std::atomic_size_t                   m_next_inbox{0};
+    std::atomic_bool                     m_stop{false};
+
+    std::atomic<uint32_t>   m_num_sleeping{0};
+    std::mutex              m_sleep_mutex;
+    std::condition_variable m_sleep_cv;
+
+    // task nodes shared between threads
+    std::mutex                               m_nodes_mutex;
+    TaskNode *                               mp_free_nodes{nullptr};
+    std::vector<std::unique_ptr<TaskNode[]>> m_node_blocks;
 
 public:
     ThreadPool(ThreadPool const &)             = delete;
     ThreadPool & operator=(ThreadPool const &) = delete;
 
-    ThreadPool() : m_io_serv(), m_work(m_io_serv), m_num_tasks(0)
+    ThreadPool()
     {
         uint32_t    num_cores = std::thread::hardware_concurrency();
         std::size_t pool_size = std::max<uint32_t>(1, num_cores - 1);   // 2 threads on single core system
         createPoolThreads(pool_size);
     }
 
-    ThreadPool(std::size_t pool_size) : m_io_serv(), m_work(m_io_serv), m_num_tasks(0)
-    {
-        createPoolThreads(pool_size);
-    }
+    ThreadPool(std::size_t pool_size) { createPoolThreads(pool_size); }
 
-    ~ThreadPool()
-    {
-        // Force all threads to return from io_service::run().
-        m_io_serv.stop();
-
-        for(auto & th : m_threads)
-        {
-            if(th.joinable())
-                th.join();
-        }
-    }
+    ~ThreadPool();
 
     std::size_t getNumTasks() const { return m_num_tasks; }
+    std::size_t getNumThreads() const { return m_workers.size(); }
+    // Index of the calling worker thread in this pool, -1 if called from outside
+    int32_t getCurrentThreadIndex() const
+    {
+        return ts_context.pool == this ? static_cast<int32_t>(ts_context.index) : -1;
+    }
 
     template<typename FunctionType,
-             typename = std::enable_if_t<!std::is_void_v<std::result_of_t<FunctionType()>>>>
+             std::enable_if_t<!std::is_void_v<std::result_of_t<FunctionType()>>, int> = 0>
     auto submit(FunctionType && f)
     {
         using result_type = typename std::result_of_t<FunctionType()>;
         using task_type   = typename std::packaged_task<result_type()>;
 
-        // https://stackoverflow.com/questions/13157502/how-do-you-post-a-boost-packaged-task-to-an-io-service-in-c03
-        auto ff = [this, f = std::forward<FunctionType>(f)]() -> result_type {
-            return wrapTask(std::move(f));
-        };
-        auto                     task = std::make_shared<task_type>(std::move(ff));
-        std::future<result_type> res  = task->get_future();
+        task_type                task(std::forward<FunctionType>(f));
+        std::future<result_type> res = task.get_future();
 
-        ++m_num_tasks;
-        m_io_serv.post(std::bind(&task_type::operator(), task));
+        enqueue(Task(std::move(task)));
 
         return res;
     }
 
-    void submit(std::function<void()> f)
+    // Exceptions thrown by void tasks are suppressed.
+    template<typename FunctionType,
+             std::enable_if_t<std::is_void_v<std::result_of_t<FunctionType()>>, int> = 0>
+    void submit(FunctionType && f)
     {
-        auto ff = [this, f = std::move(f)]() {
-            wrapTask(std::move(f));
-        };
-
-        ++m_num_tasks;
-        m_io_serv.post(ff);
+        enqueue(Task(std::forward<FunctionType>(f)));
     }
 
-private:
-    /// Wrap a task so that the available count can be decreased
-    template<typename FunctionType,
-             typename = std::enable_if_t<!std::is_void_v<std::result_of_t<FunctionType()>>>>
-    auto wrapTask(FunctionType f)
-    {
-        using result_type = typename std::result_of_t<FunctionType()>;
+    // Runs one queued task on the calling thread, returns false if nothing was found. Any task may be run,
+    // the waits for a particular task use it only when blocking could deadlock the pool.
+    bool runPendingTask();
 
-        result_type res = f();
-        --m_num_tasks;
-        return res;
-    }
+private:
+    void createPoolThreads(std::size_t pool_size);
+    void workerLoop(std::size_t index);
 
-    void wrapTask(std::function<void()> f)
-    {
-        // Run the user supplied task.
-        try
-        {
-            f();
-        }
-        // Suppress all exceptions.
-        catch(...)
-        {}
-
-        --m_num_tasks;
-    }
+    void enqueue(Task task);
+    bool findTask(std::size_t index, TaskNode *& node);
+    bool stealTask(std::size_t first_victim, std::size_t num_victims, TaskNode *& node);
+    void runTask(TaskNode * node);
+    void wakeWorker();
 
-    void createPoolThreads(std::size_t pool_size)
-    {
-        for(std::size_t i = 0; i < pool_size; ++i)
-        {
-            m_threads.emplace_back([this]() { m_io_serv.run(); });
-        }
-    }
+    TaskNode * acquireNode();
+    void       releaseNode(TaskNode * node);
 };
 }   // namespace evnt
 
@@ -0,0 +1,160 @@
+#ifndef WORKSTEALINGQUEUE_H
+#define WORKSTEALINGQUEUE_H
+
+#include <atomic>
+#include <cassert>
+#include <cstdint>
+#include <memory>
+#include <type_traits>
+#include <vector>
+
+namespace evnt
+{
+/**
+ * Chase-Lev work-stealing deque.
+ * The owner thread pushes and pops at the bottom (LIFO), any other thread steals from the top (FIFO).
+ * Memory orderings follow "Correct and Efficient Work-Stealing for Weak Memory Models" (Le et al., 2013).
+ * T must be trivially copyable (pointers or indices).
+ */
+template<typename T>
+class WorkStealingQueue
+{
+    static_assert(std::is_trivially_copyable_v<T>,
+                  "WorkStealingQueue only supports trivially copyable types");
+
+    struct Array
+    {
+        int64_t                           capacity;
+        int64_t                           mask;
+        std::unique_ptr<std::atomic<T>[]> items;
+
+        explicit Array(int64_t cap) :
+            capacity{cap},
+            mask{cap - 1},
+            items{std::make_unique<std::atomic<T>[]>(static_cast<size_t>(cap))}
+        {}
+
+        void put(int64_t i, T item) { items[i & mask].store(item, std::memory_order_relaxed); }
+        T    get(int64_t i) const { return items[i & mask].load(std::memory_order_relaxed); }
+    };
+
+    alignas(64) std::atomic<int64_t> m_top{0};
+    alignas(64) std::atomic<int64_t> m_bottom{0};
+    alignas(64) std::atomic<Array *> mp_array;
+    // Arrays replaced by grow() may still be read by thieves, so they live until the queue is destroyed.
+    std::vector<std::unique_ptr<Array>> m_arrays;
+
+public:
+    explicit WorkStealingQueue(int64_t capacity = 1024)
+    {
+        assert(capacity > 0 && (capacity & (capacity - 1)) == 0);   // power of 2
+
+        m_arrays.push_back(std::make_unique<Array>(capacity));
+        mp_array.store(m_arrays.back().get(), std::memory_order_relaxed);
+    }
+
+    WorkStealingQueue(WorkStealingQueue const &)             = delete;
+    WorkStealingQueue & operator=(WorkStealingQueue const &) = delete;
+
+    bool empty() const
+    {
+        int64_t b = m_bottom.load(std::memory_order_relaxed);
+        int64_t t = m_top.load(std::memory_order_relaxed);
+        return b <= t;
+    }
+
+    size_t size() const
+    {
+        int64_t b = m_bottom.load(std::memory_order_relaxed);
+        int64_t t = m_top.load(std::memory_order_relaxed);
+        return static_cast<size_t>(b >= t ? b - t : 0);
+    }
+
+    // owner thread only
+    void push(T item)
+    {
+        int64_t b = m_bottom.load(std::memory_order_relaxed);
+        int64_t t = m_top.load(std::memory_order_acquire);
+        Array * a = mp_array.load(std::memory_order_relaxed);
+
+        if(b - t > a->capacity - 1)
+            a = grow(a, b, t);
+
+        a->put(b, item);
+        std::atomic_thread_fence(std::memory_order_release);
+        m_bottom.store(b + 1, std::memory_order_relaxed);
+    }
+
+    // owner thread only
+    bool pop(T & item)
+    {
+        int64_t b = m_bottom.load(std::memory_order_relaxed) - 1;
+        Array * a = mp_array.load(std::memory_order_relaxed);
+        m_bottom.store(b, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        int64_t t = m_top.load(std::memory_order_relaxed);
+
+        bool res = false;
+        if(t <= b)
+        {
+            item = a->get(b);
+            res  = true;
+
+            if(t == b)
+            {
+                // last item, race against thieves
+                if(!m_top.compare_exchange_strong(t, t + 1, std::memory_order_seq_cst,
+                                                  std::memory_order_relaxed))
+                    res = false;
+
+                m_bottom.store(b + 1, std::memory_order_relaxed);
+            }
+        }
+        else
+        {
+            m_bottom.store(b + 1, std::memory_order_relaxed);
+        }
+
+        return res;
+    }
+
+    // any thread
+    bool steal(T & item)
+    {
+        int64_t t = m_top.load(std::memory_order_acquire);
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        int64_t b = m_bottom.load(std::memory_order_acquire);
+
+        if(t < b)
+        {
+            Array * a   = mp_array.load(std::memory_order_acquire);
+            T       tmp = a->get(t);
+
+            if(!m_top.compare_exchange_strong(t, t + 1, std::memory_order_seq_cst, std::memory_order_relaxed))
+                return false;
+
+            item = tmp;
+            return true;
+        }
+
+        return false;
+    }
+
+private:
+    Array * grow(Array * a, int64_t b, int64_t t)
+    {
+        auto new_array = std::make_unique<Array>(a->capacity * 2);
+
+        for(int64_t i = t; i != b; ++i)
+            new_array->put(i, a->get(i));
+
+        Array * ptr = new_array.get();
+        m_arrays.push_back(std::move(new_array));
+        mp_array.store(ptr, std::memory_order_release);
+
+        return ptr;
+    }
+};
+}   // namespace evnt
+
+#endif   // WORKSTEALINGQUEUE_H
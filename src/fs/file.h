@@ -1,6 +1,7 @@
 #ifndef FILE_H
 #define FILE_H
 
+#include "file_mapping.h"
 #include "memory_stream.h"
 #include <ctime>
 
@@ -54,6 +55,15 @@ public:
         std::swap(m_name, name);
         m_last_write_time = timestamp;
     }
+    // zero-copy view of size bytes at offset in the mapping, the file keeps the mapping alive
+    InFile(std::string name, std::time_t timestamp, std::shared_ptr<FileMapping const> mapping,
+           size_t offset, size_t size) :
+        m_data(mapping->getData() + offset, size), mp_mapping{std::move(mapping)}
+    {
+        assert(offset + size <= mp_mapping->getSize());
+        std::swap(m_name, name);
+        m_last_write_time = timestamp;
+    }
     InFile(OutFile const & outfile)
     {
         m_name            = outfile.getName();
@@ -65,13 +75,19 @@ public:
     }
     ~InFile() override = default;
 
+    InFile(InFile const &)             = default;
+    InFile & operator=(InFile const &) = default;
+    InFile(InFile &&)                  = default;
+    InFile & operator=(InFile &&)      = default;
+
     int8_t const * getData() const override { return m_data.getPtr(); }
     size_t         getFileSize() const override { return m_data.getCapacity(); }
 
     InputMemoryStream & getStream() { return m_data; }
 
 private:
-    InputMemoryStream m_data;
+    InputMemoryStream                  m_data;
+    std::shared_ptr<FileMapping const> mp_mapping;   // keeps the data of a mapped file alive
 };
 }   // namespace evnt
 #endif   // FILE_H
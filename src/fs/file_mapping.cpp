@@ -0,0 +1,113 @@
+#include "file_mapping.h"
+
+#include <algorithm>
+
+#ifdef _WIN32
+#    define WIN32_LEAN_AND_MEAN
+#    include <windows.h>
+#else
+#    include <fcntl.h>
+#    include <sys/mman.h>
+#    include <sys/stat.h>
+#    include <unistd.h>
+#endif
+
+namespace evnt
+{
+#ifdef _WIN32
+FileMapping::~FileMapping()
+{
+    if(mp_data != nullptr)
+        UnmapViewOfFile(mp_data);
+    if(mp_mapping != nullptr)
+        CloseHandle(mp_mapping);
+}
+
+std::shared_ptr<FileMapping> FileMapping::Map(std::string const & fname)
+{
+    HANDLE file = CreateFileA(fname.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING,
+                              FILE_ATTRIBUTE_NORMAL, nullptr);
+    if(file == INVALID_HANDLE_VALUE)
+        return {};
+
+    LARGE_INTEGER size;
+    if(!GetFileSizeEx(file, &size) || size.QuadPart <= 0)
+    {
+        CloseHandle(file);
+        return {};
+    }
+
+    // the mapping object keeps the file open
+    HANDLE mapping = CreateFileMappingA(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+    CloseHandle(file);
+    if(mapping == nullptr)
+        return {};
+
+    void * data = MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+    if(data == nullptr)
+    {
+        CloseHandle(mapping);
+        return {};
+    }
+
+    std::shared_ptr<FileMapping> res(new FileMapping());
+    res->mp_data    = static_cast<int8_t const *>(data);
+    res->m_size     = static_cast<std::size_t>(size.QuadPart);
+    res->mp_mapping = mapping;
+
+    return res;
+}
+
+void FileMapping::prefetch(std::size_t offset, std::size_t size) const
+{
+    // PrefetchVirtualMemory needs Windows 8, the pages are read on the first access
+    (void)offset;
+    (void)size;
+}
+#else
+FileMapping::~FileMapping()
+{
+    if(mp_data != nullptr)
+        munmap(const_cast<int8_t *>(mp_data), m_size);
+}
+
+std::shared_ptr<FileMapping> FileMapping::Map(std::string const & fname)
+{
+    int fd = open(fname.c_str(), O_RDONLY);
+    if(fd < 0)
+        return {};
+
+    struct stat st;
+    if(fstat(fd, &st) != 0 || st.st_size <= 0)
+    {
+        close(fd);
+        return {};
+    }
+
+    std::size_t const size = static_cast<std::size_t>(st.st_size);
+    void *            data = mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);   // the mapping keeps a reference to the file
+    if(data == MAP_FAILED)
+        return {};
+
+    std::shared_ptr<FileMapping> res(new FileMapping());
+    res->mp_data = static_cast<int8_t const *>(data);
+    res->m_size  = size;
+
+    return res;
+}
+
+void FileMapping::prefetch(std::size_t offset, std::size_t size) const
+{
+    if(offset >= m_size)
+        return;
+
+    // the address must be page aligned
+    std::size_t const page  = static_cast<std::size_t>(sysconf(_SC_PAGESIZE));
+    std::size_t const begin = offset / page * page;
+    std::size_t const end   = std::min(offset + size, m_size);
+
+    posix_madvise(const_cast<int8_t *>(mp_data) + begin, end - begin, POSIX_MADV_WILLNEED);
+}
+#endif
+}   // namespace evnt
@@ -0,0 +1,43 @@
+#ifndef FILEMAPPING_H
+#define FILEMAPPING_H
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+
+namespace evnt
+{
+/**
+ * Read-only memory mapping of a whole file. The pages are shared with the OS page cache, files viewing the
+ * mapping (see InFile) hold a shared_ptr to keep it alive. The mapped data must not be written.
+ */
+class FileMapping
+{
+public:
+    ~FileMapping();
+
+    FileMapping(FileMapping const &)             = delete;
+    FileMapping & operator=(FileMapping const &) = delete;
+
+    // nullptr if the file can't be opened or mapped, empty files are not mapped
+    static std::shared_ptr<FileMapping> Map(std::string const & fname);
+
+    int8_t const * getData() const { return mp_data; }
+    std::size_t    getSize() const { return m_size; }
+
+    // asks the OS to read the range in ahead of access with one large request
+    void prefetch(std::size_t offset, std::size_t size) const;
+
+private:
+    FileMapping() = default;
+
+    int8_t const * mp_data{nullptr};
+    std::size_t    m_size{0};
+#ifdef _WIN32
+    void * mp_mapping{nullptr};   // HANDLE of the file mapping object
+#endif
+};
+}   // namespace evnt
+
+#endif   // FILEMAPPING_H
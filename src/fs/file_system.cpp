@@ -1,5 +1,7 @@
 #include "file_system.h"
 #include "../core/exception.h"
+#include "../core/taskgraph.h"
+#include "../core/threadpool.h"
 #include "../log/log.h"
 #include <random>
 #include <algorithm>
@@ -7,9 +9,13 @@
 #include <chrono>
 #include <filesystem>
 #include <fstream>
+#include <limits>
+#include <tuple>
 #include <zlib.h>
 
 #include "zip.h"
+#include "zip_directory.h"
+#include "zip_writer.h"
 
 // https://medium.com/@sshambir/%D0%BF%D1%80%D0%B8%D0%B2%D0%B5%D1%82-std-filesystem-4c7ed50d5634
 namespace evnt
@@ -17,6 +23,26 @@ namespace evnt
 // namespace fs = boost::filesystem;
 namespace fs = std::filesystem;
 
+namespace
+{
+    // the readers of the old file keep its data, written is false if the temporary file is incomplete
+    bool ReplaceFile(std::string const & temp_path, std::string const & path, bool written)
+    {
+        std::error_code ec;
+        if(written)
+            fs::rename(temp_path, path, ec);
+
+        if(!written || ec)
+        {
+            fs::remove(temp_path, ec);
+            Log::Log(Log::error, Log::cstr_log("FileSystem: \"%s\" - not written", path.c_str()));
+            return false;
+        }
+
+        return true;
+    }
+}   // namespace
+
 std::string FileSystem::GetTempDir()
 {
     return fs::temp_directory_path().generic_string();
@@ -62,12 +88,12 @@ std::string FileSystem::GetTempFileName()
     return generate_random_alphanumeric_string(10) + ".tmp";
 }
 
-FileSystem::FileSystem(std::string root_dir)
+FileSystem::FileSystem(std::string root_dir, ThreadPool * pool) : mp_thread_pool{pool}
 {
     assert(!root_dir.empty());
 
     std::swap(m_data_dir, root_dir);
-    std::list<std::string> zip_file_list;
+    std::vector<std::string> zip_file_list;
 
     fs::path p(m_data_dir);
 
@@ -87,184 +113,318 @@ FileSystem::FileSystem(std::string root_dir)
                     std::string tmp_fname = lp.generic_string();
                     tmp_fname.erase(0, m_data_dir.length() + 1);
 
-                    file_data fd;
-                    fd.fname = tmp_fname;
-
-                    m_files.emplace_back(std::move(fd));
+                    addFile(tmp_fname, {});
                 }
             }
         }
     }
 
-    if(!zip_file_list.empty())
-        std::for_each(zip_file_list.begin(), zip_file_list.end(),
-                      [this](std::string const & fname) { this->addZippedDir(fname); });
+    // the directories are read in parallel, the files are added in the order of the walk so the first file
+    // with the same name is the same as with the serial scan
+    std::vector<ZipDirectory> zip_dirs(zip_file_list.size());
+    auto                      read_dirs = [&zip_file_list, &zip_dirs](size_t first, size_t last) {
+        for(size_t i = first; i < last; ++i)
+            zip_dirs[i].valid = ReadZipDirectory(zip_file_list[i], zip_dirs[i]);
+    };
+
+    if(mp_thread_pool != nullptr && zip_file_list.size() > 1)
+        parallel_for(*mp_thread_pool, size_t{0}, zip_file_list.size(), read_dirs, size_t{1});
+    else
+        read_dirs(0, zip_file_list.size());
+
+    for(size_t i = 0; i < zip_file_list.size(); ++i)
+    {
+        if(zip_dirs[i].valid)
+            addZippedDir(zip_file_list[i], zip_dirs[i]);
+    }
 }
 
-void FileSystem::addZippedDir(std::string const & fname)
+FileSystem::~FileSystem()
 {
-    std::ifstream ifs;
-    ifs.open(fname, std::ifstream::in | std::ifstream::binary);
-    if(!ifs.is_open())
+    stopWatching();
+
     {
-        Log::Log(Log::error,
-                 Log::cstr_log("FileSystem::AddZippedDir File: \"%s\" - not found", fname.c_str()));
-        return;
+        std::unique_lock lk(m_io_mutex);
+        m_io_stop = true;
+        m_io_cv.notify_one();
+
+        // inflate tasks in the pool use the file table
+        m_io_done_cv.wait(lk, [this] { return m_io_pending == 0; });
     }
 
-    // get length of file:
-    ifs.seekg(0, std::ifstream::end);
-    size_t const fileSize    = static_cast<size_t>(ifs.tellg());
-    size_t       EOCD_offset = 0;
+    if(m_io_thread.joinable())
+        m_io_thread.join();
+}
 
-    for(size_t offset = fileSize - sizeof(EOCD); offset != 0; --offset)
-    {
-        uint32_t signature = 0;
+void FileSystem::addFile(std::string_view fname, file_data fd)
+{
+    auto [interned, inserted] = m_index.insert(fname, static_cast<uint32_t>(m_files.size()));
+    fd.fname                  = interned;   // lives as long as the index
 
-        ifs.seekg(offset, std::ifstream::beg);
-        ifs.read(reinterpret_cast<char *>(&signature), sizeof(signature));
+    if(inserted)
+    {
+        m_files.push_back(fd);
+        return;
+    }
 
-        if(0x06054b50 == signature)
-        {
-            EOCD_offset = static_cast<size_t>(ifs.tellg());
-            break;
-        }
+    // created again after it was removed
+    auto & existed = m_files[m_index.find(interned)];
+    if(existed.removed)
+    {
+        existed = fd;
+        --m_num_removed;
     }
+}
 
-    if(EOCD_offset == 0)
+uint32_t FileSystem::findFile(std::string_view fname) const
+{
+    uint32_t const index = m_index.find(fname);
+    return index != PathIndex::npos && !m_files[index].removed ? index : PathIndex::npos;
+}
+
+bool FileSystem::ReadZipDirectory(std::string const & fname, ZipDirectory & dir)
+{
+    std::ifstream ifs(fname, std::ifstream::binary);
+    if(!ifs.is_open())
     {
         Log::Log(Log::error,
-                 Log::cstr_log("FileSystem::AddZippedDir File: \"%s\" - not found EOCD_offset signature",
-                               fname.c_str()));
-        return;
+                 Log::cstr_log("FileSystem::ReadZipDirectory File: \"%s\" - not found", fname.c_str()));
+        return false;
     }
 
-    EOCD eocd{};
-    ifs.seekg(EOCD_offset, std::ifstream::beg);
-    ifs.read(reinterpret_cast<char *>(&eocd), sizeof(eocd));
+    ZipCentralDirectory cd;
+    if(!ReadZipCentralDirectory(ifs, fname, cd))
+        return false;
+
+    dir.central_dir = std::move(cd.data);
 
-    ifs.seekg(eocd.centralDirectoryOffset, std::ifstream::beg);
-    CentralDirectoryFileHeader cdfh{};
+    char const * const data = dir.central_dir.data();
+    size_t             pos  = 0;
+    dir.entries.reserve(static_cast<size_t>(cd.num_entries));
 
-    for(uint16_t i = 0; i < eocd.numberCentralDirectoryRecord; ++i)
+    for(uint64_t i = 0; i < cd.num_entries; ++i)
     {
-        file_data zfile;
-        zfile.is_zip = true;
+        CentralDirectoryFileHeader cdfh{};
+        if(pos + sizeof(cdfh) <= dir.central_dir.size())
+            std::memcpy(&cdfh, data + pos, sizeof(cdfh));
 
-        ifs.read(reinterpret_cast<char *>(&cdfh), sizeof(cdfh));
+        size_t const name_pos  = pos + sizeof(cdfh);
+        size_t const extra_pos = name_pos + cdfh.filenameLength;
+        pos                    = extra_pos + cdfh.extraFieldLength + cdfh.fileCommentLength;
 
-        if(0x02014b50 != cdfh.signature)
+        if(0x02014b50 != cdfh.signature || pos > dir.central_dir.size())
         {
-            Log::Log(
-                Log::error,
-                Log::cstr_log(
-                    "FileSystem::AddZippedDir File: \"%s\" - not found CentralDirectoryFileHeader signature",
-                    fname.c_str()));
-            return;
+            Log::Log(Log::error,
+                     Log::cstr_log("FileSystem::ReadZipDirectory File: \"%s\" - corrupted central directory",
+                                   fname.c_str()));
+            return false;
         }
 
         if(cdfh.generalPurposeBitFlag & 0x1)   // encrypted
         {
             Log::Log(Log::error,
-                     Log::cstr_log("FileSystem::AddZippedDir File: \"%s\" - encrypted", fname.c_str()));
-            return;
-        }
-        if(cdfh.generalPurposeBitFlag & 0x8)   // DataDescr Struct
-        {
-            Log::Log(Log::error, Log::cstr_log("FileSystem::AddZippedDir File: \"%s\" - DataDescr Struct",
-                                               fname.c_str()));
-            return;
+                     Log::cstr_log("FileSystem::ReadZipDirectory File: \"%s\" - encrypted", fname.c_str()));
+            return false;
         }
 
-        if(cdfh.filenameLength)
-        {
-            std::unique_ptr<char[]> filename = std::make_unique<char[]>(cdfh.filenameLength + 1);
-            ifs.read(reinterpret_cast<char *>(filename.get()), cdfh.filenameLength);
+        // entries with a data descriptor (bit 3) are fine, the sizes in the central directory are valid
 
-            filename[cdfh.filenameLength] = 0;
+        if(cdfh.compressionMethod != 0 && cdfh.compressionMethod != Z_DEFLATED)
+            continue;
 
-            zfile.zip_data.fname = std::string(filename.get());
-        }
+        uint64_t uncompressed = cdfh.uncompressedSize;
+        uint64_t compressed   = cdfh.compressedSize;
+        uint64_t lfh_offset   = cdfh.localFileHeaderOffset;
 
-        if(cdfh.compressionMethod != 0 && cdfh.compressionMethod != Z_DEFLATED)
+        if((uncompressed == 0xFFFFFFFF || compressed == 0xFFFFFFFF || lfh_offset == 0xFFFFFFFF)
+           && !ReadZip64ExtraField(data + extra_pos, cdfh.extraFieldLength, uncompressed, compressed,
+                                   lfh_offset))
         {
-            continue;
+            Log::Log(Log::error,
+                     Log::cstr_log("FileSystem::ReadZipDirectory File: \"%s\" - corrupted ZIP64 extra field",
+                                   fname.c_str()));
+            return false;
         }
 
-        zfile.zip_data.compressed       = (Z_DEFLATED == cdfh.compressionMethod);
-        zfile.zip_data.compressedSize   = cdfh.compressedSize;
-        zfile.zip_data.uncompressedSize = cdfh.uncompressedSize;
-        zfile.zip_data.lfhOffset        = cdfh.localFileHeaderOffset;
+        file_data::ZFileData zd;
+        zd.compressed       = (Z_DEFLATED == cdfh.compressionMethod);
+        zd.compressedSize   = static_cast<size_t>(compressed);
+        zd.uncompressedSize = static_cast<size_t>(uncompressed);
+        zd.lfhOffset        = static_cast<size_t>(lfh_offset);
+
+        // local headers usually repeat the name and the extra field of the central directory
+        zd.lfhSize = sizeof(LocalFileHeader) + cdfh.filenameLength + cdfh.extraFieldLength;
+
+        if(zd.uncompressedSize != 0 || zd.compressed)
+            dir.entries.emplace_back(std::string_view(data + name_pos, cdfh.filenameLength), zd);
+    }
+
+    return true;
+}
+
+void FileSystem::addZippedDir(std::string const & fname, ZipDirectory const & dir)
+{
+    // interned once, a replaced archive keeps its string
+    auto it = m_archives.find(fname);
+    if(it == m_archives.end())
+        it = m_archives.insert(m_index.intern(fname)).first;
+
+    std::string_view const archive = *it;
+    m_index.reserve(m_index.size() + dir.entries.size());
+
+    for(auto const & [entry_name, zip_data] : dir.entries)
+    {
+        file_data zfile;
+        zfile.is_zip   = true;
+        zfile.zip_data = zip_data;
+        zfile.archive  = archive;
+
+        addFile(entry_name, zfile);
+    }
+}
+
+bool FileSystem::startWatching(std::function<void(std::vector<std::string> const &)> on_changed)
+{
+    stopWatching();
+
+    auto on_changes = [this, on_changed = std::move(on_changed)](
+                          std::vector<FileWatcher::Change> const & changes) {
+        std::vector<std::string> changed;
+        applyChanges(changes, changed);
+
+        if(!changed.empty() && on_changed)
+            on_changed(changed);
+    };
+
+    mp_watcher = std::make_unique<FileWatcher>(m_data_dir, std::move(on_changes));
+    if(!mp_watcher->isRunning())
+        mp_watcher.reset();
+
+    m_copy_files = mp_watcher != nullptr;
+    return mp_watcher != nullptr;
+}
+
+void FileSystem::stopWatching()
+{
+    mp_watcher.reset();   // joins the watcher thread
+    m_copy_files = false;
+}
 
-        if(zfile.zip_data.uncompressedSize != 0 || zfile.zip_data.compressed != 0)
+void FileSystem::applyChanges(std::vector<FileWatcher::Change> const & changes,
+                              std::vector<std::string> &               changed)
+{
+    for(auto const & change : changes)
+    {
+        fs::path const path(change.path);
+        if(path.extension() == fs::path(".zip"))
         {
-            zfile.fname = fname;
-            m_files.emplace_back(std::move(zfile));
+            replaceZipEntries((fs::path(m_data_dir) / path).generic_string(),
+                              change.action == FileWatcher::Action::removed, changed);
+            continue;
         }
 
-        if(cdfh.extraFieldLength)
+        std::unique_lock lk(m_files_mutex);
+        if(change.action == FileWatcher::Action::removed)
         {
-            ifs.seekg(cdfh.extraFieldLength, std::ifstream::cur);
+            uint32_t const index = findFile(change.path);
+            if(index == PathIndex::npos || m_files[index].is_zip)
+                continue;
+
+            m_files[index].removed = true;
+            ++m_num_removed;
         }
-        if(cdfh.fileCommentLength)
+        else
         {
-            ifs.seekg(cdfh.fileCommentLength, std::ifstream::cur);
+            // a modified regular file is read again by getFile, nothing to update
+            addFile(change.path, {});
         }
+
+        changed.push_back(change.path);
     }
+
+    std::sort(changed.begin(), changed.end());
+    changed.erase(std::unique(changed.begin(), changed.end()), changed.end());
 }
 
-bool FileSystem::isExist(std::string const & fname) const
+void FileSystem::replaceZipEntries(std::string const & fname, bool removed,
+                                   std::vector<std::string> & changed)
 {
-    assert(!fname.empty());
+    // the entries are replaced by the entries of the new directory, the directory is read unlocked
+    resetArchiveMapping(fname);
+
+    ZipDirectory dir;
+    bool const   valid = !removed && ReadZipDirectory(fname, dir);
 
-    for(auto & fl : m_files)
+    std::unique_lock lk(m_files_mutex);
+    for(auto & fd : m_files)
     {
-        if(fl.is_zip)
-        {
-            if(fname == fl.zip_data.fname)
-                return true;
-        }
-        else
+        if(fd.is_zip && !fd.removed && fd.archive == fname)
         {
-            if(fname == fl.fname)
-                return true;
+            fd.removed = true;
+            ++m_num_removed;
+            changed.emplace_back(fd.fname);
         }
     }
 
-    return false;
+    if(valid)
+    {
+        addZippedDir(fname, dir);
+        for(auto const & entry : dir.entries)
+            changed.emplace_back(entry.first);
+    }
 }
 
-InFile FileSystem::getFile(std::string const & fname) const
+bool FileSystem::isExist(std::string const & fname) const
 {
     assert(!fname.empty());
 
-    auto res = std::find_if(m_files.begin(), m_files.end(), [&fname](file_data const & f) -> bool {
-        if(f.is_zip)
-        {
-            if(fname == f.zip_data.fname)
-                return true;
-        }
-        else
-        {
-            if(fname == f.fname)
-                return true;
-        }
+    std::shared_lock lk(m_files_mutex);
+    return findFile(fname) != PathIndex::npos;
+}
 
-        return false;
+size_t FileSystem::getNumFiles() const
+{
+    std::shared_lock lk(m_files_mutex);
+    return m_files.size() - m_num_removed;
+}
+
+std::vector<std::string> FileSystem::getFileList(std::string const & dir, bool recursive) const
+{
+    std::vector<std::string> res;
+
+    std::shared_lock lk(m_files_mutex);
+    m_index.forEachFile(dir, recursive, [this, &res](std::string_view fname, uint32_t index) {
+        if(!m_files[index].removed)
+            res.emplace_back(fname);
     });
 
-    if(res != m_files.end())
+    return res;
+}
+
+InFile FileSystem::getFile(std::string const & fname) const
+{
+    assert(!fname.empty());
+
+    file_data fd;
     {
-        if((*res).is_zip)
-            return loadZipFile(*res);
-        else
-            return loadRegularFile(*res);
+        std::shared_lock lk(m_files_mutex);
+
+        uint32_t const index = findFile(fname);
+        if(index == PathIndex::npos)
+        {
+            Log::Log(Log::warning,
+                     Log::cstr_log("FileSystem::GetFile File: \"%s\" - not found", fname.c_str()));
+            EV_EXCEPT("File not found");
+        }
+
+        // the names are interned, the copy stays valid after the unlock
+        fd = m_files[index];
     }
+
+    if(fd.is_zip)
+        return loadZipFile(fd);
     else
-    {
-        Log::Log(Log::warning, Log::cstr_log("FileSystem::GetFile File: \"%s\" - not found", fname.c_str()));
-        EV_EXCEPT("File not found");
-    }
+        return loadRegularFile(fd);
 }
 
 bool FileSystem::writeFile(std::string const & path, BaseFile const * file)
@@ -274,7 +434,11 @@ bool FileSystem::writeFile(std::string const & path, BaseFile const * file)
     if(!path.empty())
         filename = path + '/' + filename;
 
-    std::ofstream ofs(std::string(m_data_dir + '/' + filename), std::ios::binary);
+    // the file may be mapped by the readers, it is replaced and never truncated
+    std::string const full_path = m_data_dir + '/' + filename;
+    std::string const temp_path = full_path + '.' + GetTempFileName();
+
+    std::ofstream ofs(temp_path, std::ios::binary);
     if(!ofs.is_open())
     {
         Log::Log(Log::error,
@@ -285,481 +449,446 @@ bool FileSystem::writeFile(std::string const & path, BaseFile const * file)
               static_cast<std::streamsize>(file->getFileSize()));
     ofs.close();
 
-    if(!isExist(filename))
-    {
-        file_data fd;
-        fd.fname = filename;
+    if(!ReplaceFile(temp_path, full_path, !ofs.fail()))
+        return false;
 
-        m_files.emplace_back(std::move(fd));
-    }
+    std::unique_lock lk(m_files_mutex);
+    addFile(filename, {});
 
     return true;
 }
 
-void GetDosTime(std::time_t rawtime, uint16_t & time, uint16_t & date)
-{
-    // http://stackoverflow.com/questions/15763259/unix-timestamp-to-fat-timestamp
-    struct tm * timeinfo;
-    timeinfo = localtime(&rawtime);
-
-    time =
-        static_cast<uint16_t>((timeinfo->tm_hour << 11) | (timeinfo->tm_min << 5) | (timeinfo->tm_sec >> 1));
-    date = static_cast<uint16_t>(
-        ((timeinfo->tm_year - 80) << 9) | ((timeinfo->tm_mon + 1) << 5) | (timeinfo->tm_mday));
-}
-
-// http://blog2k.ru/archives/3397
 bool FileSystem::createZIP(std::vector<BaseFile const *> filelist, std::string const & zipname)
 {
-    // http://stackoverflow.com/questions/922360/why-cant-i-make-a-vector-of-references
     assert(!filelist.empty());
     assert(!zipname.empty());
 
-    struct FileInfo
+    // the same name as the archives found by the constructor and the watcher
+    std::string const path      = (fs::path(m_data_dir) / zipname).generic_string();
+    std::string const temp_path = path + '.' + GetTempFileName();
+
+    // the old archive is replaced at once, the files loaded from it keep its mapping
+    bool written = false;
     {
-        uint32_t compressedSize;
-        uint32_t uncompressedSize;
-        uint16_t compressionMethod;
-        uint32_t crc32;
-        uint32_t offset;
-    };
+        ZipWriter writer(temp_path, false, mp_thread_pool);
 
-    // Буфер для сжатых данных
-    std::vector<uint8_t> dataBuffer;
-    // Информация для создания Central directory file header
-    std::vector<FileInfo> fileInfoList;
+        written = writer.isOpen();
+        for(BaseFile const * file : filelist)
+            written = written && writer.addFile(file);
 
-    std::ofstream ofs(std::string(m_data_dir + '/' + zipname), std::ofstream::binary | std::ofstream::trunc);
-    if(!ofs.is_open())
-    {
-        return false;
+        written = written && writer.finish();
     }
 
-    uint16_t time = 0;
-    uint16_t date = 0;
+    if(!ReplaceFile(temp_path, path, written))
+        return false;
 
-    for(size_t i = 0; i < filelist.size(); i++)
-    {
-        std::string       fname = filelist[i]->getName();
-        std::vector<char> buf;
-        buf.resize(filelist[i]->getFileSize());
-        buf.assign(filelist[i]->getData(), filelist[i]->getData() + filelist[i]->getFileSize());
+    std::vector<std::string> changed;
+    replaceZipEntries(path, false, changed);
 
-        LocalFileHeader lfh{};
-        memset(&lfh, 0, sizeof(lfh));
+    return true;
+}
 
-        lfh.uncompressedSize = static_cast<uint32_t>(buf.size());
+bool FileSystem::addFileToZIP(BaseFile const * file, std::string const & zipname)
+{
+    assert(!zipname.empty());
 
-        lfh.crc32 = static_cast<uint32_t>(
-            crc32(0, reinterpret_cast<unsigned char const *>(buf.data()), lfh.uncompressedSize));
+    std::string const path = m_data_dir + '/' + zipname;
 
-        // Выделим память для сжатых данных
-        dataBuffer.resize(lfh.uncompressedSize);
+    // the data section is kept, the mapping is reset because the archive grows
+    resetArchiveMapping(path);
 
-        // Структура для сжатия данных
-        z_stream zStream;
-        memset(&zStream, 0, sizeof(zStream));
-        deflateInit2(&zStream, Z_BEST_COMPRESSION, Z_DEFLATED, -MAX_WBITS, 8, Z_DEFAULT_STRATEGY);
+    ZipWriter writer(path, true, mp_thread_pool);
+    return writer.addFile(file) && writer.finish();
+}
 
-        // Сжимаем данные
-        zStream.avail_in  = lfh.uncompressedSize;
-        zStream.next_in   = reinterpret_cast<unsigned char *>(buf.data());
-        zStream.avail_out = lfh.uncompressedSize;
-        zStream.next_out  = dataBuffer.data();
-        deflate(&zStream, Z_FINISH);
+// https://stackoverflow.com/questions/61030383/how-to-convert-stdfilesystemfile-time-type-to-time-t
+template<typename TP>
+std::time_t to_time_t(TP tp)
+{
+    using namespace std::chrono;
+    auto sctp = time_point_cast<system_clock::duration>(tp - TP::clock::now() + system_clock::now());
+    return system_clock::to_time_t(sctp);
+}
 
-        // Размер сжатых данных
-        char *   data_ptr = nullptr;
-        uint32_t size     = 0;
-        if(zStream.total_out >= lfh.uncompressedSize)
-        {
-            lfh.compressedSize    = lfh.uncompressedSize;
-            lfh.compressionMethod = 0;
+InFile FileSystem::loadRegularFile(file_data const & f) const
+{
+    std::string const path = m_data_dir + '/' + std::string(f.fname);
 
-            data_ptr = buf.data();
-            size     = lfh.uncompressedSize;
-        }
-        else
-        {
-            lfh.compressedSize    = static_cast<uint32_t>(zStream.total_out);
-            lfh.compressionMethod = Z_DEFLATED;
+    std::error_code ec;
+    auto            ftime     = fs::last_write_time(path, ec);
+    std::time_t     time      = ec ? 0 : to_time_t(ftime);
+    size_t const    file_size = static_cast<size_t>(fs::file_size(path, ec));
 
-            data_ptr = reinterpret_cast<char *>(dataBuffer.data());
-            size     = lfh.compressedSize;
+    if(!ec && file_size >= min_mapped_size && !m_copy_files)
+    {
+        if(auto mapping = FileMapping::Map(path))
+        {
+            size_t const size = mapping->getSize();
+            return {std::string(f.fname), time, std::move(mapping), 0, size};
         }
-
-        // Очистка
-        deflateEnd(&zStream);
-
-        lfh.filenameLength = static_cast<uint16_t>(fname.size());
-
-        // Сохраним смещение к записи Local File Header внутри архива
-        uint32_t const lfhOffset = static_cast<uint32_t>(ofs.tellp());
-
-        GetDosTime(filelist[i]->timeStamp(), time, date);
-
-        // Запишем сигнатуру Local File Header
-        lfh.signature        = 0x04034b50;
-        lfh.modificationDate = date;
-        lfh.modificationTime = time;
-        // Запишем Local File Header
-        ofs.write(reinterpret_cast<char *>(&lfh), sizeof(lfh));
-        // Запишем имя файла
-        ofs.write(fname.c_str(), static_cast<std::streamsize>(fname.size()));
-        // Запишем данные
-        ofs.write(data_ptr, static_cast<std::streamsize>(size));
-
-        // Сохраним все данные для Central directory file header
-        FileInfo fileInfo{};
-        fileInfo.compressedSize    = lfh.compressedSize;
-        fileInfo.uncompressedSize  = lfh.uncompressedSize;
-        fileInfo.compressionMethod = lfh.compressionMethod;
-        fileInfo.crc32             = lfh.crc32;
-        fileInfo.offset            = lfhOffset;
-        fileInfoList.push_back(fileInfo);
     }
 
-    // Смещение первой записи для EOCD
-    uint32_t const firstOffsetCDFH = static_cast<uint32_t>(ofs.tellp());
-
-    for(uint32_t i = 0; i < filelist.size(); ++i)
+    std::ifstream ifs(path, std::ios::binary);
+    if(!ifs.is_open())
     {
-        std::string const &        filename = filelist[i]->getName();
-        FileInfo const &           fileInfo = fileInfoList[i];
-        CentralDirectoryFileHeader cdfh{};
-        memset(&cdfh, 0, sizeof(cdfh));
+        Log::Log(Log::error,
+                 Log::cstr_log("FileSystem::LoadRegularFile: \"%s\" - not found", path.c_str()));
+        EV_EXCEPT("Unable to load file");
+    }
 
-        GetDosTime(filelist[i]->timeStamp(), time, date);
+    ifs.seekg(0, std::ios_base::end);
+    size_t read_size = static_cast<size_t>(ifs.tellg());
+    ifs.seekg(0, std::ios_base::beg);
 
-        cdfh.compressedSize        = fileInfo.compressedSize;
-        cdfh.uncompressedSize      = fileInfo.uncompressedSize;
-        cdfh.compressionMethod     = fileInfo.compressionMethod;
-        cdfh.crc32                 = fileInfo.crc32;
-        cdfh.localFileHeaderOffset = fileInfo.offset;
-        cdfh.filenameLength        = static_cast<uint16_t>(filename.size());
-        cdfh.signature             = 0x02014b50;
-        cdfh.modificationDate      = date;
-        cdfh.modificationTime      = time;
+    auto data = std::make_unique<int8_t[]>(read_size);
 
-        // Запишем структуру
-        ofs.write(reinterpret_cast<char *>(&cdfh), sizeof(cdfh));
+    ifs.read(reinterpret_cast<char *>(const_cast<int8_t *>(data.get())),
+             static_cast<std::streamsize>(read_size));
 
-        // Имя файла
-        ofs.write(filename.c_str(), cdfh.filenameLength);
+    bool success = !ifs.fail() && read_size == static_cast<size_t>(ifs.gcount());
+    if(!success)
+    {
+        Log::Log(Log::error,
+                 Log::cstr_log("FileSystem::LoadRegularFile: \"%s\" - not found", path.c_str()));
+        EV_EXCEPT("Unable to load file");
     }
 
-    // Посчитаем размер данных для следующего шага
-    uint32_t const lastOffsetCDFH = static_cast<uint32_t>(ofs.tellp());
+    ifs.close();
+
+    return {std::string(f.fname), time, read_size, std::move(data)};
+}
 
-    EOCD eocd{};
-    memset(&eocd, 0, sizeof(eocd));
-    eocd.centralDirectoryOffset       = firstOffsetCDFH;
-    eocd.numberCentralDirectoryRecord = static_cast<uint16_t>(filelist.size());
-    eocd.totalCentralDirectoryRecord  = static_cast<uint16_t>(filelist.size());
-    eocd.sizeOfCentralDirectory       = lastOffsetCDFH - firstOffsetCDFH;
+std::shared_ptr<FileMapping const> FileSystem::getArchiveMapping(std::string const & fname) const
+{
+    std::lock_guard lk(m_mapping_mutex);
 
-    // Пишем сигнатуру
-    uint32_t signature = 0x06054b50;
-    ofs.write(reinterpret_cast<char *>(&signature), sizeof(signature));
+    auto it = m_archive_mappings.find(fname);
+    if(it == m_archive_mappings.end())
+        it = m_archive_mappings.emplace(fname, FileMapping::Map(fname)).first;
 
-    // Пишем EOCD
-    ofs.write(reinterpret_cast<char *>(&eocd), sizeof(eocd));
+    return it->second;
+}
 
-    ofs.close();
-    return true;
+void FileSystem::resetArchiveMapping(std::string const & fname)
+{
+    // files taken from the old mapping keep it alive
+    std::lock_guard lk(m_mapping_mutex);
+    m_archive_mappings.erase(fname);
 }
 
-bool FileSystem::addFileToZIP(BaseFile const * file, std::string const & zipname)
+// http://blog2k.ru/archives/3392
+InFile FileSystem::loadZipFile(file_data const & zf) const
 {
-    assert(!zipname.empty());
+    std::string const                  archive = std::string(zf.archive);
+    std::shared_ptr<FileMapping const> mapping = getArchiveMapping(archive);
+    std::optional<InFile>              file;
 
-    std::fstream ofs(m_data_dir + '/' + zipname,
-                     std::fstream::binary | std::fstream::ate | std::fstream::out | std::fstream::in);
-    if(!ofs.is_open())
+    if(mapping)
     {
-        return false;
+        // the views of the stored entries hold the mapping
+        auto views = m_copy_files ? nullptr : mapping;
+        file       = ExtractZipEntry(zf, mapping->getData(), 0, mapping->getSize(), std::move(views));
     }
-
-    size_t const fileSize     = static_cast<size_t>(ofs.tellg());
-    size_t       EOCD_offset_ = 0;
-
-    for(size_t offset = fileSize - sizeof(EOCD); offset != 0; --offset)
+    else
     {
-        uint32_t signature = 0;
-
-        ofs.seekg(offset, std::fstream::beg);
-        ofs.read(reinterpret_cast<char *>(&signature), sizeof(signature));
-
-        if(0x06054b50 == signature)
+        std::ifstream ifs(archive, std::ifstream::binary);
+        if(!ifs.is_open())
         {
-            EOCD_offset_ = static_cast<size_t>(ofs.tellg());
-            break;
+            Log::Log(Log::error,
+                     Log::cstr_log("FileSystem::LoadZipFile: \"%s\" - not found", archive.c_str()));
+            EV_EXCEPT("Unable to load file");
         }
-    }
 
-    if(EOCD_offset_ == 0)
-        return false;
+        LocalFileHeader lfh{};
+        ifs.seekg(zf.zip_data.lfhOffset, std::ifstream::beg);
+        ifs.read(reinterpret_cast<char *>(&lfh), sizeof(lfh));
 
-    EOCD eocd{};
-    ofs.seekg(EOCD_offset_, std::fstream::beg);
-    ofs.read(reinterpret_cast<char *>(&eocd), sizeof(eocd));
+        if(0x04034b50 == lfh.signature)
+        {
+            // the sizes in the local header are 0 with a data descriptor and 0xFFFFFFFF for ZIP64
+            size_t const size =
+                sizeof(lfh) + lfh.filenameLength + lfh.extraFieldLength + zf.zip_data.compressedSize;
+            auto buffer = std::make_unique<int8_t[]>(size);
 
-    auto centralDirectoryData = std::make_unique<char[]>(eocd.sizeOfCentralDirectory);
-    ofs.seekg(eocd.centralDirectoryOffset, std::fstream::beg);
-    ofs.read(centralDirectoryData.get(), static_cast<std::streamsize>(eocd.sizeOfCentralDirectory));
-    ofs.seekg(eocd.centralDirectoryOffset, std::fstream::beg);
+            ifs.seekg(zf.zip_data.lfhOffset, std::ifstream::beg);
+            ifs.read(reinterpret_cast<char *>(buffer.get()), static_cast<std::streamsize>(size));
 
-    std::vector<std::string> zip_fnames;
+            file = ExtractZipEntry(zf, buffer.get(), zf.zip_data.lfhOffset, static_cast<size_t>(ifs.gcount()),
+                                   nullptr);
+        }
+        ifs.close();
+    }
 
-    for(uint16_t i = 0; i < eocd.numberCentralDirectoryRecord; ++i)
+    if(!file)
     {
-        CentralDirectoryFileHeader cdfh{};
+        Log::Log(Log::error,
+                 Log::cstr_log("FileSystem::LoadZipFile: \"%s\" - doesn't have zip file signature",
+                               archive.c_str()));
+        EV_EXCEPT("Unable to load file");
+    }
 
-        ofs.read(reinterpret_cast<char *>(&cdfh), sizeof(cdfh));
+    return std::move(*file);
+}
 
-        if(0x02014b50 != cdfh.signature)
-        {
-            return false;
-        }
+std::optional<InFile> FileSystem::ExtractZipEntry(file_data const & zf, int8_t const * data, size_t offset,
+                                                  size_t size, std::shared_ptr<FileMapping const> mapping)
+{
+    size_t const lfh_pos = zf.zip_data.lfhOffset - offset;   // position of the entry in data
 
-        if(cdfh.filenameLength)
-        {
-            auto filename = std::make_unique<char[]>(cdfh.filenameLength + 1);
-            ofs.read(static_cast<char *>(filename.get()), cdfh.filenameLength);
+    LocalFileHeader lfh{};
+    if(zf.zip_data.lfhOffset < offset || lfh_pos + sizeof(lfh) > size)
+        return {};
 
-            filename[cdfh.filenameLength] = 0;
+    std::memcpy(&lfh, data + lfh_pos, sizeof(lfh));
 
-            zip_fnames.push_back(std::string(filename.get()));
-        }
-    }
+    // the sizes are taken from the central directory, the local header may not have them
+    size_t const compressed_size   = zf.zip_data.compressedSize;
+    size_t const uncompressed_size = zf.zip_data.uncompressedSize;
 
-    ofs.seekg(eocd.centralDirectoryOffset, std::fstream::beg);
+    size_t const src_pos = lfh_pos + sizeof(lfh) + lfh.filenameLength + lfh.extraFieldLength;
+    if(0x04034b50 != lfh.signature || src_pos + compressed_size > size)
+        return {};
 
-    auto file_it = std::find_if(zip_fnames.begin(), zip_fnames.end(),
-                                [&file](std::string const & zn) -> bool { return file->getName() == zn; });
+    int8_t const * src = data + src_pos;
 
-    if(file_it != zip_fnames.end())
-        return false;   // Если есть файл с таким именем
+    struct tm timeinfo;
+    std::memset(&timeinfo, 0, sizeof(timeinfo));
+    timeinfo.tm_year = ((lfh.modificationDate & 0xFE00) >> 9) + 1980;
+    timeinfo.tm_mon  = (lfh.modificationDate & 0x01E0) >> 5;
+    timeinfo.tm_mday = lfh.modificationDate & 0x001F;
 
-    uint16_t time = 0;
-    uint16_t date = 0;
-    GetDosTime(file->timeStamp(), time, date);
+    timeinfo.tm_hour = (lfh.modificationTime & 0xF800) >> 11;
+    timeinfo.tm_min  = (lfh.modificationTime & 0x07E0) >> 5;
+    timeinfo.tm_sec  = (lfh.modificationTime & 0x001f) * 2;
 
-    LocalFileHeader lfh{};
-    memset(&lfh, 0, sizeof(lfh));
-    // Буфер для сжатых данных
-    std::vector<uint8_t> dataBuffer;
-
-    lfh.uncompressedSize = static_cast<uint32_t>(file->getFileSize());
-
-    lfh.crc32 = static_cast<uint32_t>(
-        crc32(0, reinterpret_cast<unsigned char const *>(file->getData()), lfh.uncompressedSize));
-
-    // Выделим память для сжатых данных
-    dataBuffer.resize(lfh.uncompressedSize);
-
-    // Структура для сжатия данных
-    z_stream zStream;
-    memset(&zStream, 0, sizeof(zStream));
-    deflateInit2(&zStream, Z_BEST_COMPRESSION, Z_DEFLATED, -MAX_WBITS, 8, Z_DEFAULT_STRATEGY);
-
-    // Сжимаем данные
-    zStream.avail_in  = lfh.uncompressedSize;
-    zStream.next_in   = reinterpret_cast<unsigned char *>(const_cast<int8_t *>(file->getData()));
-    zStream.avail_out = lfh.uncompressedSize;
-    zStream.next_out  = dataBuffer.data();
-    deflate(&zStream, Z_FINISH);
-
-    // Размер сжатых данных
-    char *   data_ptr = nullptr;
-    uint32_t size     = 0;
-    if(zStream.total_out >= lfh.uncompressedSize)
-    {
-        lfh.compressedSize    = lfh.uncompressedSize;
-        lfh.compressionMethod = 0;
+    std::time_t t = std::mktime(&timeinfo);
 
-        data_ptr = reinterpret_cast<char *>(const_cast<int8_t *>(file->getData()));
-        size     = lfh.uncompressedSize;
-    }
-    else
+    if(!zf.zip_data.compressed)
     {
-        lfh.compressedSize    = static_cast<uint32_t>(zStream.total_out);
-        lfh.compressionMethod = Z_DEFLATED;
+        // stored entries are read in place
+        if(mapping)
+            return InFile{std::string(zf.fname), t, std::move(mapping), src_pos, compressed_size};
 
-        data_ptr = reinterpret_cast<char *>(dataBuffer.data());
-        size     = lfh.compressedSize;
-    }
+        auto copy = std::make_unique<int8_t[]>(compressed_size);
+        std::memcpy(copy.get(), src, compressed_size);
 
-    // Очистка
-    deflateEnd(&zStream);
+        return InFile{std::string(zf.fname), t, compressed_size, std::move(copy)};
+    }
 
-    lfh.filenameLength = static_cast<uint16_t>(file->getName().size());
+    auto unpacked = std::make_unique<int8_t[]>(uncompressed_size);
 
-    // Сохраним смещение к записи Local File Header внутри архива
-    uint32_t const lfhOffset = static_cast<uint32_t>(ofs.tellp());
+    z_stream zs;
+    std::memset(&zs, 0, sizeof(zs));
+    inflateInit2(&zs, -MAX_WBITS);
 
-    // Запишем сигнатуру Local File Header
-    lfh.signature        = 0x04034b50;
-    lfh.modificationDate = date;
-    lfh.modificationTime = time;
-    // Запишем Local File Header
-    ofs.write(reinterpret_cast<char *>(&lfh), sizeof(lfh));
-    // Запишем имя файла
-    ofs.write(file->getName().c_str(), static_cast<std::streamsize>(file->getName().size()));
-    // Запишем данные
-    ofs.write(data_ptr, static_cast<std::streamsize>(size));
+    zs.next_in  = reinterpret_cast<unsigned char *>(const_cast<int8_t *>(src));
+    zs.next_out = reinterpret_cast<unsigned char *>(unpacked.get());
 
-    uint32_t const firstOffsetCDFH = static_cast<uint32_t>(ofs.tellp());
+    // avail_in and avail_out are 32 bit, ZIP64 entries are inflated in parts
+    size_t in_left  = compressed_size;
+    size_t out_left = uncompressed_size;
+    int    res      = Z_OK;
+    bool   progress = true;
+    while((res == Z_OK || res == Z_BUF_ERROR) && progress)
+    {
+        uInt const in_part  = static_cast<uInt>(std::min<size_t>(in_left, std::numeric_limits<uInt>::max()));
+        uInt const out_part = static_cast<uInt>(std::min<size_t>(out_left, std::numeric_limits<uInt>::max()));
+        zs.avail_in         = in_part;
+        zs.avail_out        = out_part;
+
+        res = inflate(&zs, in_part == in_left ? Z_FINISH : Z_NO_FLUSH);
+
+        size_t const consumed = in_part - zs.avail_in;
+        size_t const produced = out_part - zs.avail_out;
+        in_left -= consumed;
+        out_left -= produced;
+        progress = consumed != 0 || produced != 0;
+    }
 
-    ofs.write(centralDirectoryData.get(), static_cast<std::streamsize>(eocd.sizeOfCentralDirectory));
+    inflateEnd(&zs);
 
-    CentralDirectoryFileHeader cdfh{};
-    memset(&cdfh, 0, sizeof(cdfh));
+    if(res != Z_STREAM_END || out_left != 0)
+    {
+        Log::Log(Log::error, Log::cstr_log("FileSystem::ExtractZipEntry: \"%s\" - corrupted compressed data",
+                                           std::string(zf.fname).c_str()));
+        EV_EXCEPT("Unable to load file");
+    }
 
-    cdfh.compressedSize        = lfh.compressedSize;
-    cdfh.uncompressedSize      = lfh.uncompressedSize;
-    cdfh.compressionMethod     = lfh.compressionMethod;
-    cdfh.crc32                 = lfh.crc32;
-    cdfh.localFileHeaderOffset = lfhOffset;
-    cdfh.filenameLength        = lfh.filenameLength;
-    cdfh.signature             = 0x02014b50;
-    cdfh.modificationDate      = date;
-    cdfh.modificationTime      = time;
+    return InFile{std::string(zf.fname), t, uncompressed_size, std::move(unpacked)};
+}
 
-    // Запишем структуру
-    ofs.write(reinterpret_cast<char *>(&cdfh), sizeof(cdfh));
+std::future<InFile> FileSystem::getFileAsync(std::string const & fname)
+{
+    assert(!fname.empty());
 
-    // Имя файла
-    ofs.write(file->getName().c_str(), cdfh.filenameLength);
+    ReadRequest         request;
+    std::future<InFile> res = request.promise.get_future();
+    {
+        std::shared_lock lk(m_files_mutex);
 
-    uint32_t const lastOffsetCDFH = static_cast<uint32_t>(ofs.tellp());
+        uint32_t const index = findFile(fname);
+        if(index == PathIndex::npos)
+        {
+            Log::Log(Log::warning,
+                     Log::cstr_log("FileSystem::GetFileAsync File: \"%s\" - not found", fname.c_str()));
+            request.promise.set_exception(
+                std::make_exception_ptr(Exception("File not found", __LINE__, __FILE__)));
+            return res;
+        }
 
-    eocd.centralDirectoryOffset       = firstOffsetCDFH;
-    eocd.numberCentralDirectoryRecord = static_cast<uint16_t>(eocd.numberCentralDirectoryRecord + 1);
-    eocd.totalCentralDirectoryRecord  = static_cast<uint16_t>(eocd.totalCentralDirectoryRecord + 1);
-    eocd.sizeOfCentralDirectory       = lastOffsetCDFH - firstOffsetCDFH;
+        request.fd = m_files[index];
+    }
 
-    // Пишем сигнатуру
-    uint32_t const signature = 0x06054b50;
-    ofs.write(reinterpret_cast<char const *>(&signature), sizeof(signature));
+    std::unique_lock lk(m_io_mutex);
+    m_io_done_cv.wait(lk, [this] { return m_io_queue.size() < max_pending_reads; });
 
-    // Пишем EOCD
-    ofs.write(reinterpret_cast<char *>(&eocd), sizeof(eocd));
+    if(!m_io_thread.joinable())
+        m_io_thread = std::thread(&FileSystem::ioThreadLoop, this);
 
-    ofs.close();
-    return true;
-}
+    m_io_queue.push_back(std::move(request));
+    ++m_io_pending;
+    m_io_cv.notify_one();
 
-// https://stackoverflow.com/questions/61030383/how-to-convert-stdfilesystemfile-time-type-to-time-t
-template<typename TP>
-std::time_t to_time_t(TP tp)
-{
-    using namespace std::chrono;
-    auto sctp = time_point_cast<system_clock::duration>(tp - TP::clock::now() + system_clock::now());
-    return system_clock::to_time_t(sctp);
+    return res;
 }
 
-InFile FileSystem::loadRegularFile(file_data const & f) const
+template<typename LoadFunc>
+void FileSystem::serveRequest(ReadRequest & request, LoadFunc && load)
 {
-    std::ifstream ifs(m_data_dir + '/' + f.fname, std::ios::binary);
-    if(!ifs.is_open())
+    try
     {
-        Log::Log(Log::error,
-                 Log::cstr_log("FileSystem::LoadRegularFile: \"%s\" - not found", f.fname.c_str()));
-        EV_EXCEPT("Unable to load file");
+        request.promise.set_value(load());
+    }
+    catch(...)
+    {
+        request.promise.set_exception(std::current_exception());
     }
 
-    ifs.seekg(0, std::ios_base::end);
-    size_t file_size = static_cast<size_t>(ifs.tellg());
-    ifs.seekg(0, std::ios_base::beg);
-
-    auto data = std::make_unique<int8_t[]>(file_size);
+    // the destructor waits for the last request, notify under the lock
+    std::lock_guard lk(m_io_mutex);
+    --m_io_pending;
+    m_io_done_cv.notify_all();
+}
 
-    ifs.read(reinterpret_cast<char *>(const_cast<int8_t *>(data.get())),
-             static_cast<std::streamsize>(file_size));
+void FileSystem::ioThreadLoop()
+{
+    std::vector<ReadRequest> requests;
 
-    bool success = !ifs.fail() && file_size == static_cast<size_t>(ifs.gcount());
-    if(!success)
+    while(true)
     {
-        Log::Log(Log::error,
-                 Log::cstr_log("FileSystem::LoadRegularFile: \"%s\" - not found", f.fname.c_str()));
-        EV_EXCEPT("Unable to load file");
-    }
+        {
+            std::unique_lock lk(m_io_mutex);
+            m_io_cv.wait(lk, [this] { return m_io_stop || !m_io_queue.empty(); });
 
-    ifs.close();
+            if(m_io_queue.empty())
+                return;   // stopped, all requests are taken
 
-    auto        ftime = fs::last_write_time(m_data_dir + '/' + f.fname);
-    std::time_t time  = to_time_t(ftime);
+            // everything queued meanwhile is one batch, entries of the same archive are read together
+            std::swap(requests, m_io_queue);
+            m_io_done_cv.notify_all();
+        }
 
-    return {f.fname, time, file_size, std::move(data)};
-}
+        std::sort(requests.begin(), requests.end(), [](ReadRequest const & l, ReadRequest const & r) {
+            return std::tie(l.fd.is_zip, l.fd.archive, l.fd.zip_data.lfhOffset)
+                   < std::tie(r.fd.is_zip, r.fd.archive, r.fd.zip_data.lfhOffset);
+        });
 
-// http://blog2k.ru/archives/3392
-InFile FileSystem::loadZipFile(file_data const & zf) const
-{
-    std::unique_ptr<int8_t[]> data;
+        for(size_t first = 0; first < requests.size();)
+        {
+            if(!requests[first].fd.is_zip)
+            {
+                auto & request = requests[first];
+                serveRequest(request, [this, &request] { return loadRegularFile(request.fd); });
+                ++first;
+                continue;
+            }
 
-    std::ifstream ifs(zf.fname, std::ifstream::binary);
-    if(!ifs.is_open())
-    {
-        Log::Log(Log::error, Log::cstr_log("FileSystem::LoadZipFile: \"%s\" - not found", zf.fname.c_str()));
-        EV_EXCEPT("Unable to load file");
-    }
+            size_t last = first + 1;
+            while(last < requests.size() && requests[last].fd.archive == requests[first].fd.archive)
+                ++last;
 
-    ifs.seekg(zf.zip_data.lfhOffset, std::ifstream::beg);
-    LocalFileHeader lfh{};
-    ifs.read(reinterpret_cast<char *>(&lfh), sizeof(lfh));
+            readZipEntries(requests, first, last);
+            first = last;
+        }
 
-    if(0x04034b50 != lfh.signature)
-    {
-        Log::Log(Log::error,
-                 Log::cstr_log("FileSystem::LoadZipFile: \"%s\" - doesn't have zip file signature",
-                               zf.fname.c_str()));
-        EV_EXCEPT("Unable to load file");
+        requests.clear();
     }
+}
 
-    ifs.seekg(lfh.filenameLength, std::ifstream::cur);
-    ifs.seekg(lfh.extraFieldLength, std::ifstream::cur);
+void FileSystem::readZipEntries(std::vector<ReadRequest> & requests, size_t first, size_t last)
+{
+    std::string const                  archive = std::string(requests[first].fd.archive);
+    std::shared_ptr<FileMapping const> mapping = getArchiveMapping(archive);
+    std::ifstream                      ifs;
 
-    auto readBuffer = std::make_unique<int8_t[]>(lfh.compressedSize);
-    ifs.read(reinterpret_cast<char *>(readBuffer.get()), static_cast<std::streamsize>(lfh.compressedSize));
+    if(!mapping)
+        ifs.open(archive, std::ifstream::binary);
 
-    if(!zf.zip_data.compressed)
+    while(first < last)
     {
-        data = std::move(readBuffer);
-    }
-    else
-    {
-        data = std::make_unique<int8_t[]>(lfh.uncompressedSize);
+        // entries close to each other are read with one request, the requests are sorted by the offset
+        size_t const begin      = requests[first].fd.zip_data.lfhOffset;
+        size_t       end        = begin;
+        size_t       group_last = first;
+        for(; group_last < last; ++group_last)
+        {
+            auto const & zd        = requests[group_last].fd.zip_data;
+            size_t const entry_end = zd.lfhOffset + zd.lfhSize + zd.compressedSize;
 
-        z_stream zs;
-        std::memset(&zs, 0, sizeof(zs));
-        inflateInit2(&zs, -MAX_WBITS);
+            if(group_last != first
+               && (zd.lfhOffset > end + max_coalesce_gap || entry_end - begin > max_coalesced_read))
+                break;
 
-        zs.avail_in  = lfh.compressedSize;
-        zs.next_in   = reinterpret_cast<unsigned char *>(readBuffer.get());
-        zs.avail_out = lfh.uncompressedSize;
-        zs.next_out  = reinterpret_cast<unsigned char *>(data.get());
+            end = std::max(end, entry_end);
+        }
 
-        inflate(&zs, Z_FINISH);
+        int8_t const *                       data   = nullptr;
+        size_t                               offset = 0;
+        size_t                               size   = 0;
+        std::shared_ptr<std::vector<int8_t>> buffer;   // shared by the inflate tasks of the group
 
-        inflateEnd(&zs);
-    }
-    ifs.close();
+        if(mapping)
+        {
+            mapping->prefetch(begin, end - begin);
 
-    struct tm timeinfo;
-    std::memset(&timeinfo, 0, sizeof(timeinfo));
-    timeinfo.tm_year = ((lfh.modificationDate & 0xFE00) >> 9) + 1980;
-    timeinfo.tm_mon  = (lfh.modificationDate & 0x01E0) >> 5;
-    timeinfo.tm_mday = lfh.modificationDate & 0x001F;
+            data = mapping->getData();
+            size = mapping->getSize();
+        }
+        else if(ifs.is_open())
+        {
+            buffer = std::make_shared<std::vector<int8_t>>(end - begin);
 
-    timeinfo.tm_hour = (lfh.modificationTime & 0xF800) >> 11;
-    timeinfo.tm_min  = (lfh.modificationTime & 0x07E0) >> 5;
-    timeinfo.tm_sec  = (lfh.modificationTime & 0x001f) * 2;
+            ifs.clear();
+            ifs.seekg(static_cast<std::streamoff>(begin), std::ifstream::beg);
+            ifs.read(reinterpret_cast<char *>(buffer->data()), static_cast<std::streamsize>(buffer->size()));
 
-    std::time_t t        = std::mktime(&timeinfo);
-    size_t      unc_size = zf.zip_data.compressed ? lfh.uncompressedSize : lfh.compressedSize;
+            data   = buffer->data();
+            offset = begin;
+            size   = static_cast<size_t>(ifs.gcount());
+        }
 
-    return {zf.fname, t, unc_size, std::move(data)};
+        for(size_t i = first; i < group_last; ++i)
+        {
+            bool const compressed = requests[i].fd.zip_data.compressed;
+
+            auto task = [this, request = std::move(requests[i]), data, offset, size, mapping,
+                         buffer]() mutable {
+                serveRequest(request, [&] {
+                    // an entry with a larger local header than expected is loaded separately
+                    std::optional<InFile> file =
+                        ExtractZipEntry(request.fd, data, offset, size, m_copy_files ? nullptr : mapping);
+                    return file ? std::move(*file) : loadZipFile(request.fd);
+                });
+            };
+
+            // stored entries are views of the mapping or a copy, there is nothing to do in parallel
+            if(mp_thread_pool != nullptr && compressed)
+                mp_thread_pool->submit(std::move(task));
+            else
+                task();
+        }
+
+        first = group_last;
+    }
 }
 }   // namespace evnt
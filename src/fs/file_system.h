@@ -3,53 +3,152 @@
 
 // #include "../assets/assetmanager.h"
 #include "file.h"
+#include "file_watcher.h"
+#include "path_index.h"
+#include <atomic>
+#include <condition_variable>
 #include <functional>
-#include <list>
+#include <future>
+#include <mutex>
+#include <optional>
+#include <shared_mutex>
+#include <thread>
+#include <unordered_map>
+#include <unordered_set>
 
 namespace evnt
 {
+class ThreadPool;
+
 class FileSystem
 {
 public:
-    FileSystem(std::string root_dir);
-    virtual ~FileSystem() = default;
+    // compressed zip files loaded with getFileAsync are inflated in the pool, on the I/O thread if nullptr
+    FileSystem(std::string root_dir, ThreadPool * pool = nullptr);
+    virtual ~FileSystem();
 
     bool   isExist(std::string const & fname) const;
     InFile getFile(std::string const & fname) const;   // ex. file name: "fonts/times.ttf"
-    size_t getNumFiles() const { return m_files.size(); }
+    size_t getNumFiles() const;
+    // files in the directory and its subdirectories if recursive, dir "" - the root of the data tree
+    std::vector<std::string> getFileList(std::string const & dir, bool recursive = true) const;
+
+    // Loads the file on the I/O thread, errors are passed through the future. Requests queued together
+    // for the same archive are read at once. Blocks while max_pending_reads requests are waiting.
+    std::future<InFile> getFileAsync(std::string const & fname);
 
+    // writeFile and createZIP write a temporary file and rename it over the old one, the files loaded from
+    // the old one stay valid, they hold its mapping
     bool writeFile(std::string const & path, BaseFile const * file);   // Memory file
+    // the entries are compressed in the pool (see ZipWriter), addFileToZIP doesn't rewrite the archive data
     bool createZIP(std::vector<BaseFile const *> filelist,
                    std::string const &           zipname);   // all zip files saves in root directory
     bool addFileToZIP(BaseFile const * file, std::string const & zipname);
 
+    // Starts watching the data dir (Linux only, see FileWatcher). The file table follows the created,
+    // modified and deleted files and zip files, then on_changed gets the names of the changed files (the
+    // entries of a changed zip file included) on the watcher thread. false if the changes can't be watched.
+    // While watching, the files are copied instead of mapped: an external writer may truncate a file in
+    // place, the views of its mapping would fault then.
+    bool startWatching(std::function<void(std::vector<std::string> const &)> on_changed);
+    void stopWatching();
+
     static std::string GetTempDir();
     static std::string GetCurrentDir();
     static std::string GetTempFileName();
 
+    // smaller regular files are read into memory, a mapping costs more than a copy of a few pages
+    static constexpr size_t min_mapped_size = 16 * 1024;
+
+    static constexpr size_t max_pending_reads  = 256;
+    static constexpr size_t max_coalesce_gap   = 64 * 1024;         // unrequested bytes read between entries
+    static constexpr size_t max_coalesced_read = 8 * 1024 * 1024;   // bytes
+
 private:
     struct file_data
     {
         struct ZFileData
         {
-            bool        compressed       = false;
-            size_t      compressedSize   = 0;
-            size_t      uncompressedSize = 0;
-            size_t      lfhOffset        = 0;
-            std::string fname;
+            bool   compressed       = false;
+            size_t compressedSize   = 0;
+            size_t uncompressedSize = 0;
+            size_t lfhOffset        = 0;
+            size_t lfhSize          = 0;   // expected size of the local header with the name and extra field
         };
 
-        bool        is_zip = false;
-        ZFileData   zip_data;
-        std::string fname;
+        bool             is_zip  = false;
+        bool             removed = false;   // deleted while watched, the index can't remove paths
+        ZFileData        zip_data;
+        std::string_view fname;     // path in the data tree, interned in m_index
+        std::string_view archive;   // path of the zip file
     };
 
-    void   addZippedDir(std::string const & fname);
+    // the first file with the same name is kept, requires m_files_mutex locked outside the constructor
+    void     addFile(std::string_view fname, file_data fd);
+    uint32_t findFile(std::string_view fname) const;   // npos if not found or removed, requires m_files_mutex
+    void     applyChanges(std::vector<FileWatcher::Change> const & changes,
+                          std::vector<std::string> &               changed);
+    // drops the mapping and the entries of the archive, then adds the entries of its current directory
+    void replaceZipEntries(std::string const & fname, bool removed, std::vector<std::string> & changed);
     InFile loadRegularFile(file_data const & f) const;
     InFile loadZipFile(file_data const & zf) const;
 
-    std::list<file_data> m_files;
-    std::string          m_data_dir;
+    struct ZipDirectory
+    {
+        using Entry = std::pair<std::string_view, file_data::ZFileData>;
+
+        bool               valid = false;
+        std::vector<char>  central_dir;   // the entry names point into it
+        std::vector<Entry> entries;
+    };
+
+    // Reads the tail of the archive and the whole central directory with one request each, the entries are
+    // parsed in memory. Doesn't touch the file table, archives are read in parallel by the constructor.
+    static bool ReadZipDirectory(std::string const & fname, ZipDirectory & dir);
+    void        addZippedDir(std::string const & fname, ZipDirectory const & dir);
+
+    // The entry from data which holds size bytes of the archive starting at offset, nullopt if the entry is
+    // not entirely in data. If mapping is set data is the mapping, stored entries are returned as views.
+    static std::optional<InFile> ExtractZipEntry(file_data const & zf, int8_t const * data, size_t offset,
+                                                 size_t size, std::shared_ptr<FileMapping const> mapping);
+
+    struct ReadRequest
+    {
+        file_data            fd;
+        std::promise<InFile> promise;
+    };
+
+    void ioThreadLoop();
+    void readZipEntries(std::vector<ReadRequest> & requests, size_t first, size_t last);
+    template<typename LoadFunc>
+    void serveRequest(ReadRequest & request, LoadFunc && load);
+
+    // one mapping per archive shared by all files of the archive, nullptr if the archive can't be mapped
+    std::shared_ptr<FileMapping const> getArchiveMapping(std::string const & fname) const;
+    void                               resetArchiveMapping(std::string const & fname);
+
+    std::vector<file_data>               m_files;
+    size_t                               m_num_removed{0};
+    PathIndex                            m_index;      // file name -> index in m_files
+    std::unordered_set<std::string_view> m_archives;   // paths of the zip files, interned in m_index
+    mutable std::shared_mutex            m_files_mutex;
+    std::string                          m_data_dir;
+
+    mutable std::mutex                                                          m_mapping_mutex;
+    mutable std::unordered_map<std::string, std::shared_ptr<FileMapping const>> m_archive_mappings;
+
+    // the I/O thread is started by the first getFileAsync
+    ThreadPool *             mp_thread_pool{nullptr};
+    std::thread              m_io_thread;
+    std::mutex               m_io_mutex;
+    std::condition_variable  m_io_cv;           // a request is queued or the thread is stopped
+    std::condition_variable  m_io_done_cv;      // requests are taken from the queue or served
+    size_t                   m_io_pending{0};   // requests not served yet
+    std::vector<ReadRequest> m_io_queue;
+    bool                     m_io_stop{false};
+
+    std::unique_ptr<FileWatcher> mp_watcher;
+    std::atomic_bool             m_copy_files{false};   // no views of the mappings while watching
 };
 }   // namespace evnt
 
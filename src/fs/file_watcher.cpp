@@ -0,0 +1,259 @@
+#include "file_watcher.h"
+#include "../log/log.h"
+
+#include <algorithm>
+#include <filesystem>
+
+#ifdef __linux__
+#    include <cerrno>
+#    include <poll.h>
+#    include <sys/eventfd.h>
+#    include <sys/inotify.h>
+#    include <unistd.h>
+#endif
+
+namespace evnt
+{
+namespace fs = std::filesystem;
+
+FileWatcher::Action FileWatcher::MergeActions(Action first, Action second)
+{
+    if(second == Action::removed)
+        return Action::removed;
+
+    // replaced, the editors write a new file and rename it over the old one
+    if(first == Action::removed)
+        return Action::modified;
+
+    // the file is not known by the receiver yet
+    if(first == Action::added)
+        return Action::added;
+
+    return Action::modified;
+}
+
+void FileWatcher::addChange(std::string path, Action action)
+{
+    Clock::time_point const deadline = Clock::now() + m_delay;
+
+    auto [it, inserted] = m_pending.try_emplace(std::move(path), PendingChange{action, deadline});
+    if(!inserted)
+    {
+        it->second.action   = MergeActions(it->second.action, action);
+        it->second.deadline = deadline;
+    }
+}
+
+void FileWatcher::flushChanges()
+{
+    Clock::time_point const now = Clock::now();
+    std::vector<Change>     changes;
+
+    for(auto it = m_pending.begin(); it != m_pending.end();)
+    {
+        if(it->second.deadline <= now)
+        {
+            changes.push_back({it->first, it->second.action});
+            it = m_pending.erase(it);
+        }
+        else
+        {
+            ++it;
+        }
+    }
+
+    if(changes.empty())
+        return;
+
+    std::sort(changes.begin(), changes.end(),
+              [](Change const & l, Change const & r) { return l.path < r.path; });
+
+    try
+    {
+        m_callback(changes);
+    }
+    catch(std::exception const & e)
+    {
+        Log::Log(Log::error, Log::cstr_log("FileWatcher: \"%s\" - %s", m_root_dir.c_str(), e.what()));
+    }
+}
+
+#ifdef __linux__
+FileWatcher::FileWatcher(std::string root_dir, Callback callback, std::chrono::milliseconds delay) :
+    m_root_dir{std::move(root_dir)}, m_callback{std::move(callback)}, m_delay{delay}
+{
+    m_inotify_fd = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+    m_stop_fd    = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+    if(m_inotify_fd < 0 || m_stop_fd < 0)
+    {
+        Log::Log(Log::error,
+                 Log::cstr_log("FileWatcher: \"%s\" - inotify is not available", m_root_dir.c_str()));
+        return;
+    }
+
+    addWatches({}, false);
+    if(m_watches.empty())
+        return;
+
+    m_thread = std::thread(&FileWatcher::threadLoop, this);
+}
+
+FileWatcher::~FileWatcher()
+{
+    if(m_thread.joinable())
+    {
+        uint64_t const one = 1;
+        if(write(m_stop_fd, &one, sizeof(one)) != sizeof(one))
+            Log::Log(Log::error, Log::cstr_log("FileWatcher: \"%s\" - can't stop", m_root_dir.c_str()));
+
+        m_thread.join();
+    }
+
+    if(m_inotify_fd >= 0)
+        close(m_inotify_fd);
+    if(m_stop_fd >= 0)
+        close(m_stop_fd);
+}
+
+void FileWatcher::addWatches(std::string const & dir, bool report_files)
+{
+    uint32_t const mask = IN_CREATE | IN_CLOSE_WRITE | IN_DELETE | IN_MOVED_FROM | IN_MOVED_TO | IN_ONLYDIR;
+
+    auto add_watch = [this, mask](std::string const & rel_dir) {
+        std::string const path = rel_dir.empty() ? m_root_dir : m_root_dir + '/' + rel_dir;
+
+        int const wd = inotify_add_watch(m_inotify_fd, path.c_str(), mask);
+        if(wd < 0)
+        {
+            Log::Log(Log::warning, Log::cstr_log("FileWatcher: \"%s\" - not watched", path.c_str()));
+            return;
+        }
+
+        m_watches[wd] = rel_dir;
+    };
+
+    add_watch(dir);
+
+    // the subdirectories and the files created before the watch was added
+    std::error_code ec;
+    fs::path const  root_path(m_root_dir);
+    for(auto it = fs::recursive_directory_iterator(dir.empty() ? root_path : root_path / dir, ec);
+        !ec && it != fs::recursive_directory_iterator(); it.increment(ec))
+    {
+        std::string const rel_path = it->path().lexically_relative(root_path).generic_string();
+        if(it->is_directory(ec))
+            add_watch(rel_path);
+        else if(report_files)
+            addChange(rel_path, Action::added);
+    }
+}
+
+void FileWatcher::threadLoop()
+{
+    pollfd fds[2] = {{m_inotify_fd, POLLIN, 0}, {m_stop_fd, POLLIN, 0}};
+
+    for(;;)
+    {
+        int timeout = -1;
+        if(!m_pending.empty())
+        {
+            auto next = std::min_element(
+                m_pending.begin(), m_pending.end(),
+                [](auto const & l, auto const & r) { return l.second.deadline < r.second.deadline; });
+
+            auto const wait = next->second.deadline - Clock::now();
+            auto const ms   = std::chrono::ceil<std::chrono::milliseconds>(wait).count();
+            timeout         = static_cast<int>(std::max<int64_t>(0, ms));
+        }
+
+        if(poll(fds, 2, timeout) < 0 && errno != EINTR)
+        {
+            Log::Log(Log::error, Log::cstr_log("FileWatcher: \"%s\" - poll failed", m_root_dir.c_str()));
+            return;
+        }
+
+        if(fds[1].revents & POLLIN)
+            return;
+
+        if(fds[0].revents & POLLIN)
+            readEvents();
+
+        flushChanges();
+    }
+}
+
+void FileWatcher::readEvents()
+{
+    alignas(inotify_event) char buf[64 * 1024];
+
+    for(;;)
+    {
+        ssize_t const len = read(m_inotify_fd, buf, sizeof(buf));
+        if(len <= 0)
+            return;   // EAGAIN, all events are read
+
+        for(char const * p = buf; p < buf + len;)
+        {
+            auto const * event = reinterpret_cast<inotify_event const *>(p);
+            p += sizeof(inotify_event) + event->len;
+
+            if(event->mask & IN_Q_OVERFLOW)
+            {
+                Log::Log(Log::warning,
+                         Log::cstr_log("FileWatcher: \"%s\" - events are lost", m_root_dir.c_str()));
+                continue;
+            }
+
+            auto it = m_watches.find(event->wd);
+            if(it == m_watches.end())
+                continue;
+
+            // the directory is removed
+            if(event->mask & IN_IGNORED)
+            {
+                m_watches.erase(it);
+                continue;
+            }
+
+            if(event->len == 0)
+                continue;
+
+            std::string path = it->second.empty() ? std::string(event->name) : it->second + '/' + event->name;
+            if(event->mask & IN_ISDIR)
+            {
+                // the files of a removed directory are reported by their own events
+                if(event->mask & (IN_CREATE | IN_MOVED_TO))
+                    addWatches(path, true);
+            }
+            else if(event->mask & (IN_CREATE | IN_MOVED_TO))
+            {
+                addChange(std::move(path), Action::added);
+            }
+            else if(event->mask & IN_CLOSE_WRITE)
+            {
+                addChange(std::move(path), Action::modified);
+            }
+            else if(event->mask & (IN_DELETE | IN_MOVED_FROM))
+            {
+                addChange(std::move(path), Action::removed);
+            }
+        }
+    }
+}
+#else
+FileWatcher::FileWatcher(std::string root_dir, Callback callback, std::chrono::milliseconds delay) :
+    m_root_dir{std::move(root_dir)}, m_callback{std::move(callback)}, m_delay{delay}
+{
+    Log::Log(Log::warning,
+             Log::cstr_log("FileWatcher: \"%s\" - not supported on the platform", m_root_dir.c_str()));
+}
+
+FileWatcher::~FileWatcher() {}
+
+void FileWatcher::addWatches(std::string const &, bool) {}
+
+void FileWatcher::threadLoop() {}
+
+void FileWatcher::readEvents() {}
+#endif
+}   // namespace evnt
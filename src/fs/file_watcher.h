@@ -0,0 +1,78 @@
+#ifndef FILEWATCHER_H
+#define FILEWATCHER_H
+
+#include <chrono>
+#include <functional>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+namespace evnt
+{
+/**
+ * Watches the files of a directory tree (inotify, Linux only). The events of a file are coalesced: the file
+ * is reported once when no events came for it during the delay, so a burst of writes or the write and rename
+ * of an editor is one change. The directories created later are watched too. The callback runs on the
+ * watcher thread.
+ */
+class FileWatcher
+{
+public:
+    enum class Action
+    {
+        added,
+        modified,
+        removed
+    };
+
+    struct Change
+    {
+        std::string path;   // relative to the root, "textures/stone.tga"
+        Action      action;
+    };
+
+    using Callback = std::function<void(std::vector<Change> const &)>;
+
+    FileWatcher(std::string root_dir, Callback callback,
+                std::chrono::milliseconds delay = std::chrono::milliseconds(100));
+    ~FileWatcher();
+
+    FileWatcher(FileWatcher const &)             = delete;
+    FileWatcher & operator=(FileWatcher const &) = delete;
+
+    bool isRunning() const { return m_thread.joinable(); }   // false if not supported or failed
+
+private:
+    using Clock = std::chrono::steady_clock;
+
+    struct PendingChange
+    {
+        Action            action;
+        Clock::time_point deadline;
+    };
+
+    static Action MergeActions(Action first, Action second);
+
+    void threadLoop();
+    void readEvents();
+    void addWatches(std::string const & dir, bool report_files);   // dir relative to the root
+    void addChange(std::string path, Action action);
+    void flushChanges();
+
+    std::string               m_root_dir;
+    Callback                  m_callback;
+    std::chrono::milliseconds m_delay;
+
+    int m_inotify_fd{-1};
+    int m_stop_fd{-1};   // eventfd, wakes the thread up
+
+    // accessed by the watcher thread only after the start
+    std::unordered_map<int, std::string>           m_watches;   // watch descriptor -> dir relative to root
+    std::unordered_map<std::string, PendingChange> m_pending;
+
+    std::thread m_thread;
+};
+}   // namespace evnt
+
+#endif   // FILEWATCHER_H
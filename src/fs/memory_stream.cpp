@@ -7,7 +7,7 @@ namespace evnt
 {
 void OutputMemoryStream::write(int8_t const * inData, size_t inByteCount)
 {
-    m_buffer.reserve(m_buffer.size() + inByteCount);
+    // no reserve() here: an exact reserve on every write defeats the geometric growth of the vector
     m_buffer.insert(std::end(m_buffer), inData, inData + inByteCount);
 }
 
@@ -25,7 +25,18 @@ void InputMemoryStream::read(void * outData, size_t inByteCount) const
         throw std::range_error("InputMemoryStream::Read - no data to read!");
     }
 
-    std::memcpy(outData, mup_data.get() + m_head, inByteCount);
+    std::memcpy(outData, mp_data + m_head, inByteCount);
+
+    m_head = resultHead;
+}
+
+void InputMemoryStream::skip(size_t inByteCount) const
+{
+    size_t resultHead = m_head + inByteCount;
+    if(resultHead > m_capacity)
+    {
+        throw std::range_error("InputMemoryStream::skip - no data to skip!");
+    }
 
     m_head = resultHead;
 }
@@ -31,14 +31,14 @@ public:
         return *this;
     }
 
-    OutputMemoryStream(OutputMemoryStream && other) : OutputMemoryStream() { std::swap(*this, other); }
+    OutputMemoryStream(OutputMemoryStream && other) : OutputMemoryStream() { swap(*this, other); }
     OutputMemoryStream & operator=(OutputMemoryStream && other)
     {
         // check for self-assignment
         if(&other == this)
             return *this;
 
-        std::swap(*this, other);
+        swap(*this, other);
 
         return *this;
     }
@@ -52,11 +52,12 @@ public:
 
     int8_t const * getBufferPtr() const { return m_buffer.data(); }
     size_t         getLength() const { return m_buffer.size(); }
+    void           reserve(size_t inByteCount) { m_buffer.reserve(inByteCount); }
 
     void write(int8_t const * inData, size_t inByteCount);
 
     template<typename T>
-    void write(T & inData)
+    void write(T const & inData)
     {
         // https://stackoverflow.com/questions/48225673/why-is-stdis-pod-deprecated-in-c20
         static_assert(std::is_standard_layout_v<T>, "Generic Write only supports primitive data types");
@@ -83,10 +84,15 @@ class InputMemoryStream
 {
 public:
     InputMemoryStream(std::unique_ptr<int8_t[]> inData, size_t inByteCount) :
-        mup_data{std::move(inData)}, m_head{0}, m_capacity{inByteCount}
+        mup_data{std::move(inData)}, mp_data{mup_data.get()}, m_head{0}, m_capacity{inByteCount}
     {}
-    InputMemoryStream(size_t inByteCount) :
-        mup_data{std::make_unique<int8_t[]>(inByteCount)}, m_head{0}, m_capacity{inByteCount}
+    explicit InputMemoryStream(size_t inByteCount) :
+        mup_data{std::make_unique<int8_t[]>(inByteCount)}, mp_data{mup_data.get()}, m_head{0},
+        m_capacity{inByteCount}
+    {}
+    // non-owning view, the data must outlive the stream (copies of the stream own their data)
+    InputMemoryStream(int8_t const * inData, size_t inByteCount) :
+        mp_data{inData}, m_head{0}, m_capacity{inByteCount}
     {}
     InputMemoryStream()  = default;
     ~InputMemoryStream() = default;
@@ -94,7 +100,8 @@ public:
     InputMemoryStream(InputMemoryStream const & other) : m_head{other.m_head}, m_capacity{other.m_capacity}
     {
         mup_data = std::make_unique<int8_t[]>(m_capacity);
-        std::memcpy(mup_data.get(), other.mup_data.get(), m_capacity);
+        std::memcpy(mup_data.get(), other.mp_data, m_capacity);
+        mp_data = mup_data.get();
     }
     InputMemoryStream & operator=(InputMemoryStream const & other)
     {
@@ -105,19 +112,20 @@ public:
         m_head     = other.m_head;
         m_capacity = other.m_capacity;
         mup_data   = std::make_unique<int8_t[]>(m_capacity);
-        std::memcpy(mup_data.get(), other.mup_data.get(), m_capacity);
+        std::memcpy(mup_data.get(), other.mp_data, m_capacity);
+        mp_data = mup_data.get();
 
         return *this;
     }
 
-    InputMemoryStream(InputMemoryStream && other) : InputMemoryStream() { std::swap(*this, other); }
+    InputMemoryStream(InputMemoryStream && other) : InputMemoryStream() { swap(*this, other); }
     InputMemoryStream & operator=(InputMemoryStream && other)
     {
         // check for self-assignment
         if(&other == this)
             return *this;
 
-        std::swap(*this, other);
+        swap(*this, other);
 
         return *this;
     }
@@ -127,6 +135,7 @@ public:
         using std::swap;
 
         swap(left.mup_data, right.mup_data);
+        swap(left.mp_data, right.mp_data);
         swap(left.m_head, right.m_head);
         swap(left.m_capacity, right.m_capacity);
     }
@@ -151,18 +160,20 @@ public:
 
     size_t         getRemainingDataSize() const { return m_capacity - m_head; }
     size_t         getCapacity() const { return m_capacity; }
-    int8_t const * getCurPosPtr() const { return mup_data.get() + m_head; }
-    int8_t const * getPtr() const { return mup_data.get(); }
+    int8_t const * getCurPosPtr() const { return mp_data + m_head; }
+    int8_t const * getPtr() const { return mp_data; }
 
     void resetHead() { m_head = 0; }
+    void skip(size_t inByteCount) const;
     void setCapacity(uint32_t newCapacity) { m_capacity = newCapacity; }
 
     static InputMemoryStream ConvertToInputMemoryStream(OutputMemoryStream const & inStream);
 
 private:
     std::unique_ptr<int8_t[]> mup_data;
-    mutable size_t            m_head;
-    size_t                    m_capacity;
+    int8_t const *            mp_data{nullptr};
+    mutable size_t            m_head{0};
+    size_t                    m_capacity{0};
 };
 }   // namespace evnt
 
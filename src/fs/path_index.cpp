@@ -0,0 +1,190 @@
+#include "path_index.h"
+
+#include <cassert>
+#include <cstring>
+
+namespace evnt
+{
+// FNV-1a
+uint64_t PathIndex::Hash(std::string_view str)
+{
+    uint64_t hash = 14695981039346656037ull;
+    for(char c : str)
+    {
+        hash ^= static_cast<uint8_t>(c);
+        hash *= 1099511628211ull;
+    }
+
+    return hash;
+}
+
+template<typename E>
+uint32_t PathIndex::Table::find(std::vector<E> const & entries, std::string_view path, uint64_t hash) const
+{
+    if(slots.empty())
+        return npos;
+
+    size_t const mask = slots.size() - 1;
+    for(size_t i = static_cast<size_t>(hash) & mask;; i = (i + 1) & mask)
+    {
+        Slot const & slot = slots[i];
+        if(slot.index == npos)
+            return npos;
+
+        if(slot.hash == hash && entries[slot.index].path == path)
+            return slot.index;
+    }
+}
+
+void PathIndex::Table::insert(uint64_t hash, uint32_t index)
+{
+    // the load factor is kept below 1/2, probe sequences stay short
+    if((size + 1) * 2 > slots.size())
+        rehash(slots.empty() ? 64 : slots.size() * 2);
+
+    size_t const mask = slots.size() - 1;
+    size_t       i    = static_cast<size_t>(hash) & mask;
+    while(slots[i].index != npos)
+        i = (i + 1) & mask;
+
+    slots[i] = {hash, index};
+    ++size;
+}
+
+void PathIndex::Table::rehash(size_t num_slots)
+{
+    assert((num_slots & (num_slots - 1)) == 0);
+
+    std::vector<Slot> old_slots(num_slots);
+    std::swap(slots, old_slots);
+
+    size_t const mask = slots.size() - 1;
+    for(Slot const & slot : old_slots)
+    {
+        if(slot.index == npos)
+            continue;
+
+        size_t i = static_cast<size_t>(slot.hash) & mask;
+        while(slots[i].index != npos)
+            i = (i + 1) & mask;
+
+        slots[i] = slot;
+    }
+}
+
+std::pair<std::string_view, bool> PathIndex::insert(std::string_view path, uint32_t value)
+{
+    uint64_t const hash  = Hash(path);
+    uint32_t const found = m_file_table.find(m_files, path, hash);
+    if(found != npos)
+        return {m_files[found].path, false};
+
+    std::string_view const interned = intern(path);
+    auto const             index    = static_cast<uint32_t>(m_files.size());
+
+    m_files.push_back({interned, value});
+    m_file_table.insert(hash, index);
+
+    size_t const   sep = interned.rfind('/');
+    uint32_t const dir = getOrCreateDir(sep == std::string_view::npos ? std::string_view{}
+                                                                      : interned.substr(0, sep));
+    m_dirs[dir].files.push_back(index);
+
+    return {interned, true};
+}
+
+uint32_t PathIndex::find(std::string_view path) const
+{
+    uint32_t const index = m_file_table.find(m_files, path, Hash(path));
+    return index == npos ? npos : m_files[index].value;
+}
+
+void PathIndex::reserve(size_t num_files)
+{
+    m_files.reserve(num_files);
+
+    size_t num_slots = 64;
+    while(num_slots < num_files * 2)
+        num_slots *= 2;
+
+    if(num_slots > m_file_table.slots.size())
+        m_file_table.rehash(num_slots);
+}
+
+void PathIndex::forEachFile(std::string_view dir, bool recursive,
+                            std::function<void(std::string_view, uint32_t)> const & func) const
+{
+    // "textures/" and "textures" are the same directory
+    if(!dir.empty() && dir.back() == '/')
+        dir.remove_suffix(1);
+
+    uint32_t const index = m_dir_table.find(m_dirs, dir, Hash(dir));
+    if(index != npos)
+        visitDir(index, recursive, func);
+}
+
+void PathIndex::visitDir(uint32_t dir, bool recursive,
+                         std::function<void(std::string_view, uint32_t)> const & func) const
+{
+    for(uint32_t file : m_dirs[dir].files)
+        func(m_files[file].path, m_files[file].value);
+
+    if(recursive)
+    {
+        for(uint32_t subdir : m_dirs[dir].subdirs)
+            visitDir(subdir, recursive, func);
+    }
+}
+
+uint32_t PathIndex::getOrCreateDir(std::string_view path)
+{
+    // path is interned
+    uint64_t const hash  = Hash(path);
+    uint32_t       index = m_dir_table.find(m_dirs, path, hash);
+    if(index != npos)
+        return index;
+
+    index = static_cast<uint32_t>(m_dirs.size());
+    m_dirs.push_back({path, {}, {}});
+    m_dir_table.insert(hash, index);
+
+    if(!path.empty())
+    {
+        size_t const   sep    = path.rfind('/');
+        uint32_t const parent = getOrCreateDir(sep == std::string_view::npos ? std::string_view{}
+                                                                            : path.substr(0, sep));
+        m_dirs[parent].subdirs.push_back(index);
+    }
+
+    return index;
+}
+
+std::string_view PathIndex::intern(std::string_view str)
+{
+    if(str.empty())
+        return {};
+
+    char * data = nullptr;
+    if(str.size() > string_block_size / 4)
+    {
+        // long strings get a block of their own, the current block stays in use
+        m_string_blocks.push_back(std::make_unique<char[]>(str.size()));
+        data = m_string_blocks.back().get();
+    }
+    else
+    {
+        if(mp_string_block == nullptr || str.size() > string_block_size - m_string_block_used)
+        {
+            m_string_blocks.push_back(std::make_unique<char[]>(string_block_size));
+            mp_string_block     = m_string_blocks.back().get();
+            m_string_block_used = 0;
+        }
+
+        data = mp_string_block + m_string_block_used;
+        m_string_block_used += str.size();
+    }
+
+    std::memcpy(data, str.data(), str.size());
+    return {data, str.size()};
+}
+}   // namespace evnt
@@ -0,0 +1,88 @@
+#ifndef PATHINDEX_H
+#define PATHINDEX_H
+
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+namespace evnt
+{
+/**
+ * Maps file paths ("fonts/times.ttf") to values. The table is a flat open addressing hash table (linear
+ * probing) of precomputed path hashes, the path strings are interned in the index and stay valid as long as
+ * the index. Files are also grouped by directory for the prefix enumeration. Paths can't be removed.
+ * Not thread safe.
+ */
+class PathIndex
+{
+public:
+    static constexpr uint32_t npos = ~0u;
+
+    static uint64_t Hash(std::string_view str);
+
+    // returns the interned path and false if the path is already in the index, the existing value is kept
+    std::pair<std::string_view, bool> insert(std::string_view path, uint32_t value);
+
+    uint32_t find(std::string_view path) const;   // npos if not found
+    bool     contains(std::string_view path) const { return find(path) != npos; }
+    size_t   size() const { return m_files.size(); }
+    void     reserve(size_t num_files);
+
+    // calls func(path, value) for the files in dir ("" - the root) in the order of insertion
+    void forEachFile(std::string_view dir, bool recursive,
+                     std::function<void(std::string_view, uint32_t)> const & func) const;
+
+    // copy of the string which lives as long as the index
+    std::string_view intern(std::string_view str);
+
+private:
+    struct Slot
+    {
+        uint64_t hash{0};
+        uint32_t index{npos};   // npos - empty slot
+    };
+
+    struct Table
+    {
+        std::vector<Slot> slots;   // the size is 0 or a power of two
+        size_t            size{0};
+
+        template<typename E>
+        uint32_t find(std::vector<E> const & entries, std::string_view path, uint64_t hash) const;
+        void     insert(uint64_t hash, uint32_t index);
+        void     rehash(size_t num_slots);
+    };
+
+    struct FileEntry
+    {
+        std::string_view path;
+        uint32_t         value;
+    };
+
+    struct DirEntry
+    {
+        std::string_view      path;
+        std::vector<uint32_t> files;     // indices in m_files
+        std::vector<uint32_t> subdirs;   // indices in m_dirs
+    };
+
+    uint32_t getOrCreateDir(std::string_view path);
+    void     visitDir(uint32_t dir, bool recursive,
+                      std::function<void(std::string_view, uint32_t)> const & func) const;
+
+    Table                  m_file_table;
+    std::vector<FileEntry> m_files;
+    Table                  m_dir_table;
+    std::vector<DirEntry>  m_dirs;
+
+    static constexpr size_t              string_block_size = 64 * 1024;
+    std::vector<std::unique_ptr<char[]>> m_string_blocks;
+    char *                               mp_string_block{nullptr};   // the block being filled
+    size_t                               m_string_block_used{0};
+};
+}   // namespace evnt
+
+#endif   // PATHINDEX_H
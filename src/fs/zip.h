@@ -57,6 +57,29 @@ struct LocalFileHeader
                                       // extra field (variable size)
 };
 
+struct EOCD64Locator   // Zip64 end of central directory locator, precedes EOCD
+{
+    uint32_t signature;      // PK67
+    uint32_t diskNumber;     // number of the disk with the Zip64 EOCD
+    uint64_t eocd64Offset;   // relative offset of the Zip64 EOCD
+    uint32_t totalDisks;     // total number of disks
+};
+
+struct EOCD64   // Zip64 end of central directory record
+{
+    uint32_t signature;                      // PK66
+    uint64_t sizeOfRecord;                   // size of the remaining record
+    uint16_t versionMadeBy;                  // version made by
+    uint16_t versionToExtract;               // version needed to extract
+    uint32_t diskNumber;                     // number of this disk
+    uint32_t startDiskNumber;                // disk where central directory starts
+    uint64_t numberCentralDirectoryRecord;   // number of central directory records on this disk
+    uint64_t totalCentralDirectoryRecord;    // total number of central directory records
+    uint64_t sizeOfCentralDirectory;         // size of central directory
+    uint64_t centralDirectoryOffset;         // offset of start of central directory
+                                             // extensible data sector (variable size)
+};
+
 #pragma pack(pop)
 
 #endif   // ZIP_H_INCLUDED
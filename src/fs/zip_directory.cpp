@@ -0,0 +1,141 @@
+#include "zip_directory.h"
+#include "../log/log.h"
+#include "zip.h"
+#include <algorithm>
+#include <cstring>
+
+namespace evnt
+{
+bool ReadZipCentralDirectory(std::istream & is, std::string const & fname, ZipCentralDirectory & cd)
+{
+    is.seekg(0, std::istream::end);
+    uint64_t const file_size = static_cast<uint64_t>(is.tellg());
+
+    // EOCD is followed by a comment of up to 64KB and preceded by the ZIP64 locator
+    size_t const eocd_size = sizeof(uint32_t) + sizeof(EOCD);
+    size_t const tail_size =
+        static_cast<size_t>(std::min<uint64_t>(file_size, sizeof(EOCD64Locator) + eocd_size + 0xFFFF));
+
+    std::vector<char> tail(tail_size);
+    is.seekg(static_cast<std::streamoff>(file_size - tail_size), std::istream::beg);
+    is.read(tail.data(), static_cast<std::streamsize>(tail_size));
+
+    size_t eocd_pos = tail_size;   // position of the signature in tail
+    EOCD   eocd{};
+    if(is && tail_size >= eocd_size)
+    {
+        for(size_t pos = tail_size - eocd_size + 1; pos-- > 0;)
+        {
+            uint32_t signature = 0;
+            std::memcpy(&signature, tail.data() + pos, sizeof(signature));
+            if(0x06054b50 != signature)
+                continue;
+
+            std::memcpy(&eocd, tail.data() + pos + sizeof(signature), sizeof(eocd));
+            if(pos + eocd_size + eocd.commentLength <= tail_size)
+            {
+                eocd_pos = pos;
+                break;
+            }
+        }
+    }
+
+    if(eocd_pos == tail_size)
+    {
+        Log::Log(Log::error,
+                 Log::cstr_log("ReadZipCentralDirectory File: \"%s\" - not found EOCD signature",
+                               fname.c_str()));
+        return false;
+    }
+
+    uint64_t num_entries = eocd.totalCentralDirectoryRecord;
+    uint64_t cd_size     = eocd.sizeOfCentralDirectory;
+    uint64_t cd_offset   = eocd.centralDirectoryOffset;
+
+    EOCD64Locator locator{};
+    if(eocd_pos >= sizeof(locator))
+        std::memcpy(&locator, tail.data() + eocd_pos - sizeof(locator), sizeof(locator));
+
+    if(0x07064b50 == locator.signature)
+    {
+        EOCD64 eocd64{};
+        is.seekg(static_cast<std::streamoff>(locator.eocd64Offset), std::istream::beg);
+        is.read(reinterpret_cast<char *>(&eocd64), sizeof(eocd64));
+
+        if(!is || 0x06064b50 != eocd64.signature)
+        {
+            Log::Log(Log::error,
+                     Log::cstr_log("ReadZipCentralDirectory File: \"%s\" - not found ZIP64 EOCD",
+                                   fname.c_str()));
+            return false;
+        }
+
+        num_entries = eocd64.totalCentralDirectoryRecord;
+        cd_size     = eocd64.sizeOfCentralDirectory;
+        cd_offset   = eocd64.centralDirectoryOffset;
+    }
+
+    if(cd_offset > file_size || cd_size > file_size - cd_offset
+       || num_entries > cd_size / sizeof(CentralDirectoryFileHeader))
+    {
+        Log::Log(Log::error, Log::cstr_log("ReadZipCentralDirectory File: \"%s\" - corrupted EOCD",
+                                           fname.c_str()));
+        return false;
+    }
+
+    cd.data.resize(static_cast<size_t>(cd_size));
+    is.seekg(static_cast<std::streamoff>(cd_offset), std::istream::beg);
+    is.read(cd.data.data(), static_cast<std::streamsize>(cd_size));
+    if(!is)
+    {
+        Log::Log(Log::error, Log::cstr_log("ReadZipCentralDirectory File: \"%s\" - truncated",
+                                           fname.c_str()));
+        return false;
+    }
+
+    cd.offset      = cd_offset;
+    cd.num_entries = num_entries;
+    char const * const comment = tail.data() + eocd_pos + eocd_size;
+    cd.comment.assign(comment, comment + eocd.commentLength);
+
+    return true;
+}
+
+bool ReadZip64ExtraField(char const * extra, size_t extra_size, uint64_t & uncompressed,
+                         uint64_t & compressed, uint64_t & lfh_offset)
+{
+    for(size_t pos = 0; pos + 4 <= extra_size;)
+    {
+        uint16_t id   = 0;
+        uint16_t size = 0;
+        std::memcpy(&id, extra + pos, sizeof(id));
+        std::memcpy(&size, extra + pos + 2, sizeof(size));
+        pos += 4;
+
+        if(pos + size > extra_size)
+            return false;
+
+        if(id == 0x0001)
+        {
+            size_t field = pos;
+            for(uint64_t * value : {&uncompressed, &compressed, &lfh_offset})
+            {
+                if(*value != 0xFFFFFFFF)
+                    continue;
+
+                if(field + sizeof(uint64_t) > pos + size)
+                    return false;
+
+                std::memcpy(value, extra + field, sizeof(uint64_t));
+                field += sizeof(uint64_t);
+            }
+
+            return true;
+        }
+
+        pos += size;
+    }
+
+    return false;
+}
+}   // namespace evnt
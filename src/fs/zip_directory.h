@@ -0,0 +1,30 @@
+#ifndef ZIPDIRECTORY_H
+#define ZIPDIRECTORY_H
+
+#include <cstdint>
+#include <istream>
+#include <string>
+#include <vector>
+
+namespace evnt
+{
+struct ZipCentralDirectory
+{
+    uint64_t          offset{0};   // of the first header, the data section ends here
+    uint64_t          num_entries{0};
+    std::vector<char> data;      // the headers with the names, extra fields and comments
+    std::vector<char> comment;   // of the archive
+};
+
+// Reads the tail of the archive (EOCD with the comment and the ZIP64 locator) and the whole central directory
+// with one request each, ZIP64 archives are supported. false if the file is not an archive or is corrupted,
+// the errors are logged with fname.
+bool ReadZipCentralDirectory(std::istream & is, std::string const & fname, ZipCentralDirectory & cd);
+
+// reads the value of the ZIP64 extended information extra field for each field set to 0xFFFFFFFF, the values
+// are stored in the order of the arguments
+bool ReadZip64ExtraField(char const * extra, size_t extra_size, uint64_t & uncompressed,
+                         uint64_t & compressed, uint64_t & lfh_offset);
+}   // namespace evnt
+
+#endif   // ZIPDIRECTORY_H
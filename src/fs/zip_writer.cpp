@@ -0,0 +1,483 @@
+#include "zip_writer.h"
+#include "../core/threadpool.h"
+#include "../log/log.h"
+#include "zip.h"
+#include "zip_directory.h"
+#include <algorithm>
+#include <cassert>
+#include <chrono>
+#include <cstring>
+#include <filesystem>
+#include <limits>
+#include <zlib.h>
+
+namespace evnt
+{
+static constexpr uint64_t zip64_marker_32 = 0xFFFFFFFF;
+static constexpr uint64_t zip64_marker_16 = 0xFFFF;
+
+template<typename T>
+static void Append(std::vector<char> & buf, T const & value)
+{
+    char const * bytes = reinterpret_cast<char const *>(&value);
+    buf.insert(buf.end(), bytes, bytes + sizeof(value));
+}
+
+static void GetDosTime(std::time_t rawtime, uint16_t & time, uint16_t & date)
+{
+    // http://stackoverflow.com/questions/15763259/unix-timestamp-to-fat-timestamp
+    struct tm * timeinfo;
+    timeinfo = localtime(&rawtime);
+
+    // the DOS year is 7 bits from 1980, the earlier times (0 - unknown) get the first day
+    if(timeinfo == nullptr || timeinfo->tm_year < 80)
+    {
+        time = 0;
+        date = (1 << 5) | 1;
+        return;
+    }
+
+    timeinfo->tm_year = std::min(timeinfo->tm_year, 80 + 127);
+
+    time =
+        static_cast<uint16_t>((timeinfo->tm_hour << 11) | (timeinfo->tm_min << 5) | (timeinfo->tm_sec >> 1));
+    date = static_cast<uint16_t>(
+        ((timeinfo->tm_year - 80) << 9) | ((timeinfo->tm_mon + 1) << 5) | (timeinfo->tm_mday));
+}
+
+ZipWriter::ZipWriter(std::string const & fname, bool append, ThreadPool * pool) :
+    ZipWriter(fname, append, pool, Policy{})
+{}
+
+ZipWriter::ZipWriter(std::string const & fname, bool append, ThreadPool * pool, Policy policy) :
+    m_fname{fname}, mp_thread_pool{pool}, m_policy{policy}
+{
+    if(append && std::filesystem::exists(fname))
+    {
+        m_ofs.open(fname, std::fstream::binary | std::fstream::in | std::fstream::out);
+        if(!m_ofs.is_open())
+            return;
+
+        ZipCentralDirectory cd;
+        if(!ReadZipCentralDirectory(m_ofs, fname, cd))
+        {
+            m_ofs.close();   // not an archive, the file is kept
+            return;
+        }
+
+        // the names of the archive entries are kept to reject duplicates
+        for(size_t i = 0, pos = 0; i < cd.num_entries; ++i)
+        {
+            CentralDirectoryFileHeader cdfh{};
+            if(pos + sizeof(cdfh) <= cd.data.size())
+                std::memcpy(&cdfh, cd.data.data() + pos, sizeof(cdfh));
+
+            size_t const name_pos = pos + sizeof(cdfh);
+            pos = name_pos + cdfh.filenameLength + cdfh.extraFieldLength + cdfh.fileCommentLength;
+
+            if(0x02014b50 != cdfh.signature || pos > cd.data.size())
+            {
+                Log::Log(Log::error, Log::cstr_log("ZipWriter: \"%s\" - corrupted central directory",
+                                                   fname.c_str()));
+                m_ofs.close();
+                return;
+            }
+
+            m_names.emplace(cd.data.data() + name_pos, cdfh.filenameLength);
+        }
+
+        // the directory and the end records are written back if the append fails
+        m_ofs.seekg(0, std::fstream::end);
+        m_append_end = static_cast<uint64_t>(m_ofs.tellg());
+        m_old_tail.resize(m_append_end - cd.offset);
+        m_ofs.seekg(static_cast<std::streamoff>(cd.offset), std::fstream::beg);
+        m_ofs.read(m_old_tail.data(), static_cast<std::streamsize>(m_old_tail.size()));
+        if(!m_ofs)
+        {
+            Log::Log(Log::error, Log::cstr_log("ZipWriter: \"%s\" - read error", fname.c_str()));
+            m_ofs.close();
+            return;
+        }
+
+        m_num_entries = cd.num_entries;
+        m_central_dir = std::move(cd.data);
+        m_comment     = std::move(cd.comment);
+
+        // the new entries overwrite the old central directory, the new one is written after them
+        m_ofs.seekp(static_cast<std::streamoff>(cd.offset), std::fstream::beg);
+        m_offset       = cd.offset;
+        m_append_start = cd.offset;
+        return;
+    }
+
+    m_ofs.open(fname, std::fstream::binary | std::fstream::out | std::fstream::trunc);
+}
+
+ZipWriter::~ZipWriter()
+{
+    // the pending entries reference the file data, they must be done before the files are released
+    finish();
+}
+
+bool ZipWriter::addFile(BaseFile const * file)
+{
+    assert(file != nullptr);
+
+    if(!isOpen() || m_finished || m_failed)
+        return false;
+
+    if(!m_names.insert(file->getName()).second)
+    {
+        Log::Log(Log::warning, Log::cstr_log("ZipWriter::AddFile File: \"%s\" - already in \"%s\"",
+                                             file->getName().c_str(), m_fname.c_str()));
+        return false;
+    }
+
+    if(mp_thread_pool == nullptr)
+    {
+        if(!writeEntry(CompressEntry(file, m_policy)))
+            m_failed = true;
+
+        return !m_failed;
+    }
+
+    size_t const size = file->getFileSize();
+    m_pending.push_back(
+        {mp_thread_pool->submit([file, policy = m_policy] { return CompressEntry(file, policy); }), size});
+    m_pending_bytes += size;
+
+    return writePending(max_pending_bytes);
+}
+
+bool ZipWriter::finish()
+{
+    if(m_finished)
+        return !m_failed;
+
+    m_finished = true;
+    writePending(0);
+
+    if(!isOpen())
+        return false;
+
+    // the entries written before a failure are dropped with the archive changes
+    if(m_failed || !writeCentralDirectory())
+    {
+        m_failed = true;
+        discard();
+    }
+
+    return !m_failed;
+}
+
+void ZipWriter::discard()
+{
+    m_ofs.close();
+
+    std::error_code ec;
+    if(!m_old_tail.empty())
+    {
+        std::filesystem::resize_file(m_fname, m_append_start, ec);
+        if(!ec)
+        {
+            std::ofstream ofs(m_fname, std::ofstream::binary | std::ofstream::app);
+            ofs.write(m_old_tail.data(), static_cast<std::streamsize>(m_old_tail.size()));
+            ofs.close();
+            if(!ofs)
+                ec = std::make_error_code(std::errc::io_error);
+        }
+    }
+    else
+    {
+        std::filesystem::remove(m_fname, ec);
+    }
+
+    if(ec)
+        Log::Log(Log::error, Log::cstr_log("ZipWriter: \"%s\" - not restored: %s", m_fname.c_str(),
+                                           ec.message().c_str()));
+}
+
+bool ZipWriter::writePending(size_t max_bytes)
+{
+    while(!m_pending.empty())
+    {
+        std::future<Entry> & front = m_pending.front().entry;
+        if(front.wait_for(std::chrono::seconds(0)) != std::future_status::ready)
+        {
+            if(m_pending_bytes <= max_bytes)
+                break;
+
+            front.wait();
+        }
+
+        try
+        {
+            Entry const entry = front.get();
+            if(!m_failed && !writeEntry(entry))
+                m_failed = true;
+        }
+        catch(std::exception const & e)
+        {
+            Log::Log(Log::error,
+                     Log::cstr_log("ZipWriter: \"%s\" - compression failed: %s", m_fname.c_str(), e.what()));
+            m_failed = true;
+        }
+
+        m_pending_bytes -= m_pending.front().size;
+        m_pending.pop_front();
+    }
+
+    return !m_failed;
+}
+
+ZipWriter::Entry ZipWriter::CompressEntry(BaseFile const * file, Policy const & policy)
+{
+    size_t const size = file->getFileSize();
+
+    Entry entry;
+    entry.name              = file->getName();
+    entry.time              = file->timeStamp();
+    entry.src               = file->getData();
+    entry.uncompressed_size = size;
+    entry.compressed_size   = size;
+
+    // crc32 takes 32 bit sizes
+    auto const * src = reinterpret_cast<unsigned char const *>(entry.src);
+    uLong        crc = crc32(0, nullptr, 0);
+    for(size_t pos = 0; pos < size;)
+    {
+        uInt const part = static_cast<uInt>(std::min<size_t>(size - pos, std::numeric_limits<uInt>::max()));
+        crc             = crc32(crc, src + pos, part);
+        pos += part;
+    }
+    entry.crc32 = static_cast<uint32_t>(crc);
+
+    if(size < policy.min_deflate_size)
+        return entry;
+
+    // already compressed data (textures, sounds) is found out on a prefix instead of deflating all of it
+    if(size > policy.sample_size)
+    {
+        size_t const sample     = policy.sample_size;
+        size_t const max_sample = static_cast<size_t>(static_cast<double>(sample) * policy.max_ratio);
+        if(!Deflate(entry.src, sample, Z_BEST_SPEED, max_sample, entry.data))
+        {
+            entry.data = {};
+            return entry;
+        }
+    }
+
+    int const    level    = size < policy.large_size ? policy.level : policy.large_level;
+    size_t const max_size = static_cast<size_t>(static_cast<double>(size) * policy.max_ratio);
+    if(Deflate(entry.src, size, level, max_size, entry.data))
+    {
+        entry.compressed      = true;
+        entry.compressed_size = entry.data.size();
+    }
+    else
+    {
+        entry.data = {};
+    }
+
+    return entry;
+}
+
+bool ZipWriter::Deflate(int8_t const * src, size_t size, int level, size_t max_size,
+                        std::vector<uint8_t> & dst)
+{
+    z_stream zs;
+    std::memset(&zs, 0, sizeof(zs));
+    if(deflateInit2(&zs, level, Z_DEFLATED, -MAX_WBITS, 8, Z_DEFAULT_STRATEGY) != Z_OK)
+        return false;
+
+    // the output grows up to max_size, deflate stops as soon as the entry is known to be stored
+    dst.resize(std::min(max_size, size / 4 + 1024));
+
+    zs.next_in = reinterpret_cast<unsigned char *>(const_cast<int8_t *>(src));
+
+    size_t in_left = size;
+    size_t out_pos = 0;
+    int    res     = Z_OK;
+    while(res == Z_OK || res == Z_BUF_ERROR)
+    {
+        if(out_pos == dst.size())
+        {
+            if(dst.size() == max_size)
+                break;
+
+            dst.resize(std::min(max_size, dst.size() * 2));
+        }
+
+        // avail_in and avail_out are 32 bit
+        uInt const in_part  = static_cast<uInt>(std::min<size_t>(in_left, std::numeric_limits<uInt>::max()));
+        uInt const out_part = static_cast<uInt>(
+            std::min<size_t>(dst.size() - out_pos, std::numeric_limits<uInt>::max()));
+        zs.avail_in  = in_part;
+        zs.next_out  = dst.data() + out_pos;
+        zs.avail_out = out_part;
+
+        res = deflate(&zs, in_part == in_left ? Z_FINISH : Z_NO_FLUSH);
+
+        in_left -= in_part - zs.avail_in;
+        out_pos += out_part - zs.avail_out;
+    }
+
+    deflateEnd(&zs);
+
+    dst.resize(out_pos);
+    return res == Z_STREAM_END;
+}
+
+bool ZipWriter::writeEntry(Entry const & entry)
+{
+    uint16_t time = 0;
+    uint16_t date = 0;
+    GetDosTime(entry.time, time, date);
+
+    uint64_t const lfh_offset = m_offset;
+    bool const     zip64_sizes =
+        entry.uncompressed_size >= zip64_marker_32 || entry.compressed_size >= zip64_marker_32;
+
+    LocalFileHeader lfh{};
+    std::memset(&lfh, 0, sizeof(lfh));
+    lfh.signature         = 0x04034b50;
+    lfh.versionToExtract  = zip64_sizes ? 45 : 20;
+    lfh.compressionMethod = entry.compressed ? Z_DEFLATED : 0;
+    lfh.modificationTime  = time;
+    lfh.modificationDate  = date;
+    lfh.crc32             = entry.crc32;
+    lfh.compressedSize    = static_cast<uint32_t>(std::min(entry.compressed_size, zip64_marker_32));
+    lfh.uncompressedSize  = static_cast<uint32_t>(std::min(entry.uncompressed_size, zip64_marker_32));
+    lfh.filenameLength    = static_cast<uint16_t>(entry.name.size());
+
+    // ZIP64 extended information, the local header has both sizes or none
+    std::vector<char> extra;
+    if(zip64_sizes)
+    {
+        Append(extra, uint16_t{0x0001});
+        Append(extra, uint16_t{16});
+        Append(extra, entry.uncompressed_size);
+        Append(extra, entry.compressed_size);
+    }
+    lfh.extraFieldLength = static_cast<uint16_t>(extra.size());
+
+    char const * data = entry.compressed ? reinterpret_cast<char const *>(entry.data.data())
+                                         : reinterpret_cast<char const *>(entry.src);
+
+    m_ofs.write(reinterpret_cast<char const *>(&lfh), sizeof(lfh));
+    m_ofs.write(entry.name.data(), static_cast<std::streamsize>(entry.name.size()));
+    m_ofs.write(extra.data(), static_cast<std::streamsize>(extra.size()));
+    m_ofs.write(data, static_cast<std::streamsize>(entry.compressed_size));
+
+    if(!m_ofs)
+    {
+        Log::Log(Log::error, Log::cstr_log("ZipWriter: \"%s\" - write error", m_fname.c_str()));
+        return false;
+    }
+
+    m_offset += sizeof(lfh) + entry.name.size() + extra.size() + entry.compressed_size;
+
+    // the central directory has the 64 bit values of the fields which don't fit
+    std::vector<char> values;
+    for(uint64_t value : {entry.uncompressed_size, entry.compressed_size, lfh_offset})
+    {
+        if(value >= zip64_marker_32)
+            Append(values, value);
+    }
+
+    extra.clear();
+    if(!values.empty())
+    {
+        Append(extra, uint16_t{0x0001});
+        Append(extra, static_cast<uint16_t>(values.size()));
+        extra.insert(extra.end(), values.begin(), values.end());
+    }
+
+    CentralDirectoryFileHeader cdfh{};
+    std::memset(&cdfh, 0, sizeof(cdfh));
+    cdfh.signature             = 0x02014b50;
+    cdfh.versionMadeBy         = extra.empty() ? 20 : 45;
+    cdfh.versionToExtract      = extra.empty() ? 20 : 45;
+    cdfh.compressionMethod     = lfh.compressionMethod;
+    cdfh.modificationTime      = time;
+    cdfh.modificationDate      = date;
+    cdfh.crc32                 = entry.crc32;
+    cdfh.compressedSize        = lfh.compressedSize;
+    cdfh.uncompressedSize      = lfh.uncompressedSize;
+    cdfh.filenameLength        = lfh.filenameLength;
+    cdfh.extraFieldLength      = static_cast<uint16_t>(extra.size());
+    cdfh.localFileHeaderOffset = static_cast<uint32_t>(std::min(lfh_offset, zip64_marker_32));
+
+    Append(m_central_dir, cdfh);
+    m_central_dir.insert(m_central_dir.end(), entry.name.begin(), entry.name.end());
+    m_central_dir.insert(m_central_dir.end(), extra.begin(), extra.end());
+    ++m_num_entries;
+
+    return true;
+}
+
+bool ZipWriter::writeCentralDirectory()
+{
+    uint64_t const cd_offset = m_offset;
+    uint64_t const cd_size   = m_central_dir.size();
+
+    m_ofs.write(m_central_dir.data(), static_cast<std::streamsize>(cd_size));
+
+    bool const zip64 =
+        m_num_entries >= zip64_marker_16 || cd_size >= zip64_marker_32 || cd_offset >= zip64_marker_32;
+    if(zip64)
+    {
+        EOCD64 eocd64{};
+        std::memset(&eocd64, 0, sizeof(eocd64));
+        eocd64.signature    = 0x06064b50;
+        eocd64.sizeOfRecord = sizeof(eocd64) - sizeof(eocd64.signature) - sizeof(eocd64.sizeOfRecord);
+        eocd64.versionMadeBy                = 45;
+        eocd64.versionToExtract             = 45;
+        eocd64.numberCentralDirectoryRecord = m_num_entries;
+        eocd64.totalCentralDirectoryRecord  = m_num_entries;
+        eocd64.sizeOfCentralDirectory       = cd_size;
+        eocd64.centralDirectoryOffset       = cd_offset;
+
+        EOCD64Locator locator{};
+        std::memset(&locator, 0, sizeof(locator));
+        locator.signature    = 0x07064b50;
+        locator.eocd64Offset = cd_offset + cd_size;
+        locator.totalDisks   = 1;
+
+        m_ofs.write(reinterpret_cast<char const *>(&eocd64), sizeof(eocd64));
+        m_ofs.write(reinterpret_cast<char const *>(&locator), sizeof(locator));
+    }
+
+    EOCD eocd{};
+    std::memset(&eocd, 0, sizeof(eocd));
+    eocd.numberCentralDirectoryRecord = static_cast<uint16_t>(std::min(m_num_entries, zip64_marker_16));
+    eocd.totalCentralDirectoryRecord  = eocd.numberCentralDirectoryRecord;
+    eocd.sizeOfCentralDirectory       = static_cast<uint32_t>(std::min(cd_size, zip64_marker_32));
+    eocd.centralDirectoryOffset       = static_cast<uint32_t>(std::min(cd_offset, zip64_marker_32));
+    eocd.commentLength                = static_cast<uint16_t>(m_comment.size());
+
+    uint32_t const signature = 0x06054b50;
+    m_ofs.write(reinterpret_cast<char const *>(&signature), sizeof(signature));
+    m_ofs.write(reinterpret_cast<char const *>(&eocd), sizeof(eocd));
+    m_ofs.write(m_comment.data(), static_cast<std::streamsize>(m_comment.size()));
+
+    m_ofs.flush();
+    if(!m_ofs)
+    {
+        Log::Log(Log::error, Log::cstr_log("ZipWriter: \"%s\" - write error", m_fname.c_str()));
+        return false;
+    }
+
+    auto const end = static_cast<uint64_t>(m_ofs.tellp());
+    m_ofs.close();
+    if(m_ofs.fail())
+        return false;
+
+    // the old end records may reach past the new ones
+    std::error_code ec;
+    if(end < m_append_end)
+        std::filesystem::resize_file(m_fname, end, ec);
+
+    return !ec;
+}
+}   // namespace evnt
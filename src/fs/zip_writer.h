@@ -0,0 +1,106 @@
+#ifndef ZIPWRITER_H
+#define ZIPWRITER_H
+
+#include "file.h"
+#include <deque>
+#include <fstream>
+#include <future>
+#include <unordered_set>
+
+namespace evnt
+{
+class ThreadPool;
+
+/**
+ * Streaming zip writer. Entries are compressed in the thread pool and written in the order they were added
+ * as soon as the entries before them are written, the memory used is bounded by max_pending_bytes. Each
+ * entry is stored or deflated depending on its size and compressibility (see Policy). An existing archive
+ * is appended to in place: the new entries are written from the offset of its central directory and the
+ * new directory after them, the old entry data is never overwritten. If an entry fails, no central
+ * directory is written, the appended archive is truncated back to the old directory offset and its old
+ * directory and end records are written back, a new archive is removed. ZIP64 records are written when the
+ * archive needs them.
+ */
+class ZipWriter
+{
+public:
+    struct Policy
+    {
+        int    level            = 9;             // deflate level of entries smaller than large_size
+        int    large_level      = 6;             // the best level is too slow for big files
+        size_t large_size       = 1024 * 1024;   // bytes
+        size_t min_deflate_size = 128;           // smaller entries are stored
+        size_t sample_size      = 64 * 1024;     // larger entries are probed on a prefix, fastest level
+        float  max_ratio        = 0.95f;         // compressed / uncompressed, the entry is stored above it
+    };
+
+    // append - adds the entries to the archive if it exists, otherwise the archive is created or replaced
+    ZipWriter(std::string const & fname, bool append, ThreadPool * pool = nullptr);
+    ZipWriter(std::string const & fname, bool append, ThreadPool * pool, Policy policy);
+    ~ZipWriter();   // finish() if not finished
+
+    ZipWriter(ZipWriter const &)             = delete;
+    ZipWriter & operator=(ZipWriter const &) = delete;
+
+    bool isOpen() const { return m_ofs.is_open(); }
+
+    // The data of the file must stay valid until the entry is written, at the latest until finish(). false
+    // if the archive has an entry with the same name or on a write error.
+    bool addFile(BaseFile const * file);
+    // writes the pending entries and the central directory, false on a write error or a failed entry
+    bool finish();
+
+    static constexpr size_t max_pending_bytes = 64 * 1024 * 1024;   // uncompressed data being compressed
+
+private:
+    struct Entry
+    {
+        std::string          name;
+        std::time_t          time              = 0;
+        uint32_t             crc32             = 0;
+        bool                 compressed        = false;
+        uint64_t             uncompressed_size = 0;
+        uint64_t             compressed_size   = 0;
+        int8_t const *       src               = nullptr;   // the file data
+        std::vector<uint8_t> data;                          // deflated data, empty if the entry is stored
+    };
+
+    struct PendingEntry
+    {
+        std::future<Entry> entry;
+        size_t             size;   // uncompressed
+    };
+
+    static Entry CompressEntry(BaseFile const * file, Policy const & policy);
+    // false if the deflated data doesn't fit into max_size bytes
+    static bool Deflate(int8_t const * src, size_t size, int level, size_t max_size,
+                        std::vector<uint8_t> & dst);
+
+    // writes the entries compressed so far in order, waits while more than max_bytes are being compressed
+    bool writePending(size_t max_bytes);
+    bool writeEntry(Entry const & entry);
+    bool writeCentralDirectory();
+    void discard();   // restores the appended archive or removes the new one
+
+    std::string  m_fname;
+    std::fstream m_ofs;
+    ThreadPool * mp_thread_pool{nullptr};
+    Policy       m_policy;
+    bool         m_finished{false};
+    bool         m_failed{false};
+
+    std::deque<PendingEntry> m_pending;   // compressed in the pool, not written yet
+    size_t                   m_pending_bytes{0};
+
+    uint64_t                        m_offset{0};         // the end of the data section
+    uint64_t                        m_append_start{0};   // the old central directory offset
+    uint64_t                        m_append_end{0};     // the size of the appended archive
+    uint64_t                        m_num_entries{0};
+    std::vector<char>               m_central_dir;   // headers of the entries
+    std::vector<char>               m_comment;       // of the appended archive
+    std::vector<char>               m_old_tail;      // the old directory and end records, empty - new one
+    std::unordered_set<std::string> m_names;
+};
+}   // namespace evnt
+
+#endif   // ZIPWRITER_H
@@ -0,0 +1,132 @@
+#include "chunkstorage.h"
+#include "../core/exception.h"
+
+#include <cassert>
+#include <cstring>
+
+namespace evnt
+{
+ChunkStorage::ChunkStorage(int32_t type_id, std::vector<FieldDesc> fields) :
+    m_type_id{type_id}, m_fields{std::move(fields)}
+{
+    std::size_t row_size = sizeof(uint32_t);
+    for(auto const & f : m_fields)
+    {
+        assert(f.align <= chunk_alignment);
+        row_size += f.size;
+    }
+
+    if(row_size > chunk_size)
+        EV_EXCEPT("Component is too large for the chunk storage.");
+
+    // padding between the arrays may not fit for the largest capacity
+    uint32_t capacity = static_cast<uint32_t>(chunk_size / row_size);
+    while(capacity > 0 && !computeLayout(capacity))
+        --capacity;
+
+    if(capacity == 0)
+        EV_EXCEPT("Component is too large for the chunk storage.");
+}
+
+bool ChunkStorage::computeLayout(uint32_t capacity)
+{
+    m_offsets.clear();
+
+    std::size_t offset = capacity * sizeof(uint32_t);   // instance ids
+    for(auto const & f : m_fields)
+    {
+        offset = (offset + f.align - 1) / f.align * f.align;
+        m_offsets.push_back(offset);
+        offset += f.size * capacity;
+    }
+
+    if(offset > chunk_size)
+        return false;
+
+    m_capacity = capacity;
+    return true;
+}
+
+void ChunkStorage::add(uint32_t instance_id)
+{
+    assert(!contains(instance_id));
+
+    std::size_t const row = m_size;
+    if(row == m_chunks.size() * m_capacity)
+        m_chunks.push_back(std::make_unique<Chunk>());
+
+    auto & chunk = *m_chunks[row / m_capacity];
+    reinterpret_cast<uint32_t *>(chunk.data)[row % m_capacity] = instance_id;
+    for(uint32_t i = 0; i < m_fields.size(); ++i)
+        std::memset(getFieldPtr(row, i), 0, m_fields[i].size);
+
+    m_rows[instance_id] = row;
+    ++m_size;
+}
+
+void ChunkStorage::remove(uint32_t instance_id)
+{
+    auto it = m_rows.find(instance_id);
+    if(it == m_rows.end())
+        return;
+
+    std::size_t const row  = it->second;
+    std::size_t const last = m_size - 1;
+    m_rows.erase(it);
+
+    if(row != last)
+    {
+        uint32_t const moved_id = getInstanceIds(last / m_capacity)[last % m_capacity];
+        for(uint32_t i = 0; i < m_fields.size(); ++i)
+            std::memcpy(getFieldPtr(row, i), getFieldPtr(last, i), m_fields[i].size);
+
+        reinterpret_cast<uint32_t *>(m_chunks[row / m_capacity]->data)[row % m_capacity] = moved_id;
+        m_rows[moved_id] = row;
+    }
+
+    --m_size;
+
+    // keep one spare chunk to avoid reallocations on add/remove at the chunk boundary
+    while(m_chunks.size() > getNumChunks() + 1)
+        m_chunks.pop_back();
+}
+
+void ChunkStorage::reserve(std::size_t size)
+{
+    m_rows.reserve(size);
+    m_chunks.reserve((size + m_capacity - 1) / m_capacity);
+}
+
+void * ChunkStorage::getField(uint32_t instance_id, uint32_t field)
+{
+    auto it = m_rows.find(instance_id);
+    if(it == m_rows.end())
+        EV_EXCEPT("Trying to acquire not created component.");
+
+    return getFieldPtr(it->second, field);
+}
+
+std::size_t ChunkStorage::getChunkSize(std::size_t chunk) const
+{
+    std::size_t const first = chunk * m_capacity;
+    return first < m_size ? std::min<std::size_t>(m_capacity, m_size - first) : 0;
+}
+
+void * ChunkStorage::getFieldArray(std::size_t chunk, uint32_t field) const
+{
+    assert(chunk < m_chunks.size() && field < m_fields.size());
+    return m_chunks[chunk]->data + m_offsets[field];
+}
+
+uint32_t const * ChunkStorage::getInstanceIds(std::size_t chunk) const
+{
+    assert(chunk < m_chunks.size());
+    return reinterpret_cast<uint32_t const *>(m_chunks[chunk]->data);
+}
+
+void * ChunkStorage::getFieldPtr(std::size_t row, uint32_t field) const
+{
+    return static_cast<unsigned char *>(getFieldArray(row / m_capacity, field))
+           + (row % m_capacity) * m_fields[field].size;
+}
+}   // namespace evnt
@@ -0,0 +1,169 @@
+#ifndef CHUNKSTORAGE_H
+#define CHUNKSTORAGE_H
+
+#include <cstdint>
+#include <memory>
+#include <tuple>
+#include <type_traits>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+namespace evnt
+{
+class Object;
+
+// Non-owning view of a contiguous array
+template<typename T>
+class ArrayView
+{
+public:
+    ArrayView() = default;
+    ArrayView(T * data, std::size_t size) : mp_data{data}, m_size{size} {}
+
+    T *         data() const { return mp_data; }
+    std::size_t size() const { return m_size; }
+    bool        empty() const { return m_size == 0; }
+
+    T * begin() const { return mp_data; }
+    T * end() const { return mp_data + m_size; }
+
+    T & operator[](std::size_t i) const { return mp_data[i]; }
+
+private:
+    T *         mp_data{nullptr};
+    std::size_t m_size{0};
+};
+
+/**
+ * Struct-of-arrays storage for the instances of one component class.
+ * Instances live in fixed size chunks, every chunk holds an array of instance ids followed by one array per
+ * field. Rows are kept dense: removing an instance moves the last row into the hole, so the field arrays
+ * can be iterated without gaps. Field types must be trivially copyable, new rows are zero initialized.
+ */
+class ChunkStorage
+{
+public:
+    static constexpr std::size_t chunk_size      = 16 * 1024;
+    static constexpr std::size_t chunk_alignment = 64;
+
+    struct FieldDesc
+    {
+        uint32_t size;
+        uint32_t align;
+    };
+
+    ChunkStorage(int32_t type_id, std::vector<FieldDesc> fields);
+
+    ChunkStorage(ChunkStorage const &)             = delete;
+    ChunkStorage & operator=(ChunkStorage const &) = delete;
+
+    void add(uint32_t instance_id);
+    void remove(uint32_t instance_id);
+    void reserve(std::size_t size);
+    bool contains(uint32_t instance_id) const { return m_rows.find(instance_id) != m_rows.end(); }
+
+    void * getField(uint32_t instance_id, uint32_t field);
+
+    int32_t     getTypeId() const { return m_type_id; }
+    std::size_t getSize() const { return m_size; }
+    uint32_t    getChunkCapacity() const { return m_capacity; }
+    std::size_t getNumChunks() const { return (m_size + m_capacity - 1) / m_capacity; }
+    std::size_t getChunkSize(std::size_t chunk) const;
+
+    void *           getFieldArray(std::size_t chunk, uint32_t field) const;
+    uint32_t const * getInstanceIds(std::size_t chunk) const;
+
+private:
+    struct alignas(chunk_alignment) Chunk
+    {
+        unsigned char data[chunk_size];
+    };
+
+    bool   computeLayout(uint32_t capacity);
+    void * getFieldPtr(std::size_t row, uint32_t field) const;
+
+    int32_t                                   m_type_id;
+    std::vector<FieldDesc>                    m_fields;
+    std::vector<std::size_t>                  m_offsets;   // offset of every field array inside a chunk
+    uint32_t                                  m_capacity{0};
+    std::size_t                               m_size{0};
+    std::vector<std::unique_ptr<Chunk>>       m_chunks;
+    std::unordered_map<uint32_t, std::size_t> m_rows;   // key = instance_id, row
+};
+
+/**
+ * POD components opt in to the chunk storage by declaring their fields as a tuple, the fields are stored in
+ * separate arrays:
+ *
+ * struct Velocity
+ * {
+ *     using Fields = std::tuple<glm::vec3, float>;   // direction, speed
+ *     static int32_t GetClassIDStatic() { return ClassName(Velocity); }
+ * };
+ *
+ * Classes defined with OBJECT_DEFINE are stored as a single array of object pointers (ObjectFields).
+ */
+template<typename T, typename = void>
+struct IsSoAComponent : std::false_type
+{};
+
+template<typename T>
+struct IsSoAComponent<T, std::void_t<typename T::Fields>> : std::true_type
+{};
+
+struct ObjectFields
+{
+    using Fields = std::tuple<Object *>;
+};
+
+template<typename Cmp>
+using ComponentFields = typename std::conditional_t<IsSoAComponent<Cmp>::value, Cmp, ObjectFields>::Fields;
+
+template<typename FieldsTuple, std::size_t... Is>
+std::vector<ChunkStorage::FieldDesc> MakeFieldDescs(std::index_sequence<Is...>)
+{
+    static_assert((std::is_trivially_copyable_v<std::tuple_element_t<Is, FieldsTuple>> && ...),
+                  "chunk storage fields must be trivially copyable");
+
+    return {ChunkStorage::FieldDesc{
+        static_cast<uint32_t>(sizeof(std::tuple_element_t<Is, FieldsTuple>)),
+        static_cast<uint32_t>(alignof(std::tuple_element_t<Is, FieldsTuple>))}...};
+}
+
+template<typename Cmp>
+std::vector<ChunkStorage::FieldDesc> MakeFieldDescs()
+{
+    using Fields = ComponentFields<Cmp>;
+    return MakeFieldDescs<Fields>(std::make_index_sequence<std::tuple_size_v<Fields>>{});
+}
+
+// Typed access to one chunk of a ChunkStorage
+template<typename Cmp>
+class ChunkView
+{
+public:
+    using Fields = ComponentFields<Cmp>;
+
+    template<std::size_t I>
+    using FieldType = std::tuple_element_t<I, Fields>;
+
+    ChunkView(ChunkStorage const & storage, std::size_t chunk) : mp_storage{&storage}, m_chunk{chunk} {}
+
+    std::size_t size() const { return mp_storage->getChunkSize(m_chunk); }
+
+    template<std::size_t I>
+    ArrayView<FieldType<I>> get() const
+    {
+        return {static_cast<FieldType<I> *>(mp_storage->getFieldArray(m_chunk, I)), size()};
+    }
+
+    ArrayView<uint32_t const> getInstanceIds() const { return {mp_storage->getInstanceIds(m_chunk), size()}; }
+
+private:
+    ChunkStorage const * mp_storage;
+    std::size_t          m_chunk;
+};
+}   // namespace evnt
+
+#endif   // CHUNKSTORAGE_H
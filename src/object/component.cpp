@@ -102,14 +102,14 @@ void Component::read(InputMemoryStream const & inMemoryStream, ObjectManager & g
     }
 }
 
-void Component::link(ObjectManager & gmgr, std::map<uint32_t, uint32_t> const & id_remap)
+void Component::link(ObjectManager & gmgr, IdRemap const & id_remap)
 {
+    if(mp_owner == nullptr)
+        return;
+
     // https://stackoverflow.com/questions/22419063/error-cast-from-pointer-to-smaller-type-int32_t-loses-information-in-eaglview-mm
     uint32_t inst_id = static_cast<uint32_t>(reinterpret_cast<size_t>(mp_owner));
 
-    if(id_remap.find(inst_id) == id_remap.end())
-        EV_EXCEPT("Trying linking not exist object");
-
     mp_owner = static_cast<Entity *>(gmgr.getObjectPtr(id_remap.at(inst_id)));
 }
 }   // namespace evnt
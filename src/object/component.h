@@ -15,8 +15,9 @@ public:
 
     Component() = default;
 
-    void setOwnerInternal(Entity * go);
-    void sendMessage(CmpMsgsTable::msg_id messageIdentifier, std::any msg_data);
+    void     setOwnerInternal(Entity * go);
+    Entity * getOwner() const { return mp_owner; }
+    void     sendMessage(CmpMsgsTable::msg_id messageIdentifier, std::any msg_data);
 
     // test
     void onAddMessage(Component * rec, CmpMsgsTable::msg_id id, std::any msg_data);
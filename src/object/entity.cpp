@@ -133,7 +133,7 @@ void Entity::read(InputMemoryStream const & inMemoryStream, ObjectManager & gmgr
     }
 }
 
-void Entity::link(ObjectManager & gmgr, std::map<uint32_t, uint32_t> const & id_remap)
+void Entity::link(ObjectManager & gmgr, IdRemap const & id_remap)
 {
     if(m_components.empty())
         return;
@@ -142,9 +142,6 @@ void Entity::link(ObjectManager & gmgr, std::map<uint32_t, uint32_t> const & id_
     {
         uint32_t c_inst = cmp->m_link_key;
 
-        if(id_remap.find(c_inst) == id_remap.end())
-            EV_EXCEPT("Trying linking not exist object");
-
         auto ptr = gmgr.getObject(id_remap.at(c_inst));
 
         m_components[key] = ptr;
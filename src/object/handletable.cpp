@@ -0,0 +1,113 @@
+#include "handletable.h"
+#include "../core/event.h"
+#include "../core/exception.h"
+
+namespace evnt
+{
+HandleTable::~HandleTable()
+{
+    for(auto & page : m_pages)
+        delete[] page.load(std::memory_order_relaxed);
+}
+
+uint32_t HandleTable::acquire(Object * ptr)
+{
+    std::lock_guard lk(m_write_mutex);
+
+    uint32_t index = 0;
+    if(!m_free_slots.empty())
+    {
+        index = m_free_slots.back();
+        m_free_slots.pop_back();
+    }
+    else
+    {
+        if(m_num_slots > index_mask)
+            EV_EXCEPT("Too many objects, the instance id space is exhausted.");
+
+        index = m_num_slots++;
+        if((index & (page_size - 1)) == 0)
+            m_pages[index >> page_bits].store(new Slot[page_size], std::memory_order_release);
+    }
+
+    Slot *         page = m_pages[index >> page_bits].load(std::memory_order_relaxed);
+    Slot &         slot = page[index & (page_size - 1)];
+    uint32_t const id   = (slot.generation << index_bits) | index;
+
+    // a reader which sees the new ptr must not match the previous id of the slot anymore
+    slot.ptr.store(ptr, std::memory_order_release);
+    slot.id.store(id, std::memory_order_release);
+
+    return id;
+}
+
+void HandleTable::setHandle(uint32_t id, PObjHandle const & handle)
+{
+    Slot * slot = findSlot(id);
+    if(slot == nullptr)
+        EV_EXCEPT("Trying to set the handle of not created object.");
+
+    FlagLock lk(slot->handle_lock);
+    slot->handle = handle;
+}
+
+void HandleTable::release(uint32_t id)
+{
+    std::lock_guard lk(m_write_mutex);
+
+    Slot * slot = findSlot(id);
+    if(slot == nullptr)
+        return;
+
+    // invalidate the id first, readers recheck it after loading the pointer
+    slot->id.store(0, std::memory_order_release);
+    slot->ptr.store(nullptr, std::memory_order_release);
+    {
+        FlagLock hlk(slot->handle_lock);
+        slot->handle.reset();
+    }
+
+    // the next generation would repeat the ids of the slot (generation 0 is never used, so an id is never 0)
+    if(slot->generation == generation_mask)
+        return;
+
+    ++slot->generation;
+    m_free_slots.push_back(GetIndex(id));
+}
+
+Object * HandleTable::find(uint32_t id) const
+{
+    Slot * slot = findSlot(id);
+    if(slot == nullptr)
+        return nullptr;
+
+    Object * ptr = slot->ptr.load(std::memory_order_acquire);
+
+    // the slot may have been released and reused between the loads
+    return slot->id.load(std::memory_order_acquire) == id ? ptr : nullptr;
+}
+
+PObjHandle HandleTable::findHandle(uint32_t id) const
+{
+    Slot * slot = findSlot(id);
+    if(slot == nullptr)
+        return {};
+
+    FlagLock lk(slot->handle_lock);
+    return slot->id.load(std::memory_order_acquire) == id ? slot->handle.lock() : PObjHandle{};
+}
+
+HandleTable::Slot * HandleTable::findSlot(uint32_t id) const
+{
+    uint32_t const index = GetIndex(id);
+    if(id == 0 || index >= max_pages * page_size)
+        return nullptr;
+
+    Slot * page = m_pages[index >> page_bits].load(std::memory_order_acquire);
+    if(page == nullptr)
+        return nullptr;
+
+    Slot & slot = page[index & (page_size - 1)];
+    return slot.id.load(std::memory_order_acquire) == id ? &slot : nullptr;
+}
+}   // namespace evnt
@@ -0,0 +1,71 @@
+#ifndef HANDLETABLE_H
+#define HANDLETABLE_H
+
+#include "objhandle.h"
+
+#include <atomic>
+#include <mutex>
+#include <vector>
+
+namespace evnt
+{
+/**
+ * Maps instance ids to objects with one array index.
+ * An instance id is a generational handle: the low bits are a slot index, the high bits are the generation
+ * of the slot. Releasing a slot bumps its generation, so ids of destroyed objects (stale handles) never
+ * resolve to an object which reuses the slot. A slot whose generation would wrap is retired instead of
+ * reused. Slots live in pages which are never moved or freed while the table is alive, lookups don't take
+ * a lock. Ids are never 0.
+ */
+class HandleTable
+{
+public:
+    static constexpr uint32_t index_bits      = 22;
+    static constexpr uint32_t index_mask      = (1u << index_bits) - 1;
+    static constexpr uint32_t generation_mask = (1u << (32 - index_bits)) - 1;
+    static constexpr uint32_t page_bits       = 12;
+    static constexpr uint32_t page_size       = 1u << page_bits;
+    static constexpr uint32_t max_pages       = 1u << (index_bits - page_bits);
+
+    static_assert(IdRemap::index_mask == index_mask, "IdRemap must use the same id layout");
+
+    static uint32_t GetIndex(uint32_t id) { return id & index_mask; }
+    static uint32_t GetGeneration(uint32_t id) { return id >> index_bits; }
+
+    HandleTable() = default;
+    ~HandleTable();
+
+    HandleTable(HandleTable const &)             = delete;
+    HandleTable & operator=(HandleTable const &) = delete;
+
+    // ptr may be nullptr for components without an Object (SoA components)
+    uint32_t acquire(Object * ptr);
+    void     setHandle(uint32_t id, PObjHandle const & handle);
+    void     release(uint32_t id);
+
+    bool       contains(uint32_t id) const { return findSlot(id) != nullptr; }
+    Object *   find(uint32_t id) const;   // nullptr for stale or unknown ids
+    PObjHandle findHandle(uint32_t id) const;
+
+private:
+    struct Slot
+    {
+        std::atomic<uint32_t> id{0};   // current id, 0 - free slot
+        std::atomic<Object *> ptr{nullptr};
+        uint32_t              generation{1};
+
+        // weak_ptr can't be read and written concurrently
+        mutable std::atomic_bool handle_lock{false};
+        std::weak_ptr<ObjHandle> handle;
+    };
+
+    Slot * findSlot(uint32_t id) const;
+
+    std::atomic<Slot *>   m_pages[max_pages] = {};
+    uint32_t              m_num_slots{0};   // slots ever created
+    std::vector<uint32_t> m_free_slots;
+    std::mutex            m_write_mutex;
+};
+}   // namespace evnt
+
+#endif   // HANDLETABLE_H
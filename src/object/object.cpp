@@ -11,7 +11,25 @@ Object::StaticObjectInit const Object::sm_class_register{Object::InitType};
 
 void Object::InitType()
 {
-    RegisterClass(ClassName(Object), -1, "Object", sizeof(Object), Object::CreateInstance);
+    RegisterClass(ClassName(Object), -1, "Object", sizeof(Object), alignof(Object), Object::CreateInstance);
+}
+
+uint32_t IdRemap::at(uint32_t old_id) const
+{
+    uint32_t const new_id = find(old_id);
+    if(new_id == 0)
+        EV_EXCEPT("Trying linking not exist object");
+
+    return new_id;
+}
+
+void Object::deleteObj()
+{
+    if(m_is_delete.exchange(true, std::memory_order_acq_rel) || mp_deleted_list == nullptr)
+        return;
+
+    std::lock_guard lk(mp_deleted_list->mutex);
+    mp_deleted_list->ids.push_back(m_instance_id);
 }
 
 Object::RTTI & Object::ClassIDToRTTI(int32_t classID)
@@ -30,8 +48,8 @@ Object::RTTI & Object::ClassIDToRTTI(int32_t classID)
     return id->second;
 }
 
-void Object::RegisterClass(int32_t inClassID, int32_t inBaseClass, std::string const & inName, int32_t size,
-                           CreateFunc inFunc)
+void Object::RegisterClass(int32_t inClassID, int32_t inBaseClass, std::string const & inName,
+                           std::size_t size, std::size_t align, CreateFunc inFunc)
 {
     assert(inClassID != -1);
     assert(s_classid_to_rtti_map.find(inClassID) == s_classid_to_rtti_map.end());
@@ -39,13 +57,37 @@ void Object::RegisterClass(int32_t inClassID, int32_t inBaseClass, std::string c
     RTTI rtti;
 
     rtti.base      = inBaseClass;
-    rtti.size      = size;
+    rtti.size      = static_cast<int32_t>(size);
     rtti.className = inName;
     rtti.factory   = std::move(inFunc);
+    rtti.pool      = std::make_shared<SlabPool>(size, align);
 
     s_classid_to_rtti_map[inClassID] = rtti;
 }
 
+void * Object::AllocateInstance(int32_t classID, std::size_t size)
+{
+    auto & pool = *ClassIDToRTTI(classID).pool;
+    if(size > pool.getSlotSize())
+        return ::operator new(size);
+
+    return pool.allocate();
+}
+
+void Object::FreeInstance(int32_t classID, void * p, std::size_t size)
+{
+    auto & pool = *ClassIDToRTTI(classID).pool;
+    if(size > pool.getSlotSize())
+        ::operator delete(p);
+    else
+        pool.deallocate(p);
+}
+
+SlabPool::Stats Object::GetPoolStats(int32_t classID)
+{
+    return ClassIDToRTTI(classID).pool->getStats();
+}
+
 bool Object::IsDerivedFromClassID(int32_t classID, int32_t derivedFromClassID)
 {
     int32_t search = classID;
@@ -1,12 +1,17 @@
 #ifndef OBJECT_H
 #define OBJECT_H
 
+#include "../core/slabpool.h"
 #include "../fs/memory_stream.h"
 #include "classids.h"
 
+#include <atomic>
 #include <functional>
 #include <map>
 #include <memory>
+#include <mutex>
+#include <unordered_map>
+#include <vector>
 
 // https://stackoverflow.com/questions/34222703/how-to-override-static-method-of-template-class-in-derived-class
 #define OBJECT_DEFINE                                                                                   \
@@ -15,13 +20,16 @@
     void         dump(int32_t indentLevel = 0) const override;                                          \
     void         write(OutputMemoryStream & inMemoryStream, ObjectManager const & gmgr) const override; \
     void         read(InputMemoryStream const & inMemoryStream, ObjectManager & gmgr) override;         \
-    void         link(ObjectManager & gmgr, std::map<uint32_t, uint32_t> const & id_remap) override;    \
+    void         link(ObjectManager & gmgr, IdRemap const & id_remap) override;                        \
     int32_t      getClassIDVirtual() const override;                                                    \
     char const * getClassString() const override;                                                       \
                                                                                                         \
     static int32_t                 GetClassIDStatic();                                                  \
     static std::unique_ptr<Object> CreateInstance();                                                    \
-    static void                    InitType();
+    static void                    InitType();                                                          \
+                                                                                                        \
+    static void * operator new(std::size_t size);                                                       \
+    static void   operator delete(void * p, std::size_t size);
 
 #define OBJECT_IMPLEMENT(inClass, inBaseClass)                                                             \
     evnt::Object::StaticObjectInit const inClass::sm_class_register{inClass::InitType};                    \
@@ -45,17 +53,79 @@
     void inClass::InitType()                                                                               \
     {                                                                                                      \
         evnt::Object::RegisterClass(ClassName(inClass), ClassName(inBaseClass), #inClass, sizeof(inClass), \
-                                    inClass::CreateInstance);                                              \
+                                    alignof(inClass), inClass::CreateInstance);                            \
+    }                                                                                                      \
+    void * inClass::operator new(std::size_t size)                                                         \
+    {                                                                                                      \
+        return evnt::Object::AllocateInstance(ClassName(inClass), size);                                   \
+    }                                                                                                      \
+    void inClass::operator delete(void * p, std::size_t size)                                              \
+    {                                                                                                      \
+        evnt::Object::FreeInstance(ClassName(inClass), p, size);                                           \
     }
 
 namespace evnt
 {
 class ObjectManager;
 
+/**
+ * Maps the instance ids stored in a snapshot to the ids of the loaded objects.
+ * The table is a flat array indexed by the slot index part of the old id (see HandleTable), the full id is
+ * checked on lookup. add() for ids below max_index may be called from several threads. The other ids (the
+ * ids of the streams written before snapshots aren't handle ids) and the ids whose slot is taken by another
+ * id are kept in a map, they must be added by one thread at a time.
+ */
+class IdRemap
+{
+public:
+    static constexpr uint32_t index_mask = (1u << 22) - 1;
+
+    explicit IdRemap(uint32_t max_index = 0) : m_ids(max_index + 1) {}
+
+    void add(uint32_t old_id, uint32_t new_id)
+    {
+        uint32_t const index = old_id & index_mask;
+        if(index < m_ids.size() && (m_ids[index].old_id == 0 || m_ids[index].old_id == old_id))
+            m_ids[index] = {old_id, new_id};
+        else
+            m_other_ids[old_id] = new_id;
+    }
+
+    bool     contains(uint32_t old_id) const { return find(old_id) != 0; }
+    uint32_t find(uint32_t old_id) const   // 0 if not found
+    {
+        uint32_t const index = old_id & index_mask;
+        if(index < m_ids.size() && m_ids[index].old_id == old_id)
+            return m_ids[index].new_id;
+
+        auto it = m_other_ids.find(old_id);
+        return it != m_other_ids.end() ? it->second : 0;
+    }
+    uint32_t at(uint32_t old_id) const;   // throws if not found
+
+private:
+    struct Entry
+    {
+        uint32_t old_id{0};
+        uint32_t new_id{0};
+    };
+
+    std::vector<Entry>                     m_ids;
+    std::unordered_map<uint32_t, uint32_t> m_other_ids;
+};
+
+// Instance ids of deleted objects of one class, waiting to be released by ObjectManager
+struct DeletedObjects
+{
+    std::mutex            mutex;
+    std::vector<uint32_t> ids;
+};
+
 class Object
 {
-    uint32_t m_instance_id{0};   // 0 - not initialized
-    bool     m_is_delete{false};
+    uint32_t         m_instance_id{0};   // 0 - not initialized
+    std::atomic_bool m_is_delete{false};
+    DeletedObjects * mp_deleted_list{nullptr};   // set by ObjectManager
 
 public:
     using CreateFunc = std::function<std::unique_ptr<Object>()>;
@@ -70,6 +140,8 @@ public:
         int32_t     size{0};     // sizeof size
         std::string className;   // the name of the class
         CreateFunc  factory;     // the factory function of the class
+
+        std::shared_ptr<SlabPool> pool;   // memory of the class instances
     };
 
     static StaticObjectInit const sm_class_register;
@@ -85,8 +157,10 @@ public:
     uint32_t getInstanceId() const { return m_instance_id; }
     void     setInstanceId(uint32_t inNetworkId) { m_instance_id = inNetworkId; }
 
-    bool isDeleted() const { return m_is_delete; }
-    void deleteObj() { m_is_delete = true; }
+    bool isDeleted() const { return m_is_delete.load(std::memory_order_acquire); }
+    // the first call queues the object for release, see ObjectManager::releaseStalledObjects
+    void deleteObj();
+    void setDeletedList(DeletedObjects * list) { mp_deleted_list = list; }
 
     bool isDerivedFrom(int32_t classID) { return IsDerivedFromClassID(getClassIDVirtual(), classID); }
 
@@ -96,7 +170,7 @@ public:
     virtual void dump(int32_t indentLevel = 0) const { (void)indentLevel; }
     virtual void write(OutputMemoryStream & inMemoryStream, ObjectManager const & gmgr) const {}
     virtual void read(InputMemoryStream const & inMemoryStream, ObjectManager & gmgr) {}
-    virtual void link(ObjectManager & gmgr, std::map<uint32_t, uint32_t> const & id_remap) {}
+    virtual void link(ObjectManager & gmgr, IdRemap const & id_remap) {}
 
     static int32_t                 GetClassIDStatic() { return ClassName(Object); }
     static std::unique_ptr<Object> CreateInstance() { return std::make_unique<Object>(); }
@@ -104,7 +178,13 @@ public:
     /// Returns the RTTI information for a classID
     static RTTI & ClassIDToRTTI(int32_t classID);
     static void   RegisterClass(int32_t inClassID, int32_t inBaseClass, std::string const & inName,
-                                int32_t size, CreateFunc inFunc);
+                                std::size_t size, std::size_t align, CreateFunc inFunc);
+
+    /// Instances of OBJECT_DEFINE classes are allocated from the pool of the class, objects of a derived
+    /// class without OBJECT_DEFINE don't fit the slots and use the global heap
+    static void *          AllocateInstance(int32_t classID, std::size_t size);
+    static void            FreeInstance(int32_t classID, void * p, std::size_t size);
+    static SlabPool::Stats GetPoolStats(int32_t classID);
 
     /// Finds out if classID is derived from compareClassID
     static bool IsDerivedFromClassID(int32_t classID, int32_t derivedFromClassID);
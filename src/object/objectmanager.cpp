@@ -1,20 +1,42 @@
 #include "objectmanager.h"
 #include "../core/exception.h"
-#include <cassert>
+#include "../core/taskgraph.h"
+#include <cstring>
 #include <iostream>
-#include <limits>
-#include <map>
 
 namespace evnt
 {
+namespace
+{
+    // Snapshot layout: header, type table, chunk table, chunk data. A chunk is a contiguous block of up to
+    // snapshot_chunk_objects objects of one class written by Object::write().
+    constexpr uint32_t snapshot_magic         = 0x4E535645;   // "EVSN"
+    constexpr uint32_t snapshot_version       = 1;
+    constexpr uint32_t snapshot_chunk_objects = 4096;
+
+    struct SnapshotType
+    {
+        int32_t     class_id{0};
+        std::string name;
+    };
+
+    struct SnapshotChunk
+    {
+        uint32_t type_index{0};
+        uint32_t num_objects{0};
+        uint64_t offset{0};   // from the beginning of the chunk data
+        uint64_t size{0};
+    };
+}   // namespace
+
 ObjectManager::~ObjectManager()
 {
-    std::lock_guard<std::mutex> lk(m_objects_mutex);
+    std::lock_guard<std::shared_mutex> lk(m_objects_mutex);
 
     for(auto & [type_id, components] : m_objects)
-        for(auto & [instance_id, obj_entry] : components)
+        for(auto & [instance_id, obj] : components)
         {
-            if(auto sp = obj_entry.handle.lock())
+            if(auto sp = m_handles.findHandle(instance_id))
                 sp->nullify();
         }
 }
@@ -28,61 +50,49 @@ PObjHandle ObjectManager::createDefaultObj(int32_t obj_type)
 
 PObjHandle ObjectManager::registerObj(PUniqueObjPtr ob, int32_t obj_type)
 {
-    uint32_t const instance_id = m_next_available_id.fetch_add(1, std::memory_order_relaxed);
-    assert(instance_id != std::numeric_limits<uint32_t>::max());
+    std::lock_guard<std::shared_mutex> lk(m_objects_mutex);
+    return insertObj(std::move(ob), obj_type);
+}
+
+PObjHandle ObjectManager::insertObj(PUniqueObjPtr ob, int32_t obj_type)
+{
+    uint32_t const instance_id = m_handles.acquire(ob.get());
 
     ob->setInstanceId(instance_id);
-    PObjHandle sp = std::make_shared<ObjHandle>(ob.get());
+    PObjHandle sp = std::allocate_shared<ObjHandle>(PoolAllocator<ObjHandle>(), ob.get());
+    m_handles.setHandle(instance_id, sp);
 
-    ObjEntry new_entry;
-    new_entry.unique = std::move(ob);
-    new_entry.handle = sp;
+    m_objects[obj_type][instance_id] = std::move(ob);
 
-    {
-        std::lock_guard<std::mutex> lk(m_objects_mutex);
-        m_objects[obj_type][instance_id] = std::move(new_entry);
-    }
+    auto & deleted_list = m_deleted[obj_type];
+    if(!deleted_list)
+        deleted_list = std::make_unique<DeletedObjects>();
+    sp->getPtr()->setDeletedList(deleted_list.get());
 
-    return sp;
-}
+    // pointer array for iteration without walking the map
+    auto & storage = getOrCreateStorage(obj_type, MakeFieldDescs<Object>);
+    storage.add(instance_id);
+    *static_cast<Object **>(storage.getField(instance_id, 0)) = sp->getPtr();
 
-bool ObjectManager::objectExists(uint32_t id) const
-{
-    std::lock_guard<std::mutex> lk(m_objects_mutex);
-    for(auto & [type_id, components] : m_objects)
-    {
-        if(components.find(id) != components.end())
-            return true;
-    }
-    return false;
+    return sp;
 }
 
 PObjHandle ObjectManager::getObject(uint32_t id)
 {
-    std::lock_guard<std::mutex> lk(m_objects_mutex);
+    PObjHandle sp = m_handles.findHandle(id);
+    if(!sp)
+        EV_EXCEPT("Trying to acquire not created object.");
 
-    for(auto & [type_id, components] : m_objects)
-    {
-        auto const iterFind = components.find(id);
-        if(iterFind != components.end())
-            return iterFind->second.handle.lock();
-    }
-
-    EV_EXCEPT("Trying to acquire not created object.");
+    return sp;
 }
 
 Object * ObjectManager::getObjectPtr(uint32_t id)
 {
-    std::lock_guard<std::mutex> lk(m_objects_mutex);
-
-    for(auto & [type_id, components] : m_objects)
-    {
-        auto const iterFind = components.find(id);
-        if(iterFind != components.end())
-            return iterFind->second.unique.get();
-    }
+    Object * ptr = m_handles.find(id);
+    if(ptr == nullptr)
+        EV_EXCEPT("Trying to acquire not created object.");
 
-    EV_EXCEPT("Trying to acquire not created object.");
+    return ptr;
 }
 
 ObjectManager::ComponentsList const & ObjectManager::getObjectsByType(int32_t cmp_type)
@@ -97,70 +107,377 @@ ObjectManager::ComponentsList const & ObjectManager::getObjectsByType(int32_t cm
 
 void ObjectManager::releaseStalledObjects()
 {
-    std::lock_guard<std::mutex> lk(m_objects_mutex);
+    sweep(SweepClock::time_point::max());
+}
 
-    for(auto & [type_id, components] : m_objects)
-        for(auto it = components.begin(); it != components.end();)
+bool ObjectManager::releaseStalledObjects(std::chrono::microseconds budget)
+{
+    return sweep(SweepClock::now() + budget);
+}
+
+bool ObjectManager::sweep(SweepClock::time_point deadline)
+{
+    constexpr std::size_t batch_size = 64;   // deletions released between the deadline checks
+
+    std::lock_guard<std::shared_mutex> lk(m_objects_mutex);
+
+    if(m_deleted.empty())
+        return true;
+
+    // start from a different type every call, so one type with many deletions can't starve the others
+    auto start = m_deleted.begin();
+    std::advance(start, m_sweep_start++ % m_deleted.size());
+
+    uint32_t batch[batch_size];
+    auto     it = start;
+    do
+    {
+        auto & [type_id, list] = *it;
+        while(true)
         {
-            if(it->second.unique->isDeleted())
-                it = components.erase(it);
-            else
-                ++it;
+            std::size_t num = 0;
+            {
+                std::lock_guard<std::mutex> list_lk(list->mutex);
+                while(num < batch_size && !list->ids.empty())
+                {
+                    batch[num++] = list->ids.back();
+                    list->ids.pop_back();
+                }
+            }
+
+            if(num == 0)
+                break;
+
+            for(std::size_t i = 0; i < num; ++i)
+                releaseObject(type_id, batch[i]);
+
+            if(SweepClock::now() >= deadline)
+                return false;
         }
+
+        if(++it == m_deleted.end())
+            it = m_deleted.begin();
+    } while(it != start);
+
+    return true;
+}
+
+void ObjectManager::releaseObject(int32_t type_id, uint32_t instance_id)
+{
+    auto & components = m_objects[static_cast<uint32_t>(type_id)];
+    auto   it         = components.find(instance_id);
+    if(it == components.end())
+        return;
+
+    m_chunks.at(type_id)->remove(instance_id);
+    m_handles.release(instance_id);
+    components.erase(it);
+}
+
+ChunkStorage & ObjectManager::getOrCreateStorage(int32_t type_id, MakeFieldsFunc make_fields)
+{
+    auto & storage = m_chunks[type_id];
+    if(!storage)
+        storage = std::make_unique<ChunkStorage>(type_id, make_fields());
+
+    return *storage;
+}
+
+ChunkStorage const * ObjectManager::findStorage(int32_t type_id) const
+{
+    auto it = m_chunks.find(type_id);
+    return it != m_chunks.end() ? it->second.get() : nullptr;
 }
 
 void ObjectManager::dump() const
 {
-    std::lock_guard<std::mutex> lk(m_objects_mutex);
+    std::lock_guard<std::shared_mutex> lk(m_objects_mutex);
 
     for(auto & [type_id, components] : m_objects)
-        for(auto & [instance_id, obj_entry] : components)
+        for(auto & [instance_id, obj] : components)
         {
-            if(!obj_entry.unique->isDeleted())
+            if(!obj->isDeleted())
             {
-                obj_entry.unique->dump();
+                obj->dump();
                 std::cout << std::endl;
             }
         }
 }
 
+void ObjectManager::dumpPoolStats() const
+{
+    std::lock_guard<std::shared_mutex> lk(m_objects_mutex);
+
+    for(auto & [type_id, components] : m_objects)
+    {
+        auto const stats = Object::GetPoolStats(static_cast<int32_t>(type_id));
+        std::cout << Object::ClassIDToString(static_cast<int32_t>(type_id)) << ": live " << stats.live
+                  << ", peak " << stats.peak << ", capacity " << stats.capacity << ", slabs "
+                  << stats.num_slabs << " (" << stats.num_partial_slabs << " partially used), free "
+                  << stats.free_ratio << std::endl;
+    }
+}
+
 void ObjectManager::serialize(OutputMemoryStream & inMemoryStream) const
 {
-    std::lock_guard<std::mutex> lk(m_objects_mutex);
+    std::lock_guard<std::shared_mutex> lk(m_objects_mutex);
+
+    std::vector<SnapshotType>  types;
+    std::vector<SnapshotChunk> chunks;
+    OutputMemoryStream         data;
+    uint32_t                   num_objects = 0;
+    uint32_t                   max_index   = 0;
 
     for(auto & [type_id, components] : m_objects)
-        for(auto & [instance_id, obj_entry] : components)
+    {
+        auto const type_index = static_cast<uint32_t>(types.size());
+        bool       has_objects = false;
+
+        for(auto & [instance_id, obj] : components)
         {
-            if(!obj_entry.unique->isDeleted())
-                obj_entry.unique->write(inMemoryStream, *this);
+            if(obj->isDeleted())
+                continue;
+
+            if(chunks.empty() || chunks.back().type_index != type_index
+               || chunks.back().num_objects == snapshot_chunk_objects)
+            {
+                chunks.push_back({type_index, 0, data.getLength(), 0});
+            }
+
+            obj->write(data, *this);
+
+            auto & chunk = chunks.back();
+            chunk.size   = data.getLength() - chunk.offset;
+            ++chunk.num_objects;
+            ++num_objects;
+            max_index   = std::max(max_index, HandleTable::GetIndex(instance_id));
+            has_objects = true;
+        }
+
+        if(has_objects)
+        {
+            int32_t const class_id = static_cast<int32_t>(type_id);
+            types.push_back({class_id, Object::ClassIDToString(class_id)});
         }
+    }
+
+    uint32_t const num_types  = static_cast<uint32_t>(types.size());
+    uint32_t const num_chunks = static_cast<uint32_t>(chunks.size());
+
+    inMemoryStream.reserve(inMemoryStream.getLength() + data.getLength() + num_chunks * sizeof(SnapshotChunk)
+                           + num_types * 64 + 64);
+
+    inMemoryStream.write(snapshot_magic);
+    inMemoryStream.write(snapshot_version);
+    inMemoryStream.write(num_types);
+    inMemoryStream.write(num_chunks);
+    inMemoryStream.write(num_objects);
+    inMemoryStream.write(max_index);
+
+    for(auto & type : types)
+    {
+        uint32_t const name_length = static_cast<uint32_t>(type.name.size());
+        inMemoryStream.write(type.class_id);
+        inMemoryStream.write(name_length);
+        inMemoryStream.write(reinterpret_cast<int8_t const *>(type.name.data()), name_length);
+    }
+
+    for(auto & chunk : chunks)
+    {
+        inMemoryStream.write(chunk.type_index);
+        inMemoryStream.write(chunk.num_objects);
+        inMemoryStream.write(chunk.offset);
+        inMemoryStream.write(chunk.size);
+    }
+
+    inMemoryStream.write(data.getBufferPtr(), data.getLength());
 }
 
-void ObjectManager::deserialize(InputMemoryStream const & inMemoryStream, std::vector<PObjHandle> & objects)
+void ObjectManager::deserialize(InputMemoryStream const & inMemoryStream, std::vector<PObjHandle> & objects,
+                                ThreadPool * pool)
 {
     objects.clear();
-    std::map<uint32_t, uint32_t> istance_id_remap;   // [old_id, new_id]
+
+    uint32_t magic = 0;
+    if(inMemoryStream.getRemainingDataSize() >= sizeof(magic))
+        std::memcpy(&magic, inMemoryStream.getCurPosPtr(), sizeof(magic));
+
+    if(magic != snapshot_magic)
+    {
+        deserializeObjects(inMemoryStream, objects);
+        return;
+    }
+
+    uint32_t version     = 0;
+    uint32_t num_types   = 0;
+    uint32_t num_chunks  = 0;
+    uint32_t num_objects = 0;
+    uint32_t max_index   = 0;
+
+    inMemoryStream.read(magic);
+    inMemoryStream.read(version);
+    if(version > snapshot_version)
+        EV_EXCEPT("Snapshot version is not supported.");
+
+    inMemoryStream.read(num_types);
+    inMemoryStream.read(num_chunks);
+    inMemoryStream.read(num_objects);
+    inMemoryStream.read(max_index);
+    if(max_index > IdRemap::index_mask)
+        EV_EXCEPT("Snapshot is corrupted.");
+
+    // class ids are resolved by name, so snapshots survive renumbering of the classes
+    std::vector<SnapshotType> types(num_types);
+    for(auto & type : types)
+    {
+        uint32_t name_length = 0;
+        inMemoryStream.read(type.class_id);
+        inMemoryStream.read(name_length);
+        type.name.resize(name_length);
+        inMemoryStream.read(type.name.data(), name_length);
+
+        int32_t const class_id = Object::StringToClassID(type.name);
+        if(class_id == -1)
+            EV_EXCEPT("Snapshot contains unknown class: " + type.name);
+
+        type.class_id = class_id;
+    }
+
+    std::vector<SnapshotChunk> chunks(num_chunks);
+    std::vector<uint32_t>      first_object(num_chunks);   // index of the first object of a chunk in objects
+    uint32_t                   total_objects = 0;
+    for(uint32_t i = 0; i < num_chunks; ++i)
+    {
+        auto & chunk = chunks[i];
+        inMemoryStream.read(chunk.type_index);
+        inMemoryStream.read(chunk.num_objects);
+        inMemoryStream.read(chunk.offset);
+        inMemoryStream.read(chunk.size);
+
+        if(chunk.type_index >= num_types)
+            EV_EXCEPT("Snapshot is corrupted.");
+
+        first_object[i] = total_objects;
+        total_objects += chunk.num_objects;
+    }
+
+    int8_t const * data      = inMemoryStream.getCurPosPtr();
+    uint64_t const data_size = inMemoryStream.getRemainingDataSize();
+    uint64_t       data_end  = 0;
+    for(auto & chunk : chunks)
+    {
+        if(chunk.offset > data_size || chunk.size > data_size - chunk.offset)
+            EV_EXCEPT("Snapshot is corrupted.");
+
+        data_end = std::max(data_end, chunk.offset + chunk.size);
+    }
+
+    if(total_objects != num_objects)
+        EV_EXCEPT("Snapshot is corrupted.");
+
+    // the chunks are read through their own streams, the data that follows the snapshot is next
+    inMemoryStream.skip(static_cast<size_t>(data_end));
+
+    // grow the tables of every class once instead of rehashing while the chunks are registered
+    {
+        std::vector<std::size_t> type_objects(num_types, 0);
+        for(auto & chunk : chunks)
+            type_objects[chunk.type_index] += chunk.num_objects;
+
+        std::lock_guard<std::shared_mutex> lk(m_objects_mutex);
+        for(uint32_t i = 0; i < num_types; ++i)
+        {
+            auto & components = m_objects[static_cast<uint32_t>(types[i].class_id)];
+            components.reserve(components.size() + type_objects[i]);
+
+            auto & storage = getOrCreateStorage(types[i].class_id, MakeFieldDescs<Object>);
+            storage.reserve(storage.getSize() + type_objects[i]);
+        }
+    }
+
+    objects.resize(num_objects);
+    IdRemap id_remap(max_index);
+
+    // the chunks are independent, with a pool every chunk is decoded and linked by a separate task
+    std::exception_ptr error;
+    std::mutex         error_mutex;
+    auto               for_each_chunk = [&](auto && func) {
+        auto run = [&](std::size_t first, std::size_t last) {
+            for(std::size_t i = first; i < last; ++i)
+            {
+                try
+                {
+                    func(i);
+                }
+                catch(...)
+                {
+                    std::lock_guard<std::mutex> elk(error_mutex);
+                    if(!error)
+                        error = std::current_exception();
+                }
+            }
+        };
+
+        if(pool != nullptr)
+            parallel_for(*pool, std::size_t{0}, chunks.size(), run, std::size_t{1});
+        else
+            run(0, chunks.size());
+
+        if(error)
+            std::rethrow_exception(error);
+    };
+
+    for_each_chunk([&](std::size_t i) {
+        auto const &      chunk    = chunks[i];
+        int32_t const     class_id = types[chunk.type_index].class_id;
+        auto const &      factory  = Object::ClassIDToRTTI(class_id).factory;
+        InputMemoryStream block(data + chunk.offset, static_cast<size_t>(chunk.size));
+
+        std::vector<PUniqueObjPtr> loaded;
+        loaded.reserve(chunk.num_objects);
+        for(uint32_t n = 0; n < chunk.num_objects; ++n)
+        {
+            loaded.push_back(factory());
+            loaded.back()->read(block, *this);
+        }
+
+        std::lock_guard<std::shared_mutex> lk(m_objects_mutex);
+        for(uint32_t n = 0; n < chunk.num_objects; ++n)
+        {
+            uint32_t const old_id = loaded[n]->getInstanceId();
+
+            objects[first_object[i] + n] = insertObj(std::move(loaded[n]), class_id);
+            id_remap.add(old_id, objects[first_object[i] + n]->getInstanceId());
+        }
+    });
+
+    for_each_chunk([&](std::size_t i) {
+        for(uint32_t n = 0; n < chunks[i].num_objects; ++n)
+            objects[first_object[i] + n]->getPtr()->link(*this, id_remap);
+    });
+}
+
+void ObjectManager::deserializeObjects(InputMemoryStream const & inMemoryStream,
+                                       std::vector<PObjHandle> & objects)
+{
+    IdRemap id_remap;
 
     while(inMemoryStream.getRemainingDataSize() > 0)
     {
-        auto    stream_cur_ptr = inMemoryStream.getCurPosPtr();
-        int32_t type_id        = *reinterpret_cast<int32_t *>(const_cast<int8_t *>(stream_cur_ptr));
+        int32_t type_id = 0;
+        std::memcpy(&type_id, inMemoryStream.getCurPosPtr(), sizeof(type_id));
 
         auto obj = Object::ClassIDToRTTI(type_id).factory();
         obj->read(inMemoryStream, *this);
         auto old_id = obj->getInstanceId();
 
-        auto obj_handler         = registerObj(std::move(obj), type_id);
-        istance_id_remap[old_id] = obj_handler->getPtr()->getInstanceId();
+        auto obj_handler = registerObj(std::move(obj), type_id);
+        id_remap.add(old_id, obj_handler->getInstanceId());
 
         objects.push_back(obj_handler);
     }
 
-    for(auto & [type_id, components] : m_objects)
-        for(auto & [instance_id, obj_entry] : components)
-        {
-            obj_entry.unique->link(*this, istance_id_remap);
-        }
+    for(auto & obj : objects)
+        obj->getPtr()->link(*this, id_remap);
 }
-
 }   // namespace evnt
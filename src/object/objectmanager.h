@@ -1,42 +1,64 @@
 #ifndef GAMEOBJECTMANAGER_H
 #define GAMEOBJECTMANAGER_H
 
-#include "objhandle.h"
+#include "../core/exception.h"
+#include "chunkstorage.h"
+#include "handletable.h"
 
 #include <atomic>
+#include <chrono>
 #include <mutex>
+#include <shared_mutex>
 
 namespace evnt
 {
+class ThreadPool;
+
 class ObjectManager
 {
-    using PUniqueObjPtr = std::unique_ptr<Object>;
-    using PWeakHandle   = std::weak_ptr<ObjHandle>;
-
-    struct ObjEntry
-    {
-        PUniqueObjPtr unique;
-        PWeakHandle   handle;
-    };
-
-    using ComponentsList = std::unordered_map<uint32_t, ObjEntry>;   // key = instance_id, ObjEntry
-
-    std::atomic<uint32_t>                        m_next_available_id = {1};   // 0 is not a valid ID
-    std::unordered_map<uint32_t, ComponentsList> m_objects;                   // key = type_id
-    mutable std::mutex                           m_objects_mutex;
+    using PUniqueObjPtr  = std::unique_ptr<Object>;
+    using ComponentsList = std::unordered_map<uint32_t, PUniqueObjPtr>;   // key = instance_id
+
+    using PChunkStorage   = std::unique_ptr<ChunkStorage>;
+    using PDeletedObjects = std::unique_ptr<DeletedObjects>;
+    using MakeFieldsFunc  = std::vector<ChunkStorage::FieldDesc> (*)();
+    using SweepClock      = std::chrono::steady_clock;
+
+    HandleTable                                  m_handles;   // instance_id -> object, lock-free lookup
+    std::unordered_map<uint32_t, ComponentsList> m_objects;   // key = type_id
+    std::unordered_map<int32_t, PChunkStorage>   m_chunks;    // key = type_id
+    std::unordered_map<int32_t, PDeletedObjects> m_deleted;   // key = type_id, filled by Object::deleteObj
+    std::size_t                                  m_sweep_start{0};   // first type of the next sweep
+    mutable std::shared_mutex                    m_objects_mutex;   // shared by the chunk readers
+
+    // m_objects_mutex must be locked
+    ChunkStorage &       getOrCreateStorage(int32_t type_id, MakeFieldsFunc make_fields);
+    ChunkStorage const * findStorage(int32_t type_id) const;
+    PObjHandle           insertObj(PUniqueObjPtr ob, int32_t obj_type);
+    // stream of objects without snapshot header (the format before snapshots)
+    void deserializeObjects(InputMemoryStream const & inMemoryStream, std::vector<PObjHandle> & objects);
+
+    bool sweep(SweepClock::time_point deadline);
+    void releaseObject(int32_t type_id, uint32_t instance_id);
 
 public:
     ObjectManager() = default;
     ~ObjectManager();
 
+    // Releases the objects deleted since the last call, the cost is proportional to the number of deletions.
     void releaseStalledObjects();
+    // Incremental version for the frame loop: stops when the time budget is spent,
+    // returns false if deleted objects are left for the next call.
+    bool releaseStalledObjects(std::chrono::microseconds budget);
 
-    bool objectExists(uint32_t instance_id) const;
+    // Lookups by instance id take O(1) and don't lock, ids of released objects are reported as not existing.
+    bool objectExists(uint32_t instance_id) const { return m_handles.contains(instance_id); }
 
     PObjHandle createDefaultObj(int32_t obj_type);
     PObjHandle registerObj(PUniqueObjPtr ob, int32_t obj_type);
     PObjHandle getObject(uint32_t instance_id);
     Object *   getObjectPtr(uint32_t instance_id);
+    Object *   findObject(uint32_t instance_id) const { return m_handles.find(instance_id); }   // or nullptr
 
     ComponentsList const & getObjectsByType(int32_t cmp_type);
     template<typename type>
@@ -45,9 +67,34 @@ public:
     template<typename type>
     PObjHandle createDefaultObj();
 
+    // SoA components (see IsSoAComponent), returns the instance id of the new component
+    template<typename type>
+    uint32_t createComponent();
+    template<typename type>
+    void destroyComponent(uint32_t instance_id);
+    template<typename type, std::size_t field>
+    typename ChunkView<type>::template FieldType<field> & getComponentField(uint32_t instance_id);
+
+    // Chunks of a SoA component class, or chunks of object pointers for OBJECT_DEFINE classes.
+    // Creating or destroying objects of the class invalidates the views. forEachChunk and forEachObject hold
+    // the objects lock shared while func runs, func must not create or destroy objects.
+    template<typename type>
+    std::vector<ChunkView<type>> query() const;
+    template<typename type, typename FunctionType>
+    void forEachChunk(FunctionType && func) const;
+    // Calls func(type &) for every not deleted object of an OBJECT_DEFINE class
+    template<typename type, typename FunctionType>
+    void forEachObject(FunctionType && func) const;
+
+    // Writes a snapshot: objects grouped by class in chunks, preceded by type and chunk tables.
     void serialize(OutputMemoryStream & inMemoryStream) const;
-    void deserialize(InputMemoryStream const & inMemoryStream, std::vector<PObjHandle> & objects);
+    // Reads a snapshot (or the older object by object stream). With a pool the chunks are decoded and linked
+    // in parallel, objects are returned in the snapshot order.
+    void deserialize(InputMemoryStream const & inMemoryStream, std::vector<PObjHandle> & objects,
+                     ThreadPool * pool = nullptr);
     void dump() const;
+    // allocation statistics of the registered classes, see Object::GetPoolStats
+    void dumpPoolStats() const;
 };
 
 template<typename type>
@@ -61,6 +108,85 @@ PObjHandle ObjectManager::createDefaultObj()
 {
     return createDefaultObj(type::GetClassIDStatic());
 }
+
+template<typename type>
+uint32_t ObjectManager::createComponent()
+{
+    static_assert(IsSoAComponent<type>::value, "createDefaultObj() must be used for OBJECT_DEFINE classes");
+
+    uint32_t const instance_id = m_handles.acquire(nullptr);
+
+    std::lock_guard<std::shared_mutex> lk(m_objects_mutex);
+    getOrCreateStorage(type::GetClassIDStatic(), MakeFieldDescs<type>).add(instance_id);
+
+    return instance_id;
+}
+
+template<typename type>
+void ObjectManager::destroyComponent(uint32_t instance_id)
+{
+    static_assert(IsSoAComponent<type>::value, "OBJECT_DEFINE classes are deleted through their handles");
+
+    std::lock_guard<std::shared_mutex> lk(m_objects_mutex);
+    auto                        it = m_chunks.find(type::GetClassIDStatic());
+    if(it != m_chunks.end() && it->second->contains(instance_id))
+    {
+        it->second->remove(instance_id);
+        m_handles.release(instance_id);
+    }
+}
+
+template<typename type, std::size_t field>
+typename ChunkView<type>::template FieldType<field> & ObjectManager::getComponentField(uint32_t instance_id)
+{
+    std::shared_lock lk(m_objects_mutex);
+    auto             it = m_chunks.find(type::GetClassIDStatic());
+    if(it == m_chunks.end())
+        EV_EXCEPT("Trying to acquire not created component.");
+
+    return *static_cast<typename ChunkView<type>::template FieldType<field> *>(
+        it->second->getField(instance_id, field));
+}
+
+template<typename type>
+std::vector<ChunkView<type>> ObjectManager::query() const
+{
+    std::shared_lock             lk(m_objects_mutex);
+    std::vector<ChunkView<type>> res;
+    if(auto storage = findStorage(type::GetClassIDStatic()); storage != nullptr)
+    {
+        res.reserve(storage->getNumChunks());
+        for(std::size_t i = 0; i < storage->getNumChunks(); ++i)
+            res.emplace_back(*storage, i);
+    }
+
+    return res;
+}
+
+template<typename type, typename FunctionType>
+void ObjectManager::forEachChunk(FunctionType && func) const
+{
+    std::shared_lock lk(m_objects_mutex);
+    if(auto storage = findStorage(type::GetClassIDStatic()); storage != nullptr)
+    {
+        for(std::size_t i = 0; i < storage->getNumChunks(); ++i)
+            func(ChunkView<type>(*storage, i));
+    }
+}
+
+template<typename type, typename FunctionType>
+void ObjectManager::forEachObject(FunctionType && func) const
+{
+    static_assert(!IsSoAComponent<type>::value, "forEachChunk() must be used for SoA components");
+
+    forEachChunk<type>([&func](ChunkView<type> const & chunk) {
+        for(Object * obj : chunk.template get<0>())
+        {
+            if(!obj->isDeleted())
+                func(*static_cast<type *>(obj));
+        }
+    });
+}
 }   // namespace evnt
 
 #endif   // GAMEOBJECTMANAGER_H
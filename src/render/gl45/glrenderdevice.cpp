@@ -1,4 +1,5 @@
 #include "glrenderdevice.h"
+#include "gltexture.h"
 #include "typeconversions.h"
 #include <GL/glew.h>
 #include <algorithm>
@@ -44,6 +45,12 @@ bool GLRenderDevice::isExtensionsSupported(std::string const & extension_name) c
            != std::end(m_extensions);
 }
 
+std::unique_ptr<ITexture> GLRenderDevice::createTexture(int32_t width, int32_t height, int32_t levels,
+                                                        TextureInternalFormat format)
+{
+    return std::make_unique<GLTexture>(width, height, false, levels, format);
+}
+
 void GLRenderDevice::clearColorFramebufferCommand(int32_t attachment, glm::vec4 color)
 {
     m_commands.push_back([color, attachment]() {
@@ -15,6 +15,9 @@ public:
     bool init() override;
     bool isExtensionsSupported(std::string const & extension_name) const override;
 
+    std::unique_ptr<ITexture> createTexture(int32_t width, int32_t height, int32_t levels,
+                                            TextureInternalFormat format) override;
+
     void clearColorFramebufferCommand(int32_t attachment, glm::vec4 color) override;
     void clearDepthFramebufferCommand(float value) override;
     void clearAllBuffers() override;
@@ -91,6 +91,13 @@ void GLTexture::setData(int32_t x, int32_t y, int32_t z, int32_t w, int32_t h, i
                         TextureDataTypeToGLTextureDataType(type), pixels);
 }
 
+void GLTexture::setCompressedData(int32_t x, int32_t y, int32_t w, int32_t h, int32_t level, int32_t size,
+                                  void const * data)
+{
+    glCompressedTextureSubImage2D(m_id, level, x, y, w, h,
+                                  TextureInternalFormatToGLTextureInternalFormat(m_format), size, data);
+}
+
 void GLTexture::copyPixels(ITexture & dest, int32_t sX, int32_t sY, int32_t sZ, int32_t sLevel, int32_t dX,
                            int32_t dY, int32_t dZ, int32_t dLevel, int32_t width, int32_t height,
                            int32_t depth)
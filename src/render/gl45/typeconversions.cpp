@@ -315,6 +315,22 @@ GLenum TextureInternalFormatToGLTextureInternalFormat(TextureInternalFormat fmt)
             return GL_RGB32F;
         case TextureInternalFormat::RGBA32F:
             return GL_RGBA32F;
+        case TextureInternalFormat::SRGB8:
+            return GL_SRGB8;
+        case TextureInternalFormat::SRGB8_ALPHA8:
+            return GL_SRGB8_ALPHA8;
+        case TextureInternalFormat::RGB_BC1:
+            return GL_COMPRESSED_RGB_S3TC_DXT1_EXT;
+        case TextureInternalFormat::SRGB_BC1:
+            return GL_COMPRESSED_SRGB_S3TC_DXT1_EXT;
+        case TextureInternalFormat::RGBA_BC3:
+            return GL_COMPRESSED_RGBA_S3TC_DXT5_EXT;
+        case TextureInternalFormat::SRGB_ALPHA_BC3:
+            return GL_COMPRESSED_SRGB_ALPHA_S3TC_DXT5_EXT;
+        case TextureInternalFormat::RGBA_BC7:
+            return GL_COMPRESSED_RGBA_BPTC_UNORM;
+        case TextureInternalFormat::SRGB_ALPHA_BC7:
+            return GL_COMPRESSED_SRGB_ALPHA_BPTC_UNORM;
         default:
             UNEXPECTED("Unknown TextureInternalFormat mode");
             return GL_NEAREST;
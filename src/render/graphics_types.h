@@ -303,7 +303,15 @@ enum class TextureInternalFormat
     R32F,
     RG32F,
     RGB32F,
-    RGBA32F
+    RGBA32F,
+    SRGB8,
+    SRGB8_ALPHA8,
+    RGB_BC1,   // block compressed, see ITexture::setCompressedData
+    SRGB_BC1,
+    RGBA_BC3,
+    SRGB_ALPHA_BC3,
+    RGBA_BC7,
+    SRGB_ALPHA_BC7
 };
 
 enum class TexturePixelFormat
@@ -47,12 +47,6 @@ bool Render::init()
     return mp_device->init();
 }
 
-void Render::addUpdateCommand(std::function<void()> f)
-{
-    std::lock_guard lk(m_update_queue_mutex);
-    m_update_queue.push_back(std::move(f));
-}
-
 std::unique_ptr<Render> Render::CreateRender(std::string const & render_type, Window & owner_window)
 {
     if(render_type.empty())
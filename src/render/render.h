@@ -29,7 +29,18 @@ public:
         return mp_device->isExtensionsSupported(extension_name);
     }
 
-    void addUpdateCommand(std::function<void()> f);
+    void addUpdateCommand(std::function<void()> f)
+    {
+        std::lock_guard lk(m_update_queue_mutex);
+        m_update_queue.push_back(std::move(f));
+    }
+
+    // in the render thread, e.g. by the update commands
+    std::unique_ptr<ITexture> createTexture(int32_t width, int32_t height, int32_t levels,
+                                            TextureInternalFormat format)
+    {
+        return mp_device->createTexture(width, height, levels, format);
+    }
 
     // Fabric method
     static std::unique_ptr<Render> CreateRender(std::string const & render_type, Window & owner_window);
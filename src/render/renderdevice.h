@@ -5,7 +5,9 @@
 #include "shader.h"
 #include "shaderconstants.h"
 #include "shaderdescriptor.h"
+#include "texture.h"
 #include <functional>
+#include <memory>
 
 namespace evnt
 {
@@ -29,6 +31,10 @@ public:
     virtual bool init()                                                          = 0;
     virtual bool isExtensionsSupported(std::string const & extension_name) const = 0;
 
+    // 2D texture with the storage of all the levels, called in the render thread
+    virtual std::unique_ptr<ITexture> createTexture(int32_t width, int32_t height, int32_t levels,
+                                                    TextureInternalFormat format) = 0;
+
     virtual void clearColorFramebufferCommand(int32_t attachment, glm::vec4 color) = 0;
     virtual void clearDepthFramebufferCommand(float value)                         = 0;
     virtual void clearAllBuffers()                                                 = 0;
@@ -85,6 +85,9 @@ public:
                          TextureDataType type, void const * pixels)                            = 0;
     virtual void setData(int32_t x, int32_t y, int32_t z, int32_t w, int32_t h, int32_t d, int32_t level,
                          TexturePixelFormat format, TextureDataType type, void const * pixels) = 0;
+    // the blocks of a compressed format, x, y, w and h are multiples of 4 except at the level edges
+    virtual void setCompressedData(int32_t x, int32_t y, int32_t w, int32_t h, int32_t level, int32_t size,
+                                   void const * data)                                          = 0;
     virtual void copyPixels(ITexture & dest, int32_t sX, int32_t sY, int32_t sZ, int32_t sLevel, int32_t dX,
                             int32_t dY, int32_t dZ, int32_t dLevel, int32_t width, int32_t height,
                             int32_t depth)                                                     = 0;
@@ -0,0 +1,405 @@
+#include "batchculling.h"
+#include "../core/taskgraph.h"
+#include <algorithm>
+#include <cmath>
+
+#if(defined(__x86_64__) || defined(__i386__)) && defined(__GNUC__)
+#    define EV_CULL_KERNELS_X86
+#    define EV_TARGET_SSE2 __attribute__((target("sse2")))
+#    define EV_TARGET_AVX  __attribute__((target("avx")))
+#    include <immintrin.h>
+#endif
+
+namespace evnt
+{
+namespace
+{
+    // the planes of the frustum by component, |n| selects the box corner nearest to the plane
+    struct CullPlanes
+    {
+        float nx[6];
+        float ny[6];
+        float nz[6];
+        float d[6];
+        float abs_nx[6];
+        float abs_ny[6];
+        float abs_nz[6];
+    };
+
+    using BoxFunc    = void (*)(CullPlanes const &, BoxArray const &, size_t, size_t, uint64_t *);
+    using SphereFunc = void (*)(CullPlanes const &, SphereArray const &, size_t, size_t, uint64_t *);
+
+    struct Kernels
+    {
+        char const * name;
+        BoxFunc      boxes;     // [first, last), first is a multiple of 64
+        SphereFunc   spheres;
+    };
+
+    CullPlanes GetCullPlanes(Frustum const & frustum)
+    {
+        CullPlanes planes;
+        for(uint32_t i = 0; i < 6; ++i)
+        {
+            Plane const & plane = frustum.getPlane(i);
+
+            planes.nx[i]     = plane.m_normal.x;
+            planes.ny[i]     = plane.m_normal.y;
+            planes.nz[i]     = plane.m_normal.z;
+            planes.d[i]      = plane.m_dist;
+            planes.abs_nx[i] = std::fabs(plane.m_normal.x);
+            planes.abs_ny[i] = std::fabs(plane.m_normal.y);
+            planes.abs_nz[i] = std::fabs(plane.m_normal.z);
+        }
+
+        return planes;
+    }
+
+    //==============================================================================
+    //         Scalar, the tails of the SIMD versions
+    //==============================================================================
+    // Culled if the nearest corner is outside of a plane, the SIMD versions compute the same expressions
+    bool BoxVisible(CullPlanes const & p, BoxArray const & b, size_t i)
+    {
+        for(uint32_t k = 0; k < 6; ++k)
+        {
+            float const dist =
+                p.nx[k] * b.center_x[i] + p.ny[k] * b.center_y[i] + p.nz[k] * b.center_z[i] + p.d[k];
+            float const rad =
+                p.abs_nx[k] * b.extent_x[i] + p.abs_ny[k] * b.extent_y[i] + p.abs_nz[k] * b.extent_z[i];
+            if(dist > rad)
+                return false;
+        }
+
+        return true;
+    }
+
+    bool SphereVisible(CullPlanes const & p, SphereArray const & s, size_t i)
+    {
+        for(uint32_t k = 0; k < 6; ++k)
+        {
+            float const dist =
+                p.nx[k] * s.center_x[i] + p.ny[k] * s.center_y[i] + p.nz[k] * s.center_z[i] + p.d[k];
+            if(dist > s.radius[i])
+                return false;
+        }
+
+        return true;
+    }
+
+    void CullBoxesScalar(CullPlanes const & planes, BoxArray const & boxes, size_t first, size_t last,
+                         uint64_t * visible)
+    {
+        for(size_t word_first = first; word_first < last; word_first += 64)
+            visible[word_first / 64] = 0;
+
+        for(size_t i = first; i < last; ++i)
+            visible[i / 64] |= uint64_t{BoxVisible(planes, boxes, i)} << (i % 64);
+    }
+
+    void CullSpheresScalar(CullPlanes const & planes, SphereArray const & spheres, size_t first, size_t last,
+                           uint64_t * visible)
+    {
+        for(size_t word_first = first; word_first < last; word_first += 64)
+            visible[word_first / 64] = 0;
+
+        for(size_t i = first; i < last; ++i)
+            visible[i / 64] |= uint64_t{SphereVisible(planes, spheres, i)} << (i % 64);
+    }
+
+#ifdef EV_CULL_KERNELS_X86
+    //==============================================================================
+    //         SSE2, 4 objects a step
+    //==============================================================================
+    EV_TARGET_SSE2 void CullBoxesSse2(CullPlanes const & planes, BoxArray const & boxes, size_t first,
+                                      size_t last, uint64_t * visible)
+    {
+        __m128 nx[6], ny[6], nz[6], d[6], ax[6], ay[6], az[6];
+        for(uint32_t k = 0; k < 6; ++k)
+        {
+            nx[k] = _mm_set1_ps(planes.nx[k]);
+            ny[k] = _mm_set1_ps(planes.ny[k]);
+            nz[k] = _mm_set1_ps(planes.nz[k]);
+            d[k]  = _mm_set1_ps(planes.d[k]);
+            ax[k] = _mm_set1_ps(planes.abs_nx[k]);
+            ay[k] = _mm_set1_ps(planes.abs_ny[k]);
+            az[k] = _mm_set1_ps(planes.abs_nz[k]);
+        }
+
+        size_t const simd_last = first + (last - first) / 4 * 4;
+        for(size_t word_first = first; word_first < last; word_first += 64)
+        {
+            uint64_t word = 0;
+            for(size_t i = word_first; i < std::min(word_first + 64, simd_last); i += 4)
+            {
+                __m128 const cx = _mm_loadu_ps(boxes.center_x.data() + i);
+                __m128 const cy = _mm_loadu_ps(boxes.center_y.data() + i);
+                __m128 const cz = _mm_loadu_ps(boxes.center_z.data() + i);
+                __m128 const ex = _mm_loadu_ps(boxes.extent_x.data() + i);
+                __m128 const ey = _mm_loadu_ps(boxes.extent_y.data() + i);
+                __m128 const ez = _mm_loadu_ps(boxes.extent_z.data() + i);
+
+                __m128 outside = _mm_setzero_ps();
+                for(uint32_t k = 0; k < 6; ++k)
+                {
+                    __m128 dist = _mm_add_ps(_mm_mul_ps(nx[k], cx), _mm_mul_ps(ny[k], cy));
+                    dist        = _mm_add_ps(_mm_add_ps(dist, _mm_mul_ps(nz[k], cz)), d[k]);
+                    __m128 rad  = _mm_add_ps(_mm_mul_ps(ax[k], ex), _mm_mul_ps(ay[k], ey));
+                    rad         = _mm_add_ps(rad, _mm_mul_ps(az[k], ez));
+                    outside     = _mm_or_ps(outside, _mm_cmpgt_ps(dist, rad));
+                }
+
+                word |= uint64_t(~_mm_movemask_ps(outside) & 0xf) << (i - word_first);
+            }
+
+            visible[word_first / 64] = word;
+        }
+
+        for(size_t i = simd_last; i < last; ++i)
+            visible[i / 64] |= uint64_t{BoxVisible(planes, boxes, i)} << (i % 64);
+    }
+
+    EV_TARGET_SSE2 void CullSpheresSse2(CullPlanes const & planes, SphereArray const & spheres, size_t first,
+                                        size_t last, uint64_t * visible)
+    {
+        __m128 nx[6], ny[6], nz[6], d[6];
+        for(uint32_t k = 0; k < 6; ++k)
+        {
+            nx[k] = _mm_set1_ps(planes.nx[k]);
+            ny[k] = _mm_set1_ps(planes.ny[k]);
+            nz[k] = _mm_set1_ps(planes.nz[k]);
+            d[k]  = _mm_set1_ps(planes.d[k]);
+        }
+
+        size_t const simd_last = first + (last - first) / 4 * 4;
+        for(size_t word_first = first; word_first < last; word_first += 64)
+        {
+            uint64_t word = 0;
+            for(size_t i = word_first; i < std::min(word_first + 64, simd_last); i += 4)
+            {
+                __m128 const cx  = _mm_loadu_ps(spheres.center_x.data() + i);
+                __m128 const cy  = _mm_loadu_ps(spheres.center_y.data() + i);
+                __m128 const cz  = _mm_loadu_ps(spheres.center_z.data() + i);
+                __m128 const rad = _mm_loadu_ps(spheres.radius.data() + i);
+
+                __m128 outside = _mm_setzero_ps();
+                for(uint32_t k = 0; k < 6; ++k)
+                {
+                    __m128 dist = _mm_add_ps(_mm_mul_ps(nx[k], cx), _mm_mul_ps(ny[k], cy));
+                    dist        = _mm_add_ps(_mm_add_ps(dist, _mm_mul_ps(nz[k], cz)), d[k]);
+                    outside     = _mm_or_ps(outside, _mm_cmpgt_ps(dist, rad));
+                }
+
+                word |= uint64_t(~_mm_movemask_ps(outside) & 0xf) << (i - word_first);
+            }
+
+            visible[word_first / 64] = word;
+        }
+
+        for(size_t i = simd_last; i < last; ++i)
+            visible[i / 64] |= uint64_t{SphereVisible(planes, spheres, i)} << (i % 64);
+    }
+
+    //==============================================================================
+    //         AVX, 8 objects a step
+    //==============================================================================
+    // the scalar tails are called after vzeroupper, the AVX-SSE transitions cost hundreds of cycles
+    EV_TARGET_AVX void CullBoxesAvx(CullPlanes const & planes, BoxArray const & boxes, size_t first,
+                                    size_t last, uint64_t * visible)
+    {
+        __m256 nx[6], ny[6], nz[6], d[6], ax[6], ay[6], az[6];
+        for(uint32_t k = 0; k < 6; ++k)
+        {
+            nx[k] = _mm256_set1_ps(planes.nx[k]);
+            ny[k] = _mm256_set1_ps(planes.ny[k]);
+            nz[k] = _mm256_set1_ps(planes.nz[k]);
+            d[k]  = _mm256_set1_ps(planes.d[k]);
+            ax[k] = _mm256_set1_ps(planes.abs_nx[k]);
+            ay[k] = _mm256_set1_ps(planes.abs_ny[k]);
+            az[k] = _mm256_set1_ps(planes.abs_nz[k]);
+        }
+
+        size_t const simd_last = first + (last - first) / 8 * 8;
+        for(size_t word_first = first; word_first < last; word_first += 64)
+        {
+            uint64_t word = 0;
+            for(size_t i = word_first; i < std::min(word_first + 64, simd_last); i += 8)
+            {
+                __m256 const cx = _mm256_loadu_ps(boxes.center_x.data() + i);
+                __m256 const cy = _mm256_loadu_ps(boxes.center_y.data() + i);
+                __m256 const cz = _mm256_loadu_ps(boxes.center_z.data() + i);
+                __m256 const ex = _mm256_loadu_ps(boxes.extent_x.data() + i);
+                __m256 const ey = _mm256_loadu_ps(boxes.extent_y.data() + i);
+                __m256 const ez = _mm256_loadu_ps(boxes.extent_z.data() + i);
+
+                __m256 outside = _mm256_setzero_ps();
+                for(uint32_t k = 0; k < 6; ++k)
+                {
+                    __m256 dist = _mm256_add_ps(_mm256_mul_ps(nx[k], cx), _mm256_mul_ps(ny[k], cy));
+                    dist        = _mm256_add_ps(_mm256_add_ps(dist, _mm256_mul_ps(nz[k], cz)), d[k]);
+                    __m256 rad  = _mm256_add_ps(_mm256_mul_ps(ax[k], ex), _mm256_mul_ps(ay[k], ey));
+                    rad         = _mm256_add_ps(rad, _mm256_mul_ps(az[k], ez));
+                    outside     = _mm256_or_ps(outside, _mm256_cmp_ps(dist, rad, _CMP_GT_OQ));
+                }
+
+                word |= uint64_t(~_mm256_movemask_ps(outside) & 0xff) << (i - word_first);
+            }
+
+            visible[word_first / 64] = word;
+        }
+
+        _mm256_zeroupper();
+        for(size_t i = simd_last; i < last; ++i)
+            visible[i / 64] |= uint64_t{BoxVisible(planes, boxes, i)} << (i % 64);
+    }
+
+    EV_TARGET_AVX void CullSpheresAvx(CullPlanes const & planes, SphereArray const & spheres, size_t first,
+                                      size_t last, uint64_t * visible)
+    {
+        __m256 nx[6], ny[6], nz[6], d[6];
+        for(uint32_t k = 0; k < 6; ++k)
+        {
+            nx[k] = _mm256_set1_ps(planes.nx[k]);
+            ny[k] = _mm256_set1_ps(planes.ny[k]);
+            nz[k] = _mm256_set1_ps(planes.nz[k]);
+            d[k]  = _mm256_set1_ps(planes.d[k]);
+        }
+
+        size_t const simd_last = first + (last - first) / 8 * 8;
+        for(size_t word_first = first; word_first < last; word_first += 64)
+        {
+            uint64_t word = 0;
+            for(size_t i = word_first; i < std::min(word_first + 64, simd_last); i += 8)
+            {
+                __m256 const cx  = _mm256_loadu_ps(spheres.center_x.data() + i);
+                __m256 const cy  = _mm256_loadu_ps(spheres.center_y.data() + i);
+                __m256 const cz  = _mm256_loadu_ps(spheres.center_z.data() + i);
+                __m256 const rad = _mm256_loadu_ps(spheres.radius.data() + i);
+
+                __m256 outside = _mm256_setzero_ps();
+                for(uint32_t k = 0; k < 6; ++k)
+                {
+                    __m256 dist = _mm256_add_ps(_mm256_mul_ps(nx[k], cx), _mm256_mul_ps(ny[k], cy));
+                    dist        = _mm256_add_ps(_mm256_add_ps(dist, _mm256_mul_ps(nz[k], cz)), d[k]);
+                    outside     = _mm256_or_ps(outside, _mm256_cmp_ps(dist, rad, _CMP_GT_OQ));
+                }
+
+                word |= uint64_t(~_mm256_movemask_ps(outside) & 0xff) << (i - word_first);
+            }
+
+            visible[word_first / 64] = word;
+        }
+
+        _mm256_zeroupper();
+        for(size_t i = simd_last; i < last; ++i)
+            visible[i / 64] |= uint64_t{SphereVisible(planes, spheres, i)} << (i % 64);
+    }
+#endif
+
+    Kernels SelectKernels()
+    {
+#ifdef EV_CULL_KERNELS_X86
+        __builtin_cpu_init();
+        // checks the OS support of the AVX state too
+        if(__builtin_cpu_supports("avx"))
+            return {"avx", CullBoxesAvx, CullSpheresAvx};
+        if(__builtin_cpu_supports("sse2"))
+            return {"sse2", CullBoxesSse2, CullSpheresSse2};
+#endif
+        return {"scalar", CullBoxesScalar, CullSpheresScalar};
+    }
+
+    Kernels const & GetKernels()
+    {
+        static Kernels const kernels = SelectKernels();
+        return kernels;
+    }
+
+    // chunks of whole words, a word is written by one thread
+    template<typename ArrayType, typename FuncType>
+    void CullInPool(ThreadPool & pool, CullPlanes const & planes, ArrayType const & objects,
+                    uint64_t * visible, FuncType func)
+    {
+        size_t const count     = objects.size();
+        size_t const num_words = GetMaskSize(count);
+        size_t const grain     = std::max<size_t>(16, num_words / (4 * (pool.getNumThreads() + 1)));
+
+        parallel_for(
+            pool, size_t{0}, num_words,
+            [&](size_t first, size_t last) {
+                func(planes, objects, first * 64, std::min(last * 64, count), visible);
+            },
+            grain);
+    }
+}   // namespace
+
+void BoxArray::add(AABB const & box)
+{
+    resize(size() + 1);
+    set(size() - 1, box);
+}
+
+void BoxArray::set(size_t index, AABB const & box)
+{
+    glm::vec3 const center = (box.min() + box.max()) * 0.5f;
+    glm::vec3 const extent = (box.max() - box.min()) * 0.5f;
+
+    center_x[index] = center.x;
+    center_y[index] = center.y;
+    center_z[index] = center.z;
+    extent_x[index] = extent.x;
+    extent_y[index] = extent.y;
+    extent_z[index] = extent.z;
+}
+
+void BoxArray::resize(size_t size)
+{
+    center_x.resize(size);
+    center_y.resize(size);
+    center_z.resize(size);
+    extent_x.resize(size);
+    extent_y.resize(size);
+    extent_z.resize(size);
+}
+
+void SphereArray::add(glm::vec3 const & center, float rad)
+{
+    center_x.push_back(center.x);
+    center_y.push_back(center.y);
+    center_z.push_back(center.z);
+    radius.push_back(rad);
+}
+
+void SphereArray::resize(size_t size)
+{
+    center_x.resize(size);
+    center_y.resize(size);
+    center_z.resize(size);
+    radius.resize(size);
+}
+
+void CullBoxes(Frustum const & frustum, BoxArray const & boxes, uint64_t * visible)
+{
+    GetKernels().boxes(GetCullPlanes(frustum), boxes, 0, boxes.size(), visible);
+}
+
+void CullBoxes(Frustum const & frustum, BoxArray const & boxes, uint64_t * visible, ThreadPool & pool)
+{
+    CullInPool(pool, GetCullPlanes(frustum), boxes, visible, GetKernels().boxes);
+}
+
+void CullSpheres(Frustum const & frustum, SphereArray const & spheres, uint64_t * visible)
+{
+    GetKernels().spheres(GetCullPlanes(frustum), spheres, 0, spheres.size(), visible);
+}
+
+void CullSpheres(Frustum const & frustum, SphereArray const & spheres, uint64_t * visible, ThreadPool & pool)
+{
+    CullInPool(pool, GetCullPlanes(frustum), spheres, visible, GetKernels().spheres);
+}
+
+char const * GetCullKernelsName()
+{
+    return GetKernels().name;
+}
+}   // namespace evnt
@@ -0,0 +1,58 @@
+#ifndef BATCHCULLING_H
+#define BATCHCULLING_H
+
+#include "frustum.h"
+#include <cstdint>
+
+namespace evnt
+{
+class ThreadPool;
+
+// Boxes as the centers and the half sizes, struct of arrays for the SIMD tests
+struct BoxArray
+{
+    std::vector<float> center_x;
+    std::vector<float> center_y;
+    std::vector<float> center_z;
+    std::vector<float> extent_x;
+    std::vector<float> extent_y;
+    std::vector<float> extent_z;
+
+    void   add(AABB const & box);
+    void   set(size_t index, AABB const & box);
+    void   resize(size_t size);
+    void   clear() { resize(0); }
+    size_t size() const { return center_x.size(); }
+};
+
+struct SphereArray
+{
+    std::vector<float> center_x;
+    std::vector<float> center_y;
+    std::vector<float> center_z;
+    std::vector<float> radius;
+
+    void   add(glm::vec3 const & center, float rad);
+    void   resize(size_t size);
+    void   clear() { resize(0); }
+    size_t size() const { return center_x.size(); }
+};
+
+// Batch versions of Frustum::cullBox and cullSphere. Bit i % 64 of visible[i / 64] is set if the object i is
+// not culled, visible holds GetMaskSize() words, the unused bits of the last one are 0. 8 objects are tested
+// at once with AVX, 4 with SSE, the version is chosen by the CPU at the first call. The pool versions split
+// the arrays into chunks of whole words, the calling thread takes part.
+inline size_t GetMaskSize(size_t count)
+{
+    return (count + 63) / 64;
+}
+
+void CullBoxes(Frustum const & frustum, BoxArray const & boxes, uint64_t * visible);
+void CullBoxes(Frustum const & frustum, BoxArray const & boxes, uint64_t * visible, ThreadPool & pool);
+void CullSpheres(Frustum const & frustum, SphereArray const & spheres, uint64_t * visible);
+void CullSpheres(Frustum const & frustum, SphereArray const & spheres, uint64_t * visible, ThreadPool & pool);
+
+char const * GetCullKernelsName();   // "avx", "sse2" or "scalar"
+}   // namespace evnt
+
+#endif   // BATCHCULLING_H
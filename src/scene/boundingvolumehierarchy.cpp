@@ -0,0 +1,691 @@
+#include "boundingvolumehierarchy.h"
+#include <algorithm>
+#include <cmath>
+
+namespace evnt
+{
+namespace
+{
+    // half of the surface area
+    float Area(AABB const & bb)
+    {
+        glm::vec3 const size = bb.max() - bb.min();
+        return size.x * size.y + size.y * size.z + size.z * size.x;
+    }
+
+    AABB Union(AABB const & l, AABB const & r)
+    {
+        AABB bb = l;
+        bb.expandBy(r);
+        return bb;
+    }
+
+    // expandBy() of the default AABB keeps the max above 0
+    AABB const empty_bound{glm::vec3{std::numeric_limits<float>::max()},
+                           glm::vec3{std::numeric_limits<float>::lowest()}};
+
+    // the bounds of the build, branchless unlike AABB::expandBy()
+    struct BuildBound
+    {
+        glm::vec3 min{std::numeric_limits<float>::max()};
+        glm::vec3 max{std::numeric_limits<float>::lowest()};
+
+        void grow(glm::vec3 const & point_min, glm::vec3 const & point_max)
+        {
+            min = glm::min(min, point_min);
+            max = glm::max(max, point_max);
+        }
+
+        float area() const { return Area(AABB{min, max}); }
+    };
+}   // namespace
+
+BoundingVolumeHierarchy::ProxyID BoundingVolumeHierarchy::addProxy(AABB const & bound, uint32_t user_data)
+{
+    uint32_t const leaf = allocateNode();
+    Node &         node = m_nodes[leaf];
+
+    node.bound     = bound;
+    node.user_data = user_data;
+    node.type      = NodeType::leaf;
+    insertLeaf(leaf);
+
+    ++m_num_proxies;
+    ++m_num_changes;
+
+    return leaf;
+}
+
+void BoundingVolumeHierarchy::removeProxy(ProxyID proxy)
+{
+    if(!isValid(proxy))
+        return;
+
+    removeLeaf(proxy);
+    freeNode(proxy);
+
+    --m_num_proxies;
+    ++m_num_changes;
+}
+
+void BoundingVolumeHierarchy::moveProxy(ProxyID proxy, AABB const & bound)
+{
+    Node & node = m_nodes[proxy];
+
+    node.bound = bound;
+    if(!node.moved)
+    {
+        node.moved = true;
+        m_moved.push_back(proxy);
+    }
+}
+
+bool BoundingVolumeHierarchy::isValid(ProxyID proxy) const
+{
+    return proxy < m_nodes.size() && m_nodes[proxy].type == NodeType::leaf;
+}
+
+void BoundingVolumeHierarchy::update()
+{
+    if(!m_moved.empty())
+    {
+        m_num_changes += m_moved.size();
+
+        // one pass over the tree is cheaper than the paths to the root then
+        bool const refit_all = m_moved.size() > m_num_proxies / 4;
+        for(uint32_t leaf : m_moved)
+        {
+            Node & node = m_nodes[leaf];
+            if(node.type != NodeType::leaf || !node.moved)
+                continue;   // removed or queued twice
+
+            node.moved = false;
+            if(!refit_all && node.parent != invalid_node)
+                refit(node.parent);
+        }
+        m_moved.clear();
+
+        if(refit_all)
+            refitAll();
+    }
+
+    // the cost is checked once the number of changes reaches the tree size, O(1) a change
+    if(m_num_changes > 0 && m_num_changes >= m_num_proxies)
+    {
+        m_num_changes = 0;
+        if(getCost() > m_built_cost * rebuild_cost_ratio)
+            rebuild();
+    }
+}
+
+void BoundingVolumeHierarchy::rebuild()
+{
+    // the bounds are copied, the leaves are read in order then
+    struct BuildItem
+    {
+        glm::vec3 min;
+        glm::vec3 max;
+        glm::vec3 centroid;
+        uint32_t  node;
+    };
+
+    std::vector<BuildItem> items;
+    items.reserve(m_num_proxies);
+    for(uint32_t i = 0; i < m_nodes.size(); ++i)
+    {
+        Node & node = m_nodes[i];
+        if(node.type == NodeType::leaf)
+        {
+            node.moved = false;
+            glm::vec3 const min = node.bound.min();
+            glm::vec3 const max = node.bound.max();
+            items.push_back({min, max, (min + max) * 0.5f, i});
+        }
+        else if(node.type == NodeType::inner)
+        {
+            freeNode(i);
+        }
+    }
+
+    m_moved.clear();
+    m_root        = invalid_node;
+    m_num_changes = 0;
+
+    struct BuildTask
+    {
+        uint32_t first;
+        uint32_t last;
+        uint32_t parent;
+        uint32_t slot;
+    };
+
+    std::vector<BuildTask> tasks;
+    if(!items.empty())
+        tasks.push_back({0, static_cast<uint32_t>(items.size()), invalid_node, 0});
+
+    while(!tasks.empty())
+    {
+        BuildTask const task = tasks.back();
+        tasks.pop_back();
+
+        uint32_t index = items[task.first].node;
+        if(task.last - task.first > 1)
+        {
+            BuildBound bound;
+            BuildBound centroid_bound;
+            for(uint32_t i = task.first; i < task.last; ++i)
+            {
+                bound.grow(items[i].min, items[i].max);
+                centroid_bound.grow(items[i].centroid, items[i].centroid);
+            }
+
+            glm::vec3 const extent = centroid_bound.max - centroid_bound.min;
+            int const       axis =
+                extent.x > extent.y ? (extent.x > extent.z ? 0 : 2) : (extent.y > extent.z ? 1 : 2);
+
+            // binned SAH split on the longest axis of the centroids, the median if no split separates them
+            static constexpr uint32_t max_bins = 16;
+
+            uint32_t const count    = task.last - task.first;
+            uint32_t const num_bins = std::min(max_bins, count);
+            uint32_t       mid      = task.first + count / 2;
+            bool           split    = false;
+            if(count > 2 && extent[axis] > 0.0f)
+            {
+                float const axis_min = centroid_bound.min[axis];
+                float const scale    = static_cast<float>(num_bins) / extent[axis];
+                auto        get_bin  = [&](BuildItem const & item) {
+                    auto const bin = static_cast<uint32_t>((item.centroid[axis] - axis_min) * scale);
+                    return std::min(num_bins - 1, bin);
+                };
+
+                BuildBound bin_bounds[max_bins];
+                uint32_t   bin_counts[max_bins] = {};
+                for(uint32_t i = task.first; i < task.last; ++i)
+                {
+                    uint32_t const bin = get_bin(items[i]);
+                    bin_bounds[bin].grow(items[i].min, items[i].max);
+                    ++bin_counts[bin];
+                }
+
+                // right_costs[i] for the bins [i, num_bins)
+                float      right_costs[max_bins] = {};
+                BuildBound accum;
+                uint32_t   accum_count = 0;
+                for(uint32_t i = num_bins - 1; i > 0; --i)
+                {
+                    accum.grow(bin_bounds[i].min, bin_bounds[i].max);
+                    accum_count += bin_counts[i];
+                    right_costs[i] = accum_count > 0 ? accum.area() * static_cast<float>(accum_count) : 0.0f;
+                }
+
+                float    best_cost = std::numeric_limits<float>::max();
+                uint32_t best_bin  = 0;
+                accum              = BuildBound{};
+                accum_count        = 0;
+                for(uint32_t i = 1; i < num_bins; ++i)
+                {
+                    accum.grow(bin_bounds[i - 1].min, bin_bounds[i - 1].max);
+                    accum_count += bin_counts[i - 1];
+
+                    float const cost = accum.area() * static_cast<float>(accum_count) + right_costs[i];
+                    if(accum_count > 0 && accum_count < count && cost < best_cost)
+                    {
+                        best_cost = cost;
+                        best_bin  = i;
+                    }
+                }
+
+                if(best_bin > 0)
+                {
+                    auto const it =
+                        std::partition(items.begin() + task.first, items.begin() + task.last,
+                                       [&](BuildItem const & item) { return get_bin(item) < best_bin; });
+                    mid   = static_cast<uint32_t>(it - items.begin());
+                    split = true;
+                }
+            }
+
+            if(!split)
+            {
+                std::nth_element(items.begin() + task.first, items.begin() + mid, items.begin() + task.last,
+                                 [axis](BuildItem const & l, BuildItem const & r) {
+                                     return l.centroid[axis] < r.centroid[axis];
+                                 });
+            }
+
+            index       = allocateNode();
+            Node & node = m_nodes[index];
+            node.bound  = AABB{bound.min, bound.max};
+            node.type   = NodeType::inner;
+
+            tasks.push_back({task.first, mid, index, 0});
+            tasks.push_back({mid, task.last, index, 1});
+        }
+
+        m_nodes[index].parent = task.parent;
+        if(task.parent == invalid_node)
+            m_root = index;
+        else
+            m_nodes[task.parent].child[task.slot] = index;
+    }
+
+    m_built_cost = getCost();
+}
+
+float BoundingVolumeHierarchy::getCost() const
+{
+    if(m_root == invalid_node || m_nodes[m_root].type == NodeType::leaf)
+        return 0.0f;
+
+    float area = 0.0f;
+    for(Node const & node : m_nodes)
+    {
+        if(node.type == NodeType::inner)
+            area += Area(node.bound);
+    }
+
+    float const root_area = Area(m_nodes[m_root].bound);
+    return root_area > 0.0f ? area / root_area : 0.0f;
+}
+
+void BoundingVolumeHierarchy::queryFrustum(Frustum const & frustum, Frustum const * frust2,
+                                           std::vector<ProxyID> & result) const
+{
+    result.clear();
+    if(m_root == invalid_node)
+        return;
+
+    FrustumPlanes const planes(frustum, frust2);
+
+    // the bits of the planes the node may cross, 0 - inside all of them
+    struct Entry
+    {
+        uint32_t node;
+        uint32_t planes_mask;
+    };
+
+    std::vector<Entry> stack;
+    stack.reserve(64);
+    stack.push_back({m_root, planes.getAllPlanesMask()});
+
+    while(!stack.empty())
+    {
+        Entry const  entry = stack.back();
+        Node const & node  = m_nodes[entry.node];
+        uint32_t     mask  = entry.planes_mask;
+        stack.pop_back();
+
+        if(mask != 0)
+        {
+            glm::vec3 const center = (node.bound.min() + node.bound.max()) * 0.5f;
+            glm::vec3 const extent = (node.bound.max() - node.bound.min()) * 0.5f;
+            if(!planes.test(center, extent, mask))
+                continue;
+        }
+
+        if(node.type == NodeType::leaf)
+        {
+            result.push_back(entry.node);
+        }
+        else
+        {
+            stack.push_back({node.child[0], mask});
+            stack.push_back({node.child[1], mask});
+        }
+    }
+}
+
+void BoundingVolumeHierarchy::queryAABB(AABB const & bound, std::vector<ProxyID> & result) const
+{
+    result.clear();
+    if(m_root == invalid_node)
+        return;
+
+    std::vector<uint32_t> stack;
+    stack.reserve(64);
+    stack.push_back(m_root);
+
+    while(!stack.empty())
+    {
+        uint32_t const index = stack.back();
+        Node const &   node  = m_nodes[index];
+        stack.pop_back();
+
+        if(!node.bound.intersects(bound))
+            continue;
+
+        if(node.type == NodeType::leaf)
+        {
+            result.push_back(index);
+        }
+        else
+        {
+            stack.push_back(node.child[0]);
+            stack.push_back(node.child[1]);
+        }
+    }
+}
+
+void BoundingVolumeHierarchy::castRay(glm::vec3 const & origin, glm::vec3 const & dir, float max_dist,
+                                      std::vector<RayHit> & hits) const
+{
+    hits.clear();
+    if(m_root == invalid_node)
+        return;
+
+    glm::vec3 const inv_dir = GetInverse(dir);
+
+    std::vector<uint32_t> stack;
+    stack.reserve(64);
+    stack.push_back(m_root);
+
+    while(!stack.empty())
+    {
+        uint32_t const index = stack.back();
+        Node const &   node  = m_nodes[index];
+        stack.pop_back();
+
+        float dist;
+        if(!IntersectRay(origin, inv_dir, max_dist, node.bound.min(), node.bound.max(), dist))
+            continue;
+
+        if(node.type == NodeType::leaf)
+        {
+            hits.push_back({index, dist});
+        }
+        else
+        {
+            stack.push_back(node.child[0]);
+            stack.push_back(node.child[1]);
+        }
+    }
+
+    std::sort(hits.begin(), hits.end(), [](RayHit const & l, RayHit const & r) { return l.dist < r.dist; });
+}
+
+BoundingVolumeHierarchy::ProxyID BoundingVolumeHierarchy::castRayFirst(glm::vec3 const & origin,
+                                                                       glm::vec3 const & dir, float max_dist,
+                                                                       float * dist) const
+{
+    glm::vec3 const inv_dir = GetInverse(dir);
+    float           best    = max_dist;
+    float           root_dist;
+    if(m_root == invalid_node)
+        return invalid_proxy;
+
+    AABB const & root_bound = m_nodes[m_root].bound;
+    if(!IntersectRay(origin, inv_dir, best, root_bound.min(), root_bound.max(), root_dist))
+        return invalid_proxy;
+
+    struct Entry
+    {
+        uint32_t node;
+        float    dist;
+    };
+
+    // the nearer child is visited first, the subtrees behind the closest hit are skipped
+    std::vector<Entry> stack;
+    stack.reserve(64);
+    stack.push_back({m_root, root_dist});
+
+    ProxyID result = invalid_proxy;
+    while(!stack.empty())
+    {
+        Entry const entry = stack.back();
+        stack.pop_back();
+
+        if(entry.dist > best)
+            continue;
+
+        Node const & node = m_nodes[entry.node];
+        if(node.type == NodeType::leaf)
+        {
+            best   = entry.dist;
+            result = entry.node;
+            continue;
+        }
+
+        AABB const & bound0 = m_nodes[node.child[0]].bound;
+        AABB const & bound1 = m_nodes[node.child[1]].bound;
+        float        child_dist[2];
+        bool const   hit0 = IntersectRay(origin, inv_dir, best, bound0.min(), bound0.max(), child_dist[0]);
+        bool const   hit1 = IntersectRay(origin, inv_dir, best, bound1.min(), bound1.max(), child_dist[1]);
+        if(hit0 && hit1)
+        {
+            uint32_t const near = child_dist[0] <= child_dist[1] ? 0 : 1;
+            stack.push_back({node.child[1 - near], child_dist[1 - near]});
+            stack.push_back({node.child[near], child_dist[near]});
+        }
+        else if(hit0 || hit1)
+        {
+            uint32_t const slot = hit0 ? 0 : 1;
+            stack.push_back({node.child[slot], child_dist[slot]});
+        }
+    }
+
+    if(result != invalid_proxy && dist != nullptr)
+        *dist = best;
+
+    return result;
+}
+
+uint32_t BoundingVolumeHierarchy::allocateNode()
+{
+    uint32_t index;
+    if(!m_free_nodes.empty())
+    {
+        index = m_free_nodes.back();
+        m_free_nodes.pop_back();
+    }
+    else
+    {
+        index = static_cast<uint32_t>(m_nodes.size());
+        m_nodes.emplace_back();
+    }
+
+    m_nodes[index] = {empty_bound, invalid_node, {invalid_node, invalid_node}, 0, NodeType::free, false};
+    return index;
+}
+
+void BoundingVolumeHierarchy::freeNode(uint32_t index)
+{
+    m_nodes[index].type  = NodeType::free;
+    m_nodes[index].moved = false;
+    m_free_nodes.push_back(index);
+}
+
+void BoundingVolumeHierarchy::insertLeaf(uint32_t leaf)
+{
+    if(m_root == invalid_node)
+    {
+        m_root               = leaf;
+        m_nodes[leaf].parent = invalid_node;
+        return;
+    }
+
+    // Descend while a child is cheaper than a new parent here, the ancestors grow by the same area on any
+    // path below a node
+    AABB const bound = m_nodes[leaf].bound;
+    uint32_t   index = m_root;
+    while(m_nodes[index].type == NodeType::inner)
+    {
+        Node const & node        = m_nodes[index];
+        float const  combined    = Area(Union(node.bound, bound));
+        float const  cost        = 2.0f * combined;
+        float const  inheritance = 2.0f * (combined - Area(node.bound));
+
+        float child_costs[2];
+        for(uint32_t k = 0; k < 2; ++k)
+        {
+            Node const & child = m_nodes[node.child[k]];
+            float const  grown = Area(Union(child.bound, bound));
+
+            child_costs[k] = inheritance + (child.type == NodeType::leaf ? grown : grown - Area(child.bound));
+        }
+
+        if(cost < child_costs[0] && cost < child_costs[1])
+            break;
+
+        index = node.child[child_costs[0] <= child_costs[1] ? 0 : 1];
+    }
+
+    uint32_t const sibling    = index;
+    uint32_t const old_parent = m_nodes[sibling].parent;
+    uint32_t const parent     = allocateNode();
+    Node &         node       = m_nodes[parent];
+
+    node.bound    = Union(m_nodes[sibling].bound, bound);
+    node.parent   = old_parent;
+    node.child[0] = sibling;
+    node.child[1] = leaf;
+    node.type     = NodeType::inner;
+
+    m_nodes[sibling].parent = parent;
+    m_nodes[leaf].parent    = parent;
+    if(old_parent == invalid_node)
+        m_root = parent;
+    else
+        m_nodes[old_parent].child[m_nodes[old_parent].child[0] == sibling ? 0 : 1] = parent;
+
+    rotate(parent);
+    if(old_parent != invalid_node)
+        refit(old_parent);
+}
+
+void BoundingVolumeHierarchy::removeLeaf(uint32_t leaf)
+{
+    if(leaf == m_root)
+    {
+        m_root = invalid_node;
+        return;
+    }
+
+    // the sibling takes the place of the parent
+    uint32_t const parent  = m_nodes[leaf].parent;
+    uint32_t const grand   = m_nodes[parent].parent;
+    uint32_t const sibling = m_nodes[parent].child[m_nodes[parent].child[0] == leaf ? 1 : 0];
+    freeNode(parent);
+
+    m_nodes[sibling].parent = grand;
+    if(grand == invalid_node)
+    {
+        m_root = sibling;
+    }
+    else
+    {
+        m_nodes[grand].child[m_nodes[grand].child[0] == parent ? 0 : 1] = sibling;
+        refit(grand);
+    }
+}
+
+void BoundingVolumeHierarchy::refit(uint32_t index)
+{
+    while(index != invalid_node)
+    {
+        Node &     node  = m_nodes[index];
+        AABB const bound = Union(m_nodes[node.child[0]].bound, m_nodes[node.child[1]].bound);
+        if(bound == node.bound)
+            break;   // the ancestors are the same
+
+        node.bound = bound;
+        rotate(index);
+        index = node.parent;
+    }
+}
+
+void BoundingVolumeHierarchy::rotate(uint32_t index)
+{
+    // Tree rotations of Kopta et al., "Fast, Effective BVH Updates for Animated Scenes": swap a child with a
+    // grandchild on the other side or two grandchildren if the children lose area, the node bound is the same
+    uint32_t const b  = m_nodes[index].child[0];
+    uint32_t const c  = m_nodes[index].child[1];
+    Node const &   nb = m_nodes[b];
+    Node const &   nc = m_nodes[c];
+
+    float    best_gain = 0.0f;
+    uint32_t best_x    = invalid_node;
+    uint32_t best_y    = invalid_node;
+    auto     consider  = [&](uint32_t x, uint32_t y, float gain) {
+        if(gain > best_gain)
+        {
+            best_gain = gain;
+            best_x    = x;
+            best_y    = y;
+        }
+    };
+
+    if(nc.type == NodeType::inner)
+    {
+        for(uint32_t k = 0; k < 2; ++k)
+            consider(b, nc.child[k], Area(nc.bound) - Area(Union(nb.bound, m_nodes[nc.child[1 - k]].bound)));
+    }
+
+    if(nb.type == NodeType::inner)
+    {
+        for(uint32_t k = 0; k < 2; ++k)
+            consider(c, nb.child[k], Area(nb.bound) - Area(Union(nc.bound, m_nodes[nb.child[1 - k]].bound)));
+    }
+
+    if(nb.type == NodeType::inner && nc.type == NodeType::inner)
+    {
+        for(uint32_t i = 0; i < 2; ++i)
+        {
+            for(uint32_t j = 0; j < 2; ++j)
+            {
+                AABB const & bi = m_nodes[nb.child[i]].bound;
+                AABB const & cj = m_nodes[nc.child[j]].bound;
+                float const  new_b = Area(Union(cj, m_nodes[nb.child[1 - i]].bound));
+                float const  new_c = Area(Union(bi, m_nodes[nc.child[1 - j]].bound));
+
+                consider(nb.child[i], nc.child[j], Area(nb.bound) + Area(nc.bound) - new_b - new_c);
+            }
+        }
+    }
+
+    if(best_x == invalid_node)
+        return;
+
+    uint32_t const px = m_nodes[best_x].parent;
+    uint32_t const py = m_nodes[best_y].parent;
+
+    m_nodes[px].child[m_nodes[px].child[0] == best_x ? 0 : 1] = best_y;
+    m_nodes[py].child[m_nodes[py].child[0] == best_y ? 0 : 1] = best_x;
+    m_nodes[best_x].parent                                    = py;
+    m_nodes[best_y].parent                                    = px;
+
+    for(uint32_t child : {b, c})
+    {
+        Node & node = m_nodes[child];
+        if(node.type == NodeType::inner)
+            node.bound = Union(m_nodes[node.child[0]].bound, m_nodes[node.child[1]].bound);
+    }
+}
+
+void BoundingVolumeHierarchy::refitAll()
+{
+    if(m_root == invalid_node)
+        return;
+
+    // breadth-first, the children after the parents
+    std::vector<uint32_t> order;
+    order.reserve(m_nodes.size());
+    order.push_back(m_root);
+    for(size_t i = 0; i < order.size(); ++i)
+    {
+        Node const & node = m_nodes[order[i]];
+        if(node.type == NodeType::inner)
+        {
+            order.push_back(node.child[0]);
+            order.push_back(node.child[1]);
+        }
+    }
+
+    for(size_t i = order.size(); i-- > 0;)
+    {
+        Node & node = m_nodes[order[i]];
+        if(node.type == NodeType::inner)
+            node.bound = Union(m_nodes[node.child[0]].bound, m_nodes[node.child[1]].bound);
+    }
+}
+}   // namespace evnt
@@ -0,0 +1,87 @@
+#ifndef BOUNDINGVOLUMEHIERARCHY_H
+#define BOUNDINGVOLUMEHIERARCHY_H
+
+#include "spatialindex.h"
+
+namespace evnt
+{
+/**
+ * Dynamic AABB tree with one proxy per leaf. rebuild() builds the tree top-down by the surface area heuristic
+ * (SAH) with binned splits. An added proxy becomes the sibling of the node of the least SAH cost, a moved one
+ * is refitted by update(): the bounds of its ancestors are recomputed bottom-up and the children of each of
+ * them are rotated when that lowers the SAH cost, so the tree stays close to the built one while the objects
+ * move. The tree is rebuilt if its cost grows too much anyway. Proxy ids are stable, rebuild() reallocates
+ * only the inner nodes.
+ */
+class BoundingVolumeHierarchy : public SpatialIndex
+{
+public:
+    struct RayHit
+    {
+        ProxyID proxy;
+        float   dist;   // to the proxy bound, 0 if the origin is inside
+    };
+
+    ProxyID      addProxy(AABB const & bound, uint32_t user_data) override;
+    void         removeProxy(ProxyID proxy) override;
+    void         moveProxy(ProxyID proxy, AABB const & bound) override;   // refitted by the next update()
+    bool         isValid(ProxyID proxy) const;
+    uint32_t     getUserData(ProxyID proxy) const override { return m_nodes[proxy].user_data; }
+    AABB const & getBound(ProxyID proxy) const { return m_nodes[proxy].bound; }
+    size_t       getNumProxies() const override { return m_num_proxies; }
+
+    void  update() override;
+    void  rebuild();
+    float getCost() const;   // the sum of the inner node areas relative to the root area, O(n)
+
+    // the subtrees inside all the planes are added without tests
+    void queryFrustum(Frustum const & frustum, Frustum const * frust2,
+                      std::vector<ProxyID> & result) const override;
+    void queryAABB(AABB const & bound, std::vector<ProxyID> & result) const override;
+    // all the hits sorted by the distance
+    void    castRay(glm::vec3 const & origin, glm::vec3 const & dir, float max_dist,
+                    std::vector<RayHit> & hits) const;
+    ProxyID castRayFirst(glm::vec3 const & origin, glm::vec3 const & dir, float max_dist,
+                         float * dist = nullptr) const override;
+
+private:
+    enum class NodeType : uint8_t
+    {
+        free,
+        leaf,
+        inner
+    };
+
+    struct Node
+    {
+        AABB     bound;
+        uint32_t parent;
+        uint32_t child[2];
+        uint32_t user_data;
+        NodeType type;
+        bool     moved;
+    };
+
+    inline static uint32_t const invalid_node = std::numeric_limits<uint32_t>::max();
+
+    static constexpr float rebuild_cost_ratio = 1.5f;   // of the cost after the last rebuild
+
+    uint32_t allocateNode();
+    void     freeNode(uint32_t index);
+    void     insertLeaf(uint32_t leaf);
+    void     removeLeaf(uint32_t leaf);
+    void     refit(uint32_t index);   // the node and its ancestors while the bounds change
+    void     rotate(uint32_t index);
+    void     refitAll();
+
+    std::vector<Node>     m_nodes;
+    std::vector<uint32_t> m_free_nodes;
+    std::vector<uint32_t> m_moved;
+    uint32_t              m_root{invalid_node};
+    size_t                m_num_proxies{0};
+    size_t                m_num_changes{0};   // since the last cost check
+    float                 m_built_cost{0.0f};
+};
+}   // namespace evnt
+
+#endif   // BOUNDINGVOLUMEHIERARCHY_H
@@ -74,5 +74,5 @@ void CameraComponent::write(OutputMemoryStream & inMemoryStream, ObjectManager c
 
 void CameraComponent::read(InputMemoryStream const & inMemoryStream, ObjectManager & gmgr) {}
 
-void CameraComponent::link(ObjectManager & gmgr, std::map<uint32_t, uint32_t> const & id_remap) {}
+void CameraComponent::link(ObjectManager & gmgr, IdRemap const & id_remap) {}
 }   // namespace evnt
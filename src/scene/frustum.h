@@ -11,6 +11,7 @@ class Frustum
 public:
     glm::vec3 const & getOrigin() const { return m_origin; }
     glm::vec3 const & getCorner(uint32_t index) const { return m_corners[index]; }
+    Plane const &     getPlane(uint32_t index) const { return m_planes[index]; }   // normal points outside
 
     void buildViewFrustum(glm::mat4 const & trans_mat, float fov, float aspect, float near_plane,
                           float far_plane);
@@ -11,5 +11,5 @@ void LightComponent::write(OutputMemoryStream & inMemoryStream, ObjectManager co
 
 void LightComponent::read(InputMemoryStream const & inMemoryStream, ObjectManager & gmgr) {}
 
-void LightComponent::link(ObjectManager & gmgr, std::map<uint32_t, uint32_t> const & id_remap) {}
+void LightComponent::link(ObjectManager & gmgr, IdRemap const & id_remap) {}
 }   // namespace evnt
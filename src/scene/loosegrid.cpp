@@ -0,0 +1,449 @@
+#include "loosegrid.h"
+#include <cassert>
+
+namespace evnt
+{
+namespace
+{
+    constexpr uint32_t coord_bits  = 20;
+    constexpr int32_t  coord_limit = 1 << (coord_bits - 1);   // the cell coordinates are in [-limit, limit)
+
+    uint64_t MakeKey(uint32_t level, glm::ivec3 const & coords)
+    {
+        uint64_t key = level;
+        for(int axis = 0; axis < 3; ++axis)
+            key = (key << coord_bits) | static_cast<uint64_t>(coords[axis] + coord_limit);
+
+        return key;
+    }
+
+    glm::vec3 ToVec3(glm::ivec3 const & coords)
+    {
+        return {static_cast<float>(coords.x), static_cast<float>(coords.y), static_cast<float>(coords.z)};
+    }
+
+    bool IsInside(glm::ivec3 const & coords, glm::ivec3 const & min, glm::ivec3 const & max)
+    {
+        return coords.x >= min.x && coords.x <= max.x && coords.y >= min.y && coords.y <= max.y
+               && coords.z >= min.z && coords.z <= max.z;
+    }
+
+    bool Intersects(glm::vec3 const & min, glm::vec3 const & max, AABB const & bound)
+    {
+        return std::max(min.x, bound.min().x) <= std::min(max.x, bound.max().x)
+               && std::max(min.y, bound.min().y) <= std::min(max.y, bound.max().y)
+               && std::max(min.z, bound.min().z) <= std::min(max.z, bound.max().z);
+    }
+
+    // the part of the ray inside the box, IntersectRay() with the exit distance
+    bool ClipRay(glm::vec3 const & origin, glm::vec3 const & inv_dir, float max_dist, glm::vec3 const & min,
+                 glm::vec3 const & max, float & t_min, float & t_max)
+    {
+        t_min = 0.0f;
+        t_max = max_dist;
+        for(int axis = 0; axis < 3; ++axis)
+        {
+            if(std::isinf(inv_dir[axis]))
+            {
+                if(origin[axis] < min[axis] || origin[axis] > max[axis])
+                    return false;
+
+                continue;
+            }
+
+            float t0 = (min[axis] - origin[axis]) * inv_dir[axis];
+            float t1 = (max[axis] - origin[axis]) * inv_dir[axis];
+            if(t0 > t1)
+                std::swap(t0, t1);
+
+            t_min = std::max(t_min, t0);
+            t_max = std::min(t_max, t1);
+            if(t_min > t_max)
+                return false;
+        }
+
+        return true;
+    }
+}   // namespace
+
+LooseGrid::LooseGrid(float cell_size)
+{
+    assert(cell_size > 0.0f);
+
+    for(uint32_t level = 0; level < num_levels; ++level)
+    {
+        m_cell_size[level]     = cell_size * static_cast<float>(1u << level);
+        m_inv_cell_size[level] = 1.0f / m_cell_size[level];
+        m_level_min[level]     = glm::ivec3(std::numeric_limits<int32_t>::max());
+        m_level_max[level]     = glm::ivec3(std::numeric_limits<int32_t>::lowest());
+    }
+
+    m_cells.emplace_back();
+    m_cells[large_cell].key = large_key;
+}
+
+LooseGrid::ProxyID LooseGrid::addProxy(AABB const & bound, uint32_t user_data)
+{
+    ProxyID proxy;
+    if(!m_free_proxies.empty())
+    {
+        proxy = m_free_proxies.back();
+        m_free_proxies.pop_back();
+    }
+    else
+    {
+        proxy = static_cast<ProxyID>(m_proxies.size());
+        m_proxies.emplace_back();
+    }
+
+    m_proxies[proxy].user_data = user_data;
+    insertEntry(proxy, bound);
+
+    return proxy;
+}
+
+void LooseGrid::removeProxy(ProxyID proxy)
+{
+    removeEntry(proxy);
+
+    m_proxies[proxy].cell = invalid_cell;
+    m_free_proxies.push_back(proxy);
+}
+
+void LooseGrid::moveProxy(ProxyID proxy, AABB const & bound)
+{
+    uint32_t   level;
+    glm::ivec3 coords;
+
+    ProxyInfo const & info = m_proxies[proxy];
+    Cell &            cell = m_cells[info.cell];
+    if(getCellKey(bound, level, coords) == cell.key)
+    {
+        cell.entries[info.slot].min = bound.min();
+        cell.entries[info.slot].max = bound.max();
+        return;
+    }
+
+    removeEntry(proxy);
+    insertEntry(proxy, bound);
+}
+
+void LooseGrid::queryFrustum(Frustum const & frustum, Frustum const * frust2,
+                             std::vector<ProxyID> & result) const
+{
+    result.clear();
+
+    FrustumPlanes const planes(frustum, frust2);
+    auto                add_entries = [&planes, &result](Cell const & cell, uint32_t mask) {
+        for(Entry const & entry : cell.entries)
+        {
+            glm::vec3 const center     = (entry.min + entry.max) * 0.5f;
+            glm::vec3 const extent     = (entry.max - entry.min) * 0.5f;
+            uint32_t        entry_mask = mask;
+            if(mask == 0 || planes.test(center, extent, entry_mask))
+                result.push_back(entry.proxy);
+        }
+    };
+
+    add_entries(m_cells[large_cell], planes.getAllPlanesMask());
+
+    // the loose cells are tested first, the entries of the ones inside all the planes are added without tests
+    for(uint32_t level = 0; level < num_levels; ++level)
+    {
+        float const     cs = m_cell_size[level];
+        glm::vec3 const extent{cs};
+        for(uint32_t index : m_level_cells[level])
+        {
+            Cell const &    cell = m_cells[index];
+            glm::vec3 const center = (ToVec3(cell.coords) + glm::vec3(0.5f)) * cs;
+
+            uint32_t mask = planes.getAllPlanesMask();
+            if(planes.test(center, extent, mask))
+                add_entries(cell, mask);
+        }
+    }
+}
+
+void LooseGrid::queryAABB(AABB const & bound, std::vector<ProxyID> & result) const
+{
+    result.clear();
+
+    auto add_entries = [&bound, &result](Cell const & cell) {
+        for(Entry const & entry : cell.entries)
+        {
+            if(Intersects(entry.min, entry.max, bound))
+                result.push_back(entry.proxy);
+        }
+    };
+
+    add_entries(m_cells[large_cell]);
+
+    for(uint32_t level = 0; level < num_levels; ++level)
+    {
+        if(m_level_cells[level].empty())
+            continue;
+
+        // the loose cell c is [c - 0.5, c + 1.5] cells, the range is clipped by the occupied cells
+        float const inv_cs    = m_inv_cell_size[level];
+        uint64_t    num_cells = 1;
+        glm::ivec3  min, max;
+        for(int axis = 0; axis < 3 && num_cells > 0; ++axis)
+        {
+            float const lo = std::max(static_cast<float>(m_level_min[level][axis]),
+                                      std::ceil(bound.min()[axis] * inv_cs - 1.5f));
+            float const hi = std::min(static_cast<float>(m_level_max[level][axis]),
+                                      std::floor(bound.max()[axis] * inv_cs + 0.5f));
+            if(!(lo <= hi))
+            {
+                num_cells = 0;
+                continue;
+            }
+
+            min[axis] = static_cast<int32_t>(lo);
+            max[axis] = static_cast<int32_t>(hi);
+            num_cells *= static_cast<uint64_t>(max[axis] - min[axis] + 1);
+        }
+
+        if(num_cells == 0)
+            continue;
+
+        if(num_cells < m_level_cells[level].size())
+        {
+            for(int32_t z = min.z; z <= max.z; ++z)
+            {
+                for(int32_t y = min.y; y <= max.y; ++y)
+                {
+                    for(int32_t x = min.x; x <= max.x; ++x)
+                    {
+                        if(Cell const * cell = findCell(level, glm::ivec3(x, y, z)))
+                            add_entries(*cell);
+                    }
+                }
+            }
+        }
+        else
+        {
+            for(uint32_t index : m_level_cells[level])
+            {
+                if(IsInside(m_cells[index].coords, min, max))
+                    add_entries(m_cells[index]);
+            }
+        }
+    }
+}
+
+LooseGrid::ProxyID LooseGrid::castRayFirst(glm::vec3 const & origin, glm::vec3 const & dir, float max_dist,
+                                           float * dist) const
+{
+    glm::vec3 const inv_dir = GetInverse(dir);
+    float           best    = max_dist;
+    ProxyID         result  = invalid_proxy;
+
+    auto test_entries = [&](Cell const & cell) {
+        for(Entry const & entry : cell.entries)
+        {
+            float entry_dist;
+            if(IntersectRay(origin, inv_dir, best, entry.min, entry.max, entry_dist)
+               && (result == invalid_proxy || entry_dist < best))
+            {
+                best   = entry_dist;
+                result = entry.proxy;
+            }
+        }
+    };
+
+    test_entries(m_cells[large_cell]);
+
+    for(uint32_t level = 0; level < num_levels; ++level)
+    {
+        if(m_level_cells[level].empty())
+            continue;
+
+        float const        cs        = m_cell_size[level];
+        glm::ivec3 const & level_min = m_level_min[level];
+        glm::ivec3 const & level_max = m_level_max[level];
+
+        // the loose cells of the level
+        glm::vec3 const region_min = (ToVec3(level_min) - glm::vec3(0.5f)) * cs;
+        glm::vec3 const region_max = (ToVec3(level_max) + glm::vec3(1.5f)) * cs;
+
+        float t_enter, t_exit;
+        if(!ClipRay(origin, inv_dir, best, region_min, region_max, t_enter, t_exit))
+            continue;
+
+        // The ray steps through the grid offset by the half of the cell, the points of its cell v are inside
+        // the loose cells v + {0, 1}^3. A step along an axis adds the 4 cells of the far layer. The loose
+        // cells of the hits nearer than the entry into a cell are visited before it.
+        glm::ivec3 cur, step;
+        float      t_next[3], t_delta[3];
+        for(int axis = 0; axis < 3; ++axis)
+        {
+            float const pos  = (origin[axis] + dir[axis] * t_enter) / cs - 0.5f;
+            float const cell = std::min(std::max(std::floor(pos), static_cast<float>(level_min[axis] - 1)),
+                                        static_cast<float>(level_max[axis]));
+
+            cur[axis] = static_cast<int32_t>(cell);
+            if(dir[axis] > 0.0f)
+            {
+                step[axis]    = 1;
+                t_next[axis]  = ((static_cast<float>(cur[axis]) + 1.5f) * cs - origin[axis]) * inv_dir[axis];
+                t_delta[axis] = cs * inv_dir[axis];
+            }
+            else if(dir[axis] < 0.0f)
+            {
+                step[axis]    = -1;
+                t_next[axis]  = ((static_cast<float>(cur[axis]) + 0.5f) * cs - origin[axis]) * inv_dir[axis];
+                t_delta[axis] = -cs * inv_dir[axis];
+            }
+            else
+            {
+                step[axis]    = 0;
+                t_next[axis]  = std::numeric_limits<float>::infinity();
+                t_delta[axis] = std::numeric_limits<float>::infinity();
+            }
+        }
+
+        int step_axis = -1;   // all the 8 cells at the first one
+        for(;;)
+        {
+            for(int32_t i = 0; i < 8; ++i)
+            {
+                glm::ivec3 const offset(i & 1, (i >> 1) & 1, (i >> 2) & 1);
+                if(step_axis >= 0 && offset[step_axis] != (step[step_axis] > 0 ? 1 : 0))
+                    continue;
+
+                glm::ivec3 const coords(cur.x + offset.x, cur.y + offset.y, cur.z + offset.z);
+                if(!IsInside(coords, level_min, level_max))
+                    continue;
+
+                if(Cell const * cell = findCell(level, coords))
+                    test_entries(*cell);
+            }
+
+            step_axis = t_next[0] <= t_next[1] ? 0 : 1;
+            step_axis = t_next[step_axis] <= t_next[2] ? step_axis : 2;
+            if(t_next[step_axis] > std::min(t_exit, best))
+                break;
+
+            cur[step_axis] += step[step_axis];
+            if(cur[step_axis] < level_min[step_axis] - 1 || cur[step_axis] > level_max[step_axis])
+                break;
+
+            t_next[step_axis] += t_delta[step_axis];
+        }
+    }
+
+    if(result != invalid_proxy && dist != nullptr)
+        *dist = best;
+
+    return result;
+}
+
+uint64_t LooseGrid::getCellKey(AABB const & bound, uint32_t & level, glm::ivec3 & coords) const
+{
+    glm::vec3 const size     = bound.max() - bound.min();
+    float const     max_size = std::max(size.x, std::max(size.y, size.z));
+
+    // NaN goes to the large ones
+    level = 0;
+    while(level < num_levels && !(max_size <= m_cell_size[level]))
+        ++level;
+
+    if(level == num_levels)
+        return large_key;
+
+    glm::vec3 const center = (bound.min() + bound.max()) * 0.5f;
+    for(int axis = 0; axis < 3; ++axis)
+    {
+        float const cell = std::floor(center[axis] * m_inv_cell_size[level]);
+        if(!(cell >= -coord_limit && cell < coord_limit))
+            return large_key;
+
+        coords[axis] = static_cast<int32_t>(cell);
+    }
+
+    return MakeKey(level, coords);
+}
+
+uint32_t LooseGrid::acquireCell(uint64_t key, uint32_t level, glm::ivec3 const & coords)
+{
+    auto const it = m_cell_map.find(key);
+    if(it != m_cell_map.end())
+        return it->second;
+
+    // the freed cells keep the capacity of their entries
+    uint32_t index;
+    if(!m_free_cells.empty())
+    {
+        index = m_free_cells.back();
+        m_free_cells.pop_back();
+    }
+    else
+    {
+        index = static_cast<uint32_t>(m_cells.size());
+        m_cells.emplace_back();
+    }
+
+    Cell & cell     = m_cells[index];
+    cell.key        = key;
+    cell.coords     = coords;
+    cell.level      = level;
+    cell.level_slot = static_cast<uint32_t>(m_level_cells[level].size());
+    m_cell_map[key] = index;
+    m_level_cells[level].push_back(index);
+
+    for(int axis = 0; axis < 3; ++axis)
+    {
+        m_level_min[level][axis] = std::min(m_level_min[level][axis], coords[axis]);
+        m_level_max[level][axis] = std::max(m_level_max[level][axis], coords[axis]);
+    }
+
+    return index;
+}
+
+void LooseGrid::releaseCell(uint32_t index)
+{
+    Cell const &            cell        = m_cells[index];
+    std::vector<uint32_t> & level_cells = m_level_cells[cell.level];
+
+    level_cells[cell.level_slot]           = level_cells.back();
+    m_cells[level_cells.back()].level_slot = cell.level_slot;
+    level_cells.pop_back();
+
+    m_cell_map.erase(cell.key);
+    m_free_cells.push_back(index);
+}
+
+LooseGrid::Cell const * LooseGrid::findCell(uint32_t level, glm::ivec3 const & coords) const
+{
+    auto const it = m_cell_map.find(MakeKey(level, coords));
+    return it != m_cell_map.end() ? &m_cells[it->second] : nullptr;
+}
+
+void LooseGrid::insertEntry(ProxyID proxy, AABB const & bound)
+{
+    uint32_t   level;
+    glm::ivec3 coords;
+
+    uint64_t const key   = getCellKey(bound, level, coords);
+    uint32_t const index = key == large_key ? large_cell : acquireCell(key, level, coords);
+
+    ProxyInfo & info = m_proxies[proxy];
+    info.cell        = index;
+    info.slot        = static_cast<uint32_t>(m_cells[index].entries.size());
+    m_cells[index].entries.push_back({bound.min(), bound.max(), proxy});
+}
+
+void LooseGrid::removeEntry(ProxyID proxy)
+{
+    ProxyInfo const & info = m_proxies[proxy];
+    Cell &            cell = m_cells[info.cell];
+
+    cell.entries[info.slot]                       = cell.entries.back();
+    m_proxies[cell.entries[info.slot].proxy].slot = info.slot;
+    cell.entries.pop_back();
+
+    if(cell.entries.empty() && info.cell != large_cell)
+        releaseCell(info.cell);
+}
+}   // namespace evnt
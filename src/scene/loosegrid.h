@@ -0,0 +1,90 @@
+#ifndef LOOSEGRID_H
+#define LOOSEGRID_H
+
+#include "spatialindex.h"
+#include <unordered_map>
+
+namespace evnt
+{
+/**
+ * Hierarchical loose grid of hashed cells. The cells of a level are twice the size of the ones below, a proxy
+ * goes to the lowest level with the cells not smaller than its bound, to the cell of its bound center. The
+ * loose cell is the cell grown by the half of its size, it contains the whole bound. Only the occupied cells
+ * are stored, the entries of a cell are kept together with their bounds. Adding, moving and removing are O(1)
+ * and applied at once, a move inside the cell only rewrites the entry. The queries walk the cells of the
+ * query region or the occupied cells, the rays step through the grid of each level from the nearest cell.
+ * The bounds too large for the top level, or too far for the 20 bit cell coordinates, are tested one by one.
+ */
+class LooseGrid : public SpatialIndex
+{
+public:
+    explicit LooseGrid(float cell_size);   // of the lowest level
+
+    ProxyID  addProxy(AABB const & bound, uint32_t user_data) override;
+    void     removeProxy(ProxyID proxy) override;
+    void     moveProxy(ProxyID proxy, AABB const & bound) override;
+    uint32_t getUserData(ProxyID proxy) const override { return m_proxies[proxy].user_data; }
+    size_t   getNumProxies() const override { return m_proxies.size() - m_free_proxies.size(); }
+    size_t   getNumCells() const { return m_cell_map.size(); }
+    void     update() override {}
+
+    void    queryFrustum(Frustum const & frustum, Frustum const * frust2,
+                         std::vector<ProxyID> & result) const override;
+    void    queryAABB(AABB const & bound, std::vector<ProxyID> & result) const override;
+    ProxyID castRayFirst(glm::vec3 const & origin, glm::vec3 const & dir, float max_dist,
+                         float * dist = nullptr) const override;
+
+private:
+    struct Entry
+    {
+        glm::vec3 min;
+        glm::vec3 max;
+        ProxyID   proxy;
+    };
+
+    struct Cell
+    {
+        std::vector<Entry> entries;
+        uint64_t           key;
+        glm::ivec3         coords;
+        uint32_t           level;
+        uint32_t           level_slot;   // in m_level_cells
+    };
+
+    struct ProxyInfo
+    {
+        uint32_t cell;
+        uint32_t slot;   // in the cell entries
+        uint32_t user_data;
+    };
+
+    static constexpr uint32_t num_levels = 8;
+    static constexpr uint32_t large_cell = 0;   // the bounds out of the levels
+    static constexpr uint64_t large_key  = std::numeric_limits<uint64_t>::max();
+
+    inline static uint32_t const invalid_cell = std::numeric_limits<uint32_t>::max();
+
+    // large_key for the bounds out of the levels
+    uint64_t     getCellKey(AABB const & bound, uint32_t & level, glm::ivec3 & coords) const;
+    uint32_t     acquireCell(uint64_t key, uint32_t level, glm::ivec3 const & coords);
+    void         releaseCell(uint32_t index);
+    Cell const * findCell(uint32_t level, glm::ivec3 const & coords) const;
+    void         insertEntry(ProxyID proxy, AABB const & bound);
+    void         removeEntry(ProxyID proxy);
+
+    float m_cell_size[num_levels];
+    float m_inv_cell_size[num_levels];
+
+    std::vector<Cell>                      m_cells;   // m_cells[large_cell] isn't hashed
+    std::vector<uint32_t>                  m_free_cells;
+    std::unordered_map<uint64_t, uint32_t> m_cell_map;
+    std::vector<uint32_t>                  m_level_cells[num_levels];   // the occupied ones
+    glm::ivec3                             m_level_min[num_levels];     // of the cells ever occupied
+    glm::ivec3                             m_level_max[num_levels];
+
+    std::vector<ProxyInfo> m_proxies;
+    std::vector<ProxyID>   m_free_proxies;
+};
+}   // namespace evnt
+
+#endif   // LOOSEGRID_H
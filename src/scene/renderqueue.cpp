@@ -0,0 +1,145 @@
+#include "renderqueue.h"
+#include "../core/taskgraph.h"
+#include <algorithm>
+#include <cstring>
+
+namespace evnt
+{
+namespace
+{
+    constexpr uint32_t digit_bits  = 8;
+    constexpr uint32_t num_digits  = 64 / digit_bits;
+    constexpr uint32_t num_buckets = 1u << digit_bits;
+
+    uint64_t Mask(uint32_t bits)
+    {
+        return (uint64_t{1} << bits) - 1;
+    }
+}   // namespace
+
+uint64_t RenderQueue::MakeKey(SceneMgr::SortState const & state, float depth, SceneMgr::SortOrder order)
+{
+    static_assert(layer_bits + 1 + pipeline_bits + material_bits + depth_bits == 64, "The key must be full");
+
+    // the bits of the non-negative floats are ordered as the floats, NaN goes to 0
+    float const positive = depth > 0.0f ? depth : 0.0f;
+    uint32_t    float_bits;
+    std::memcpy(&float_bits, &positive, sizeof(float_bits));
+
+    uint64_t depth_key = float_bits >> (31 - depth_bits);
+    if(state.translucent || order == SceneMgr::SortOrder::Back_To_Front)
+        depth_key = Mask(depth_bits) - depth_key;
+
+    uint64_t const layer    = state.layer & Mask(layer_bits);
+    uint64_t const pipeline = state.pipeline & Mask(pipeline_bits);
+    uint64_t const material = state.material & Mask(material_bits);
+
+    uint64_t const key = (layer << 1 | (state.translucent ? 1 : 0)) << (64 - layer_bits - 1);
+    if(state.translucent)
+        return key | depth_key << (pipeline_bits + material_bits) | pipeline << material_bits | material;
+
+    return key | pipeline << (material_bits + depth_bits) | material << depth_bits | depth_key;
+}
+
+void RenderQueue::sort(ThreadPool * pool)
+{
+    size_t const count = m_items.size();
+    if(count < min_radix_size)
+    {
+        std::stable_sort(m_items.begin(), m_items.end(),
+                         [](RenderItem const & l, RenderItem const & r) { return l.key < r.key; });
+        return;
+    }
+
+    size_t const num_chunks =
+        pool != nullptr ? std::clamp<size_t>(count / min_chunk_size, 1, pool->getNumThreads() + 1) : 1;
+
+    auto chunk_begin = [count, num_chunks](size_t chunk) { return chunk * count / num_chunks; };
+    auto for_chunks  = [pool, num_chunks](auto && func) {
+        if(num_chunks == 1)
+        {
+            func(size_t{0});
+            return;
+        }
+
+        parallel_for(
+            *pool, size_t{0}, num_chunks,
+            [&func](size_t first, size_t last) {
+                for(size_t chunk = first; chunk < last; ++chunk)
+                    func(chunk);
+            },
+            size_t{1});
+    };
+
+    m_buffer.resize(count);
+    m_histograms.assign(num_chunks * num_digits * num_buckets, 0);
+
+    // the histograms of all the digits in one read, the totals don't change with the order of the items
+    for_chunks([this, &chunk_begin](size_t chunk) {
+        uint32_t * hist = &m_histograms[chunk * num_digits * num_buckets];
+        for(size_t i = chunk_begin(chunk); i < chunk_begin(chunk + 1); ++i)
+        {
+            uint64_t const key = m_items[i].key;
+            for(uint32_t digit = 0; digit < num_digits; ++digit)
+                ++hist[digit * num_buckets + ((key >> (digit * digit_bits)) & (num_buckets - 1))];
+        }
+    });
+
+    RenderItem * src        = m_items.data();
+    RenderItem * dst        = m_buffer.data();
+    bool         first_pass = true;
+    for(uint32_t digit = 0; digit < num_digits; ++digit)
+    {
+        // the digits equal in all the keys, e.g. the layer, don't change the order
+        bool skip = false;
+        for(uint32_t bucket = 0; bucket < num_buckets && !skip; ++bucket)
+        {
+            size_t total = 0;
+            for(size_t chunk = 0; chunk < num_chunks; ++chunk)
+                total += m_histograms[(chunk * num_digits + digit) * num_buckets + bucket];
+
+            skip = total == count;
+        }
+
+        if(skip)
+            continue;
+
+        // the chunks of the previous passes hold the other items
+        uint32_t const shift = digit * digit_bits;
+        if(!first_pass && num_chunks > 1)
+        {
+            for_chunks([this, src, digit, shift, &chunk_begin](size_t chunk) {
+                uint32_t * hist = &m_histograms[(chunk * num_digits + digit) * num_buckets];
+                std::fill(hist, hist + num_buckets, 0);
+                for(size_t i = chunk_begin(chunk); i < chunk_begin(chunk + 1); ++i)
+                    ++hist[(src[i].key >> shift) & (num_buckets - 1)];
+            });
+        }
+        first_pass = false;
+
+        // the buckets are written in order, the chunks in order inside a bucket, so the sort is stable
+        uint32_t offset = 0;
+        for(uint32_t bucket = 0; bucket < num_buckets; ++bucket)
+        {
+            for(size_t chunk = 0; chunk < num_chunks; ++chunk)
+            {
+                uint32_t &     entry = m_histograms[(chunk * num_digits + digit) * num_buckets + bucket];
+                uint32_t const size  = entry;
+                entry                = offset;
+                offset += size;
+            }
+        }
+
+        for_chunks([this, src, dst, digit, shift, &chunk_begin](size_t chunk) {
+            uint32_t * offsets = &m_histograms[(chunk * num_digits + digit) * num_buckets];
+            for(size_t i = chunk_begin(chunk); i < chunk_begin(chunk + 1); ++i)
+                dst[offsets[(src[i].key >> shift) & (num_buckets - 1)]++] = src[i];
+        });
+
+        std::swap(src, dst);
+    }
+
+    if(src != m_items.data())
+        m_items.swap(m_buffer);
+}
+}   // namespace evnt
@@ -0,0 +1,55 @@
+#ifndef RENDERQUEUE_H
+#define RENDERQUEUE_H
+
+#include "scenemgr.h"
+
+namespace evnt
+{
+class ThreadPool;
+
+struct RenderItem
+{
+    uint64_t key;
+    uint32_t object;   // of the caller, e.g. the index in the render list
+};
+
+/**
+ * Render items sorted by 64-bit keys, from the most significant bits: the layer, the translucency, then the
+ * pipeline, the material and the depth of the opaque items, or the depth, the pipeline and the material of
+ * the translucent ones. So the opaque items of a layer are grouped by the state Pipeline::optimize() keeps
+ * and ordered by the depth inside a group, the translucent ones follow them ordered by the depth only.
+ * The keys are sorted by an LSD radix sort of the 8-bit digits, the digits equal in all the keys are
+ * skipped, and the items are split into chunks over the pool if given.
+ */
+class RenderQueue
+{
+public:
+    static constexpr uint32_t layer_bits    = 4;
+    static constexpr uint32_t pipeline_bits = 12;
+    static constexpr uint32_t material_bits = 20;
+    static constexpr uint32_t depth_bits    = 27;
+
+    // Any non-negative depth, e.g. the squared distance to the viewer, the float is kept with 19 bits of its
+    // mantissa. The opaque items are ordered by the order, the translucent ones always back to front.
+    static uint64_t MakeKey(SceneMgr::SortState const & state, float depth, SceneMgr::SortOrder order);
+
+    void clear() { m_items.clear(); }
+    void reserve(size_t count) { m_items.reserve(count); }
+    void add(uint64_t key, uint32_t object) { m_items.push_back({key, object}); }
+    // stable, std::stable_sort() for the short queues
+    void sort(ThreadPool * pool = nullptr);
+
+    std::vector<RenderItem> const & getItems() const { return m_items; }
+    size_t                          size() const { return m_items.size(); }
+
+private:
+    static constexpr size_t min_radix_size = 1024;
+    static constexpr size_t min_chunk_size = 16384;   // items per pool task
+
+    std::vector<RenderItem> m_items;
+    std::vector<RenderItem> m_buffer;       // of the radix sort passes
+    std::vector<uint32_t>   m_histograms;   // [chunk][digit][bucket]
+};
+}   // namespace evnt
+
+#endif   // RENDERQUEUE_H
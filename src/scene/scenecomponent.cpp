@@ -1,4 +1,6 @@
 #include "scenecomponent.h"
+#include "../object/entity.h"
+#include <limits>
 
 namespace evnt
 {
@@ -9,6 +11,8 @@ SpatialComponent::SpatialComponent() :
     m_world_transform{1.0f},
     m_bbox{},
     m_culling{SpatialComponent::CullingMode::cull_dynamic},
+    m_scene_object{std::numeric_limits<uint32_t>::max()},
+    m_hierarchy_node{std::numeric_limits<uint32_t>::max()},
     m_parent{nullptr}
 {}
 
@@ -16,6 +20,7 @@ void SpatialComponent::updateTree(uint32_t ms_delta, bool initiator)
 {
     updateWorldData(ms_delta);
     updateWorldBound();
+    notifyTransformChanged();
 
     if(initiator)
     {
@@ -60,10 +65,22 @@ void SpatialComponent::propagateBoundToRoot()
     if(m_parent)
     {
         m_parent->updateWorldBound();
+        m_parent->notifyTransformChanged();
         m_parent->propagateBoundToRoot();
     }
 }
 
+void SpatialComponent::notifyTransformChanged()
+{
+    // the entities of a hierarchy node are moved in one batch by the hierarchy
+    if(m_hierarchy_node != std::numeric_limits<uint32_t>::max())
+        return;
+
+    // the sender class is skipped by sendMessage()
+    if(Entity * owner = getOwner())
+        owner->sendMessage(CLASS_Undefined, CmpMsgsTable::mTransformChanged, this);
+}
+
 int32_t SpatialComponent::attachChild(SpatialComponent * child)
 {
     if(!child)
@@ -136,5 +153,5 @@ void SpatialComponent::write(OutputMemoryStream & inMemoryStream, ObjectManager
 
 void SpatialComponent::read(InputMemoryStream const & inMemoryStream, ObjectManager & gmgr) {}
 
-void SpatialComponent::link(ObjectManager & gmgr, std::map<uint32_t, uint32_t> const & id_remap) {}
+void SpatialComponent::link(ObjectManager & gmgr, IdRemap const & id_remap) {}
 }   // namespace evnt
@@ -30,6 +30,8 @@ struct SpatialComponent : public Component
     AABB m_bbox;   // AABB in world space
 
     CullingMode m_culling;
+    uint32_t    m_scene_object;     // the SceneMgr::ObjectID of the entity, set by SceneMgr::addEntity()
+    uint32_t    m_hierarchy_node;   // the TransformHierarchy::NodeID of the entity, set by its owner
 
     SpatialComponent *              m_parent;
     std::vector<SpatialComponent *> m_children;   // Child nodes
@@ -43,10 +45,15 @@ struct SpatialComponent : public Component
     // Update of geometric state and controllers.  The function computes world
     // transformations on the downward pass of the scene graph traversal and
     // world bounding volumes on the upward pass of the traversal.
+    // Recursive, every initiator walks to the root, see TransformHierarchy for the large scenes.
+    // CmpMsgsTable::mTransformChanged is sent with the component for each of the changed bounds, to the
+    // component itself too, it moves the scene object (see SceneMgr::registerTransformHandler()). The
+    // components with a hierarchy node send nothing, they follow the node (see SceneMgr::followHierarchy()).
     void updateTree(uint32_t ms_delta = 0, bool initiator = true);
     void updateWorldData(uint32_t ms_delta);
     void updateWorldBound();
     void propagateBoundToRoot();
+    void notifyTransformChanged();
 
     // This is the current number of elements in the child array.
     int32_t getNumChildren() const { return static_cast<int32_t>(m_children.size()); }
@@ -1,6 +1,95 @@
 #include "scenemgr.h"
+#include "../log/log.h"
+#include "boundingvolumehierarchy.h"
+#include "loosegrid.h"
+#include "spatialscenemgr.h"
 
 namespace evnt
 {
 SceneMgr::SceneMgr() {}
+
+std::unique_ptr<SceneMgr> SceneMgr::CreateSceneMgr(std::string const & type, float grid_cell_size,
+                                                   ThreadPool * pool)
+{
+    if(type == "grid")
+    {
+        return std::make_unique<SpatialSceneMgr>(std::make_unique<LooseGrid>(grid_cell_size),
+                                                 std::make_unique<LooseGrid>(grid_cell_size), pool);
+    }
+
+    if(type != "bvh")
+        Log::Log(Log::warning, Log::cstr_log("Unknown scene manager type: %s, bvh is used", type.c_str()));
+
+    return std::make_unique<SpatialSceneMgr>(std::make_unique<BoundingVolumeHierarchy>(),
+                                             std::make_unique<BoundingVolumeHierarchy>(), pool);
+}
+
+SceneMgr::ObjectID SceneMgr::addEntity(PObjHandle entity)
+{
+    auto * const entity_ptr = dynamic_ohdl_cast<Entity>(entity);
+    assert(entity_ptr != nullptr);
+
+    auto & spatial = entity_ptr->getComponent<SpatialComponent>();
+    if(spatial.m_scene_object != invalid_object)
+        return spatial.m_scene_object;
+
+    if(entity_ptr->queryComponentImplementation(CLASS_LightComponent) != nullptr)
+        spatial.m_scene_object = addLight(std::move(entity), spatial.m_bbox, spatial.m_culling);
+    else
+        spatial.m_scene_object = addObject(std::move(entity), spatial.m_bbox, spatial.m_culling);
+
+    if(spatial.m_hierarchy_node != TransformHierarchy::invalid_node)
+    {
+        if(spatial.m_hierarchy_node >= m_node_objects.size())
+            m_node_objects.resize(spatial.m_hierarchy_node + 1, invalid_object);
+
+        m_node_objects[spatial.m_hierarchy_node] = spatial.m_scene_object;
+    }
+
+    return spatial.m_scene_object;
+}
+
+void SceneMgr::removeEntity(PObjHandle entity)
+{
+    auto * const entity_ptr = dynamic_ohdl_cast<Entity>(entity);
+    assert(entity_ptr != nullptr);
+
+    auto & spatial = entity_ptr->getComponent<SpatialComponent>();
+    if(spatial.m_scene_object == invalid_object)
+        return;
+
+    removeObject(spatial.m_scene_object);
+    spatial.m_scene_object = invalid_object;
+
+    if(spatial.m_hierarchy_node < m_node_objects.size())
+        m_node_objects[spatial.m_hierarchy_node] = invalid_object;
+}
+
+void SceneMgr::registerTransformHandler()
+{
+    Entity::s_msg_handlers.registerMessageCallback(
+        CmpMsgsTable::mTransformChanged, CLASS_SpatialComponent,
+        [this](Component * rec, CmpMsgsTable::msg_id id, std::any msg_data) {
+            auto const * spatial = std::any_cast<SpatialComponent *>(msg_data);
+            if(spatial->m_scene_object != invalid_object)
+                moveObject(spatial->m_scene_object, spatial->m_bbox);
+        });
+}
+
+void SceneMgr::followHierarchy(TransformHierarchy & hierarchy)
+{
+    hierarchy.setMovedCallback([this, &hierarchy](std::vector<TransformHierarchy::NodeID> const & nodes) {
+        for(TransformHierarchy::NodeID node : nodes)
+        {
+            ObjectID const object = node < m_node_objects.size() ? m_node_objects[node] : invalid_object;
+            if(object == invalid_object)
+                continue;
+
+            // the nodes without bounds keep the last one
+            AABB const & bound = hierarchy.getWorldBound(node);
+            if(bound.min().x <= bound.max().x)
+                moveObject(object, bound);
+        }
+    });
+}
 }   // namespace evnt
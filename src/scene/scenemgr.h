@@ -4,26 +4,81 @@
 #include "../object/entity.h"
 #include "cameracomponent.h"
 #include "scenecomponent.h"
+#include "transformhierarchy.h"
+#include <limits>
 
 namespace evnt
 {
+class ThreadPool;
+
 class SceneMgr
 {
 public:
+    using ObjectID    = uint32_t;
+    using CullingMode = SpatialComponent::CullingMode;
+
+    inline static ObjectID const invalid_object = std::numeric_limits<ObjectID>::max();
+
     enum class SortOrder
     {
         Back_To_Front,
         Front_To_Back
     };
 
+    // The render state of a renderable sortRenderList() groups by, see RenderQueue
+    struct SortState
+    {
+        uint32_t layer       = 0;   // the pass, e.g. the framebuffer
+        uint32_t pipeline    = 0;   // the shader and the fixed function state
+        uint32_t material    = 0;   // the vertex array and the textures
+        bool     translucent = false;
+    };
+
     SceneMgr();
     virtual ~SceneMgr() = default;
 
+    // type "bvh" or "grid", the cell size of the grid is about the size of the common objects
+    // the large render lists are sorted in the pool if given
+    static std::unique_ptr<SceneMgr> CreateSceneMgr(std::string const & type, float grid_cell_size,
+                                                    ThreadPool * pool = nullptr);
+
+    virtual ObjectID addObject(PObjHandle obj, AABB const & bound,
+                               CullingMode mode = CullingMode::cull_dynamic)   = 0;
+    virtual ObjectID addLight(PObjHandle light, AABB const & bound,
+                              CullingMode mode = CullingMode::cull_dynamic)    = 0;
+    virtual void     removeObject(ObjectID object)                             = 0;   // or light
+    virtual void     moveObject(ObjectID object, AABB const & bound)           = 0;
+    virtual void     setSortState(ObjectID object, SortState const & state)    = 0;
+
     virtual void updateLists(Frustum const & cam_frustum, Frustum const * frust2, bool render_queue_update,
                              bool light_queue_update)                       = 0;
     virtual std::vector<PObjHandle> const & getRenderList() const           = 0;
     virtual std::vector<PObjHandle> const & getLightList() const            = 0;
     virtual void                            sortRenderList(SortOrder order) = 0;
+
+    // The renderables only. castRay() returns the object with the nearest bound along the ray or a null
+    // handle.
+    virtual void       queryAABB(AABB const & bound, std::vector<PObjHandle> & result) const = 0;
+    virtual PObjHandle castRay(glm::vec3 const & origin, glm::vec3 const & dir,
+                               float max_dist = std::numeric_limits<float>::max(),
+                               float * dist   = nullptr) const                               = 0;
+
+    // The entity with the bound and the culling mode of its SpatialComponent, a light if it has a
+    // LightComponent. The id is kept in SpatialComponent::m_scene_object until removeEntity(), the entity
+    // should be removed before its SpatialComponent::m_hierarchy_node.
+    ObjectID addEntity(PObjHandle entity);
+    void     removeEntity(PObjHandle entity);
+
+    // The SpatialComponents without a hierarchy node move their scene objects, m_scene_object, on the
+    // CmpMsgsTable::mTransformChanged messages. One manager per application, the last registered one gets
+    // the messages.
+    void registerTransformHandler();
+    // The entities with a hierarchy node are moved to the world bounds of their nodes, in one batch at the
+    // end of each hierarchy.update().
+    void followHierarchy(TransformHierarchy & hierarchy);
+
+private:
+    std::vector<ObjectID> m_node_objects;   // by TransformHierarchy::NodeID
 };
 }   // namespace evnt
 #endif   // SCENEMGR_H
@@ -0,0 +1,126 @@
+#ifndef SPATIALINDEX_H
+#define SPATIALINDEX_H
+
+#include "frustum.h"
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <limits>
+
+namespace evnt
+{
+/**
+ * Spatial structure of a scene manager: proxies of the world bounds with the user data, the scene object
+ * ids. The implementations may defer the moves to update().
+ */
+class SpatialIndex
+{
+public:
+    using ProxyID = uint32_t;
+
+    inline static ProxyID const invalid_proxy = std::numeric_limits<ProxyID>::max();
+
+    virtual ~SpatialIndex() = default;
+
+    virtual ProxyID  addProxy(AABB const & bound, uint32_t user_data) = 0;
+    virtual void     removeProxy(ProxyID proxy)                       = 0;
+    virtual void     moveProxy(ProxyID proxy, AABB const & bound)     = 0;
+    virtual uint32_t getUserData(ProxyID proxy) const                 = 0;
+    virtual size_t   getNumProxies() const                            = 0;
+    virtual void     update()                                         = 0;
+
+    // The proxies inside the frustum, and inside frust2 too if it isn't null
+    virtual void queryFrustum(Frustum const & frustum, Frustum const * frust2,
+                              std::vector<ProxyID> & result) const                  = 0;
+    virtual void queryAABB(AABB const & bound, std::vector<ProxyID> & result) const = 0;
+    // The proxy with the nearest bound along the ray. dir needn't be normalized, the distances are in the
+    // dir lengths, 0 if the origin is inside.
+    virtual ProxyID castRayFirst(glm::vec3 const & origin, glm::vec3 const & dir, float max_dist,
+                                 float * dist = nullptr) const = 0;
+};
+
+// The planes of one or two frusta for the box tests of the spatial indices
+struct FrustumPlanes
+{
+    glm::vec3 normal[12];
+    glm::vec3 abs_normal[12];
+    float     dist[12];
+    uint32_t  count{0};
+
+    explicit FrustumPlanes(Frustum const & frustum, Frustum const * frust2 = nullptr)
+    {
+        for(Frustum const * frust : {&frustum, frust2})
+        {
+            for(uint32_t i = 0; frust != nullptr && i < 6; ++i, ++count)
+            {
+                Plane const & plane = frust->getPlane(i);
+
+                normal[count]     = plane.m_normal;
+                abs_normal[count] = glm::abs(plane.m_normal);
+                dist[count]       = plane.m_dist;
+            }
+        }
+    }
+
+    uint32_t getAllPlanesMask() const { return (1u << count) - 1; }
+
+    // False if the box is outside of a plane of the mask, its nearest corner is outside. The bits of the
+    // planes the box is inside of are cleared, the children of a box needn't test them.
+    bool test(glm::vec3 const & center, glm::vec3 const & extent, uint32_t & mask) const
+    {
+        for(uint32_t i = 0; i < count; ++i)
+        {
+            if((mask & (1u << i)) == 0)
+                continue;
+
+            float const d   = glm::dot(normal[i], center) + dist[i];
+            float const rad = glm::dot(abs_normal[i], extent);
+            if(d > rad)
+                return false;
+            if(d < -rad)
+                mask &= ~(1u << i);
+        }
+
+        return true;
+    }
+};
+
+inline glm::vec3 GetInverse(glm::vec3 const & dir)
+{
+    return glm::vec3(1.0f / dir.x, 1.0f / dir.y, 1.0f / dir.z);
+}
+
+// False if the ray misses the box or enters it farther than max_dist, dist is 0 if the origin is inside
+inline bool IntersectRay(glm::vec3 const & origin, glm::vec3 const & inv_dir, float max_dist,
+                         glm::vec3 const & min, glm::vec3 const & max, float & dist)
+{
+    float t_min = 0.0f;
+    float t_max = max_dist;
+    for(int axis = 0; axis < 3; ++axis)
+    {
+        // parallel to the slabs, 0 * inf would give NaN
+        if(std::isinf(inv_dir[axis]))
+        {
+            if(origin[axis] < min[axis] || origin[axis] > max[axis])
+                return false;
+
+            continue;
+        }
+
+        float t0 = (min[axis] - origin[axis]) * inv_dir[axis];
+        float t1 = (max[axis] - origin[axis]) * inv_dir[axis];
+        if(t0 > t1)
+            std::swap(t0, t1);
+
+        t_min = std::max(t_min, t0);
+        t_max = std::min(t_max, t1);
+        if(t_min > t_max)
+            return false;
+    }
+
+    dist = t_min;
+    return true;
+}
+}   // namespace evnt
+
+#endif   // SPATIALINDEX_H
@@ -0,0 +1,186 @@
+#include "spatialscenemgr.h"
+#include <algorithm>
+
+namespace evnt
+{
+SpatialSceneMgr::SpatialSceneMgr(std::unique_ptr<SpatialIndex> objects, std::unique_ptr<SpatialIndex> lights,
+                                 ThreadPool * pool) :
+    mp_object_index{std::move(objects)},
+    mp_light_index{std::move(lights)},
+    mp_thread_pool{pool}
+{}
+
+SpatialSceneMgr::ObjectID SpatialSceneMgr::addObject(PObjHandle obj, AABB const & bound, CullingMode mode)
+{
+    return insertObject(std::move(obj), bound, mode, false);
+}
+
+SpatialSceneMgr::ObjectID SpatialSceneMgr::addLight(PObjHandle light, AABB const & bound, CullingMode mode)
+{
+    return insertObject(std::move(light), bound, mode, true);
+}
+
+void SpatialSceneMgr::removeObject(ObjectID object)
+{
+    if(!isValid(object))
+        return;
+
+    ObjectInfo & info = m_objects[object];
+    if(info.mode == CullingMode::cull_dynamic)
+    {
+        getIndex(info).removeProxy(info.proxy);
+    }
+    else if(info.mode == CullingMode::cull_never)
+    {
+        auto const it = std::find(m_never_culled.begin(), m_never_culled.end(), object);
+        *it           = m_never_culled.back();
+        m_never_culled.pop_back();
+    }
+
+    info.handle.reset();
+    m_free_objects.push_back(object);
+}
+
+void SpatialSceneMgr::moveObject(ObjectID object, AABB const & bound)
+{
+    if(!isValid(object))
+        return;
+
+    ObjectInfo & info = m_objects[object];
+
+    info.bound = bound;
+    if(info.mode == CullingMode::cull_dynamic)
+        getIndex(info).moveProxy(info.proxy, bound);
+}
+
+void SpatialSceneMgr::setSortState(ObjectID object, SortState const & state)
+{
+    if(!isValid(object))
+        return;
+
+    m_objects[object].state = state;
+}
+
+void SpatialSceneMgr::updateLists(Frustum const & cam_frustum, Frustum const * frust2,
+                                  bool render_queue_update, bool light_queue_update)
+{
+    update();
+    m_view_origin = cam_frustum.getOrigin();
+
+    if(render_queue_update)
+    {
+        mp_object_index->queryFrustum(cam_frustum, frust2, m_query_result);
+
+        m_render_objects.clear();
+        for(SpatialIndex::ProxyID proxy : m_query_result)
+            m_render_objects.push_back(mp_object_index->getUserData(proxy));
+
+        for(ObjectID object : m_never_culled)
+        {
+            if(!m_objects[object].light)
+                m_render_objects.push_back(object);
+        }
+
+        m_render_list.clear();
+        for(ObjectID object : m_render_objects)
+            m_render_list.push_back(m_objects[object].handle);
+    }
+
+    if(light_queue_update)
+    {
+        mp_light_index->queryFrustum(cam_frustum, frust2, m_query_result);
+
+        m_light_list.clear();
+        for(SpatialIndex::ProxyID proxy : m_query_result)
+            m_light_list.push_back(m_objects[mp_light_index->getUserData(proxy)].handle);
+
+        for(ObjectID object : m_never_culled)
+        {
+            if(m_objects[object].light)
+                m_light_list.push_back(m_objects[object].handle);
+        }
+    }
+}
+
+void SpatialSceneMgr::sortRenderList(SortOrder order)
+{
+    // the objects removed after updateLists() keep their last bounds
+    m_render_queue.clear();
+    m_render_queue.reserve(m_render_objects.size());
+    for(uint32_t i = 0; i < m_render_objects.size(); ++i)
+    {
+        ObjectInfo const & info   = m_objects[m_render_objects[i]];
+        glm::vec3 const    offset = (info.bound.min() + info.bound.max()) * 0.5f - m_view_origin;
+
+        m_render_queue.add(RenderQueue::MakeKey(info.state, glm::dot(offset, offset), order), i);
+    }
+
+    m_render_queue.sort(mp_thread_pool);
+
+    std::vector<PObjHandle> sorted_list;
+    std::vector<ObjectID>   sorted_objects;
+    sorted_list.reserve(m_render_queue.size());
+    sorted_objects.reserve(m_render_queue.size());
+    for(RenderItem const & item : m_render_queue.getItems())
+    {
+        sorted_list.push_back(std::move(m_render_list[item.object]));
+        sorted_objects.push_back(m_render_objects[item.object]);
+    }
+
+    m_render_list.swap(sorted_list);
+    m_render_objects.swap(sorted_objects);
+}
+
+void SpatialSceneMgr::update()
+{
+    mp_object_index->update();
+    mp_light_index->update();
+}
+
+void SpatialSceneMgr::queryAABB(AABB const & bound, std::vector<PObjHandle> & result) const
+{
+    std::vector<SpatialIndex::ProxyID> proxies;
+    mp_object_index->queryAABB(bound, proxies);
+
+    result.clear();
+    for(SpatialIndex::ProxyID proxy : proxies)
+        result.push_back(m_objects[mp_object_index->getUserData(proxy)].handle);
+}
+
+PObjHandle SpatialSceneMgr::castRay(glm::vec3 const & origin, glm::vec3 const & dir, float max_dist,
+                                    float * dist) const
+{
+    SpatialIndex::ProxyID const proxy = mp_object_index->castRayFirst(origin, dir, max_dist, dist);
+    if(proxy == SpatialIndex::invalid_proxy)
+        return {};
+
+    return m_objects[mp_object_index->getUserData(proxy)].handle;
+}
+
+SpatialSceneMgr::ObjectID SpatialSceneMgr::insertObject(PObjHandle obj, AABB const & bound, CullingMode mode,
+                                                        bool light)
+{
+    assert(obj);
+
+    ObjectID object;
+    if(!m_free_objects.empty())
+    {
+        object = m_free_objects.back();
+        m_free_objects.pop_back();
+    }
+    else
+    {
+        object = static_cast<ObjectID>(m_objects.size());
+        m_objects.emplace_back();
+    }
+
+    ObjectInfo & info = m_objects[object];
+    info              = {std::move(obj), bound, SpatialIndex::invalid_proxy, mode, light, {}};
+    if(mode == CullingMode::cull_dynamic)
+        info.proxy = getIndex(info).addProxy(bound, object);
+    else if(mode == CullingMode::cull_never)
+        m_never_culled.push_back(object);
+
+    return object;
+}
+}   // namespace evnt
@@ -0,0 +1,87 @@
+#ifndef SPATIALSCENEMGR_H
+#define SPATIALSCENEMGR_H
+
+#include "renderqueue.h"
+#include "spatialindex.h"
+
+namespace evnt
+{
+/**
+ * Scene manager over two spatial indices, of the renderables and of the lights. The objects are registered
+ * with their world bounds, the SpatialComponent::m_bbox, and moved with their TransformHierarchy nodes; the
+ * indices are updated at the next updateLists(). The cull_never objects skip the indices and are always
+ * listed, the directional and ambient lights should be added so. The cull_always objects are kept but never
+ * listed.
+ */
+class SpatialSceneMgr : public SceneMgr
+{
+public:
+    SpatialSceneMgr(std::unique_ptr<SpatialIndex> objects, std::unique_ptr<SpatialIndex> lights,
+                    ThreadPool * pool = nullptr);
+    ~SpatialSceneMgr() override = default;
+
+    ObjectID addObject(PObjHandle obj, AABB const & bound,
+                       CullingMode mode = CullingMode::cull_dynamic) override;
+    ObjectID addLight(PObjHandle light, AABB const & bound,
+                      CullingMode mode = CullingMode::cull_dynamic) override;
+    void     removeObject(ObjectID object) override;
+    void     moveObject(ObjectID object, AABB const & bound) override;
+    void     setSortState(ObjectID object, SortState const & state) override;
+    bool     isValid(ObjectID object) const { return object < m_objects.size() && m_objects[object].handle; }
+    size_t   getNumObjects() const { return m_objects.size() - m_free_objects.size(); }
+
+    // The objects inside cam_frustum and frust2 if given, e.g. the receivers inside a shadow frustum and the
+    // view. A list not updated stays as is.
+    void updateLists(Frustum const & cam_frustum, Frustum const * frust2, bool render_queue_update,
+                     bool light_queue_update) override;
+    std::vector<PObjHandle> const & getRenderList() const override { return m_render_list; }
+    std::vector<PObjHandle> const & getLightList() const override { return m_light_list; }
+    // by the sort states and the distances of the bound centers to the origin of the last cam_frustum, see
+    // RenderQueue
+    void sortRenderList(SortOrder order) override;
+
+    // the moved objects are found after updateLists() or update()
+    void       update();
+    void       queryAABB(AABB const & bound, std::vector<PObjHandle> & result) const override;
+    PObjHandle castRay(glm::vec3 const & origin, glm::vec3 const & dir,
+                       float max_dist = std::numeric_limits<float>::max(),
+                       float * dist   = nullptr) const override;
+
+    SpatialIndex const & getObjectIndex() const { return *mp_object_index; }
+    SpatialIndex const & getLightIndex() const { return *mp_light_index; }
+
+private:
+    struct ObjectInfo
+    {
+        PObjHandle  handle;
+        AABB        bound;
+        uint32_t    proxy;   // in the index, invalid_proxy if not culled
+        CullingMode mode;
+        bool        light;
+        SortState   state;
+    };
+
+    ObjectID       insertObject(PObjHandle obj, AABB const & bound, CullingMode mode, bool light);
+    SpatialIndex & getIndex(ObjectInfo const & info)
+    {
+        return info.light ? *mp_light_index : *mp_object_index;
+    }
+
+    std::vector<ObjectInfo> m_objects;
+    std::vector<ObjectID>   m_free_objects;
+    std::vector<ObjectID>   m_never_culled;
+
+    std::unique_ptr<SpatialIndex> mp_object_index;
+    std::unique_ptr<SpatialIndex> mp_light_index;
+
+    std::vector<PObjHandle>            m_render_list;
+    std::vector<ObjectID>              m_render_objects;   // of m_render_list
+    std::vector<PObjHandle>            m_light_list;
+    std::vector<SpatialIndex::ProxyID> m_query_result;
+    glm::vec3                          m_view_origin{0.0f};
+    RenderQueue                        m_render_queue;
+    ThreadPool *                       mp_thread_pool;
+};
+}   // namespace evnt
+
+#endif   // SPATIALSCENEMGR_H
@@ -0,0 +1,320 @@
+#include "transformhierarchy.h"
+#include "../core/taskgraph.h"
+#include <algorithm>
+#include <type_traits>
+
+namespace evnt
+{
+namespace
+{
+    bool IsEmpty(AABB const & bb)
+    {
+        glm::vec3 const min = bb.min();
+        glm::vec3 const max = bb.max();
+
+        return min.x > max.x || min.y > max.y || min.z > max.z;
+    }
+
+    // expandBy() of the default AABB keeps the max above 0
+    AABB const empty_bound{glm::vec3{std::numeric_limits<float>::max()},
+                           glm::vec3{std::numeric_limits<float>::lowest()}};
+
+    template<typename RangeType>
+    void MergeRanges(std::vector<RangeType> & ranges)
+    {
+        if(ranges.size() < 2)
+            return;
+
+        std::sort(ranges.begin(), ranges.end(),
+                  [](RangeType const & l, RangeType const & r) { return l.first < r.first; });
+
+        size_t last = 0;
+        for(size_t i = 1; i < ranges.size(); ++i)
+        {
+            if(ranges[i].first <= ranges[last].last)
+                ranges[last].last = std::max(ranges[last].last, ranges[i].last);
+            else
+                ranges[++last] = ranges[i];
+        }
+
+        ranges.resize(last + 1);
+    }
+}   // namespace
+
+TransformHierarchy::NodeID TransformHierarchy::addNode(NodeID parent, glm::mat4 const & local,
+                                                       AABB const & local_bound)
+{
+    assert(parent == invalid_node || isValid(parent));
+
+    NodeID id;
+    if(!m_free_ids.empty())
+    {
+        id = m_free_ids.back();
+        m_free_ids.pop_back();
+    }
+    else
+    {
+        id = static_cast<NodeID>(m_nodes.size());
+        m_nodes.emplace_back();
+    }
+
+    // appended, moved to its level by the next update
+    auto const index = static_cast<uint32_t>(m_ids.size());
+    m_nodes[id]      = {parent, index, {}, true};
+    if(parent != invalid_node)
+        m_nodes[parent].children.push_back(id);
+    else
+        m_roots.push_back(id);
+
+    m_local.push_back(local);
+    m_world.push_back(local);
+    m_local_bound.push_back(local_bound);
+    m_bound.push_back(empty_bound);
+    m_parent.push_back(parent != invalid_node ? m_nodes[parent].index : invalid_node);
+    m_first_child.push_back(0);
+    m_num_children.push_back(0);
+    m_dirty.push_back(0);
+    m_ids.push_back(id);
+    queueChange(index, local_changed);
+
+    ++m_num_alive;
+    m_order_changed = true;
+
+    return id;
+}
+
+void TransformHierarchy::removeNode(NodeID node)
+{
+    if(!isValid(node))
+        return;
+
+    NodeID const parent   = m_nodes[node].parent;
+    auto &       siblings = parent != invalid_node ? m_nodes[parent].children : m_roots;
+    siblings.erase(std::find(siblings.begin(), siblings.end(), node));
+    if(parent != invalid_node)
+        queueChange(m_nodes[parent].index, bound_changed);
+
+    // the rows are dropped by the next update
+    std::vector<NodeID> stack{node};
+    while(!stack.empty())
+    {
+        NodeID const id   = stack.back();
+        auto &       info = m_nodes[id];
+        stack.pop_back();
+
+        stack.insert(stack.end(), info.children.begin(), info.children.end());
+        info.children.clear();
+        info.alive = false;
+
+        m_free_ids.push_back(id);
+        --m_num_alive;
+    }
+
+    m_order_changed = true;
+}
+
+void TransformHierarchy::setLocalTransform(NodeID node, glm::mat4 const & local)
+{
+    uint32_t const index = m_nodes[node].index;
+
+    m_local[index] = local;
+    queueChange(index, local_changed);
+}
+
+void TransformHierarchy::setLocalBound(NodeID node, AABB const & bound)
+{
+    uint32_t const index = m_nodes[node].index;
+
+    m_local_bound[index] = bound;
+    queueChange(index, bound_changed);
+}
+
+void TransformHierarchy::update(ThreadPool * pool)
+{
+    m_moved_nodes.clear();
+
+    if(m_order_changed)
+        rebuildOrder();
+
+    if(m_changed_nodes.empty())
+        return;
+
+    size_t const num_levels = getNumLevels();
+    m_world_ranges.resize(num_levels);
+    m_bound_ranges.resize(num_levels);
+    for(size_t level = 0; level < num_levels; ++level)
+    {
+        m_world_ranges[level].clear();
+        m_bound_ranges[level].clear();
+    }
+
+    for(NodeID id : m_changed_nodes)
+    {
+        uint32_t const index = isValid(id) ? m_nodes[id].index : invalid_node;
+        if(index == invalid_node || m_dirty[index] == 0)
+            continue;   // removed or queued twice
+
+        auto const level  = std::upper_bound(m_level_offsets.begin(), m_level_offsets.end(), index) - 1;
+        auto const offset = static_cast<size_t>(level - m_level_offsets.begin());
+        auto &     ranges = (m_dirty[index] & local_changed) ? m_world_ranges : m_bound_ranges;
+        ranges[offset].push_back({index, index + 1});
+        m_dirty[index] = 0;
+    }
+    m_changed_nodes.clear();
+
+    auto for_range = [pool](Range range, auto && func) {
+        size_t const count = range.last - range.first;
+        if(pool && count > min_chunk_size)
+        {
+            parallel_for(*pool, size_t{range.first}, size_t{range.last}, func,
+                         std::max(min_chunk_size, count / (4 * (pool->getNumThreads() + 1))));
+        }
+        else
+        {
+            func(range.first, range.last);
+        }
+    };
+
+    // top-down, the changed nodes and the children of the updated ones
+    for(size_t level = 0; level < num_levels; ++level)
+    {
+        auto & ranges = m_world_ranges[level];
+        MergeRanges(ranges);
+
+        for(Range range : ranges)
+            for_range(range, [this](size_t first, size_t last) { updateWorld(first, last); });
+
+        if(level + 1 == num_levels)
+            break;
+
+        for(Range range : ranges)
+        {
+            uint32_t const first = m_first_child[range.first];
+            uint32_t const last  = m_first_child[range.last - 1] + m_num_children[range.last - 1];
+            if(first < last)
+                m_world_ranges[level + 1].push_back({first, last});
+        }
+    }
+
+    // bottom-up, the updated nodes and their parents, once per parent however many children changed
+    for(size_t level = num_levels; level-- > 0;)
+    {
+        auto & ranges = m_bound_ranges[level];
+        ranges.insert(ranges.end(), m_world_ranges[level].begin(), m_world_ranges[level].end());
+        MergeRanges(ranges);
+
+        for(Range range : ranges)
+        {
+            for_range(range, [this](size_t first, size_t last) { updateBounds(first, last); });
+            m_moved_nodes.insert(m_moved_nodes.end(), &m_ids[range.first], &m_ids[range.last - 1] + 1);
+        }
+
+        if(level == 0)
+            break;
+
+        for(Range range : ranges)
+            m_bound_ranges[level - 1].push_back({m_parent[range.first], m_parent[range.last - 1] + 1});
+    }
+
+    if(m_on_moved && !m_moved_nodes.empty())
+        m_on_moved(m_moved_nodes);
+}
+
+void TransformHierarchy::queueChange(uint32_t index, uint8_t change)
+{
+    if(m_dirty[index] == 0)
+        m_changed_nodes.push_back(m_ids[index]);
+
+    m_dirty[index] |= change;
+}
+
+void TransformHierarchy::rebuildOrder()
+{
+    std::vector<NodeID>   order(m_roots);
+    std::vector<uint32_t> first_child;
+    std::vector<uint32_t> num_children;
+    order.reserve(m_num_alive);
+    first_child.reserve(m_num_alive);
+    num_children.reserve(m_num_alive);
+
+    m_level_offsets.assign(1, 0);
+    for(size_t begin = 0; begin < order.size();)
+    {
+        size_t const end = order.size();
+        m_level_offsets.push_back(end);
+
+        for(size_t i = begin; i < end; ++i)
+        {
+            auto const & children = m_nodes[order[i]].children;
+            first_child.push_back(static_cast<uint32_t>(order.size()));
+            num_children.push_back(static_cast<uint32_t>(children.size()));
+            order.insert(order.end(), children.begin(), children.end());
+        }
+
+        begin = end;
+    }
+
+    auto gather = [this, &order](auto & array) {
+        std::remove_reference_t<decltype(array)> sorted;
+        sorted.reserve(order.size());
+        for(NodeID id : order)
+            sorted.push_back(array[m_nodes[id].index]);
+
+        array.swap(sorted);
+    };
+
+    gather(m_local);
+    gather(m_world);
+    gather(m_local_bound);
+    gather(m_bound);
+    gather(m_dirty);
+
+    for(size_t i = 0; i < order.size(); ++i)
+        m_nodes[order[i]].index = static_cast<uint32_t>(i);
+
+    m_parent.resize(order.size());
+    for(size_t i = 0; i < order.size(); ++i)
+    {
+        NodeID const parent = m_nodes[order[i]].parent;
+        m_parent[i]         = parent != invalid_node ? m_nodes[parent].index : invalid_node;
+    }
+
+    m_first_child.swap(first_child);
+    m_num_children.swap(num_children);
+    m_ids.swap(order);
+    m_order_changed = false;
+}
+
+void TransformHierarchy::updateWorld(size_t first, size_t last)
+{
+    // the parents are in the previous level, updated before
+    for(size_t i = first; i < last; ++i)
+    {
+        uint32_t const parent = m_parent[i];
+        m_world[i]            = parent != invalid_node ? m_world[parent] * m_local[i] : m_local[i];
+    }
+}
+
+void TransformHierarchy::updateBounds(size_t first, size_t last)
+{
+    // the children are in the next level, updated before
+    for(size_t i = first; i < last; ++i)
+    {
+        AABB bound = empty_bound;
+        if(!IsEmpty(m_local_bound[i]))
+        {
+            bound = m_local_bound[i];
+            bound.transform(m_world[i]);
+        }
+
+        uint32_t const first_child = m_first_child[i];
+        for(uint32_t c = first_child; c < first_child + m_num_children[i]; ++c)
+        {
+            if(!IsEmpty(m_bound[c]))
+                bound.expandBy(m_bound[c]);
+        }
+
+        m_bound[i] = bound;
+    }
+}
+}   // namespace evnt
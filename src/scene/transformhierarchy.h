@@ -0,0 +1,111 @@
+#ifndef TRANSFORMHIERARCHY_H
+#define TRANSFORMHIERARCHY_H
+
+#include "AABB.h"
+#include <cstdint>
+#include <functional>
+#include <limits>
+
+namespace evnt
+{
+class ThreadPool;
+
+/**
+ * Flattened transform tree. The local and world matrices, bounds and parent indices are kept in arrays
+ * sorted breadth-first: the nodes of one depth are contiguous, the children of a node are contiguous and a
+ * parent always precedes its children. update() walks the levels in order, so a level is computed after
+ * the one above it without pointer chasing and is split into chunks over the pool. Only the subtrees of the
+ * changed nodes are recomputed, the bounds of their ancestors are merged once per update however many
+ * siblings changed. Nodes are referenced by stable ids, the arrays are reordered after the tree changes.
+ * The nodes of the recomputed bounds are reported once per update, in one batch.
+ */
+class TransformHierarchy
+{
+public:
+    using NodeID        = uint32_t;
+    using MovedCallback = std::function<void(std::vector<NodeID> const & nodes)>;
+
+    inline static NodeID const invalid_node = std::numeric_limits<NodeID>::max();
+
+    // local_bound in the node space, the default AABB is empty
+    NodeID addNode(NodeID parent = invalid_node, glm::mat4 const & local = glm::mat4{1.0f},
+                   AABB const & local_bound = AABB{});
+    void   removeNode(NodeID node);   // with the subtree
+    bool   isValid(NodeID node) const { return node < m_nodes.size() && m_nodes[node].alive; }
+    NodeID getParent(NodeID node) const { return m_nodes[node].parent; }
+    size_t getNumNodes() const { return m_num_alive; }
+    size_t getNumLevels() const { return m_level_offsets.empty() ? 0 : m_level_offsets.size() - 1; }
+
+    void setLocalTransform(NodeID node, glm::mat4 const & local);
+    void setLocalBound(NodeID node, AABB const & bound);
+
+    glm::mat4 const & getLocalTransform(NodeID node) const { return m_local[m_nodes[node].index]; }
+    // valid after update()
+    glm::mat4 const & getWorldTransform(NodeID node) const { return m_world[m_nodes[node].index]; }
+    AABB const &      getWorldBound(NodeID node) const { return m_bound[m_nodes[node].index]; }   // subtree
+
+    // World transforms of the changed subtrees top-down, then the bounds of them and their ancestors
+    // bottom-up. The cost depends on the number of the updated nodes, not the tree size. Ranges larger than
+    // a chunk are spread over the pool if given.
+    void update(ThreadPool * pool = nullptr);
+
+    // The nodes of the world bounds recomputed by the last update(), the children before their parents.
+    // The callback gets them at the end of each update() that changed any.
+    std::vector<NodeID> const & getMovedNodes() const { return m_moved_nodes; }
+    void                        setMovedCallback(MovedCallback callback) { m_on_moved = std::move(callback); }
+
+private:
+    struct NodeInfo
+    {
+        NodeID              parent;
+        uint32_t            index;   // in the arrays
+        std::vector<NodeID> children;
+        bool                alive;
+    };
+
+    struct Range
+    {
+        uint32_t first;
+        uint32_t last;
+    };
+
+    // m_dirty bits
+    static constexpr uint8_t local_changed = 1;
+    static constexpr uint8_t bound_changed = 2;
+
+    static constexpr size_t min_chunk_size = 512;   // nodes per pool task
+
+    void queueChange(uint32_t index, uint8_t change);
+    void rebuildOrder();
+    void updateWorld(size_t first, size_t last);
+    void updateBounds(size_t first, size_t last);
+
+    std::vector<NodeInfo> m_nodes;   // by id
+    std::vector<NodeID>   m_free_ids;
+    std::vector<NodeID>   m_roots;
+    std::vector<NodeID>   m_changed_nodes;
+    std::vector<NodeID>   m_moved_nodes;
+    MovedCallback         m_on_moved;
+    size_t                m_num_alive{0};
+    bool                  m_order_changed{false};
+
+    // The nodes to update by level. The children of consecutive nodes are consecutive, so the children and
+    // the parents of a range are a range too, a whole level of a moved tree is one range.
+    std::vector<std::vector<Range>> m_world_ranges;
+    std::vector<std::vector<Range>> m_bound_ranges;
+
+    // breadth-first order, level i is [m_level_offsets[i], m_level_offsets[i + 1])
+    std::vector<glm::mat4> m_local;
+    std::vector<glm::mat4> m_world;
+    std::vector<AABB>      m_local_bound;
+    std::vector<AABB>      m_bound;
+    std::vector<uint32_t>  m_parent;        // index, invalid_node for the roots
+    std::vector<uint32_t>  m_first_child;   // index
+    std::vector<uint32_t>  m_num_children;
+    std::vector<uint8_t>   m_dirty;   // queued changes
+    std::vector<NodeID>    m_ids;
+    std::vector<size_t>    m_level_offsets;
+};
+}   // namespace evnt
+
+#endif   // TRANSFORMHIERARCHY_H